@@ -6,10 +6,13 @@
 #include "token.h"
 #include "icode.h"
 
+class cx_context;
+
 /// cx_backend            Abstract back end class.
 
 class cx_backend {
 protected:
+    cx_context * const p_context; // context of the script being run
     cx_token *p_token; // ptr to the current token
     cx_token_code token; // code of current token
     cx_icode *p_icode; // ptr to current icode
@@ -33,12 +36,19 @@ protected:
         return p_icode->get_location_marker();
     }
 
+    int get_call_marker(void) {
+        return p_icode->get_call_marker();
+    }
+
     void get_case_item(int &value, int &location) {
         p_icode->get_case_item(value, location);
     }
 
 public:
 
+    cx_backend(cx_context *p_context) : p_context(p_context) {
+    }
+
     virtual ~cx_backend(void) {
     }
 
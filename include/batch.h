@@ -0,0 +1,16 @@
+/** Batch runner
+ * batch.h
+ *
+ * Run every script of a directory in one process, several at once,
+ * each in a context of its own, taking turns in slices of statements.
+ */
+
+#ifndef batch_h
+#define batch_h
+
+// statements a batch script runs per turn, unless --slice says
+const long cx_batch_default_slice = 100000;
+
+int cx_run_batch(const char *p_directory, int job_count, long slice);
+
+#endif
@@ -2,6 +2,8 @@
 #define buffer_h
 
 #include <fstream>
+#include <sstream>
+#include <string>
 #include <cstdio>
 #include <cstring>
 #include "misc.h"
@@ -15,10 +17,9 @@
  *         *
  ***********/
 
+class cx_context;
+
 extern const char eof_char;
-extern int input_position;
-extern int list_flag;
-extern int level;
 
 const int max_input_buffer_size = 256;
 
@@ -26,7 +27,10 @@ const int max_input_buffer_size = 256;
 
 class cx_text_in_buffer {
 protected:
+    cx_context *const p_context; // context of the script being read
     std::fstream file; // input text file
+    std::istringstream source; // input text, if not read from a file
+    std::istream *p_input; // file or source
     char *const p_file_name; // ptr to the file name
     char text[max_input_buffer_size]; // input text buffer
     char *p_char; /* ptr to the current char
@@ -35,11 +39,14 @@ protected:
     virtual char get_line(void) = 0;
 
 public:
-    cx_text_in_buffer(const char *p_input_file_name, cx_abort_code ac);
+    cx_text_in_buffer(cx_context *p_context, const char *p_input_file_name,
+            cx_abort_code ac);
+    cx_text_in_buffer(cx_context *p_context, const char *p_input_name,
+            const std::string &input_text);
 
     virtual ~cx_text_in_buffer(void) {
         file.close();
-        delete p_file_name;
+        delete[] p_file_name;
     }
 
     const char *file_name(void) {
@@ -60,7 +67,9 @@ class cx_source_buffer : public cx_text_in_buffer {
     virtual char get_line(void);
 
 public:
-    cx_source_buffer(const char *p_source_file_name);
+    cx_source_buffer(cx_context *p_context, const char *p_source_file_name);
+    cx_source_buffer(cx_context *p_context, const char *p_source_name,
+            const std::string &source_text);
 };
 
 /************
@@ -95,18 +104,29 @@ class cx_list_buffer : public cx_text_out_buffer {
     char date[26]; // date string for page header
     int page_number; // current page number
     int line_count; // count of lines in the current page
+    std::string *p_capture; // if set, lines are kept here, not printed
 
     void print_page_header(void);
 
 public:
 
+    cx_list_buffer(void)
+    : p_source_file_name(nullptr), page_number(0), line_count(0),
+    p_capture(nullptr) {
+        memset(text, '\0', sizeof (text));
+    }
+
     virtual ~cx_list_buffer(void) {
-        delete p_source_file_name;
+        delete[] p_source_file_name;
     }
 
     void initialize(const char *p_file_name);
     virtual void put_line(void);
 
+    void capture(std::string *p_text) {
+        p_capture = p_text;
+    }
+
     void put_line(const char *p_text) {
         cx_text_out_buffer::put_line(p_text);
     }
@@ -117,6 +137,4 @@ public:
     }
 };
 
-extern cx_list_buffer list;
-
 #endif
\ No newline at end of file
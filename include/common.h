@@ -5,33 +5,25 @@
 #include "misc.h"
 #include "symtable.h"
 #include "icode.h"
-
-extern int current_line_number;
-extern int current_nesting_level;
-extern cx_symtab cx_global_symtab;
-extern int symtab_count;
-extern cx_symtab *p_symtab_list;
-extern cx_symtab **p_vector_symtabs;
-
-// Pointers to predefined types.
-extern cx_symtab_node *p_main_function_id;
-extern cx_symtab_node *p_stdin;
-extern cx_symtab_node *p_stdout;
-extern cx_symtab_node *p_stderr;
-
-extern cx_type *p_integer_type;
-extern cx_type *p_float_type;
-//extern cx_type *p_double_type;
-extern cx_type *p_boolean_type;
-extern cx_type *p_char_type;
-extern cx_type *p_string_type;
-extern cx_type *p_class_type;
-extern cx_type *p_complex_type;
-extern cx_type *p_file_type;
-
-extern cx_type *p_dummy_type;
-
-extern cx_symtab cx_global_symtab;
+#include "context.h"
+
+/** cx_string_constant   Entry of the string constant pool.  Each
+ *                      distinct literal is pooled once at parse time,
+ *                      and the executor pushes a ptr to its data, so
+ *                      the length and hash are at hand without a scan.
+ *
+ *                      The data is read-only and '\0' terminated.
+ */
+struct cx_string_constant {
+    unsigned int hash;
+    int length;
+    mutable const struct cx_format *p_format; // once used as a printf format
+    char data[1];
+};
+
+unsigned int cx_string_hash(const char *p_string, int length);
+const char *cx_intern_string(const char *p_string, int length);
+const cx_string_constant *cx_string_constant_of(const void *p_data);
 
 // tokens that can start a statement
 extern const cx_token_code tokenlist_statement_start[];
@@ -87,6 +79,12 @@ bool token_in(cx_token_code tc, const cx_token_code *p_list);
 
 // env variable that holds the path to stdlib
 #define __CX_STDLIB__   "CX_STDLIB"
+
+// env variable that holds the directory of precompiled scripts
+#define __CX_CACHE__    "CX_CACHE"
+
+// env variable that holds the number of threads parallel for runs on
+#define __CX_THREADS__  "CX_THREADS"
 #endif
 //endfig
 
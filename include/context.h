@@ -0,0 +1,135 @@
+/** Interpreter context
+ * context.h
+ *
+ * Everything the translation and the execution of one script share.
+ * Each script gets a context of its own, so several can be parsed
+ * and run at once, each on its own thread.
+ */
+
+#ifndef context_h
+#define context_h
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "buffer.h"
+#include "symtable.h"
+
+struct cx_string_constant;
+struct cx_out_buffer;
+struct cx_event_loop;
+struct cx_task_table;
+struct cx_channel_table;
+struct cx_run_account;
+class cx_scheduler;
+
+///  cx_context         State of one script, from parse to exit.
+
+class cx_context {
+public:
+
+    // source position and listing
+    int current_line_number;
+    int current_nesting_level;
+    int input_position; // of the current char, with tabs expanded
+    int list_flag; // true if list source lines, else false
+    cx_list_buffer list;
+
+    // syntax errors
+    int error_count;
+    bool error_arrow_flag; // true to print arrows under syntax errors
+    int error_arrow_offset; // offset for printing the error arrow
+    bool embedded; // in a host program: errors throw cx_abort, not exit
+
+    bool xreference_flag; // true = cross-referencing on, false = off
+    int asm_label_index;
+
+    // symbol tables, numbered as they're made
+    int symtab_count;
+    cx_symtab *p_symtab_list;
+    cx_symtab **p_vector_symtabs;
+    cx_symtab global_symtab; // made after the counters it bumps
+
+    // calls resolved by the parser, indexed from the icode
+    std::vector<cx_call_site> call_sites;
+
+    // parallel for loops, indexed from the icode the same way
+    std::vector<cx_parallel_loop> parallel_loops;
+
+    // string constants, keyed by their contents
+    std::unordered_map<std::string, cx_string_constant *> string_pool;
+
+    // resolved paths of the modules #included so far
+    std::unordered_set<std::string> included_modules;
+
+    // standard routines called so far, whose names a script's own
+    // declarations can no longer take, see cx_symtab::shadowable
+    std::unordered_set<const cx_symtab_node *> called_standard_routines;
+
+    cx_symtab_node *p_program_ptr_id;
+
+    // predefined ids and types
+    cx_symtab_node *p_main_function_id;
+    cx_symtab_node *p_stdin;
+    cx_symtab_node *p_stdout;
+    cx_symtab_node *p_stderr;
+
+    cx_type *p_integer_type;
+    cx_type *p_uint8_type;
+    cx_type *p_uint16_type;
+    cx_type *p_uint32_type;
+    cx_type *p_uint64_type;
+    cx_type *p_float_type;
+    cx_type *p_double_type;
+    cx_type *p_boolean_type;
+    cx_type *p_char_type;
+    cx_type *p_wchar_type;
+    cx_type *p_complex_type;
+    cx_type *p_file_type;
+    cx_type *p_dummy_type;
+
+    // stream buffers, see io.cpp, and sockets, see net.cpp
+    cx_out_buffer *p_out_buffers;
+    std::vector<cx_out_buffer *> unsent_buffers;
+    cx_event_loop *p_event_loop;
+
+    // tasks spawned and not yet joined, see task.cpp
+    cx_task_table *p_tasks;
+
+    // channels, see channel.cpp
+    cx_channel_table *p_channels;
+
+    /* the scheduler the script's runs take turns under, if any, and
+     * what they took, see scheduler.h */
+    cx_scheduler *p_scheduler;
+    cx_run_account *p_account;
+
+    cx_context(void);
+    ~cx_context(void);
+
+    void convert_symtabs(void);
+
+    static cx_context *current(void);
+
+private:
+    friend class cx_context_scope;
+
+    cx_context(const cx_context &);
+    cx_context &operator=(const cx_context &);
+};
+
+/** cx_context_scope     Makes a context the current one of this
+ *                      thread for as long as the scope lives.  Code
+ *                      that isn't handed a context, as cx_error,
+ *                      uses the current one.
+ */
+class cx_context_scope {
+    cx_context *p_saved;
+
+public:
+    cx_context_scope(cx_context *p_context);
+    ~cx_context_scope(void);
+};
+
+#endif
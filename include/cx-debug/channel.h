@@ -0,0 +1,104 @@
+/** Channels
+ * channel.h
+ *
+ * Queues that pass values between the tasks of a script, and between
+ * a script and the threads of its host.  A channel carries values of
+ * one type, and holds up to its capacity of them, or any number if
+ * it's unbounded.
+ */
+
+#ifndef channel_h
+#define channel_h
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include "cx-debug/exec.h"
+
+/** cx_channel           A channel.  Values go through a ring of cells
+ *                      that senders and receivers claim without a
+ *                      lock (Vyukov's bounded MPMC queue).  A bounded
+ *                      channel counts the room it has left, so it's
+ *                      full at its capacity, not the ring's.  An
+ *                      unbounded channel whose ring is full spills
+ *                      into a locked deque, which is drained before
+ *                      the ring is sent into again.
+ *
+ * An array or a record travels as its buffer, which the channel owns
+ * while it holds the value.
+ */
+class cx_channel {
+
+    struct cx_cell {
+        std::atomic<size_t> sequence;
+        mem_block value;
+    };
+
+    cx_cell *p_cells;
+    const size_t mask; // count of cells, less one
+
+    // apart, as senders and receivers race for them
+    char padding0[64];
+    std::atomic<size_t> send_position;
+    char padding1[64];
+    std::atomic<size_t> receive_position;
+    char padding2[64];
+
+    std::atomic<int> room; // sends a bounded channel has room for
+    std::atomic<int> spill_count;
+    std::atomic<int> waiting; // threads waiting to send or receive
+    std::atomic<bool> closed;
+
+    std::mutex spill_mutex;
+    std::deque<mem_block> spilled;
+
+    bool push(const mem_block &value);
+    bool pop(mem_block &value);
+    bool can_send(void) const;
+    bool can_receive(void) const;
+    void wake(void);
+
+    cx_channel(const cx_channel &);
+    cx_channel &operator=(const cx_channel &);
+
+public:
+    cx_type *const p_element_type;
+    const bool is_array; // of p_element_type, of any length
+    const int capacity; // 0 if unbounded
+
+    cx_channel(cx_type *p_element_type, bool is_array, int capacity);
+    ~cx_channel(void);
+
+    // an array or a record, whose value is a buffer
+    bool holds_buffers(void) const {
+        return is_array || !p_element_type->is_scalar_type();
+    }
+
+    bool try_send(const mem_block &value);
+    bool try_receive(mem_block &value);
+    bool send(const mem_block &value);
+    bool receive(mem_block &value);
+    void close(void);
+};
+
+/** cx_channel_table     The channels of a script, by handle.  Channels
+ *                      are made under a lock, and live as long as the
+ *                      script's context, so a handle is looked up
+ *                      without one.
+ */
+struct cx_channel_table {
+    static const int chunk_size = 256;
+    static const int max_chunks = 256;
+
+    std::mutex mutex; // guards making channels
+    int count;
+    std::atomic<std::atomic<cx_channel *> *> chunks[max_chunks];
+
+    cx_channel_table(void);
+    ~cx_channel_table(void);
+
+    int add(cx_channel *p_channel);
+    cx_channel *find(int handle) const;
+};
+
+#endif
@@ -2,15 +2,20 @@
 #define exec_h
 
 #include <vector>
+#include <unordered_map>
 #include <algorithm>
+#include <climits>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include "error.h"
 #include "symtable.h"
 #include "types.h"
 #include "icode.h"
 #include "backend.h"
 
+class cx_context;
 class cx_type;
 extern bool cx_dev_debug_flag;
 
@@ -127,6 +132,104 @@ struct cx_stack_item {
 
 };
 
+/** cx_value_buffer      Header of the storage of an array or record
+ *                      value.  The value's data follows the header,
+ *                      and stack items point at the data.  Value
+ *                      parameters share the buffer of their actual
+ *                      until either side stores into it.
+ *
+ *                      The data is always followed by a '\0', so
+ *                      strings can be handed to C as is.
+ */
+struct cx_value_buffer {
+    int ref_count;
+    int capacity; // bytes the data can grow to without moving
+    int length; // bytes of data in use
+    bool is_inline; // held by a cx_inline_value, never freed
+    bool is_mapped; // read-only pages of a file, see cx_value_map
+};
+
+/** cx_inline_value      Frame slot that holds a small array or
+ *                      record value itself, so short strings
+ *                      need no buffer of their own.  The header
+ *                      must come right before the data.
+ */
+struct cx_inline_value : public cx_stack_item {
+    static const int capacity = 16;
+
+    cx_value_buffer header;
+    char data[capacity + 1];
+
+    cx_inline_value(int size) {
+        header.ref_count = 1;
+        header.capacity = capacity;
+        header.length = size;
+        header.is_inline = true;
+        header.is_mapped = false;
+        memset(data, 0, sizeof (data));
+
+        basic_types.addr__ = data;
+    }
+};
+
+// an array reference parm, whose slot holds its actual's slot
+bool cx_slot_reference(const cx_symtab_node *p_id);
+
+void *cx_value_alloc(int size);
+void *cx_value_resize(void *addr, int size);
+void *cx_value_reserve(void *addr, int capacity);
+void *cx_value_map(int fd, int64_t offset, int length, bool sequential);
+void *cx_value_share(void *addr);
+void *cx_value_unshare(void *addr);
+void *cx_value_take(void *&addr, int size);
+void cx_value_release(void *addr);
+int cx_value_length(const void *addr);
+int cx_value_size(const cx_type *p_type, const void *addr);
+
+void cx_stream_flush_all(void);
+void cx_stream_release_all(cx_context *p_context);
+bool cx_stream_open(cx_type *p_stream_type, const char *p_name,
+        const char *p_mode);
+void cx_stream_close(cx_type *p_stream_type);
+bool cx_stream_pending(const cx_type *p_stream_type);
+int cx_stream_getc(cx_type *p_stream_type);
+int cx_stream_getline(cx_type *p_stream_type, void *&addr);
+int cx_stream_scan_int(cx_type *p_stream_type);
+float cx_stream_scan_float(cx_type *p_stream_type);
+int cx_stream_read(cx_type *p_stream_type, void *p_data, int size);
+int cx_stream_write(cx_type *p_stream_type, const void *p_data, int size);
+int cx_stream_format(cx_type *p_stream_type, const struct cx_format &format,
+        const struct cx_format_arg *p_args);
+int cx_stream_pread(cx_type *p_stream_type, void *p_data, int size,
+        int64_t offset);
+int64_t cx_stream_transfer(cx_type *p_source_type, cx_type *p_target_type,
+        int64_t length);
+bool cx_stream_eof(const cx_type *p_stream_type);
+void cx_stream_send_pending(std::vector<int> &blocked_fds);
+void cx_stream_bind(cx_type *p_variable_type, cx_type *p_stream_type);
+
+int cx_socket_connect(cx_type *p_variable_type, const char *p_address);
+int cx_socket_listen(cx_type *p_variable_type, const char *p_address);
+int cx_socket_wait(cx_type *p_variable_type, int timeout);
+int cx_socket_ready(const cx_type *p_stream_type);
+void cx_socket_forget(cx_type *p_stream_type);
+void cx_socket_release_all(cx_context *p_context);
+
+void cx_task_release_all(cx_context *p_context);
+
+/** cx_stream_lock       Keeps the other tasks of a script (see
+ *                      task.cpp) off its streams while one of them
+ *                      uses a stream.  Until the script spawns a
+ *                      task there are none, and it does nothing.
+ */
+class cx_stream_lock {
+    std::mutex *p_mutex;
+
+public:
+    cx_stream_lock(const cx_context *p_context);
+    ~cx_stream_lock(void);
+};
+
 typedef std::vector<cx_stack_item *> cx_stack;
 typedef cx_stack::iterator cx_stack_iterator;
 
@@ -177,15 +280,17 @@ struct cx_frame_header : public cx_stack_item {
 ///  cx_runtime_stack       Runtime stack class.
 
 class cx_runtime_stack {
+    cx_context *const p_context; // context whose types the values have
     cx_stack cx_runstack;
 
     const cx_frame_header *p_stackbase;
     cx_frame_header *p_frame_base; // ptr to current stack frame base
+    const cx_frame_header *p_global_frame_base; // ptr to the program's frame
 
     cx_stack_iterator it_frame_base; // iterator to frame base
 
 public:
-    cx_runtime_stack(void);
+    cx_runtime_stack(cx_context *p_context);
 
     void push(const bool &value) {
             cx_runstack.push_back(new cx_stack_item((bool)value));
@@ -268,12 +373,34 @@ public:
         return (cx_runstack.end() - 1);
     }
 
+    void set_global_frame(const cx_frame_header *p_frame) {
+        p_global_frame_base = p_frame;
+    }
+
+    cx_stack_item *new_value(const cx_type *p_type) const;
     void allocate_value(cx_symtab_node *p_id);
-    void deallocate_value(cx_symtab_node *p_id);
 
     cx_stack_item *get_value_address(const cx_symtab_node *p_id);
+
+    // for the workers of a parallel for, see parallel.cpp
+    void share_frames(const cx_runtime_stack &owner,
+            const cx_symtab_node *p_program_id,
+            const cx_symtab_node *p_function_id);
+    void share_frame(const cx_runtime_stack &owner,
+            const cx_frame_header *p_header,
+            const cx_symtab_node *p_function_id);
+    cx_stack_item *privatize(const cx_symtab_node *p_id);
+
+    // for a spawned task, see task.cpp
+    std::vector<cx_stack_item *> global_slots(const cx_symtab_node *p_program_id) const;
+    void share_globals(const std::vector<cx_stack_item *> &slots);
 };
 
+struct cx_parallel_chunk;
+struct cx_parallel_loop;
+struct cx_spawned_task;
+class cx_channel;
+
 //  cx_executor           Executor subclass of cx_backend.
 
 class cx_executor : public cx_backend {
@@ -284,6 +411,31 @@ class cx_executor : public cx_backend {
 
     bool break_loop; // if true, breaks current loop
 
+    int nesting_level; // of the routine running
+
+    /* a worker of a parallel for or a spawned task runs views of the
+     * icode, see parallel.cpp */
+    bool is_worker;
+    std::unordered_map<const cx_icode *, cx_icode *> icode_views;
+
+    /* statement_count at which a run holding a scheduler's slot ends
+     * its turn, see scheduler.h */
+    long yield_at;
+
+    /* holds a slot of the context's scheduler, if it has one, through
+     * a run of go, start or call, other than a worker's */
+    class cx_run_slot {
+        cx_executor *p_executor;
+        long start_count;
+        bool entered;
+
+    public:
+        cx_run_slot(cx_executor *p_executor);
+        ~cx_run_slot(void);
+    };
+
+    void yield_slot(void);
+
     // Trace flags
     bool trace_routine_flag; // true to trace routine entry/exit
     bool trace_statement_flag; // true to trace statements
@@ -291,6 +443,7 @@ class cx_executor : public cx_backend {
     bool trace_fetch_flag; // true to trace data fetches
 
     // Routines
+    void enter_global(cx_symtab_node *p_program_id);
     void initialize_global(cx_symtab_node *p_program_id);
     void execute_routine(cx_symtab_node *p_function_id);
     void enter_routine(cx_symtab_node *p_function_id);
@@ -298,7 +451,24 @@ class cx_executor : public cx_backend {
     cx_type *execute_subroutine_call(cx_symtab_node *p_function_id);
     cx_type *execute_declared_subroutine_call(cx_symtab_node *p_function_id);
     cx_type *execute_standard_subroutine_call(cx_symtab_node *p_function_id);
-    void execute_actual_parameters(cx_symtab_node *p_function_id);
+    cx_type *execute_intrinsic_call(cx_symtab_node *p_function_id);
+    cx_type *execute_host_call(cx_symtab_node *p_function_id);
+    int execute_native_actuals(struct cx_intrinsic_arg *p_args);
+    cx_type *execute_reserve_call(cx_symtab_node *p_function_id);
+    cx_type *execute_stream_read_call(cx_symtab_node *p_function_id);
+    cx_type *execute_file_call(cx_symtab_node *p_function_id);
+    cx_type *execute_binary_io_call(cx_symtab_node *p_function_id);
+    cx_type *execute_transfer_call(cx_symtab_node *p_function_id);
+    cx_type *execute_byte_view_call(cx_symtab_node *p_function_id);
+    cx_type *execute_format_call(cx_symtab_node *p_function_id);
+    cx_type *execute_socket_call(cx_symtab_node *p_function_id);
+    cx_type *execute_join_call(cx_symtab_node *p_function_id);
+    cx_type *execute_channel_call(cx_symtab_node *p_function_id);
+    cx_type *execute_send_call(cx_symtab_node *p_function_id);
+    cx_type *execute_receive_call(cx_symtab_node *p_function_id);
+    cx_channel *channel_of(void);
+    cx_type *execute_atomic_call(cx_symtab_node *p_function_id);
+    void execute_actual_parameters(void);
 
     // Statements
     cx_symtab_node *enter_new(cx_symtab_node *p_function_id,
@@ -353,6 +523,7 @@ class cx_executor : public cx_backend {
 
     void file_out(const cx_symtab_node* p_target_id,
             const cx_type* p_expr_type);
+    cx_type *stream_type_of(const cx_symtab_node *p_id);
 
     void execute_DO(cx_symtab_node *p_function_id);
     void execute_WHILE(cx_symtab_node *p_function_id);
@@ -362,6 +533,20 @@ class cx_executor : public cx_backend {
     void execute_RETURN(cx_symtab_node *p_function_id);
     void execute_compound(cx_symtab_node *p_function_id);
 
+    // parallel for, see parallel.cpp
+    void execute_PARALLEL(cx_symtab_node *p_function_id);
+    void execute_chunk(const cx_executor &owner, const cx_parallel_loop &loop,
+            cx_symtab_node *p_function_id, int statement_location,
+            cx_parallel_chunk &chunk);
+    cx_icode *icode_of(cx_icode *p_icode);
+
+    // spawned tasks, see task.cpp
+    cx_type *execute_spawn(void);
+    void execute_task(const std::vector<cx_stack_item *> &global_slots,
+            cx_symtab_node *p_function_id, const std::vector<mem_block> &args,
+            cx_spawned_task &task);
+    void join_tasks(void);
+
     // Expressions
     cx_type *execute_expression(void);
     cx_type *execute_simple_expression(void);
@@ -391,6 +576,14 @@ class cx_executor : public cx_backend {
         run_stack.push(value);
     }
 
+    void push(const uint32_t &value) {
+        run_stack.push(value);
+    }
+
+    void push(const uint64_t &value) {
+        run_stack.push(value);
+    }
+
     void push(const int &value) {
         run_stack.push(value);
     }
@@ -407,6 +600,8 @@ class cx_executor : public cx_backend {
         run_stack.push(addr);
     }
 
+    void push_value(const cx_type *p_type, const mem_block &value);
+
     void pop(void) {
         run_stack.pop();
     }
@@ -421,7 +616,8 @@ class cx_executor : public cx_backend {
 
 public:
 
-    cx_executor(void) : cx_backend() {
+    cx_executor(cx_context *p_context)
+    : cx_backend(p_context), run_stack(p_context) {
         statement_count = 0;
 
         extern bool cx_dev_debug_flag;
@@ -432,9 +628,27 @@ public:
         trace_fetch_flag = cx_dev_debug_flag;
 
         break_loop = false;
+        nesting_level = 0;
+        is_worker = false;
+        yield_at = LONG_MAX;
     }
 
+    ~cx_executor(void);
+
     virtual void go(cx_symtab_node *p_program_id);
+
+    // for a host program, see script.h
+    void start(cx_symtab_node *p_program_id);
+    mem_block call(cx_symtab_node *p_function_id, const mem_block *p_args);
+    void stop(cx_symtab_node *p_program_id);
+
+    cx_stack_item *global_value(const cx_symtab_node *p_id) {
+        return run_stack.get_value_address(p_id);
+    }
+
+    long statements(void) const {
+        return statement_count;
+    }
 };
 
 #endif
\ No newline at end of file
@@ -1,10 +1,6 @@
 #ifndef error_h
 #define error_h
 
-extern int error_count;
-extern bool error_arrow_flag;
-extern int error_arrow_offset;
-
 ///  Abort codes for fatal translator errors.
 
 enum cx_abort_code {
@@ -20,6 +16,14 @@ enum cx_abort_code {
     abort_unimplemented_feature = -10,
 };
 
+/** cx_abort      Thrown in place of exiting, when the script runs
+ *              in a host program (see script.h).  The message has
+ *              already gone to the context's list.
+ */
+struct cx_abort {
+    cx_abort_code code;
+};
+
 void abort_translation(cx_abort_code ac);
 
 ///  cx_error codes for syntax errors.
@@ -86,7 +90,14 @@ enum cx_error_code {
     err_unimplemented_feature,
     err_missing_left_paren,
     err_missing_single_quote,
-    err_invalid_escape_char
+    err_invalid_escape_char,
+    err_invalid_parallel_for,
+    err_parallel_store,
+    err_parallel_side_effect,
+    err_invalid_spawn,
+    err_invalid_atomic,
+    err_not_atomic,
+    err_atomic_usage
 };
 
 void cx_error(cx_error_code ec);
@@ -99,7 +110,12 @@ enum cx_runtime_error_code {
     rte_division_by_zero,
     rte_invalid_function_argument,
     rte_invalid_user_input,
-    rte_unimplemented_runtime_feature
+    rte_unimplemented_runtime_feature,
+    rte_stream_not_open,
+    rte_invalid_task,
+    rte_invalid_channel,
+    rte_channel_type,
+    rte_too_many_channels
 };
 
 void cx_runtime_error(cx_runtime_error_code ec);
@@ -0,0 +1,49 @@
+/** Formats
+ * format.h
+ *
+ * Compiled printf formats.
+ */
+
+#ifndef format_h
+#define format_h
+
+#include <string>
+#include <vector>
+#include "cx-debug/exec.h"
+
+class cx_type;
+
+/** cx_format_piece      A run of text, or one conversion, of a
+ *                      format.
+ */
+struct cx_format_piece {
+    char conversion; // 'd', 's', 'f', ...; '\0' for text
+    bool plain; // no flags, width or precision
+    bool left; // pad on the right (-)
+    int width; // -1 if none
+    int precision; // -1 if none
+    std::string text; // the text, or the conversion's C spec
+    std::string wide_text; // an integer conversion's spec with ll
+};
+
+/** cx_format            A format split into its pieces, so it's
+ *                      scanned once and not at every call.
+ */
+struct cx_format {
+    static const int max_args = 32;
+
+    std::vector<cx_format_piece> pieces;
+    std::string conversions; // one per argument, in order
+};
+
+/** cx_format_arg        An argument of a formatted print.
+ */
+struct cx_format_arg {
+    const cx_type *p_type;
+    mem_block value;
+};
+
+bool cx_compile_format(const char *p_text, int length, cx_format &format);
+const cx_format *cx_constant_format(const char *p_data);
+
+#endif
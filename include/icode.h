@@ -8,6 +8,7 @@
 //const cx_token_code mc_line_marker = ((cx_token_code) 127);
 //const cx_token_code mc_location_marker = ((cx_token_code) 126);
 
+class cx_context;
 class cx_symtab_node;
 
 ///  cx_icode      Intermediate code subclass of cx_scanner.
@@ -18,9 +19,12 @@ class cx_icode : public cx_scanner {
         code_segment_size = 4096
     };
 
+    cx_context *p_context; // context whose symtabs the code names
     char *p_code; // ptr to the code segment
     char *cursor; // ptr to current code location
+    int code_length; // length of a copied code segment
     cx_symtab_node *p_node; // ptr to extracted symbol table node
+    bool is_view; // reads the code of another icode, see view below
 
     void check_bounds(int size);
     cx_symtab_node *get_symtab_node(void);
@@ -28,8 +32,20 @@ class cx_icode : public cx_scanner {
 public:
     cx_icode(const cx_icode &icode); // copy constructor
 
-    cx_icode(void) {
+    cx_icode(cx_context *p_context) : p_context(p_context) {
         p_code = cursor = new char[code_segment_size];
+        code_length = 0;
+        is_view = false;
+    }
+
+    /* view:  a cursor of its own over another icode's code, for a
+     * worker of a parallel for or a spawned task.  It leaves the
+     * context's line number to the thread that owns the context, and
+     * keeps its worker's in cx_worker_line_number. */
+    cx_icode(const cx_icode *p_icode) : p_context(p_icode->p_context) {
+        p_code = cursor = p_icode->p_code;
+        code_length = p_icode->code_length;
+        is_view = true;
     }
 
     ~cx_icode(void) {
@@ -45,9 +61,21 @@ public:
     int put_location_marker(void);
     void fixup_location_marker(int location);
     int get_location_marker(void);
+    void put_call_marker(int index);
+    int get_call_marker(void);
     void put_case_item(int value, int location);
     void get_case_item(int &value, int &location);
 
+    void replace(const char *p_new_code, int length);
+
+    const char *code(void) const {
+        return p_code;
+    }
+
+    int length(void) const {
+        return code_length;
+    }
+
     void reset(void) {
         cursor = p_code;
     }
@@ -67,4 +95,9 @@ public:
     virtual cx_token *get(void);
 };
 
+// the line of the worker this thread is running, or nullptr
+extern thread_local int *cx_worker_line_number;
+
+int cx_runtime_line(const cx_context *p_context);
+
 #endif
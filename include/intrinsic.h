@@ -0,0 +1,38 @@
+/** Intrinsics
+ * intrinsic.h
+ *
+ * Native code standing in for routines of the standard library.
+ */
+
+#ifndef intrinsic_h
+#define intrinsic_h
+
+#include "cx-debug/exec.h"
+
+/** cx_intrinsic_arg     An argument of an intrinsic call.
+ */
+struct cx_intrinsic_arg {
+    const cx_type *p_type;
+    mem_block value; // the actual's address, if passed by reference
+    bool reference;
+};
+
+typedef mem_block(*cx_intrinsic_code)(const cx_intrinsic_arg *p_args);
+
+/** cx_intrinsic         A library routine with native code.  The
+ *                      routine's Cx source stays the reference; the
+ *                      native code is bound to it only when the
+ *                      name and the signature both match.
+ */
+struct cx_intrinsic {
+    static const int max_args = 4;
+
+    const char *p_name;
+    const char *p_signature; // e.g. "bool(char)", "int(char*)"
+    cx_intrinsic_code p_code;
+};
+
+void cx_bind_intrinsics(cx_symtab *p_symtab, int first_node);
+const cx_intrinsic *cx_find_intrinsic(const char *p_name);
+
+#endif
@@ -91,7 +91,9 @@ enum cx_token_code {
     tc_EXTERN, tc_OPERATOR, tc_TEMPLATE, tc_CONST,
     tc_PRIVATE, tc_THIS, tc_WHILE, tc_PROTECTED, tc_THREADLOCAL,
     tc_FOR, tc_PUBLIC, tc_THROW, tc_DEFAULT, tc_TYPEDEF, tc_MUTABLE, tc_INCLUDE,
+    tc_PARALLEL, tc_SPAWN, tc_ATOMIC,
 
+    mc_call_marker = 125,
     mc_location_marker = 126,
     mc_line_marker = 127
 };
@@ -118,7 +120,18 @@ union cx_data_value {
     char *p_string;
 };
 
-typedef std::map<char, cx_char_code> cx_char_code_map;
+/** cx_char_code_map    The code of every char.  It's filled in once,
+ *                      and only read after that, so every scanner
+ *                      shares it.
+ */
+struct cx_char_code_map {
+    cx_char_code codes[256];
+
+    cx_char_code operator[](char ch) const {
+        return codes[(unsigned char) ch];
+    }
+};
+
 typedef std::map<std::string, cx_token_code> token_map;
 
 #endif
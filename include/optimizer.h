@@ -0,0 +1,151 @@
+/** Optimizer
+ * optimizer.h
+ *
+ * Loop invariant code motion and common subexpression elimination
+ * over the intermediate code of each routine.
+ */
+
+#ifndef optimizer_h
+#define optimizer_h
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "misc.h"
+#include "symtable.h"
+#include "types.h"
+
+class cx_context;
+
+extern bool cx_optimize_flag;
+
+typedef std::set<const cx_symtab_node *> cx_node_set;
+
+///  cx_insn      A single token decoded from a routine's icode.
+
+struct cx_insn {
+    cx_token_code code;
+
+    // identifier, number or string node
+    cx_symtab_node *p_node;
+
+    /* line number of a line marker, or the index of the
+     * insn a location marker points to */
+    int value;
+};
+
+/** cx_candidate       A pure subexpression whose value can be
+ *                     computed once into a temporary.
+ */
+struct cx_candidate {
+    int begin, end; // insn span [begin, end)
+    int stmt; // index of the statement it belongs to
+    cx_type *p_type; // runtime type of the value
+    bool may_fault; // divides by a non constant
+    cx_node_set reads; // variables the value depends on
+};
+
+///  cx_expr_info       Summary of an analysed (sub)expression.
+
+struct cx_expr_info {
+    cx_type *p_type; // int or float result, else nullptr
+    bool pure; // no calls, stores or stream reads
+    bool has_op; // contains at least one binary operator
+    bool may_fault; // contains / or % by a non constant
+    bool nonzero_constant; // single constant that is not zero
+    cx_node_set reads;
+};
+
+///  cx_stmt            A statement found in a routine's icode.
+
+struct cx_stmt {
+
+    enum cx_stmt_kind {
+        sk_empty, sk_assign, sk_call, sk_do, sk_while, sk_for,
+        sk_if, sk_compound, sk_return, sk_break
+    };
+
+    cx_stmt_kind kind;
+    int begin, end; // insn span [begin, end)
+    bool in_list; // directly inside a statement list
+    bool pure; // expressions have no calls, stores or stream reads
+    bool calls; // calls a function
+    int line_number;
+    cx_node_set writes;
+    std::vector<int> candidates; // indexes into candidates
+    std::vector<int> children; // nested statements
+};
+
+///  cx_optimizer       Icode optimizer.
+
+class cx_optimizer {
+    cx_context *const p_context; // context of the script being optimized
+    cx_symtab_node *p_function_id; // routine being optimized
+    cx_symtab *p_symtab; // routine's local symtab
+
+    std::vector<cx_insn> insns;
+    std::string tail; // undecoded bytes after the routine's body
+    std::vector<cx_candidate> candidates;
+    std::vector<cx_stmt> stmts;
+    std::vector<std::vector<int> > stmt_lists;
+
+    int pos; // current insn index during analysis
+    int current_stmt;
+    bool failed;
+
+    // planned edits
+    std::map<int, std::vector<cx_insn> > inserts;
+    std::map<int, std::pair<int, cx_symtab_node *> > replacements;
+    int temp_count;
+    int hoist_count;
+    int cse_count;
+
+    bool decode(const cx_icode *p_icode);
+    void encode(cx_icode *p_icode);
+
+    cx_token_code code(void) const {
+        return pos < (int) insns.size() ? insns[pos].code : tc_end_of_file;
+    }
+
+    void expect(cx_token_code tc) {
+        if (code() != tc) failed = true;
+        else ++pos;
+    }
+
+    // analysis
+    void analyze_statement_list(cx_token_code terminator, int parent);
+    int analyze_statement(bool in_list);
+    void analyze_assignment(void);
+    void analyze_call(cx_symtab_node *p_id, cx_expr_info &info);
+    void analyze_subscripts(cx_expr_info &info);
+    cx_expr_info analyze_expression(void);
+    cx_expr_info analyze_simple_expression(void);
+    cx_expr_info analyze_term(void);
+    cx_expr_info analyze_factor(void);
+    void add_candidate(int begin, const cx_expr_info &info);
+    void note_write(const cx_symtab_node *p_id);
+
+    // transformations
+    void collect_region(int s, cx_node_set &writes, bool &calls,
+            std::vector<int> &region) const;
+    bool invariant(const cx_candidate &cand, const cx_node_set &writes,
+            bool shared_written) const;
+    bool overlaps(int begin, int end) const;
+    std::string key(const cx_candidate &cand) const;
+    cx_symtab_node *new_temp(cx_type *p_type);
+    void plan_temp(int at, int line_number, cx_symtab_node *p_temp,
+            const cx_candidate &cand);
+    void hoist_invariants(int s);
+    void eliminate_common_subexpressions(const std::vector<int> &list);
+
+public:
+
+    cx_optimizer(cx_context *p_context) : p_context(p_context) {
+    }
+
+    void optimize(cx_symtab_node *p_program_id);
+    void optimize_routine(cx_symtab_node *p_routine_id);
+};
+
+#endif
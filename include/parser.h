@@ -12,15 +12,14 @@
 #include "exec.h"
 #include "symtable.h"
 #include "types.h"
-
-
+#include "context.h"
 
 //extern cx_icode icode;
-extern cx_symtab cx_global_symtab;
 
 ///  cx_parser     Parser class.
 
 class cx_parser {
+    cx_context * const p_context; // context of the script being parsed
     cx_text_scanner * const p_scanner; // ptr to the scanner
     cx_token *p_token; // ptr to the current token
     cx_token_code token; // code of current token
@@ -28,6 +27,11 @@ class cx_parser {
     cx_icode icode;
 
     const char *file_name;
+
+    cx_symtab_node *p_routine_id; // routine whose body is being parsed
+    int loop_depth; // loops being parsed, for a break in a parallel for
+    int parallel_index; // parallel for whose body is being parsed, or -1
+    bool atomic_declaration; // the declaration being parsed is atomic
     //cx_runtime_stack run_stack;
     //cx_compact_list_buffer * const pCompact; // compact list buffer
 
@@ -43,16 +47,34 @@ class cx_parser {
             bool parm_check_flag);
     cx_type *parse_declared_subroutine_call(const cx_symtab_node *p_function_id,
             int parm_check_flag);
+    cx_type *parse_spawn(void);
+    cx_type *parse_standard_subroutine_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_reserve_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_stream_read_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_file_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_binary_io_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_transfer_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_byte_view_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_format_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_socket_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_handle_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_channel_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_channel_io_call(const cx_symtab_node *p_function_id);
+    cx_type *parse_atomic_call(const cx_symtab_node *p_function_id);
+    cx_symtab_node *parse_stream_argument(void);
+    void parse_char_array_argument(void);
+    cx_type *parse_variable_argument(void);
 
     void parse_actual_parm_list(const cx_symtab_node *p_function_id,
             int parm_check_flag);
-    void parse_actual_parm(const cx_symtab_node *p_formal_id,
+    cx_actual_parm parse_actual_parm(const cx_symtab_node *p_formal_id,
             int parm_check_flag);
 
     // declarations
     cx_symtab_node *allocate_new_node(cx_symtab_node *p_function_id);
     void parse_declarations_or_assignment(cx_symtab_node *p_function_id);
     void parse_constant_declaration(cx_symtab_node *p_function_id);
+    void parse_atomic_declaration(cx_symtab_node *p_function_id);
     void parse_constant(cx_symtab_node *p_const_id);
     void parse_identifier_constant(cx_symtab_node *p_id1, cx_token_code sign);
 
@@ -115,6 +137,17 @@ class cx_parser {
 
     void parse_execute_directive(cx_symtab_node *p_function_id);
 
+    // parallel for, see parse_parallel.cpp
+    void parse_PARALLEL(cx_symtab_node* p_function_id);
+    void parse_reductions(cx_parallel_loop &loop);
+    void parse_loop_index(const cx_symtab_node *p_index_id);
+    void note_private(const cx_symtab_node *p_id);
+    void note_store(const cx_symtab_node *p_id, cx_token_code op, bool whole);
+    void note_fetch(const cx_symtab_node *p_id);
+    void note_call(const cx_symtab_node *p_function_id);
+    void note_side_effect(void);
+    bool is_shared(const cx_symtab_node *p_id) const;
+
     void get_token(void) {
         p_token = p_scanner->get();
         token = p_token->code();
@@ -186,18 +219,19 @@ class cx_parser {
 
 public:
 
-    cx_parser(cx_text_in_buffer *p_buffer)
-    : p_scanner(new cx_text_scanner(p_buffer)) {
+    cx_parser(cx_context *p_context, cx_text_in_buffer *p_buffer)
+    : p_context(p_context), p_scanner(new cx_text_scanner(p_buffer)),
+    symtab_stack(p_context), icode(p_context) {
 
         file_name = p_buffer->file_name();
-
-        initialize_builtin_types(&cx_global_symtab);
-
+        p_routine_id = nullptr;
+        loop_depth = 0;
+        parallel_index = -1;
+        atomic_declaration = false;
     }
 
     ~cx_parser(void) {
         delete p_scanner;
-        remove_builtin_types();
     }
 
     cx_symtab_node *parse(bool std_lib_module = false);
@@ -0,0 +1,90 @@
+/** Task pool
+ * pool.h
+ *
+ * A pool of threads that run short tasks, such as the chunks of a
+ * parallel for.  Each thread keeps a deque of tasks of its own:  it
+ * takes its newest task from the back, and a thread with nothing
+ * to do steals the oldest task from the front of another's.  A thread
+ * blocked on something other than tasks, such as a channel, lends
+ * its place to a spare thread while tasks are waiting.
+ */
+
+#ifndef pool_h
+#define pool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class cx_task_group;
+
+///  cx_task             A task, and the group it's part of.
+
+struct cx_task {
+    std::function<void(void)> run;
+    cx_task_group *p_group;
+};
+
+///  cx_task_group       Tasks that are waited for together.
+
+class cx_task_group {
+    std::atomic<int> pending; // tasks added and not yet run
+
+    friend class cx_task_pool;
+
+public:
+
+    cx_task_group(void) : pending(0) {
+    }
+
+    bool done(void) const {
+        return pending.load() == 0;
+    }
+};
+
+///  cx_task_pool        Pool of threads with a deque of tasks each.
+
+class cx_task_pool {
+
+    struct cx_task_queue {
+        std::mutex mutex;
+        std::deque<cx_task> tasks;
+    };
+
+    // one per thread of the pool, and the last for every other thread
+    std::vector<cx_task_queue *> queues;
+
+    std::atomic<int> queued; // tasks in all the queues
+    std::mutex idle_mutex;
+    std::condition_variable changed; // a task was added, or a group done
+
+    // guarded by idle_mutex
+    int idle; // threads of the pool waiting for tasks
+    int blocked; // threads in block_until
+    int spares; // threads running in place of blocked ones
+
+    int queue_of_thread(void) const;
+    bool take(int xqueue, cx_task &task);
+    void run(cx_task &task);
+    void work(int xqueue, bool spare);
+
+public:
+    cx_task_pool(int thread_count);
+
+    static cx_task_pool &shared(void);
+
+    // the pool's threads and the one waiting on them
+    int thread_count(void) const {
+        return queues.size();
+    }
+
+    void add(cx_task_group &group, const std::function<void(void)> &run);
+    void wait(cx_task_group &group);
+    void block_until(const std::function<bool(void)> &ready);
+    void notify(void);
+};
+
+#endif
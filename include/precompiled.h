@@ -0,0 +1,23 @@
+/** Precompiled scripts
+ * precompiled.h
+ *
+ * Keep the translated form of a script on disk, so a script that is
+ * run again unchanged, as from cron, skips its parse.
+ */
+
+#ifndef precompiled_h
+#define precompiled_h
+
+#include <string>
+
+class cx_context;
+class cx_symtab_node;
+
+std::string cx_precompiled_path(const char *p_source_path);
+bool cx_save_precompiled(const cx_context *p_context,
+        const cx_symtab_node *p_program_id, const char *p_source_path,
+        const char *p_cache_path);
+cx_symtab_node *cx_load_precompiled(cx_context *p_context,
+        const char *p_source_path, const char *p_cache_path);
+
+#endif
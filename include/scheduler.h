@@ -0,0 +1,89 @@
+/** Scheduler
+ * scheduler.h
+ *
+ * Take turns running many scripts on a few cores.  A scheduler has a
+ * number of slots, and a script runs only while it holds one.  After
+ * a budget of statements, a run gives its slot to the script that has
+ * waited longest, and waits for a slot again at the back of the line,
+ * so a script that never ends can't keep the others from running.
+ */
+
+#ifndef scheduler_h
+#define scheduler_h
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/** cx_run_account       What the runs of one script took:  the time
+ *                      they held a slot, and waited for one.  Read it
+ *                      between runs.
+ */
+struct cx_run_account {
+    long runs;
+    long slices; // turns in a slot
+    long statements; // executed while holding a slot
+    double cpu_seconds; // of the run's thread, while it held a slot
+    double wait_seconds; // waiting for a slot
+
+    cx_run_account(void)
+    : runs(0), slices(0), statements(0), cpu_seconds(0), wait_seconds(0) {
+    }
+};
+
+/** cx_scheduler         Slots that scripts take turns running in.  The
+ *                      runs waiting for a slot get one in the order
+ *                      they began to wait.
+ *
+ * Each run is on a thread of its own, which waits in enter and yield
+ * until it's handed a slot, and keeps it until it yields, blocks or
+ * leaves.  A thread holds at most one slot:  a run entered while its
+ * thread holds a slot runs in that one.
+ */
+class cx_scheduler {
+
+    struct cx_waiter {
+        std::condition_variable turn;
+        bool granted;
+    };
+
+    std::mutex mutex;
+    int free_slots;
+    std::deque<cx_waiter *> waiting;
+
+    void acquire(std::unique_lock<std::mutex> &lock, cx_run_account &account);
+    void release(cx_run_account &account);
+
+    cx_scheduler(const cx_scheduler &);
+    cx_scheduler &operator=(const cx_scheduler &);
+
+public:
+    const long slice; // statements a run executes per turn, 0 if unlimited
+
+    cx_scheduler(int slot_count, long slice);
+
+    bool enter(cx_run_account &account);
+    void leave(long statements);
+
+    static void yield(void);
+    static void pause(void);
+    static void resume(void);
+};
+
+/** cx_slot_pause        Gives up the slot this thread holds, if any,
+ *                      for as long as the scope lives, so a run that
+ *                      blocks lets another run meanwhile.
+ */
+class cx_slot_pause {
+public:
+
+    cx_slot_pause(void) {
+        cx_scheduler::pause();
+    }
+
+    ~cx_slot_pause(void) {
+        cx_scheduler::resume();
+    }
+};
+
+#endif
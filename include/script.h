@@ -0,0 +1,182 @@
+/** Embedding
+ * script.h
+ *
+ * Run Cx scripts inside a host program.  A script is compiled once,
+ * then run, or its functions called, as many times as the host needs,
+ * without a process or a parse per run.
+ */
+
+#ifndef script_h
+#define script_h
+
+#include <string>
+#include <vector>
+#include "scheduler.h"
+
+class cx_context;
+class cx_executor;
+class cx_symtab_node;
+class cx_type;
+union mem_block;
+
+///  Kinds of value passed between a host and a script.
+
+enum cx_value_code {
+    vc_void, vc_int, vc_float, vc_char, vc_bool, vc_string
+};
+
+/** cx_value             A value passed between a host and a script.
+ *                      Scalars are converted to the type the script
+ *                      expects; a string stands for a char array.
+ */
+struct cx_value {
+    cx_value_code code;
+
+    union {
+        int int__;
+        float float__;
+        char char__;
+        bool bool__;
+    };
+
+    std::string string__;
+
+    cx_value(void) : code(vc_void), int__(0) {
+    }
+
+    cx_value(int value) : code(vc_int), int__(value) {
+    }
+
+    cx_value(float value) : code(vc_float), float__(value) {
+    }
+
+    cx_value(char value) : code(vc_char), int__(0) {
+        char__ = value;
+    }
+
+    cx_value(bool value) : code(vc_bool), int__(0) {
+        bool__ = value;
+    }
+
+    cx_value(const char *p_string)
+    : code(vc_string), int__(0), string__(p_string) {
+    }
+
+    cx_value(const std::string &string)
+    : code(vc_string), int__(0), string__(string) {
+    }
+
+    int to_int(void) const;
+    float to_float(void) const;
+};
+
+typedef cx_value(*cx_host_code)(const cx_value *p_args, int arg_count,
+        void *p_data);
+
+/** cx_host_function     A routine of the host program that scripts
+ *                      can call.  Its signature is spelled as the
+ *                      intrinsics table spells them, e.g. "float(int)"
+ *                      or "int(char*,int)".  Parameters are passed by
+ *                      value.
+ */
+struct cx_host_function {
+    static const int max_args = 8;
+
+    std::string name;
+    std::string signature;
+    cx_host_code p_code;
+    void *p_data; // handed back to the code on each call
+};
+
+/** cx_script            A compiled script.
+ *
+ *      cx_script script;
+ *
+ *      script.define("sensor", "float(int)", read_sensor, &board);
+ *      if (!script.compile_file("policy.cx")) {
+ *          std::cerr << script.diagnostics();
+ *      }
+ *
+ *      cx_value args[] = {cx_value(3), cx_value(0.5f)};
+ *      cx_value result;
+ *      script.call("decide", args, 2, result);
+ *
+ * run executes the whole program, globals and main, from scratch each
+ * time.  call runs one function; the script's globals are set up on
+ * the first call and keep their values between calls, until reset.
+ *
+ * Errors never end the host:  a failed compile, run or call returns
+ * false, and its messages are in diagnostics.  A script is used by
+ * one thread at a time; separate scripts may run on separate threads.
+ *
+ * send, receive and close pass values through a channel the script
+ * made, by its handle, and may be used from any thread, even as the
+ * script runs on another:
+ *
+ *      script.get_global("jobs", value);  // channel(char *, 64)
+ *      script.send(value.int__, cx_value("frame-0042"));
+ *
+ * A script given a scheduler runs and is called only in the
+ * scheduler's slots, taking turns with the scripts that share it, and
+ * its account tells what its runs took:
+ *
+ *      cx_scheduler scheduler(4, 100000);  // 4 at once, in slices
+ *
+ *      script.schedule(&scheduler);
+ *      script.run();
+ *      double cpu = script.account().cpu_seconds;
+ */
+class cx_script {
+    cx_context *p_context;
+    cx_symtab_node *p_program_id;
+    cx_executor *p_executor; // globals kept between calls, if started
+    cx_scheduler *p_scheduler; // runs take turns under, if not nullptr
+    std::vector<cx_host_function *> host_functions;
+    std::string messages;
+
+    bool compile(const char *p_name, const std::string *p_text);
+    bool enter_host_function(const cx_host_function *p_host);
+    bool start(void);
+    cx_symtab_node *find_global(const char *p_name) const;
+
+    cx_script(const cx_script &);
+    cx_script &operator=(const cx_script &);
+
+public:
+    cx_script(void);
+    ~cx_script(void);
+
+    bool define(const char *p_name, const char *p_signature,
+            cx_host_code p_code, void *p_data = nullptr);
+
+    bool compile_file(const char *p_file_name);
+    bool compile_string(const std::string &source,
+            const char *p_name = "<string>");
+
+    bool run(void);
+    bool call(const char *p_name, const cx_value *p_args, int arg_count,
+            cx_value &result);
+
+    bool get_global(const char *p_name, cx_value &value);
+    bool set_global(const char *p_name, const cx_value &value);
+    void reset(void);
+
+    bool send(int channel, const cx_value &value, bool wait = true);
+    bool receive(int channel, cx_value &value, bool wait = true);
+    bool close(int channel);
+
+    void schedule(cx_scheduler *p_scheduler);
+    cx_run_account account(void) const;
+
+    const std::string &diagnostics(void) const {
+        return messages;
+    }
+};
+
+// conversions between the host's values and the script's
+cx_value cx_value_of(const cx_context *p_context, const cx_type *p_type,
+        const mem_block &value);
+bool cx_block_of(const cx_context *p_context, const cx_type *p_type,
+        const cx_value &value, mem_block &block);
+
+#endif
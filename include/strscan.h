@@ -0,0 +1,19 @@
+/** String scans
+ * strscan.h
+ *
+ * Vector scans over char buffers.  Every scan is bounded by the
+ * buffer's size and never reads past it.
+ */
+
+#ifndef strscan_h
+#define strscan_h
+
+#include <cstddef>
+
+size_t cx_find_char_or_nul(const char *p_data, size_t size, char c);
+int cx_compare_strings(const char *p_data1, size_t size1,
+        const char *p_data2, size_t size2);
+ptrdiff_t cx_find_substring(const char *p_text, size_t text_length,
+        const char *p_pattern, size_t pattern_length);
+
+#endif
@@ -10,6 +10,7 @@
 
 #include <map>
 #include <cstring>
+#include <vector>
 #include "misc.h"
 #include "cx-debug/exec.h"
 
@@ -18,13 +19,9 @@ struct cx_stack_item;
 typedef std::vector<cx_stack_item*> cx_stack;
 typedef cx_stack::iterator cx_stack_iterator;
 
-extern bool xreference_flag;
-extern int current_line_number;
-extern int current_nesting_level;
-extern int asm_label_index;
-
 struct cx_stack_item;
 
+class cx_context;
 class cx_symtab;
 class cx_symtab_node;
 class cx_line_num_list;
@@ -42,6 +39,23 @@ enum cx_define_code {
 
 enum cx_routine_code {
     rc_declared, rc_forward,
+    rc_intrinsic, // declared, and bound to native code
+    rc_host, // defined by the host program, see script.h
+
+    // standard routines
+    rc_reserve,
+    rc_getline, rc_getint, rc_getfloat,
+    rc_fopen, rc_fclose, rc_fmap,
+    rc_fread, rc_fwrite, rc_pread, rc_transfer,
+    rc_getu8, rc_getu16le, rc_getu16be, rc_getu32le, rc_getu32be,
+    rc_getu64le, rc_getu64be, rc_getbits,
+    rc_putu8, rc_putu16le, rc_putu16be, rc_putu32le, rc_putu32be,
+    rc_putu64le, rc_putu64be,
+    rc_printf, rc_fprintf,
+    rc_connect, rc_listen, rc_wait, rc_ready,
+    rc_join,
+    rc_channel, rc_send, rc_try_send, rc_receive, rc_try_receive, rc_close,
+    rc_load, rc_store, rc_fetch_add, rc_compare_exchange,
 };
 
 struct cx_local_ids {
@@ -52,6 +66,51 @@ struct cx_local_ids {
     cx_symtab_node *p_function_ids;
 };
 
+///  cx_actual_parm     How an actual parameter is bound to its
+///                     formal parameter's frame slot.
+
+struct cx_actual_parm {
+    bool reference; // pass the actual's address
+    bool int_to_float; // convert an integer actual to a float formal
+    bool copy_value; // copy an array or record value parameter
+    bool share_value; // share the copy's buffer until either side writes
+    const cx_symtab_node *p_variable_id; // actual, if a bare variable
+};
+
+/** cx_call_site        A call resolved by the parser.  The icode
+ *                      of a call with an argument list carries the
+ *                      index of its call site right after the '('.
+ */
+struct cx_call_site {
+    const cx_symtab_node *p_function_id;
+    std::vector<cx_actual_parm> parms;
+};
+
+/** cx_reduction        A variable a parallel for's iterations fold
+ *                     their values into, and the operator they fold
+ *                     with:  + * & | or ^.
+ */
+struct cx_reduction {
+    const cx_symtab_node *p_id;
+    cx_token_code op;
+};
+
+/** cx_parallel_loop    A parallel for resolved by the parser.  The
+ *                     icode of the loop carries its index right
+ *                     after the parallel, as a call marker.
+ */
+struct cx_parallel_loop {
+    const cx_symtab_node *p_index_id;
+    int step; // added to the index after each iteration
+    std::vector<cx_reduction> reductions;
+
+    // variables each worker gets a slot of its own for
+    std::vector<const cx_symtab_node *> private_ids;
+
+    // shared arrays and records the body stores elements of
+    std::vector<const cx_symtab_node *> stored_ids;
+};
+
 class cx_define {
 public:
 
@@ -72,10 +131,15 @@ public:
             cx_local_ids locals;
             cx_symtab *p_symtab;
             cx_icode *p_icode;
+            const struct cx_intrinsic *p_intrinsic;
+            const struct cx_host_function *p_host;
+
+            // stores into a global or does I/O, see parse_parallel.cpp
+            bool has_effects;
         } routine;
 
         struct {
-            int offset;
+            int offset; // slot index in the owning routine's frame
         } data;
     };
 
@@ -107,11 +171,10 @@ public:
     int global_finish_location;
     int string_length;
     bool found_global_end;
+    bool is_atomic; // used only through the atomic routines, see atomic.cpp
 
-    // pointer to runstack item
-    cx_stack_item *runstack_item;
-
-    cx_symtab_node(const char *p_string, cx_define_code dc = dc_undefined);
+    cx_symtab_node(cx_context *p_context, const char *p_string,
+            cx_define_code dc = dc_undefined);
     ~cx_symtab_node();
 
     cx_symtab_node *left_subtree(void) const {
@@ -154,6 +217,7 @@ public:
 };
 
 class cx_symtab {
+    cx_context *const p_context; // context the table is numbered in
     cx_symtab_node *root__;
     cx_symtab_node **p_vector_nodes;
     short nodes_count;
@@ -162,17 +226,7 @@ class cx_symtab {
 
 public:
 
-    cx_symtab() : nodes_count(0), xsymtab(0) {
-        extern int symtab_count;
-        extern cx_symtab *p_symtab_list;
-
-        root__ = nullptr;
-        p_vector_nodes = nullptr;
-        xsymtab = symtab_count++;
-
-        next__ = p_symtab_list;
-        p_symtab_list = this;
-    }
+    cx_symtab(cx_context *p_context);
 
     ~cx_symtab() {
         if (root__ != nullptr) delete root__;
@@ -182,6 +236,7 @@ public:
     cx_symtab_node *search(const char *p_string) const;
     cx_symtab_node *enter(const char *p_string, cx_define_code dc = dc_undefined);
     cx_symtab_node *enter_new(const char *p_string, cx_define_code dc = dc_undefined);
+    bool shadowable(const cx_symtab_node *p_node) const;
 
     cx_symtab_node *root(void) const {
         return root__;
@@ -204,6 +259,10 @@ public:
         return next__;
     }
 
+    short symtab_index(void) const {
+        return xsymtab;
+    }
+
     cx_symtab_node **node_vector(void) const {
         return p_vector_nodes;
     }
@@ -228,10 +287,7 @@ class cx_line_num_node {
 
 public:
 
-    cx_line_num_node() :
-    number(current_line_number) {
-        next__ = nullptr;
-    }
+    cx_line_num_node(void);
 };
 
 class cx_line_num_list {
@@ -257,39 +313,22 @@ class cx_symtab_stack {
         max_nesting_level = 8
     };
 
+    cx_context *const p_context; // owns the nesting level
     cx_symtab *p_symtabs[max_nesting_level]; // stack of symbol table ptrs
 
     //void InitializeMain(void);
 
 public:
-    cx_symtab_stack(void);
-    ~cx_symtab_stack(void);
-
-    cx_symtab_node *search_local(const char *p_string) {
-        return p_symtabs[current_nesting_level]->search(p_string);
-    }
+    cx_symtab_stack(cx_context *p_context);
 
+    cx_symtab_node *search_local(const char *p_string);
     cx_symtab_node *enter_local(const char *p_string,
-            cx_define_code dc = dc_undefined) {
-        return p_symtabs[current_nesting_level]->enter(p_string, dc);
-    }
-
+            cx_define_code dc = dc_undefined);
     cx_symtab_node *enter_new_local(const char *p_string,
-            cx_define_code dc = dc_undefined) {
-        return p_symtabs[current_nesting_level]->enter_new(p_string, dc);
-    }
-
-    cx_symtab *get_current_symtab(void) const {
-        return p_symtabs[current_nesting_level];
-    }
-
-    void set_current_symtab(cx_symtab *p_symtab) {
-        p_symtabs[current_nesting_level] = p_symtab;
-    }
-
-    void set_scope(int scopeLevel) {
-        current_nesting_level = scopeLevel;
-    }
+            cx_define_code dc = dc_undefined);
+    cx_symtab *get_current_symtab(void) const;
+    void set_current_symtab(cx_symtab *p_symtab);
+    void set_scope(int scope_level);
 
     cx_symtab_node *search_available_scopes(const char *p_string) const;
     cx_symtab_node *search_all(const char *p_string) const;
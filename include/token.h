@@ -6,7 +6,7 @@
 #include "error.h"
 #include "buffer.h"
 
-extern cx_char_code_map char_code_map;
+extern const cx_char_code_map char_code_map;
 
 ///  cx_token              Abstract token class.
 class cx_icode;
@@ -77,7 +77,7 @@ class cx_number_token : public cx_token {
     uint8_t radix; // number base
 
     int accumulate_value(cx_text_in_buffer &buffer,
-            float &value, cx_error_code ec);
+            double &value, cx_error_code ec);
 
     bool is_x_digit(const char &c);
     int char_value(const char &c);
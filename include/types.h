@@ -12,40 +12,12 @@
 #include "error.h"
 #include "symtable.h"
 
+class cx_context;
 class cx_type;
 class cx_symtab_node;
 class cx_symtab;
-
-// Pointers to predefined types.
-extern cx_symtab_node *p_main_function_id;
-extern cx_symtab_node *p_stdin;
-extern cx_symtab_node *p_stdout;
-extern cx_symtab_node *p_stderr;
-
-extern cx_type *p_integer_type;
-extern cx_type *p_short_type;
-extern cx_type *p_long_type;
-
-extern cx_type *p_uint8_type;
-extern cx_type *p_uint16_type;
-extern cx_type *p_uint32_type;
-extern cx_type *p_uint64_type;
-
-extern cx_type *p_float_type;
-extern cx_type *p_double_type;
-
-extern cx_type *p_boolean_type;
-
-extern cx_type *p_char_type;
-extern cx_type *p_wchar_type;
-
-//cx_type *p_class_type = nullptr;
-
-extern cx_type *p_complex_type;
-
-extern cx_type *p_file_type;
-
-extern cx_type *p_dummy_type;
+struct cx_out_buffer;
+struct cx_in_buffer;
 
 enum cx_type_form_code {
     fc_none,
@@ -113,6 +85,12 @@ public:
             char *p_file_mode;
             // file stream
             FILE *p_file_stream;
+            // pending output and read-ahead input, see io.cpp
+            cx_out_buffer *p_out_buffer;
+            cx_in_buffer *p_in_buffer;
+            /* the socket a file variable names, set by connect,
+             * listen and wait, see net.cpp */
+            cx_type *p_bound_stream;
         } stream;
     };
 
@@ -172,8 +150,8 @@ public:
             const cx_type *p_type2);
 };
 
-void initialize_builtin_types(cx_symtab *p_symtab);
-void remove_builtin_types(void);
+void initialize_builtin_types(cx_context *p_context);
+void remove_builtin_types(cx_context *p_context);
 
 
 
@@ -36,30 +36,48 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 # Object Files
 OBJECTFILES= \
 	${OBJECTDIR}/src/buffer.o \
+	${OBJECTDIR}/src/batch.o \
 	${OBJECTDIR}/src/common.o \
+	${OBJECTDIR}/src/context.o \
 	${OBJECTDIR}/src/complist.o \
 	${OBJECTDIR}/src/cx-debug/assign.o \
+	${OBJECTDIR}/src/cx-debug/atomic.o \
+	${OBJECTDIR}/src/cx-debug/channel.o \
 	${OBJECTDIR}/src/cx-debug/do.o \
 	${OBJECTDIR}/src/cx-debug/exec.o \
 	${OBJECTDIR}/src/cx-debug/expression.o \
 	${OBJECTDIR}/src/cx-debug/function.o \
 	${OBJECTDIR}/src/cx-debug/io.o \
+	${OBJECTDIR}/src/cx-debug/net.o \
+	${OBJECTDIR}/src/cx-debug/parallel.o \
+	${OBJECTDIR}/src/cx-debug/standard.o \
 	${OBJECTDIR}/src/cx-debug/statment.o \
+	${OBJECTDIR}/src/cx-debug/task.o \
 	${OBJECTDIR}/src/cx-debug/tracer.o \
 	${OBJECTDIR}/src/cx-debug/while.o \
 	${OBJECTDIR}/src/error.o \
+	${OBJECTDIR}/src/format.o \
 	${OBJECTDIR}/src/icode.o \
+	${OBJECTDIR}/src/intrinsic.o \
+	${OBJECTDIR}/src/strscan.o \
 	${OBJECTDIR}/src/main.o \
+	${OBJECTDIR}/src/optimizer.o \
 	${OBJECTDIR}/src/parse_declarations.o \
 	${OBJECTDIR}/src/parse_directive.o \
 	${OBJECTDIR}/src/parse_expression.o \
+	${OBJECTDIR}/src/parse_parallel.o \
 	${OBJECTDIR}/src/parse_routine1.o \
 	${OBJECTDIR}/src/parse_routine2.o \
+	${OBJECTDIR}/src/parse_standard.o \
 	${OBJECTDIR}/src/parse_statement.o \
 	${OBJECTDIR}/src/parse_type1.o \
 	${OBJECTDIR}/src/parse_type2.o \
 	${OBJECTDIR}/src/parser.o \
+	${OBJECTDIR}/src/pool.o \
+	${OBJECTDIR}/src/precompiled.o \
 	${OBJECTDIR}/src/scanner.o \
+	${OBJECTDIR}/src/script.o \
+	${OBJECTDIR}/src/scheduler.o \
 	${OBJECTDIR}/src/symtable.o \
 	${OBJECTDIR}/src/tknnum.o \
 	${OBJECTDIR}/src/tknstrsp.o \
@@ -81,7 +99,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-pthread
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -96,11 +114,21 @@ ${OBJECTDIR}/src/buffer.o: src/buffer.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/buffer.o src/buffer.cpp
 
+${OBJECTDIR}/src/batch.o: src/batch.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/batch.o src/batch.cpp
+
 ${OBJECTDIR}/src/common.o: src/common.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/common.o src/common.cpp
 
+${OBJECTDIR}/src/context.o: src/context.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/context.o src/context.cpp
+
 ${OBJECTDIR}/src/complist.o: src/complist.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
@@ -111,6 +139,16 @@ ${OBJECTDIR}/src/cx-debug/assign.o: src/cx-debug/assign.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/assign.o src/cx-debug/assign.cpp
 
+${OBJECTDIR}/src/cx-debug/atomic.o: src/cx-debug/atomic.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/atomic.o src/cx-debug/atomic.cpp
+
+${OBJECTDIR}/src/cx-debug/channel.o: src/cx-debug/channel.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/channel.o src/cx-debug/channel.cpp
+
 ${OBJECTDIR}/src/cx-debug/do.o: src/cx-debug/do.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
 	${RM} $@.d
@@ -136,11 +174,31 @@ ${OBJECTDIR}/src/cx-debug/io.o: src/cx-debug/io.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/io.o src/cx-debug/io.cpp
 
+${OBJECTDIR}/src/cx-debug/net.o: src/cx-debug/net.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/net.o src/cx-debug/net.cpp
+
+${OBJECTDIR}/src/cx-debug/parallel.o: src/cx-debug/parallel.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/parallel.o src/cx-debug/parallel.cpp
+
+${OBJECTDIR}/src/cx-debug/standard.o: src/cx-debug/standard.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/standard.o src/cx-debug/standard.cpp
+
 ${OBJECTDIR}/src/cx-debug/statment.o: src/cx-debug/statment.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/statment.o src/cx-debug/statment.cpp
 
+${OBJECTDIR}/src/cx-debug/task.o: src/cx-debug/task.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/cx-debug/task.o src/cx-debug/task.cpp
+
 ${OBJECTDIR}/src/cx-debug/tracer.o: src/cx-debug/tracer.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src/cx-debug
 	${RM} $@.d
@@ -156,16 +214,36 @@ ${OBJECTDIR}/src/error.o: src/error.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/error.o src/error.cpp
 
+${OBJECTDIR}/src/format.o: src/format.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/format.o src/format.cpp
+
 ${OBJECTDIR}/src/icode.o: src/icode.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/icode.o src/icode.cpp
 
+${OBJECTDIR}/src/intrinsic.o: src/intrinsic.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/intrinsic.o src/intrinsic.cpp
+
+${OBJECTDIR}/src/strscan.o: src/strscan.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/strscan.o src/strscan.cpp
+
 ${OBJECTDIR}/src/main.o: src/main.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/main.o src/main.cpp
 
+${OBJECTDIR}/src/optimizer.o: src/optimizer.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/optimizer.o src/optimizer.cpp
+
 ${OBJECTDIR}/src/parse_declarations.o: src/parse_declarations.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
@@ -181,6 +259,11 @@ ${OBJECTDIR}/src/parse_expression.o: src/parse_expression.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/parse_expression.o src/parse_expression.cpp
 
+${OBJECTDIR}/src/parse_parallel.o: src/parse_parallel.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/parse_parallel.o src/parse_parallel.cpp
+
 ${OBJECTDIR}/src/parse_routine1.o: src/parse_routine1.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
@@ -191,6 +274,11 @@ ${OBJECTDIR}/src/parse_routine2.o: src/parse_routine2.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/parse_routine2.o src/parse_routine2.cpp
 
+${OBJECTDIR}/src/parse_standard.o: src/parse_standard.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/parse_standard.o src/parse_standard.cpp
+
 ${OBJECTDIR}/src/parse_statement.o: src/parse_statement.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
@@ -211,11 +299,31 @@ ${OBJECTDIR}/src/parser.o: src/parser.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/parser.o src/parser.cpp
 
+${OBJECTDIR}/src/pool.o: src/pool.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/pool.o src/pool.cpp
+
+${OBJECTDIR}/src/precompiled.o: src/precompiled.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/precompiled.o src/precompiled.cpp
+
 ${OBJECTDIR}/src/scanner.o: src/scanner.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
 	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/scanner.o src/scanner.cpp
 
+${OBJECTDIR}/src/script.o: src/script.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/script.o src/script.cpp
+
+${OBJECTDIR}/src/scheduler.o: src/scheduler.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} $@.d
+	$(COMPILE.cc) -O2 -MMD -MP -MF $@.d -o ${OBJECTDIR}/src/scheduler.o src/scheduler.cpp
+
 ${OBJECTDIR}/src/symtable.o: src/symtable.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} $@.d
@@ -0,0 +1,286 @@
+/** Batch runner
+ * batch.cpp
+ *
+ * Run every script of a directory in one process, on a pool of
+ * threads, rather than in a process each.  Each script is parsed and
+ * run in a context of its own, with its stdout and stderr kept apart
+ * from the others'.  What a script wrote is written out, in the
+ * scripts' order, once it's done, followed by how long it ran, the
+ * CPU time it took and how many statements it executed.
+ *
+ * The scripts run in the slots of a scheduler, one per job.  With a
+ * slice, more scripts are under way than there are slots, and each
+ * gives up its slot after a slice of statements, so a script that
+ * runs long, or forever, leaves the others their turns.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+#include "batch.h"
+#include "common.h"
+#include "cx-debug/exec.h"
+#include "optimizer.h"
+#include "parser.h"
+#include "precompiled.h"
+#include "scheduler.h"
+
+// scripts under way per slot, when they take turns
+static const int cx_batch_threads_per_slot = 8;
+
+///  cx_batch_job        One script of a batch, and how its run went.
+
+struct cx_batch_job {
+    std::string path;
+    std::string output; // what the script wrote to stdout
+    std::string errors; // to stderr, and its syntax and runtime errors
+    bool ok;
+    long statement_count;
+    double seconds;
+    cx_run_account account; // of its run, under the batch's scheduler
+    bool done;
+};
+
+/** read_back           Read all a temporary file holds, and close it.
+ *
+ * @param p_file : ptr to the file.
+ * @param text   : gets the contents.
+ */
+static void read_back(FILE *p_file, std::string &text) {
+    if (p_file == nullptr) return;
+
+    char buffer[8192];
+    size_t count;
+
+    rewind(p_file);
+    while ((count = fread(buffer, 1, sizeof (buffer), p_file)) > 0) {
+        text.append(buffer, count);
+    }
+
+    fclose(p_file);
+}
+
+/** batch_scripts       The scripts of a directory:  its .cx files,
+ *                      in the order of their names.
+ *
+ * @param p_directory : ptr to the directory's path.
+ * @param paths       : gets the scripts' paths.
+ * @return false if the directory can't be read.
+ */
+static bool batch_scripts(const char *p_directory,
+        std::vector<std::string> &paths) {
+    DIR *p_dir = opendir(p_directory);
+    if (p_dir == nullptr) return false;
+
+    std::string directory = p_directory;
+    if (directory.back() != '/') directory += '/';
+
+    while (const struct dirent *p_entry = readdir(p_dir)) {
+        const char *p_name = p_entry->d_name;
+        const size_t length = strlen(p_name);
+        struct stat info;
+
+        if ((p_name[0] == '.') || (length < 4)
+                || (strcasecmp(p_name + length - 3, ".cx") != 0)) continue;
+
+        const std::string path = directory + p_name;
+        if ((stat(path.c_str(), &info) == 0) && S_ISREG(info.st_mode)) {
+            paths.push_back(path);
+        }
+    }
+
+    closedir(p_dir);
+    std::sort(paths.begin(), paths.end());
+
+    return true;
+}
+
+/** run_job             Parse and run one script, as main would, in a
+ *                      context of its own.  Its errors end the
+ *                      script, not the batch.
+ *
+ * @param job       : the script, and how its run went.
+ * @param scheduler : the batch's, that runs take turns under.
+ */
+static void run_job(cx_batch_job &job, cx_scheduler &scheduler) {
+    using namespace std::chrono;
+    const steady_clock::time_point start = steady_clock::now();
+
+    FILE *p_out = tmpfile();
+    FILE *p_err = tmpfile();
+    FILE *p_in = fopen("/dev/null", "r");
+
+    cx_context *p_context = new cx_context;
+    std::string messages;
+
+    p_context->embedded = true;
+    p_context->p_scheduler = &scheduler;
+    p_context->list_flag = cx_dev_debug_flag;
+    p_context->list.capture(&messages);
+    p_context->p_stdout->p_type->stream.p_file_stream = p_out;
+    p_context->p_stderr->p_type->stream.p_file_stream = p_err;
+    p_context->p_stdin->p_type->stream.p_file_stream = p_in;
+
+    job.ok = false;
+    job.statement_count = 0;
+
+    {
+        cx_context_scope scope(p_context);
+        std::unique_ptr<cx_executor> executor;
+        const char *p_path = job.path.c_str();
+
+        try {
+            const std::string cache_path =
+                    cx_dev_debug_flag ? "" : cx_precompiled_path(p_path);
+            cx_symtab_node *p_program_id = cache_path.empty() ? nullptr
+                    : cx_load_precompiled(p_context, p_path, cache_path.c_str());
+
+            if (p_program_id == nullptr) {
+                std::unique_ptr<cx_parser> parser(new cx_parser(p_context,
+                        new cx_source_buffer(p_context, p_path)));
+
+                p_program_id = parser->parse();
+
+                if ((p_context->error_count == 0)
+                        && (p_program_id->defn.routine.p_icode != nullptr)) {
+                    p_context->convert_symtabs();
+
+                    if (cx_optimize_flag) {
+                        cx_optimizer optimizer(p_context);
+                        optimizer.optimize(p_program_id);
+                    }
+
+                    if (!cache_path.empty()) {
+                        cx_save_precompiled(p_context, p_program_id, p_path,
+                                cache_path.c_str());
+                    }
+                } else p_program_id = nullptr;
+            }
+
+            if (p_program_id != nullptr) {
+                executor.reset(new cx_executor(p_context));
+                executor->go(p_program_id);
+                job.ok = true;
+            } else if (p_context->error_count == 0) {
+                messages.append("*** error: no function in ")
+                        .append(p_path).append("\n");
+            }
+        } catch (const cx_abort &) {
+        }
+
+        if (executor) job.statement_count = executor->statements();
+    }
+
+    job.account = *p_context->p_account;
+
+    // writes out what the script left buffered
+    delete p_context;
+
+    read_back(p_out, job.output);
+    read_back(p_err, job.errors);
+    job.errors += messages;
+    if (p_in != nullptr) fclose(p_in);
+
+    job.seconds = duration_cast<duration<double> >(steady_clock::now() - start).count();
+}
+
+/** cx_run_batch         Run the scripts of a directory on a pool of
+ *                      threads.  Each worker takes the next script
+ *                      not yet taken, so long scripts don't hold up
+ *                      the others.
+ *
+ * @param p_directory : ptr to the directory's path.
+ * @param job_count   : number of scripts run at once, or 0 for one
+ *                      per core.
+ * @param slice       : statements a script runs per turn, or 0 to
+ *                      run each script to its end.
+ * @return exit status:  0 if every script ran to the end.
+ */
+int cx_run_batch(const char *p_directory, int job_count, long slice) {
+    std::vector<std::string> paths;
+
+    if (!batch_scripts(p_directory, paths)) {
+        perror(p_directory);
+        return abort_source_file_open_failed;
+    }
+
+    if (job_count <= 0) job_count = std::thread::hardware_concurrency();
+    if (job_count <= 0) job_count = 1;
+    job_count = std::min<int>(job_count, std::max<size_t>(paths.size(), 1));
+
+    // scripts under way, each on a thread of its own, waiting for a turn
+    const int thread_count = std::min<int>(job_count * ((slice > 0)
+            ? cx_batch_threads_per_slot : 1), std::max<size_t>(paths.size(), 1));
+    cx_scheduler scheduler(job_count, slice);
+
+    std::vector<cx_batch_job> jobs(paths.size());
+    std::atomic<size_t> next_job(0);
+    std::mutex done_mutex;
+    std::condition_variable done_changed;
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        jobs[i].path = paths[i];
+        jobs[i].done = false;
+    }
+
+    using namespace std::chrono;
+    const steady_clock::time_point start = steady_clock::now();
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < thread_count; ++i) {
+        workers.push_back(std::thread([&]() {
+            size_t j;
+
+            while ((j = next_job++) < jobs.size()) {
+                run_job(jobs[j], scheduler);
+
+                std::lock_guard<std::mutex> lock(done_mutex);
+                jobs[j].done = true;
+                done_changed.notify_all();
+            }
+        }));
+    }
+
+    // report each script in order, as soon as it and those before it are done
+    int failed = 0;
+    long statement_count = 0;
+
+    for (cx_batch_job &job : jobs) {
+        {
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done_changed.wait(lock, [&job]() {
+                return job.done;
+            });
+        }
+
+        fwrite(job.output.data(), 1, job.output.size(), stdout);
+        fflush(stdout);
+        fwrite(job.errors.data(), 1, job.errors.size(), stderr);
+        fprintf(stderr, "%s: %s, %.3f ms, %.3f ms cpu, %ld statements, %ld slices\n",
+                job.path.c_str(), job.ok ? "ok" : "failed", job.seconds * 1000.0,
+                job.account.cpu_seconds * 1000.0, job.statement_count,
+                job.account.slices);
+
+        if (!job.ok) ++failed;
+        statement_count += job.statement_count;
+    }
+
+    for (std::thread &worker : workers) worker.join();
+
+    fprintf(stderr, "%d scripts, %d failed, %ld statements, %.3f s in %d slots on %d threads\n",
+            (int) jobs.size(), failed, statement_count,
+            duration_cast<duration<double> >(steady_clock::now() - start).count(),
+            job_count, thread_count);
+
+    return (failed > 0) ? abort_runtime_error : 0;
+}
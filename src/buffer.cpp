@@ -12,6 +12,7 @@
 #include <ctime>
 #include "common.h"
 #include "buffer.h"
+#include "context.h"
 
 /***********************
  *                     *
@@ -22,33 +23,51 @@
 // special end-of-file character
 const char eof_char = 0x7F;
 
-/* "virtual" position of the current char
- *  In the input buffer (with tabs expanded) */
-int input_position;
-
-// true if list source lines, else false
-int list_flag = true;
-
 /** Constructor     Construct a input text buffer by opening the
  *                  input file.
  *
+ * @param p_context         : ptr to the context of the script.
  * @param p_input_file_name : ptr to the name of the input file
  * @param ac             : abort code to use if open failed
  */
-cx_text_in_buffer::cx_text_in_buffer(const char *p_input_file_name,
-        cx_abort_code ac)
-: p_file_name(new char[strlen(p_input_file_name) + 1]) {
+cx_text_in_buffer::cx_text_in_buffer(cx_context *p_context,
+        const char *p_input_file_name, cx_abort_code ac)
+: p_context(p_context), p_input(&file),
+p_file_name(new char[strlen(p_input_file_name) + 1]) {
     // Copy the input file name.
     strcpy(p_file_name, p_input_file_name);
 
     // Open the input file.  Abort if failed.
     file.open(p_file_name, std::ios::in);
     if (!file.good()) {
-        std::cout << p_file_name << ": " << std::strerror(errno) << std::endl;
+        if (p_context->embedded) {
+            cx_list_buffer &list = p_context->list;
+
+            snprintf(list.text, sizeof (list.text), "%s: %s", p_file_name,
+                    std::strerror(errno));
+            list.put_line();
+        } else {
+            std::cout << p_file_name << ": " << std::strerror(errno) << std::endl;
+        }
+
         abort_translation(ac);
     }
 }
 
+/** Constructor     Construct a input text buffer that reads from
+ *                  text in memory rather than a file.
+ *
+ * @param p_context    : ptr to the context of the script.
+ * @param p_input_name : ptr to the name the text goes by in listings
+ * @param input_text   : the text
+ */
+cx_text_in_buffer::cx_text_in_buffer(cx_context *p_context,
+        const char *p_input_name, const std::string &input_text)
+: p_context(p_context), source(input_text), p_input(&source),
+p_file_name(new char[strlen(p_input_name) + 1]) {
+    strcpy(p_file_name, p_input_name);
+}
+
 /** get_char        Fetch and return the next__ character from the
  *                 text buffer.  If at the end of the buffer,
  *                 read the next__ source line.  If at the end of
@@ -65,13 +84,16 @@ char cx_text_in_buffer::get_char(void) {
     else if (*p_char == '\0') ch = get_line(); // null
     else { // next__ char
         ++p_char;
-        ++input_position;
+        ++p_context->input_position;
         ch = *p_char;
     }
 
     // If tab character, increment input_position to the next__
     // multiple of tab_size.
-    if (ch == '\t') input_position += tab_size - input_position % tab_size;
+    if (ch == '\t') {
+        int &input_position = p_context->input_position;
+        input_position += tab_size - input_position % tab_size;
+    }
 
     return ch;
 }
@@ -85,7 +107,7 @@ char cx_text_in_buffer::get_char(void) {
  */
 char cx_text_in_buffer::put_back_char(void) {
     --p_char;
-    --input_position;
+    --p_context->input_position;
 
     return *p_char;
 }
@@ -100,12 +122,30 @@ char cx_text_in_buffer::put_back_char(void) {
  *                  source file.  Initialize the list file, and
  *                  read the first line from the source file.
  *
+ * @param p_context          : ptr to the context of the script.
  * @param p_source_file_name : ptr to name of source file
  */
-cx_source_buffer::cx_source_buffer(const char *p_source_file_name)
-: cx_text_in_buffer(p_source_file_name, abort_source_file_open_failed) {
+cx_source_buffer::cx_source_buffer(cx_context *p_context,
+        const char *p_source_file_name)
+: cx_text_in_buffer(p_context, p_source_file_name,
+abort_source_file_open_failed) {
     // Initialize the list file and read the first source line.
-    if (list_flag) list.initialize(p_source_file_name);
+    if (p_context->list_flag) p_context->list.initialize(p_source_file_name);
+    get_line();
+}
+
+/** Constructor     Construct a source buffer over source text
+ *                  held in memory.  Initialize the list file, and
+ *                  read the first line of the text.
+ *
+ * @param p_context     : ptr to the context of the script.
+ * @param p_source_name : ptr to the name the source goes by
+ * @param source_text   : the source text
+ */
+cx_source_buffer::cx_source_buffer(cx_context *p_context,
+        const char *p_source_name, const std::string &source_text)
+: cx_text_in_buffer(p_context, p_source_name, source_text) {
+    if (p_context->list_flag) p_context->list.initialize(p_source_name);
     get_line();
 }
 
@@ -117,32 +157,30 @@ cx_source_buffer::cx_source_buffer(const char *p_source_file_name)
  *          end-of-file character if at the end of the file
  */
 char cx_source_buffer::get_line(void) {
-    extern int current_nesting_level;
-
     // If at the end of the source file, return the end-of-file char.
-    if (file.eof()) p_char = (char *) &eof_char;
+    if (p_input->eof()) p_char = (char *) &eof_char;
 
         // Else read the next__ source line and print it to the list file.
     else {
         memset(text, '\0', sizeof (text));
 
 
-        file.getline(text, max_input_buffer_size);
+        p_input->getline(text, max_input_buffer_size);
 
         p_char = text; // point to first source line char
 
         // if list_flag == true, list the source to stdout
-        if (list_flag) {
-            list.put_line(
+        if (p_context->list_flag) {
+            p_context->list.put_line(
                     text,
-                    ++current_line_number,
-                    current_nesting_level
+                    ++p_context->current_line_number,
+                    p_context->current_nesting_level
                     );
         }
 
     }
 
-    input_position = 0;
+    p_context->input_position = 0;
     return *p_char;
 }
 
@@ -155,8 +193,6 @@ char cx_source_buffer::get_line(void) {
 const int max_printline_length = 80;
 const int max_lines_per_page = 50;
 
-cx_list_buffer list; // the list file buffer
-
 /** print_page_header     Start a new page of the list file and
  *                      print the page header.
  */
@@ -181,6 +217,7 @@ void cx_list_buffer::initialize(const char *p_file_name) {
     page_number = 0;
 
     // Copy the input file name.
+    delete[] p_source_file_name;
     p_source_file_name = new char[strlen(p_file_name) + 1];
     strcpy(p_source_file_name, p_file_name);
 
@@ -198,13 +235,16 @@ void cx_list_buffer::initialize(const char *p_file_name) {
 
 void cx_list_buffer::put_line(void) {
     // Start a new page if the current one is full.
-    if (list_flag && (line_count == max_lines_per_page)) print_page_header();
+    if ((p_source_file_name != nullptr) && (line_count == max_lines_per_page)) {
+        print_page_header();
+    }
 
     // Truncate the line if it's too long.
     text[max_printline_length] = '\0';
 
-    // print the text line, and then blank out the text.
-    std::cout << text << std::endl;
+    // print the text line, or keep it, and then blank out the text.
+    if (p_capture != nullptr) p_capture->append(text).append(1, '\n');
+    else std::cout << text << std::endl;
     memset(text, '\0', sizeof (text));
 
     ++line_count;
@@ -9,25 +9,20 @@
  */
 
 
+#include <cstddef>
+#include <cstdlib>
+#include <unordered_map>
 #include "common.h"
 
-// current scope level
-int current_nesting_level = 0;
-int current_line_number = 0;
+// turn on to view Cx debugging
+#ifdef __CX_DEBUG__
+bool cx_dev_debug_flag = true;
+#else
+bool cx_dev_debug_flag = false;
+#endif
 
-/** Global symbols
- *
- * NOTE:
- *      when writing the Cx stdlib, this global symtab should be visible
- *      to the dynamic library to allow a library to add it's own symbols. - aaron
- */
-cx_symtab cx_global_symtab;
-
-// number of symtabs
-int symtab_count = 0;
-
-cx_symtab *p_symtab_list = nullptr;
-cx_symtab **p_vector_symtabs = nullptr;
+// turn off with -O0 to execute the icode as parsed
+bool cx_optimize_flag = true;
 
 /// Tokens for resyncing the parser
 
@@ -39,7 +34,7 @@ extern const cx_token_code tokenlist_declaration_start[] = {
     tc_EXPORT,
     tc_EXTERN, tc_TEMPLATE, tc_CONST, tc_PRIVATE,
     tc_PROTECTED, tc_THREADLOCAL, tc_PUBLIC, tc_TYPEDEF,
-    tc_pound, tc_dummy
+    tc_ATOMIC, tc_pound, tc_dummy
 };
 
 // tokens that follow a declaration
@@ -114,7 +109,7 @@ extern const cx_token_code tokenlist_identifier_follow[] = {
 
 // tokens that can start a statement
 extern const cx_token_code tokenlist_statement_start[] = {
-    tc_SWITCH, tc_FOR, tc_DO, tc_WHILE, tc_identifier,
+    tc_SWITCH, tc_FOR, tc_PARALLEL, tc_DO, tc_WHILE, tc_identifier,
     tc_colon_colon, tc_RETURN, tc_CONTINUE, tc_IF,
     tc_FRIEND, tc_GOTO, tc_TRY, tc_DELETE,
     tc_SIGNED, tc_BREAK, tc_STATIC,
@@ -122,8 +117,8 @@ extern const cx_token_code tokenlist_statement_start[] = {
     tc_VIRTUAL, tc_EXPORT,
     tc_EXTERN, tc_TEMPLATE, tc_CONST,
     tc_PRIVATE, tc_THIS, tc_PROTECTED, tc_THREADLOCAL,
-    tc_PUBLIC, tc_THROW, tc_TYPEDEF, tc_pound, tc_left_bracket,
-    tc_dummy
+    tc_PUBLIC, tc_THROW, tc_TYPEDEF, tc_pound, tc_left_bracket, tc_SPAWN,
+    tc_ATOMIC, tc_dummy
 };
 
 // tokens that can follow a statement
@@ -208,4 +203,57 @@ bool token_in(cx_token_code tc, const cx_token_code *p_list) {
     }
 
     return false;
-}
\ No newline at end of file
+}
+/** cx_string_hash       FNV-1a hash of a string.
+ *
+ * @param p_string : ptr to the string.
+ * @param length   : length of the string in bytes.
+ * @return hash of the string.
+ */
+unsigned int cx_string_hash(const char *p_string, int length) {
+    unsigned int hash = 2166136261u;
+
+    for (int i = 0; i < length; ++i) {
+        hash = (hash ^ (unsigned char) p_string[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+/** cx_intern_string     Find or enter a string in the constant pool.
+ *
+ * @param p_string : ptr to the string, without quotes.
+ * @param length   : length of the string in bytes.
+ * @return ptr to the pooled data.
+ */
+const char *cx_intern_string(const char *p_string, int length) {
+    std::unordered_map<std::string, cx_string_constant *> &string_pool =
+            cx_context::current()->string_pool;
+    std::string key(p_string, length);
+
+    auto it = string_pool.find(key);
+    if (it != string_pool.end()) return it->second->data;
+
+    cx_string_constant *p_constant = (cx_string_constant *)
+            malloc(offsetof(cx_string_constant, data) + length + 1);
+
+    p_constant->hash = cx_string_hash(p_string, length);
+    p_constant->length = length;
+    p_constant->p_format = nullptr;
+    memcpy(p_constant->data, p_string, length);
+    p_constant->data[length] = '\0';
+
+    string_pool[key] = p_constant;
+
+    return p_constant->data;
+}
+
+/** cx_string_constant_of        Pool entry of interned data.
+ *
+ * @param p_data : ptr returned by cx_intern_string.
+ * @return ptr to the pool entry.
+ */
+const cx_string_constant *cx_string_constant_of(const void *p_data) {
+    return (const cx_string_constant *)
+            ((const char *) p_data - offsetof(cx_string_constant, data));
+}
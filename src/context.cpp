@@ -0,0 +1,112 @@
+/** Interpreter context
+ * context.cpp
+ *
+ * Make and tear down the state of one script.  The predefined types
+ * and the standard routines are entered once per context, into its
+ * own global symbol table, so no two contexts share a type object.
+ */
+
+#include <cstdlib>
+#include "common.h"
+#include "context.h"
+#include "cx-debug/channel.h"
+#include "format.h"
+#include "scheduler.h"
+
+void initialize_std_functions(cx_context *p_context);
+
+// the context of the script this thread is working on
+static thread_local cx_context *p_current_context = nullptr;
+
+/** Constructor     Make an empty context, with the predefined
+ *                  types and the standard routines entered into
+ *                  its global symbol table.
+ */
+cx_context::cx_context(void)
+: current_line_number(0), current_nesting_level(0), input_position(0),
+list_flag(false), error_count(0), error_arrow_flag(false),
+error_arrow_offset(8), embedded(false), xreference_flag(false), asm_label_index(0),
+symtab_count(0), p_symtab_list(nullptr), p_vector_symtabs(nullptr),
+global_symtab(this), p_program_ptr_id(nullptr),
+p_main_function_id(nullptr), p_stdin(nullptr), p_stdout(nullptr),
+p_stderr(nullptr), p_integer_type(nullptr), p_uint8_type(nullptr),
+p_uint16_type(nullptr), p_uint32_type(nullptr), p_uint64_type(nullptr),
+p_float_type(nullptr), p_double_type(nullptr), p_boolean_type(nullptr),
+p_char_type(nullptr), p_wchar_type(nullptr), p_complex_type(nullptr),
+p_file_type(nullptr), p_dummy_type(nullptr), p_out_buffers(nullptr),
+p_event_loop(nullptr), p_tasks(nullptr),
+p_channels(new cx_channel_table), p_scheduler(nullptr),
+p_account(new cx_run_account) {
+    cx_context_scope scope(this);
+
+    initialize_builtin_types(this);
+    initialize_std_functions(this);
+}
+
+/** Destructor      Write out the script's pending output, close
+ *                  its sockets, and free its program, symbol tables
+ *                  and string constants.  Tasks still running are
+ *                  waited for first, and the channels they used go
+ *                  after them.
+ */
+cx_context::~cx_context(void) {
+    cx_context_scope scope(this);
+
+    cx_task_release_all(this);
+    delete p_channels;
+    delete p_account;
+    cx_stream_release_all(this);
+    cx_socket_release_all(this);
+
+    // the program's symtab is global_symtab, which goes with the context
+    if (p_program_ptr_id != nullptr) {
+        p_program_ptr_id->defn.routine.p_symtab = nullptr;
+        delete p_program_ptr_id;
+    }
+
+    remove_builtin_types(this);
+
+    for (auto &entry : string_pool) {
+        delete entry.second->p_format;
+        free(entry.second);
+    }
+
+    delete[] p_vector_symtabs;
+}
+
+/** convert_symtabs      Number the nodes of every symbol table, so
+ *                      the icode can name them, once the parse is
+ *                      done.
+ */
+void cx_context::convert_symtabs(void) {
+    delete[] p_vector_symtabs;
+    p_vector_symtabs = new cx_symtab *[symtab_count]();
+
+    for (cx_symtab *p_st = p_symtab_list; p_st; p_st = p_st->next()) {
+        if (p_st->root() != nullptr) p_st->convert(p_vector_symtabs);
+    }
+}
+
+/** current             The context of the script this thread is
+ *                      working on.
+ *
+ * @return ptr to the context, or nullptr outside any scope.
+ */
+cx_context *cx_context::current(void) {
+    return p_current_context;
+}
+
+/** Constructor     Make a context this thread's current one.
+ *
+ * @param p_context : ptr to the context.
+ */
+cx_context_scope::cx_context_scope(cx_context *p_context)
+: p_saved(p_current_context) {
+    p_current_context = p_context;
+}
+
+/** Destructor      Restore the context that was current before.
+ */
+cx_context_scope::~cx_context_scope(void) {
+    p_current_context = p_saved;
+}
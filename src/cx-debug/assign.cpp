@@ -39,6 +39,8 @@ void cx_executor::execute_assignment (const cx_symtab_node *p_target_id) {
         }
     }
 
+    const cx_token_code op = token;
+
     switch (token) {
         case tc_RETURN:
         case tc_equal:
@@ -137,11 +139,14 @@ void cx_executor::execute_assignment (const cx_symtab_node *p_target_id) {
 
     if (p_target_id->defn.how == dc_function) {
         trace_data_store(p_target_id, *p_target, p_target_type);
-    } else {
-        trace_data_store(p_target_id, *p_target_id->runstack_item, p_target_type);
+    } else if (trace_store_flag && (p_target_type->form != fc_stream)) {
+        trace_data_store(p_target_id, *run_stack.get_value_address(p_target_id),
+                p_target_type);
     }
 
-    pop();
+    // pop the assigned value; ++, -- and declarations push none
+    if ((token_in(op, tokenlist_assign_ops)) && (op != tc_plus_plus)
+            && (op != tc_minus_minus)) pop();
 }
 
 void cx_executor::assign (const cx_symtab_node* p_target_id,
@@ -614,15 +619,13 @@ void cx_executor::assign (const cx_symtab_node* p_target_id,
 
     } else {
 
-        const int size = p_target_type->size;
-        const int num_of_elements = size / p_target_type->base_type()->size;
+        const int size = p_expr_type->is_scalar_type() ? p_expr_type->size
+                : cx_value_size(p_expr_type, mem->addr__);
 
-        p_target_address = realloc(p_target_address, size);
+        // fixed-size arrays keep their size, others take the value's
+        const int length = (p_target_type->size > 0) ? p_target_type->size : size;
 
-        if (p_target_address == nullptr) {
-            perror("realloc");
-            exit(0);
-        }
+        p_target_address = cx_value_resize(p_target_address, length);
 
         char *tmp = (char *) p_target_address;
 
@@ -630,47 +633,47 @@ void cx_executor::assign (const cx_symtab_node* p_target_id,
             switch (expr_type) {
                 case cx_int:
                 {
-                    memcpy(tmp, t_int, sizeof (int));
+                    memcpy(tmp, &mem->int__, sizeof (int));
                 }
                     break;
                 case cx_char:
                 {
-                    memcpy(tmp, t_char, sizeof (char));
+                    memcpy(tmp, &mem->char__, sizeof (char));
                 }
                     break;
                 case cx_wchar:
                 {
-                    memcpy(tmp, t_wchar, sizeof (wchar_t));
+                    memcpy(tmp, &mem->wchar__, sizeof (wchar_t));
                 }
                     break;
                 case cx_float:
                 {
-                    memcpy(tmp, t_float, sizeof (float));
+                    memcpy(tmp, &mem->float__, sizeof (float));
                 }
                     break;
                 case cx_bool:
                 {
-                    memcpy(tmp, t_bool, sizeof (bool));
+                    memcpy(tmp, &mem->bool__, sizeof (bool));
                 }
                     break;
                 case cx_uint8:
                 {
-                    memcpy(tmp, t_uint8, sizeof (uint8_t));
+                    memcpy(tmp, &mem->uint8__, sizeof (uint8_t));
                 }
                     break;
                 case cx_uint16:
                 {
-                    memcpy(tmp, t_uint16, sizeof (uint16_t));
+                    memcpy(tmp, &mem->uint16__, sizeof (uint16_t));
                 }
                     break;
                 case cx_uint32:
                 {
-                    memcpy(tmp, t_uint32, sizeof (uint32_t));
+                    memcpy(tmp, &mem->uint32__, sizeof (uint32_t));
                 }
                     break;
                 case cx_uint64:
                 {
-                    memcpy(tmp, t_uint64, sizeof (uint64_t));
+                    memcpy(tmp, &mem->uint64__, sizeof (uint64_t));
                 }
                     break;
                 default:
@@ -679,14 +682,10 @@ void cx_executor::assign (const cx_symtab_node* p_target_id,
 
         } else {
             void *p_source = top()->basic_types.addr__;
-            memcpy(tmp, p_source, size);
+            memcpy(tmp, p_source, std::min(size, length));
         }
 
-        p_target_id->p_type->array.element_count = num_of_elements;
-        p_target_id->p_type->array.max_index = num_of_elements;
-        p_target_id->p_type->size = size;
-
-        p_target_id->runstack_item->basic_types.addr__ = p_target_address;
+        run_stack.get_value_address(p_target_id)->basic_types.addr__ = p_target_address;
 
     }
 }
@@ -1221,16 +1220,12 @@ cx_executor::plus_equal (const cx_symtab_node* p_target_id,
                 break;
         }
     } else {
-        const int size = p_expr_type->size;
-        const int old_size = p_target_type->size;
-        const int num_of_elements = (old_size + size) / p_expr_type->base_type()->size;
+        const int size = p_expr_type->is_scalar_type() ? p_expr_type->size
+                : cx_value_size(p_expr_type, mem->addr__);
+        const int old_size = cx_value_size(p_target_type, p_target_address);
+        const void *p_old_address = p_target_address;
 
-        p_target_address = realloc(p_target_address, old_size + size);
-
-        if (p_target_address == nullptr) {
-            perror("realloc");
-            exit(0);
-        }
+        p_target_address = cx_value_resize(p_target_address, old_size + size);
 
         char *tmp = (char *) p_target_address;
 
@@ -1282,12 +1277,13 @@ cx_executor::plus_equal (const cx_symtab_node* p_target_id,
             }
         } else {
             void *p_source = top()->basic_types.addr__;
+
+            // appending a value to itself
+            if (p_source == p_old_address) p_source = p_target_address;
+
             memcpy(&tmp[old_size], p_source, size);
         }
-        p_target_id->runstack_item->basic_types.addr__ = p_target_address;
-        p_target_id->p_type->array.element_count = num_of_elements;
-        p_target_id->p_type->array.max_index = num_of_elements;
-        p_target_id->p_type->size += size;
+        run_stack.get_value_address(p_target_id)->basic_types.addr__ = p_target_address;
     }
 }
 
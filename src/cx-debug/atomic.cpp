@@ -0,0 +1,148 @@
+/** Executor (Atomics)
+ * atomic.cpp
+ *
+ * Calls to load, store, fetch_add and compare_exchange.  Each is one
+ * std::atomic operation on the atomic's own storage, its frame slot or
+ * its element of an array, so spawned tasks and the workers of a
+ * parallel for update a counter at once without a lock.  The parser
+ * lets an atomic be used nowhere else (see parse_atomic_call), so
+ * nothing reads or writes it behind the operations' backs.
+ */
+
+#include <atomic>
+#include <cstring>
+#include "common.h"
+#include "cx-debug/exec.h"
+
+/** operand_of          The value of type T an operand holds.
+ *
+ * @param operand : the operand, converted to the atomic's type.
+ * @return the value.
+ */
+template <typename T>
+static T operand_of(const mem_block &operand) {
+    T value;
+
+    memcpy(&value, &operand, sizeof (T));
+    return value;
+}
+
+/** apply               Do an atomic routine's operation on storage
+ *                      that holds a T.
+ *
+ * @param which      : the routine.
+ * @param p_value    : ptr to the storage.
+ * @param p_operands : ptr to the routine's operands.
+ * @return what the routine gives back:  the value loaded, stored or
+ *         fetched, or whether compare_exchange stored.
+ */
+template <typename T>
+static mem_block apply(cx_routine_code which, void *p_value,
+        const mem_block *p_operands) {
+    static_assert(sizeof (std::atomic<T>) == sizeof (T),
+            "an atomic is kept as a plain value");
+
+    std::atomic<T> *p_atomic = reinterpret_cast<std::atomic<T> *> (p_value);
+    T result = 0;
+
+    switch (which) {
+        case rc_load:
+            result = p_atomic->load();
+            break;
+        case rc_store:
+            result = operand_of<T>(p_operands[0]);
+            p_atomic->store(result);
+            break;
+        case rc_fetch_add:
+            result = p_atomic->fetch_add(operand_of<T>(p_operands[0]));
+            break;
+        case rc_compare_exchange:
+        {
+            T expected = operand_of<T>(p_operands[0]);
+
+            result = p_atomic->compare_exchange_strong(expected,
+                    operand_of<T>(p_operands[1]));
+        }
+            break;
+        default:
+            break;
+    }
+
+    mem_block block;
+
+    memset(&block, 0, sizeof (block));
+    memcpy(&block, &result, sizeof (T));
+
+    return block;
+}
+
+/** execute_atomic_call  Execute a call to load, store, fetch_add or
+ *                      compare_exchange.  Leaves the value loaded,
+ *                      stored, or fetched before the add, or whether
+ *                      compare_exchange stored, on the stack.
+ *
+ *      load(<atomic>)
+ *      store(<atomic>, <expr>)
+ *      fetch_add(<atomic>, <expr>)
+ *      compare_exchange(<atomic>, <expected-expr>, <desired-expr>)
+ *
+ * The operands are evaluated before the operation, and converted to
+ * the atomic's type as an assignment would convert them.
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_atomic_call(cx_symtab_node *p_function_id) {
+    const cx_routine_code which = p_function_id->defn.routine.which;
+
+    get_token(); // (
+    get_token(); // the atomic
+    const cx_symtab_node *p_id = p_node;
+    get_token();
+    cx_type *p_type = execute_variable(p_id, true);
+    void *p_value = &((cx_stack_item *) top()->basic_types.addr__)->basic_types;
+    pop();
+
+    mem_block operands[2];
+    int count = 0;
+
+    while (token == tc_comma) {
+        get_token();
+        cx_type *p_expr_type = execute_expression();
+        cx_stack_item item;
+        void *p_unused = nullptr;
+
+        memset(&item.basic_types, 0, sizeof (item.basic_types));
+        assign(nullptr, p_type, p_expr_type, &item, p_unused);
+        pop();
+
+        operands[count++] = item.basic_types;
+    }
+
+    mem_block result;
+
+    switch (p_type->type_code) {
+        case cx_uint8: result = apply<uint8_t>(which, p_value, operands);
+            break;
+        case cx_uint16: result = apply<uint16_t>(which, p_value, operands);
+            break;
+        case cx_uint32: result = apply<uint32_t>(which, p_value, operands);
+            break;
+        case cx_uint64: result = apply<uint64_t>(which, p_value, operands);
+            break;
+        default: result = apply<int>(which, p_value, operands);
+            break;
+    }
+
+    get_token(); // token after )
+
+    // as execute_variable pushes a value of the atomic's type
+    if (which == rc_compare_exchange) {
+        push((bool) (result.int__ != 0));
+        return p_function_id->p_type;
+    } else if (p_type->type_code == cx_uint64) push(result.uint64__);
+    else push(result.int__);
+
+    return p_type;
+}
@@ -0,0 +1,556 @@
+/** Executor (Channels)
+ * channel.cpp
+ *
+ * Channels, and calls to channel, send, try_send, receive, try_receive
+ * and close.  A channel's handle is an int, as a task's is, and its
+ * type is checked as values go in and out.  A whole array or record
+ * variable is sent by moving its buffer into the channel, and a
+ * receive moves the buffer into the variable, so neither copies the
+ * data.
+ *
+ * A send or a receive that has to wait blocks its thread, and a spare
+ * thread runs the pool's tasks meanwhile (see pool.cpp), so a task it
+ * waits on gets run even with no other thread to run it.
+ */
+
+#include <thread>
+#include "common.h"
+#include "cx-debug/channel.h"
+#include "pool.h"
+
+/** Constructor         Make an empty channel.
+ *
+ * @param p_element_type : ptr to the type of the values sent.
+ * @param is_array       : true if the values are arrays, of any
+ *                         length, of the type.
+ * @param capacity       : count of values it holds, or 0 for any.
+ */
+cx_channel::cx_channel(cx_type *p_element_type, bool is_array, int capacity)
+: p_cells(nullptr), mask(0), send_position(0), receive_position(0),
+room(capacity), spill_count(0), waiting(0), closed(false),
+p_element_type(p_element_type), is_array(is_array), capacity(capacity) {
+    size_t count = 2;
+
+    // a bounded channel's ring has room for all it holds
+    while ((count < 64) || (count < (size_t) capacity)) count *= 2;
+
+    p_cells = new cx_cell[count];
+    const_cast<size_t &> (mask) = count - 1;
+
+    for (size_t i = 0; i < count; ++i) {
+        p_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+/** Destructor          Free the buffers of the values still held.
+ */
+cx_channel::~cx_channel(void) {
+    if (holds_buffers()) {
+        mem_block value;
+
+        while (try_receive(value)) cx_value_release(value.addr__);
+    }
+
+    delete[] p_cells;
+}
+
+/** push                Put a value in the ring.
+ *
+ * @param value : the value.
+ * @return false if the ring is full.
+ */
+bool cx_channel::push(const mem_block &value) {
+    size_t position = send_position.load(std::memory_order_relaxed);
+    cx_cell *p_cell;
+
+    for (;;) {
+        p_cell = &p_cells[position & mask];
+
+        const size_t sequence = p_cell->sequence.load(std::memory_order_acquire);
+        const intptr_t lag = (intptr_t) sequence - (intptr_t) position;
+
+        if (lag == 0) {
+            if (send_position.compare_exchange_weak(position, position + 1,
+                    std::memory_order_relaxed)) break;
+        } else if (lag < 0) {
+            return false;
+        } else position = send_position.load(std::memory_order_relaxed);
+    }
+
+    p_cell->value = value;
+    p_cell->sequence.store(position + 1, std::memory_order_release);
+
+    return true;
+}
+
+/** pop                 Take the oldest value out of the ring.
+ *
+ * @param value : gets the value.
+ * @return false if the ring is empty.
+ */
+bool cx_channel::pop(mem_block &value) {
+    size_t position = receive_position.load(std::memory_order_relaxed);
+    cx_cell *p_cell;
+
+    for (;;) {
+        p_cell = &p_cells[position & mask];
+
+        const size_t sequence = p_cell->sequence.load(std::memory_order_acquire);
+        const intptr_t lag = (intptr_t) sequence - (intptr_t) (position + 1);
+
+        if (lag == 0) {
+            if (receive_position.compare_exchange_weak(position, position + 1,
+                    std::memory_order_relaxed)) break;
+        } else if (lag < 0) {
+            return false;
+        } else position = receive_position.load(std::memory_order_relaxed);
+    }
+
+    value = p_cell->value;
+    p_cell->sequence.store(position + mask + 1, std::memory_order_release);
+
+    return true;
+}
+
+/** can_send            Whether a send might not have to wait.
+ */
+bool cx_channel::can_send(void) const {
+    return closed.load() || (capacity == 0) || (room.load() > 0);
+}
+
+/** can_receive         Whether a receive might not have to wait.
+ */
+bool cx_channel::can_receive(void) const {
+    const size_t position = receive_position.load();
+
+    return closed.load() || (spill_count.load() > 0)
+            || (p_cells[position & mask].sequence.load() == position + 1);
+}
+
+/** wake                Wake the threads waiting on the channel, if
+ *                      there are any, to check it again.
+ */
+void cx_channel::wake(void) {
+
+    // the value, or the close, is seen before waiting is read
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (waiting.load() > 0) cx_task_pool::shared().notify();
+}
+
+/** try_send            Send a value, if the channel has room for it.
+ *
+ * @param value : the value.  A buffer goes to the channel.
+ * @return false if the channel is full or closed.
+ */
+bool cx_channel::try_send(const mem_block &value) {
+    if (closed.load()) return false;
+
+    if (capacity > 0) {
+
+        // the ring never fills:  a send first claims room
+        if (room.fetch_sub(1) <= 0) {
+            room.fetch_add(1);
+            return false;
+        }
+
+        while (!push(value)) std::this_thread::yield();
+    } else if ((spill_count.load() > 0) || !push(value)) {
+
+        // once values spill, the rest follow them, so none overtakes
+        std::lock_guard<std::mutex> lock(spill_mutex);
+
+        spilled.push_back(value);
+        ++spill_count;
+    }
+
+    wake();
+    return true;
+}
+
+/** try_receive         Receive the oldest value, if there is one.
+ *
+ * @param value : gets the value.  A buffer goes to the receiver.
+ * @return false if the channel is empty.
+ */
+bool cx_channel::try_receive(mem_block &value) {
+    if (pop(value)) {
+        if (capacity > 0) {
+            room.fetch_add(1);
+            wake();
+        }
+
+        return true;
+    }
+
+    if (spill_count.load() == 0) return false;
+
+    std::lock_guard<std::mutex> lock(spill_mutex);
+
+    if (spilled.empty()) return false;
+
+    value = spilled.front();
+    spilled.pop_front();
+    --spill_count;
+
+    return true;
+}
+
+/** send                Send a value, waiting while the channel is
+ *                      full.
+ *
+ * @param value : the value.  A buffer goes to the channel.
+ * @return false if the channel is closed.
+ */
+bool cx_channel::send(const mem_block &value) {
+    while (!try_send(value)) {
+        if (closed.load()) return false;
+
+        ++waiting;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        cx_task_pool::shared().block_until([this]() {
+            return can_send();
+        });
+
+        --waiting;
+    }
+
+    return true;
+}
+
+/** receive             Receive the oldest value, waiting while the
+ *                      channel is empty.
+ *
+ * @param value : gets the value.  A buffer goes to the receiver.
+ * @return false if the channel is closed, and empty.
+ */
+bool cx_channel::receive(mem_block &value) {
+    while (!try_receive(value)) {
+
+        // a value sent before the close is still received
+        if (closed.load()) return try_receive(value);
+
+        ++waiting;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        cx_task_pool::shared().block_until([this]() {
+            return can_receive();
+        });
+
+        --waiting;
+    }
+
+    return true;
+}
+
+/** close               Close the channel:  sends fail from now on,
+ *                      and receives once it's empty.
+ */
+void cx_channel::close(void) {
+    closed.store(true);
+    wake();
+}
+
+/** Constructor         Make an empty table.
+ */
+cx_channel_table::cx_channel_table(void) : count(0) {
+    for (int i = 0; i < max_chunks; ++i) chunks[i].store(nullptr);
+}
+
+/** Destructor          Free the channels.
+ */
+cx_channel_table::~cx_channel_table(void) {
+    for (int i = 0; i < max_chunks; ++i) {
+        std::atomic<cx_channel *> *p_chunk = chunks[i].load();
+
+        if (p_chunk == nullptr) break;
+
+        for (int j = 0; j < chunk_size; ++j) delete p_chunk[j].load();
+        delete[] p_chunk;
+    }
+}
+
+/** add                 Add a channel to the table.
+ *
+ * @param p_channel : ptr to the channel, which the table owns.
+ * @return the channel's handle, or 0 if the table is full.
+ */
+int cx_channel_table::add(cx_channel *p_channel) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // handles start at 1
+    const int handle = count + 1;
+    const int xchunk = handle / chunk_size;
+
+    if (xchunk >= max_chunks) {
+        delete p_channel;
+        return 0;
+    }
+
+    std::atomic<cx_channel *> *p_chunk = chunks[xchunk].load();
+
+    if (p_chunk == nullptr) {
+        p_chunk = new std::atomic<cx_channel *>[chunk_size];
+        for (int i = 0; i < chunk_size; ++i) p_chunk[i].store(nullptr);
+
+        chunks[xchunk].store(p_chunk);
+    }
+
+    p_chunk[handle % chunk_size].store(p_channel);
+    ++count;
+
+    return handle;
+}
+
+/** find                Look a channel up by its handle.
+ *
+ * @param handle : the handle.
+ * @return ptr to the channel, or nullptr if there's no such channel.
+ */
+cx_channel *cx_channel_table::find(int handle) const {
+    if ((handle <= 0) || (handle / chunk_size >= max_chunks)) return nullptr;
+
+    std::atomic<cx_channel *> *p_chunk = chunks[handle / chunk_size].load();
+
+    return (p_chunk != nullptr) ? p_chunk[handle % chunk_size].load() : nullptr;
+}
+
+/** fits                 Whether values of a type can go through a
+ *                      channel:  arrays of its type, if it carries
+ *                      arrays, any scalar if it carries a scalar type,
+ *                      else the type itself.
+ *
+ * @param channel : the channel.
+ * @param p_type  : ptr to the type object.
+ * @return true if they can.
+ */
+static bool fits(const cx_channel &channel, const cx_type *p_type) {
+    if (channel.is_array) {
+        return (p_type->form == fc_array)
+                && (p_type->base_type() == channel.p_element_type);
+    }
+
+    if (channel.p_element_type->is_scalar_type()) return p_type->is_scalar_type();
+
+    return p_type == channel.p_element_type;
+}
+
+/** channel_of           The channel whose handle is on top of the
+ *                      stack, which is popped.
+ *
+ * @return ptr to the channel.
+ */
+cx_channel *cx_executor::channel_of(void) {
+    cx_channel *p_channel = p_context->p_channels->find(top()->basic_types.int__);
+    pop();
+
+    if (p_channel == nullptr) cx_runtime_error(rte_invalid_channel);
+
+    return p_channel;
+}
+
+/** execute_channel_call  Execute a call to channel, which leaves the
+ *                      new channel's handle on the stack, or to
+ *                      close, which leaves 0.
+ *
+ *      channel(<type-id> [*], <capacity-expr>)
+ *      close(<handle-expr>)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_channel_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token();
+
+    if (p_function_id->defn.routine.which == rc_close) {
+        execute_expression();
+        channel_of()->close();
+        push(0);
+    } else {
+        cx_type *p_element_type = p_node->p_type;
+        get_token(); // * or ,
+
+        const bool is_array = (token == tc_star);
+        if (is_array) get_token(); // ,
+
+        get_token();
+        execute_expression();
+        const int capacity = top()->basic_types.int__;
+        pop();
+
+        if (capacity < 0) cx_runtime_error(rte_invalid_function_argument);
+
+        const int handle = p_context->p_channels->add(
+                new cx_channel(p_element_type, is_array, capacity));
+
+        if (handle == 0) cx_runtime_error(rte_too_many_channels);
+
+        push(handle);
+    }
+
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_send_call     Execute a call to send, which waits while the
+ *                      channel is full, or to try_send, which doesn't.
+ *                      Leaves true on the stack if the value was
+ *                      sent.
+ *
+ *      send(<handle-expr>, <expr>)
+ *      try_send(<handle-expr>, <expr>)
+ *
+ * A scalar is sent as the channel's type.  A whole array or record
+ * variable moves to the channel, and is left as a new one of its
+ * type, all zeros, or empty;  any other array or record is copied.
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_send_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token();
+    execute_expression();
+    cx_channel *p_channel = channel_of();
+
+    // , and the value:  is it a whole variable, to move?
+    const int value_location = current_location();
+    cx_stack_item *p_slot = nullptr;
+    cx_type *p_type;
+
+    get_token();
+    if (token == tc_identifier) {
+        const cx_symtab_node *p_id = p_node;
+
+        if (((p_id->defn.how == dc_variable) || (p_id->defn.how == dc_value_parm))
+                && ((p_id->p_type->form == fc_array)
+                || (p_id->p_type->form == fc_complex))) {
+            get_token();
+            if (token == tc_right_paren) {
+                p_slot = run_stack.get_value_address(p_id);
+                p_type = p_id->p_type;
+            } else {
+                go_to(value_location);
+                get_token();
+            }
+        }
+    }
+
+    if (p_slot == nullptr) p_type = execute_expression();
+    if (!fits(*p_channel, p_type)) cx_runtime_error(rte_channel_type);
+
+    mem_block value;
+
+    memset(&value, 0, sizeof (value));
+
+    if (p_slot != nullptr) {
+        value.addr__ = cx_value_take(p_slot->basic_types.addr__, p_type->size);
+    } else if (p_type->is_scalar_type()) {
+        cx_stack_item item;
+        void *p_unused = nullptr;
+
+        // as an assignment to the channel's type would convert it
+        item.basic_types = value;
+        assign(nullptr, p_channel->p_element_type, p_type, &item, p_unused);
+        value = item.basic_types;
+        pop();
+    } else {
+        const void *p_data = top()->basic_types.addr__;
+        const int size = cx_value_size(p_type, p_data);
+
+        value.addr__ = cx_value_alloc(size);
+        memcpy(value.addr__, p_data, size);
+        pop();
+    }
+
+    const bool sent = (p_function_id->defn.routine.which == rc_send)
+            ? p_channel->send(value) : p_channel->try_send(value);
+
+    if (!sent && p_channel->holds_buffers()) {
+        if (p_slot != nullptr) {
+
+            // the value goes back to the variable
+            cx_value_release(p_slot->basic_types.addr__);
+            p_slot->basic_types.addr__ = value.addr__;
+        } else cx_value_release(value.addr__);
+    }
+
+    push(sent);
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_receive_call  Execute a call to receive, which waits while
+ *                      the channel is empty, or to try_receive, which
+ *                      doesn't.  Leaves true on the stack if a value
+ *                      was received into the variable.
+ *
+ *      receive(<handle-expr>, <variable>)
+ *      try_receive(<handle-expr>, <variable>)
+ *
+ * The variable is evaluated once the value is in.  A scalar is stored
+ * as an assignment would store it.  An array or a record moves into a
+ * whole variable that can hold it, and is copied, as much as fits,
+ * into anything else.
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_receive_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token();
+    execute_expression();
+    cx_channel *p_channel = channel_of();
+
+    mem_block value;
+    const bool received = (p_function_id->defn.routine.which == rc_receive)
+            ? p_channel->receive(value) : p_channel->try_receive(value);
+
+    get_token(); // variable
+    cx_symtab_node *p_id = p_node;
+    get_token();
+    cx_type *p_type = execute_variable(p_id, true);
+    void *p_target = top()->basic_types.addr__;
+    pop();
+
+    if (!fits(*p_channel, p_type)) {
+        if (received && p_channel->holds_buffers()) cx_value_release(value.addr__);
+        cx_runtime_error(rte_channel_type);
+    }
+
+    if (!received) {
+        // the variable is left as it was
+    } else if (p_type->is_scalar_type()) {
+        void *p_unused = nullptr;
+
+        push_value(p_channel->p_element_type, value);
+        assign(p_id, p_type, p_channel->p_element_type,
+                (cx_stack_item *) p_target, p_unused);
+        pop();
+    } else if ((p_type == p_id->p_type) && (p_id->defn.how != dc_reference)
+            && ((p_type->size == 0)
+            || (p_type->size == cx_value_length(value.addr__)))) {
+        cx_stack_item *p_slot = run_stack.get_value_address(p_id);
+
+        cx_value_release(p_slot->basic_types.addr__);
+        p_slot->basic_types.addr__ = value.addr__;
+    } else {
+        const int size = std::min(cx_value_size(p_type, p_target),
+                cx_value_length(value.addr__));
+
+        memcpy(p_target, value.addr__, size);
+        cx_value_release(value.addr__);
+    }
+
+    push(received);
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
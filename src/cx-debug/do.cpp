@@ -31,6 +31,7 @@ void cx_executor::execute_DO(cx_symtab_node * p_function_id) {
         get_token(); //while
         execute_expression(); // (condition)
         condition = top()->basic_types.bool__;
+        pop();
 
         if (condition != 0) this->go_to(at_loop_start);
     } while (current_location() == at_loop_start);
@@ -4,13 +4,309 @@
  * Execute the intermediate code.
  */
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "cx-debug/exec.h"
+#include "common.h"
+#include "scheduler.h"
 
-extern cx_type *p_integer_type;
-extern cx_type *p_float_type;
-extern cx_type *p_boolean_type;
-extern cx_type *p_char_type;
+/*******************
+ *                 *
+ *  Value Buffers  *
+ *                 *
+ *******************/
+
+static cx_value_buffer *buffer_of(const void *addr) {
+    return ((cx_value_buffer *) addr) - 1;
+}
+
+/** cx_value_alloc       Allocate an unshared buffer for an array
+ *                      or record value.
+ *
+ * @param size : size of the value in bytes.
+ * @return ptr to the value's data.
+ */
+void *cx_value_alloc(int size) {
+    cx_value_buffer *p_buffer = (cx_value_buffer *)
+            malloc(sizeof (cx_value_buffer) + size + 1);
+
+    if (p_buffer == nullptr) {
+        perror("malloc");
+        exit(0);
+    }
+
+    p_buffer->ref_count = 1;
+    p_buffer->capacity = size;
+    p_buffer->length = size;
+    p_buffer->is_inline = false;
+    p_buffer->is_mapped = false;
+    ((char *) (p_buffer + 1))[size] = '\0';
+
+    return p_buffer + 1;
+}
+
+/** cx_mapped_value      Bookkeeping of a mapped value.  It sits at
+ *                      the end of a page of its own, just before the
+ *                      file's pages.
+ */
+struct cx_mapped_value {
+    void *p_base; // start of the whole mapping
+    size_t size; // size of the whole mapping
+    cx_value_buffer header;
+};
+
+/** cx_value_map         Map part of a file as a read-only value.
+ *                      The pages are read straight from the file as
+ *                      they are touched, so the file may be larger
+ *                      than memory.  Storing into the value makes a
+ *                      copy of it first, as with a shared value.
+ *
+ * @param fd         : descriptor of a file open for reading.
+ * @param offset     : offset of the part, a multiple of the page size.
+ * @param length     : length of the part in bytes.
+ * @param sequential : true to advise the kernel of a sequential scan.
+ * @return ptr to the value's data, or nullptr if it can't be mapped.
+ */
+void *cx_value_map(int fd, int64_t offset, int length, bool sequential) {
+    if (length == 0) return cx_value_alloc(0);
+
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+
+    // a page for the header, and room for the '\0' after the data
+    const size_t data_size = ((size_t) length + page_size) & ~(page_size - 1);
+    const size_t size = page_size + data_size;
+
+    char *p_base = (char *) mmap(nullptr, size, PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p_base == MAP_FAILED) return nullptr;
+
+    char *p_data = p_base + page_size;
+
+    if ((mmap(p_base, page_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+            || (mmap(p_data, length, PROT_READ, MAP_SHARED | MAP_FIXED,
+            fd, (off_t) offset) == MAP_FAILED)) {
+        munmap(p_base, size);
+        return nullptr;
+    }
+
+    // the file ends on a page boundary:  follow it with a page of '\0'
+    if ((length % page_size) == 0) {
+        mmap(p_data + length, page_size, PROT_READ,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    }
+
+    if (sequential) madvise(p_data, length, MADV_SEQUENTIAL);
+
+    cx_mapped_value *p_mapped = ((cx_mapped_value *) p_data) - 1;
+    p_mapped->p_base = p_base;
+    p_mapped->size = size;
+    p_mapped->header.ref_count = 1;
+    p_mapped->header.capacity = length;
+    p_mapped->header.length = length;
+    p_mapped->header.is_inline = false;
+    p_mapped->header.is_mapped = true;
+
+    return p_data;
+}
+
+/** free_buffer          Free a buffer that has lost its last owner.
+ *
+ * @param p_buffer : ptr to the buffer's header.
+ */
+static void free_buffer(cx_value_buffer *p_buffer) {
+    if (p_buffer->is_inline) return;
+
+    if (p_buffer->is_mapped) {
+        cx_mapped_value *p_mapped = (cx_mapped_value *) (p_buffer + 1) - 1;
+        munmap(p_mapped->p_base, p_mapped->size);
+    } else free(p_buffer);
+}
+
+/** move_value           Move a value into a buffer of its own with
+ *                      the given capacity.  A shared or inline
+ *                      buffer is copied and left to its owners.
+ *
+ * @param addr     : ptr to the value's data.
+ * @param capacity : capacity of the new buffer in bytes.
+ * @return ptr to the moved value's data.
+ */
+static void *move_value(void *addr, int capacity) {
+    cx_value_buffer *p_buffer = buffer_of(addr);
+    const int length = std::min(p_buffer->length, capacity);
+
+    if ((p_buffer->ref_count == 1) && !p_buffer->is_inline
+            && !p_buffer->is_mapped) {
+        p_buffer = (cx_value_buffer *)
+                realloc(p_buffer, sizeof (cx_value_buffer) + capacity + 1);
+
+        if (p_buffer == nullptr) {
+            perror("realloc");
+            exit(0);
+        }
+
+        p_buffer->capacity = capacity;
+        p_buffer->length = length;
+        ((char *) (p_buffer + 1))[length] = '\0';
+
+        return p_buffer + 1;
+    }
+
+    void *p_copy = cx_value_alloc(capacity);
+
+    memcpy(p_copy, addr, length);
+    buffer_of(p_copy)->length = length;
+    ((char *) p_copy)[length] = '\0';
+    if (--p_buffer->ref_count == 0) free_buffer(p_buffer);
+
+    return p_copy;
+}
+
+/** cx_value_resize      Set the length of a value, keeping as much
+ *                      of its data as fits.  The buffer grows
+ *                      geometrically, so appending to a value one
+ *                      piece at a time takes amortized linear time.
+ *
+ * @param addr : ptr to the value's data, or nullptr.
+ * @param size : new size of the value in bytes.
+ * @return ptr to the resized value's data.
+ */
+void *cx_value_resize(void *addr, int size) {
+    if (addr == nullptr) return cx_value_alloc(size);
+
+    cx_value_buffer *p_buffer = buffer_of(addr);
+
+    if (p_buffer->is_mapped) {
+
+        // copy no more of the file than the value keeps
+        addr = move_value(addr, size);
+    } else if (size > p_buffer->capacity) {
+        addr = move_value(addr, std::max(size, 2 * p_buffer->capacity));
+    } else if (p_buffer->ref_count > 1) {
+        addr = move_value(addr, p_buffer->capacity);
+    }
+
+    buffer_of(addr)->length = size;
+    ((char *) addr)[size] = '\0';
+
+    return addr;
+}
+
+/** cx_value_reserve     Make sure a value's buffer can grow to the
+ *                      given capacity without moving.
+ *
+ * @param addr     : ptr to the value's data, or nullptr.
+ * @param capacity : capacity in bytes.
+ * @return ptr to the value's data.
+ */
+void *cx_value_reserve(void *addr, int capacity) {
+    if (addr == nullptr) {
+        addr = cx_value_alloc(capacity);
+        buffer_of(addr)->length = 0;
+        ((char *) addr)[0] = '\0';
+
+        return addr;
+    }
+
+    if (capacity <= buffer_of(addr)->capacity) return addr;
+
+    return move_value(addr, capacity);
+}
+
+/** cx_value_share       Add an owner to a value's buffer.
+ *
+ * @param addr : ptr to the value's data, or nullptr.
+ * @return ptr to the value's data.
+ */
+void *cx_value_share(void *addr) {
+    if (addr != nullptr) ++buffer_of(addr)->ref_count;
+
+    return addr;
+}
+
+/** cx_value_unshare     Make sure the caller is the only owner of a
+ *                      value's buffer before it stores into it.
+ *
+ * @param addr : ptr to the value's data, or nullptr.
+ * @return ptr to the caller's own copy of the value's data.
+ */
+void *cx_value_unshare(void *addr) {
+    if ((addr == nullptr) || ((buffer_of(addr)->ref_count == 1)
+            && !buffer_of(addr)->is_mapped)) return addr;
+
+    return move_value(addr, buffer_of(addr)->capacity);
+}
+
+/** cx_value_take        Take a value from its owner, for a channel.
+ *                      An unshared buffer moves as it is;  any other
+ *                      is copied, and the owner's share dropped.  The
+ *                      owner is left a new value, all zeros.
+ *
+ * @param addr : the owner's ptr to the value's data, or nullptr.  Gets
+ *               the new value.
+ * @param size : size of the new value in bytes.
+ * @return ptr to the taken value's data.
+ */
+void *cx_value_take(void *&addr, int size) {
+    void *p_taken = addr;
+
+    if (addr == nullptr) {
+        p_taken = cx_value_alloc(0);
+    } else if ((buffer_of(addr)->ref_count > 1) || buffer_of(addr)->is_inline
+            || buffer_of(addr)->is_mapped) {
+        const int length = buffer_of(addr)->length;
+
+        p_taken = cx_value_alloc(length);
+        memcpy(p_taken, addr, length);
+        cx_value_release(addr);
+    }
+
+    addr = cx_value_alloc(size);
+    memset(addr, 0, size);
+
+    return p_taken;
+}
+
+/** cx_value_release     Drop an owner of a value's buffer, and free
+ *                      the buffer with its last owner.
+ *
+ * @param addr : ptr to the value's data, or nullptr.
+ */
+void cx_value_release(void *addr) {
+    if (addr == nullptr) return;
+
+    cx_value_buffer *p_buffer = buffer_of(addr);
+
+    if (--p_buffer->ref_count == 0) free_buffer(p_buffer);
+}
+
+/** cx_value_length      Length of a value in bytes.
+ *
+ * @param addr : ptr to the value's data, or nullptr.
+ * @return length in bytes.
+ */
+int cx_value_length(const void *addr) {
+    return (addr == nullptr) ? 0 : buffer_of(addr)->length;
+}
+
+/** cx_value_size        Size of an array or record value in bytes.
+ *                      Arrays of unknown size (char *) take the
+ *                      length of their buffer, and string literals
+ *                      the length of their pool entry.
+ *
+ * @param p_type : ptr to the value's type object.
+ * @param addr   : ptr to the value's data.
+ * @return size in bytes.
+ */
+int cx_value_size(const cx_type *p_type, const void *addr) {
+    if (p_type->is_constant()) return cx_string_constant_of(addr)->length;
+
+    return (p_type->size > 0) ? p_type->size : cx_value_length(addr);
+}
 
 /*******************
  *                 *
@@ -20,13 +316,15 @@ extern cx_type *p_char_type;
 
 ///  Constructor
 
-cx_runtime_stack::cx_runtime_stack (void) {
+cx_runtime_stack::cx_runtime_stack (cx_context *p_context)
+: p_context(p_context) {
 
     // Initialize the program's stack frame at the bottom.
 
     push_frame(); // function return value
     p_frame_base = (cx_frame_header *) top(); // point to bottom of stack
     p_stackbase = (cx_frame_header *) top();
+    p_global_frame_base = p_frame_base;
 
 }
 
@@ -111,74 +409,71 @@ cx_runtime_stack::pop_frame (const cx_symtab_node *p_function_id,
     }
 }
 
-/** allocate_value       Allocate a runtime stack item for the
- *                       value of a formal parameter or a local
- *                       variable.
+/** new_value            Make a runtime stack item for the value of
+ *                      a variable of the given type, set to zero.
  *
- * @param p_id : ptr to symbol table node of variable or parm
+ * @param p_type : ptr to the variable's type object.
+ * @return ptr to the new item.
  */
-void
-cx_runtime_stack::allocate_value (cx_symtab_node *p_id) {
-    cx_type *p_type = p_id->p_type; // ptr to type object of value
-
+cx_stack_item *
+cx_runtime_stack::new_value (const cx_type *p_type) const {
     if ((p_type->form != fc_array) && (p_type->form != fc_complex)) {
-        if (p_type == p_integer_type) push((int) 0);
-        else if (p_type == p_float_type) push((float) 0.0);
-        else if (p_type == p_wchar_type) push((wchar_t)'\0');
-        else if (p_type == p_uint8_type) push((uint8_t) 0);
-        else if (p_type == p_uint16_type) push((uint16_t) 0);
-        else if (p_type == p_uint32_type) push((uint32_t) 0);
-        else if (p_type == p_uint64_type) push((uint64_t) 0);
-        else if (p_type == p_boolean_type) push((bool)false);
-        else if (p_type == p_char_type) push((char) '\0');
-        else if (p_type->form == fc_enum) push((int) 0);
-    } else {
-
-        if (p_type->size > 0) {
-            // Array or record
-            const int size = p_type->size;
-            void *addr = malloc(size + 1);
-            //memset(addr, 0, size);
-            push(addr);
-        } else {
-            push((void *) nullptr);
-        }
+        if (p_type == p_context->p_integer_type) return new cx_stack_item((int) 0);
+        else if (p_type == p_context->p_float_type) return new cx_stack_item((float) 0.0);
+        else if (p_type == p_context->p_wchar_type) return new cx_stack_item((wchar_t)'\0');
+        else if (p_type == p_context->p_uint8_type) return new cx_stack_item((uint8_t) 0);
+        else if (p_type == p_context->p_uint16_type) return new cx_stack_item((uint16_t) 0);
+        else if (p_type == p_context->p_uint32_type) return new cx_stack_item((uint32_t) 0);
+        else if (p_type == p_context->p_uint64_type) return new cx_stack_item((uint64_t) 0);
+        else if (p_type == p_context->p_boolean_type) return new cx_stack_item((bool)false);
+        else if (p_type == p_context->p_char_type) return new cx_stack_item((char) '\0');
+        else if (p_type->form == fc_enum) return new cx_stack_item((int) 0);
+        else return new cx_stack_item((void *) nullptr);
     }
 
-    /* save runstack address.
-     * this negates the need to calculate the
-     * variables offset. */
-    p_id->runstack_item = top();
+    // Array or record:  small ones are kept in the slot itself.
+    if (p_type->size <= cx_inline_value::capacity) {
+        return new cx_inline_value(p_type->size);
+    }
+
+    void *addr = cx_value_alloc(p_type->size);
+
+    memset(addr, 0, p_type->size);
+    return new cx_stack_item(addr);
 }
 
-/** deallocate_value    Deallocate the data area of an array or
- *                      record value of a formal value parameter
- *                      or a local variable.
+/** allocate_value       Allocate a runtime stack item for the
+ *                       value of a local variable.  Every local
+ *                       takes exactly one item, its frame slot.
  *
  * @param p_id : ptr to symbol table node of variable or parm
  */
 void
-cx_runtime_stack::deallocate_value (cx_symtab_node *p_id) {
-    return;
-           
-    if(p_id->runstack_item == nullptr) return;
-    
-    void *addr = p_id->runstack_item->basic_types.addr__;
-    cx_type_form_code form = p_id->p_type->form;
-    cx_define_code def_how = p_id->defn.how;
-
-    if ((addr != nullptr) && (form == fc_array) && (def_how != dc_reference)) {
-        free(p_id->runstack_item->basic_types.addr__);
-    }
+cx_runtime_stack::allocate_value (cx_symtab_node *p_id) {
+    cx_runstack.push_back(new_value(p_id->p_type));
+}
 
-    p_id->runstack_item = nullptr;
+/** cx_slot_reference    Whether a parm is an array passed by
+ *                      reference.  Its slot holds its actual's slot,
+ *                      not the array's data, so storing a grown
+ *                      array's new buffer reaches the actual.
+ *
+ * @param p_id : ptr to the parm's symtab node.
+ * @return true if it is.
+ */
+bool cx_slot_reference(const cx_symtab_node *p_id) {
+    return (p_id->defn.how == dc_reference) && (p_id->p_type->form == fc_array);
 }
 
 /** get_value_address     get the address of the runtime stack
  *                      item that contains the value of a formal
- *                      parameter or a local variable.  If
- *                      nonlocal, follow the static links to the
- *                      appropriate stack frame.
+ *                      parameter or a local variable.  Globals
+ *                      live in the program's frame, everything
+ *                      else in the current frame.  An array
+ *                      reference parm's slot holds its actual's
+ *                      slot, which is the one given back, so an
+ *                      array grown through the parm is grown in
+ *                      its actual.
  *
  * @param p_id : ptr to symbol table node of variable or parm
  *
@@ -187,12 +482,128 @@ cx_runtime_stack::deallocate_value (cx_symtab_node *p_id) {
  */
 cx_stack_item *
 cx_runtime_stack::get_value_address (const cx_symtab_node *p_id) {
-    bool functionFlag = p_id->defn.how == dc_function; // true if function
-    //   else false
-    cx_frame_header *p_header = (cx_frame_header *) p_frame_base;
+    if (p_id->defn.how == dc_function) return p_frame_base->function_value;
+
+    const cx_frame_header *p_header = (p_id->level == 0)
+            ? p_global_frame_base : p_frame_base;
+
+    cx_stack_item *p_slot =
+            cx_runstack[p_header->frame_header_index + 1 + p_id->defn.data.offset];
+
+    return cx_slot_reference(p_id)
+            ? (cx_stack_item *) p_slot->basic_types.addr__ : p_slot;
+}
+
+/** frame_size           Count of slots in a routine's frame:  one
+ *                      for each parm and each local variable.
+ *
+ * @param p_function_id : ptr to the routine's symtab node.
+ * @return count of slots.
+ */
+static int frame_size(const cx_symtab_node *p_function_id) {
+    int count = p_function_id->defn.routine.parm_count;
+
+    for (const cx_symtab_node *p_id = p_function_id->defn.routine.locals.p_variable_ids;
+            p_id != nullptr; p_id = p_id->next__) ++count;
+
+    return count;
+}
+
+/** share_frames         Set up the stack of a worker of a parallel
+ *                      for (see parallel.cpp) with the program's
+ *                      frame and the frame of the routine running
+ *                      the loop.  Their slots are the items of the
+ *                      owner's stack, so the worker sees the same
+ *                      variables.
+ *
+ * @param owner         : stack of the executor running the loop.
+ * @param p_program_id  : ptr to the program's symtab node.
+ * @param p_function_id : ptr to the routine running the loop.
+ */
+void
+cx_runtime_stack::share_frames (const cx_runtime_stack &owner,
+        const cx_symtab_node *p_program_id,
+        const cx_symtab_node *p_function_id) {
+    share_frame(owner, owner.p_global_frame_base, p_program_id);
+    p_global_frame_base = p_frame_base;
+
+    if (owner.p_frame_base != owner.p_global_frame_base) {
+        share_frame(owner, owner.p_frame_base, p_function_id);
+    }
+}
+
+/** share_frame          Push and activate a frame whose slots are
+ *                      those of a frame of another stack:  a slot
+ *                      for each parm and each local variable.
+ *
+ * @param owner         : the other stack.
+ * @param p_header      : ptr to the header of its frame.
+ * @param p_function_id : ptr to the frame's routine.
+ */
+void
+cx_runtime_stack::share_frame (const cx_runtime_stack &owner,
+        const cx_frame_header *p_header,
+        const cx_symtab_node *p_function_id) {
+    cx_frame_header *p_new_frame_base = push_frame_header(0, 0, nullptr);
+    const int count = frame_size(p_function_id);
+    const int first = p_header->frame_header_index + 1;
+
+    for (int i = 0; i < count; ++i) {
+        cx_runstack.push_back(owner.cx_runstack[first + i]);
+    }
 
-    return functionFlag ? p_header->function_value
-            : p_id->runstack_item;
+    p_frame_base = p_new_frame_base;
+}
+
+/** privatize            Give a variable of a shared frame a slot of
+ *                      its own, set to zero.
+ *
+ * @param p_id : ptr to symbol table node of the variable.
+ * @return ptr to the new slot.
+ */
+cx_stack_item *
+cx_runtime_stack::privatize (const cx_symtab_node *p_id) {
+    const cx_frame_header *p_header = (p_id->level == 0)
+            ? p_global_frame_base : p_frame_base;
+
+    cx_stack_item *&p_slot =
+            cx_runstack[p_header->frame_header_index + 1 + p_id->defn.data.offset];
+
+    p_slot = new_value(p_id->p_type);
+
+    return p_slot;
+}
+
+/** global_slots         The slots of the program's frame, for a task
+ *                      spawned by the thread that owns the stack.
+ *                      They're taken before the task starts, as the
+ *                      stack grows and moves while the task runs.
+ *
+ * @param p_program_id : ptr to the program's symtab node.
+ * @return the slots, in order.
+ */
+std::vector<cx_stack_item *>
+cx_runtime_stack::global_slots (const cx_symtab_node *p_program_id) const {
+    const int first = p_global_frame_base->frame_header_index + 1;
+
+    return std::vector<cx_stack_item *>(cx_runstack.begin() + first,
+            cx_runstack.begin() + first + frame_size(p_program_id));
+}
+
+/** share_globals        Push and activate a program frame whose
+ *                      slots are those of another stack's, as
+ *                      global_slots gave them.
+ *
+ * @param slots : the slots.
+ */
+void
+cx_runtime_stack::share_globals (const std::vector<cx_stack_item *> &slots) {
+    cx_frame_header *p_new_frame_base = push_frame_header(0, 0, nullptr);
+
+    cx_runstack.insert(cx_runstack.end(), slots.begin(), slots.end());
+
+    p_frame_base = p_new_frame_base;
+    p_global_frame_base = p_new_frame_base;
 }
 
 /**************
@@ -201,19 +612,41 @@ cx_runtime_stack::get_value_address (const cx_symtab_node *p_id) {
  *            *
  **************/
 
+///  Destructor
+
+cx_executor::~cx_executor (void) {
+    for (auto &view : icode_views) delete view.second;
+}
+
+
+/** setup_cout          Set std::cout up for the scripts' floats,
+ *                      once:  it's shared by every script running.
+ */
+static void setup_cout(void) {
+    static const bool cout_fixed =
+            (std::cout.setf(std::ios::fixed, std::ios::floatfield), true);
+
+    (void) cout_fixed;
+}
 
 ///  go                  Start the executor.
 
 void
 cx_executor::go (cx_symtab_node *p_program_id) {
+    cx_context_scope scope(p_context);
+    cx_run_slot slot(this);
+
     // Initialize standard input and output.
     eof_flag = std::cin.eof();
-    std::cout.setf(std::ios::fixed, std::ios::floatfield);
+    setup_cout();
 
     // Execute the program.
     break_loop = false;
 
     initialize_global(p_program_id);
+
+    // spawned tasks share the globals exit_routine releases
+    join_tasks();
     exit_routine(p_program_id);
 
     extern bool cx_dev_debug_flag;
@@ -226,6 +659,92 @@ cx_executor::go (cx_symtab_node *p_program_id) {
     }
 }
 
+/** start               Set up the program's globals for a host
+ *                      program, without calling main.  Its
+ *                      functions can then be called, and its
+ *                      globals read and written, until stop.
+ *
+ * @param p_program_id : ptr to the program's symtab node.
+ */
+void
+cx_executor::start (cx_symtab_node *p_program_id) {
+    cx_context_scope scope(p_context);
+    cx_run_slot slot(this);
+
+    eof_flag = std::cin.eof();
+    setup_cout();
+
+    break_loop = false;
+
+    enter_global(p_program_id);
+
+    // run the global statements, up to the call of main
+    get_token(); // {
+    get_token();
+
+    while ((token != tc_right_bracket) && (token != tc_dummy)
+            && !((token == tc_identifier)
+            && (p_node == p_context->p_main_function_id))) {
+        execute_statement(p_program_id);
+
+        while (token == tc_semicolon) get_token();
+    }
+}
+
+/** stop                Release the program's globals, once a host
+ *                      program is done with them and the tasks that
+ *                      share them are joined.
+ *
+ * @param p_program_id : ptr to the program's symtab node.
+ */
+void
+cx_executor::stop (cx_symtab_node *p_program_id) {
+    cx_context_scope scope(p_context);
+
+    join_tasks();
+    exit_routine(p_program_id);
+}
+
+/** cx_run_slot         Wait for a slot of the context's scheduler,
+ *                      unless there isn't one, the executor is a
+ *                      worker, or the thread holds a slot already.
+ *
+ * @param p_executor : ptr to the executor about to run.
+ */
+cx_executor::cx_run_slot::cx_run_slot(cx_executor *p_executor)
+: p_executor(p_executor), start_count(p_executor->statement_count),
+entered(false) {
+    cx_scheduler *p_scheduler = p_executor->p_context->p_scheduler;
+
+    if ((p_scheduler == nullptr) || p_executor->is_worker) return;
+
+    entered = p_scheduler->enter(*p_executor->p_context->p_account);
+    if (entered && (p_scheduler->slice > 0)) {
+        p_executor->yield_at = start_count + p_scheduler->slice;
+    }
+}
+
+/** ~cx_run_slot        Give up the slot, and account for the
+ *                      statements the run executed.
+ */
+cx_executor::cx_run_slot::~cx_run_slot(void) {
+    if (!entered) return;
+
+    p_executor->yield_at = LONG_MAX;
+    p_executor->p_context->p_scheduler->leave(p_executor->statement_count
+            - start_count);
+}
+
+/** yield_slot          End the run's turn, once it has executed its
+ *                      slice of statements, and set the end of the
+ *                      next one.
+ */
+void
+cx_executor::yield_slot (void) {
+    cx_scheduler::yield();
+    yield_at = statement_count + p_context->p_scheduler->slice;
+}
+
 /** range_check      Range check an assignment to a subrange.
  *
  * @param p_target_type : ptr to target type object
@@ -234,30 +753,59 @@ cx_executor::go (cx_symtab_node *p_program_id) {
 void
 cx_executor::range_check (const cx_type *p_target_type, int value) {
 
+    // arrays of unknown size are not checked
     if ((p_target_type->form == fc_array)
+            && (p_target_type->array.element_count > 0)
             && ((value < p_target_type->array.min_index)
             || (value > p_target_type->array.max_index))) {
         cx_runtime_error(rte_value_out_of_range);
     }
 }
 
-/** initialize_global    Init global scope and execute it's icode
- *                      to make sure global variable get initialized
+/** push_value          push a value of the given type, as its
+ *                      frame slot holds it.
  *
- * @param p_program_id
+ * @param p_type : ptr to the value's type object.
+ * @param value  : the value, or the data of an array or record.
  */
 void
-cx_executor::initialize_global (cx_symtab_node* p_program_id) {
+cx_executor::push_value (const cx_type *p_type, const mem_block &value) {
+    if ((p_type->form == fc_array) || (p_type->form == fc_complex)) {
+        push(value.addr__);
+    } else if (p_type == p_context->p_boolean_type) push((int) value.bool__);
+    else if (p_type == p_context->p_char_type) push(value.char__);
+    else if (p_type == p_context->p_float_type) push(value.float__);
+    else push(value.int__);
+}
+
+/** enter_global        Push and activate the program's frame, and
+ *                      allocate its globals.
+ *
+ * @param p_program_id : ptr to the program's symtab node.
+ */
+void
+cx_executor::enter_global (cx_symtab_node *p_program_id) {
 
     // Set up a new stack frame for the callee.
     cx_frame_header *p_new_frame_base = run_stack.push_frame_header
             (0, 0, p_program_id->defn.routine.p_icode);
 
     // Activate the new stack frame ...
-    current_nesting_level = 0;
+    nesting_level = 0;
     run_stack.activate_frame(p_new_frame_base, p_program_id->defn.routine.return_marker);
+    run_stack.set_global_frame(p_new_frame_base);
 
     enter_routine(p_program_id);
+}
+
+/** initialize_global    Init global scope and execute it's icode
+ *                      to make sure global variable get initialized
+ *
+ * @param p_program_id
+ */
+void
+cx_executor::initialize_global (cx_symtab_node* p_program_id) {
+    enter_global(p_program_id);
     get_token();
     execute_statement(p_program_id);
 }
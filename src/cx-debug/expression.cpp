@@ -8,6 +8,58 @@
 #include "common.h"
 #include "cx-debug/rlutil.h"
 
+/** string_length        Length of a string operand in bytes.  Pooled
+ *                      literals and unknown-size arrays know their
+ *                      length; fixed-size arrays end at their first
+ *                      '\0'.
+ *
+ * @param p_type : ptr to the operand's type object.
+ * @param addr   : ptr to the operand's data.
+ * @return length in bytes.
+ */
+static int string_length(const cx_type *p_type, const char *addr) {
+    if (p_type->is_constant() || (p_type->size == 0)) {
+        return cx_value_size(p_type, addr);
+    }
+
+    return strnlen(addr, p_type->size);
+}
+
+/** compare_strings      Compare two string operands.  Equality
+ *                      against a literal is settled by the lengths,
+ *                      and by the hashes when both are literals,
+ *                      before any data is compared.
+ *
+ * @param p_type1 : ptr to the first operand's type object.
+ * @param addr1   : ptr to the first operand's data.
+ * @param p_type2 : ptr to the second operand's type object.
+ * @param addr2   : ptr to the second operand's data.
+ * @param op      : relational operator.
+ * @return <0, 0 or >0 as with strcmp.
+ */
+static int compare_strings(const cx_type *p_type1, const char *addr1,
+        const cx_type *p_type2, const char *addr2, cx_token_code op) {
+    const bool equality = (op == tc_equal_equal) || (op == tc_not_equal);
+
+    if (equality && p_type1->is_constant() && p_type2->is_constant()) {
+        const cx_string_constant *p_constant1 = cx_string_constant_of(addr1);
+        const cx_string_constant *p_constant2 = cx_string_constant_of(addr2);
+
+        // each literal is pooled once
+        if (p_constant1 == p_constant2) return 0;
+        if (p_constant1->hash != p_constant2->hash) return 1;
+    }
+
+    const int length1 = string_length(p_type1, addr1);
+    const int length2 = string_length(p_type2, addr2);
+
+    if (equality && (length1 != length2)) return 1;
+
+    int cmp = memcmp(addr1, addr2, std::min(length1, length2));
+
+    return (cmp != 0) ? cmp : length1 - length2;
+}
+
 /** execute_expression   Execute an expression (binary relational
  *                      operators = < > <> <= and >= ).
  *
@@ -27,30 +79,36 @@ cx_executor::execute_expression(void) {
     // execute the second simple expression.
     if (token_in(token, tokenlist_relation_ops)) {
         op = token;
+        cx_type *p_value1_type = p_result_type;
         p_operand1_type = p_result_type->base_type();
-        p_result_type = p_boolean_type;
+        p_result_type = p_context->p_boolean_type;
 
         get_token();
-        p_operand2_type = execute_simple_expression()->base_type();
+        cx_type *p_value2_type = execute_simple_expression();
+        p_operand2_type = p_value2_type->base_type();
+
+        // strings compare by their contents, not their first char
+        const bool string_operands = (p_value1_type->form == fc_array)
+                && (p_value2_type->form == fc_array);
 
         // Perform the operation, and push the resulting value
         // onto the stack.
-        if (((p_operand1_type == p_integer_type) &&
-                (p_operand2_type == p_integer_type))
-                || ((p_operand1_type == p_char_type) &&
-                (p_operand2_type == p_char_type))
-                || ((p_operand1_type == p_integer_type) &&
-                (p_operand2_type == p_char_type)) ||
-                ((p_operand1_type == p_char_type) &&
-                (p_operand2_type == p_integer_type))
-                || (p_operand1_type->form == fc_enum)) {
+        if (!string_operands && (((p_operand1_type == p_context->p_integer_type) &&
+                (p_operand2_type == p_context->p_integer_type))
+                || ((p_operand1_type == p_context->p_char_type) &&
+                (p_operand2_type == p_context->p_char_type))
+                || ((p_operand1_type == p_context->p_integer_type) &&
+                (p_operand2_type == p_context->p_char_type)) ||
+                ((p_operand1_type == p_context->p_char_type) &&
+                (p_operand2_type == p_context->p_integer_type))
+                || (p_operand1_type->form == fc_enum))) {
 
             // integer <op> integer
             // boolean <op> boolean
             // char    <op> char
             // enum    <op> enum
             int value1, value2;
-            if (p_operand1_type == p_char_type) {
+            if (p_operand1_type == p_context->p_char_type) {
                 value2 = top()->basic_types.char__;
                 pop();
                 value1 = top()->basic_types.char__;
@@ -91,18 +149,18 @@ cx_executor::execute_expression(void) {
                     break;
 
             }
-        } else if ((p_operand1_type == p_float_type) ||
-                (p_operand2_type == p_float_type)) {
+        } else if (!string_operands && ((p_operand1_type == p_context->p_float_type) ||
+                (p_operand2_type == p_context->p_float_type))) {
 
             // real    <op> real
             // real    <op> integer
             // integer <op> real
-            float value2 = p_operand2_type == p_float_type ? top()->basic_types.float__
+            float value2 = p_operand2_type == p_context->p_float_type ? top()->basic_types.float__
                     : top()->basic_types.int__;
 
             pop();
 
-            float value1 = p_operand1_type == p_float_type ? top()->basic_types.float__
+            float value1 = p_operand1_type == p_context->p_float_type ? top()->basic_types.float__
                     : top()->basic_types.int__;
 
             pop();
@@ -144,7 +202,8 @@ cx_executor::execute_expression(void) {
             char *addr1 = (char *) top()->basic_types.addr__;
             pop();
 
-            int cmp = strncmp(addr1, addr2, p_operand1_type->size);
+            int cmp = compare_strings(p_value1_type, addr1,
+                    p_value2_type, addr2, op);
 
             switch (op) {
                 case tc_equal_equal: push(cmp == 0);
@@ -195,7 +254,7 @@ cx_executor::execute_simple_expression(void) {
     switch (unary_op) {
         case tc_minus:
         {
-            if (p_result_type == p_float_type) {
+            if (p_result_type == p_context->p_float_type) {
                 float f = top()->basic_types.float__;
                 pop();
 
@@ -232,8 +291,8 @@ cx_executor::execute_simple_expression(void) {
             case tc_plus:
             case tc_minus:
             {
-                if ((p_result_type == p_integer_type) &&
-                        (p_operand_type == p_integer_type)) {
+                if ((p_result_type == p_context->p_integer_type) &&
+                        (p_operand_type == p_context->p_integer_type)) {
 
                     // integer +|- integer
                     int value2 = top()->basic_types.int__;
@@ -243,9 +302,9 @@ cx_executor::execute_simple_expression(void) {
 
                     push(op == tc_plus ? value1 + value2
                             : value1 - value2);
-                    p_result_type = p_integer_type;
-                } else if ((p_result_type == p_integer_type) &&
-                        (p_operand_type == p_char_type)) {
+                    p_result_type = p_context->p_integer_type;
+                } else if ((p_result_type == p_context->p_integer_type) &&
+                        (p_operand_type == p_context->p_char_type)) {
 
                     int value2 = top()->basic_types.int__;
                     pop();
@@ -254,9 +313,9 @@ cx_executor::execute_simple_expression(void) {
 
                     push(op == tc_plus ? value1 + value2
                             : value1 - value2);
-                    p_result_type = p_integer_type;
-                } else if ((p_result_type == p_char_type) &&
-                        (p_operand_type == p_integer_type)) {
+                    p_result_type = p_context->p_integer_type;
+                } else if ((p_result_type == p_context->p_char_type) &&
+                        (p_operand_type == p_context->p_integer_type)) {
 
                     char value2 = top()->basic_types.char__;
                     pop();
@@ -265,25 +324,25 @@ cx_executor::execute_simple_expression(void) {
 
                     push(op == tc_plus ? value1 + value2
                             : value1 - value2);
-                    p_result_type = p_char_type;
+                    p_result_type = p_context->p_char_type;
                 } else {
 
                     // real    +|- real
                     // real    +|- integer
                     // integer +|- real
-                    float value2 = p_operand_type == p_float_type ? top()->basic_types.float__
+                    float value2 = p_operand_type == p_context->p_float_type ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
                     pop();
 
-                    float value1 = p_result_type == p_float_type ? top()->basic_types.float__
+                    float value1 = p_result_type == p_context->p_float_type ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
                     pop();
 
                     push(op == tc_plus ? value1 + value2
                             : value1 - value2);
-                    p_result_type = p_float_type;
+                    p_result_type = p_context->p_float_type;
                 }
 
             }
@@ -297,7 +356,7 @@ cx_executor::execute_simple_expression(void) {
                 pop();
 
                 push(value1 << value2);
-                p_result_type = p_integer_type;
+                p_result_type = p_context->p_integer_type;
             }
                 break;
             case tc_bit_rightshift:
@@ -309,7 +368,7 @@ cx_executor::execute_simple_expression(void) {
                 pop();
 
                 push(value1 >> value2);
-                p_result_type = p_integer_type;
+                p_result_type = p_context->p_integer_type;
             }
                 break;
             case tc_bit_AND:
@@ -321,7 +380,7 @@ cx_executor::execute_simple_expression(void) {
                 pop();
 
                 push(value1 & value2);
-                p_result_type = p_integer_type;
+                p_result_type = p_context->p_integer_type;
             }
                 break;
             case tc_bit_XOR:
@@ -333,7 +392,7 @@ cx_executor::execute_simple_expression(void) {
                 pop();
 
                 push(value1 ^ value2);
-                p_result_type = p_integer_type;
+                p_result_type = p_context->p_integer_type;
             }
                 break;
             case tc_bit_OR:
@@ -345,7 +404,7 @@ cx_executor::execute_simple_expression(void) {
                 pop();
 
                 push(value1 | value2);
-                p_result_type = p_integer_type;
+                p_result_type = p_context->p_integer_type;
             }
                 break;
             case tc_logic_OR:
@@ -357,7 +416,7 @@ cx_executor::execute_simple_expression(void) {
                 pop();
 
                 push(value1 || value2);
-                p_result_type = p_boolean_type;
+                p_result_type = p_context->p_boolean_type;
             }
                 break;
             default:
@@ -394,8 +453,8 @@ cx_executor::execute_term(void) {
 
         switch (op) {
             case tc_star:
-                if ((p_result_type == p_integer_type) &&
-                        (p_operand_type == p_integer_type)) {
+                if ((p_result_type == p_context->p_integer_type) &&
+                        (p_operand_type == p_context->p_integer_type)) {
 
                     // integer * integer
                     int value2 = top()->basic_types.int__;
@@ -404,41 +463,41 @@ cx_executor::execute_term(void) {
                     pop();
 
                     push(value1 * value2);
-                    p_result_type = p_integer_type;
+                    p_result_type = p_context->p_integer_type;
                 } else {
 
                     // real    * real
                     // real    * integer
                     // integer * real
-                    float value2 = p_operand_type == p_float_type
+                    float value2 = p_operand_type == p_context->p_float_type
                             ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
                     pop();
 
-                    float value1 = p_result_type == p_float_type
+                    float value1 = p_result_type == p_context->p_float_type
                             ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
                     pop();
 
                     push(value1 * value2);
-                    p_result_type = p_float_type;
+                    p_result_type = p_context->p_float_type;
                 }
                 break;
             case tc_divide:
             {
 
-                if ((p_result_type == p_integer_type) &&
-                        (p_operand_type == p_integer_type)) {
+                if ((p_result_type == p_context->p_integer_type) &&
+                        (p_operand_type == p_context->p_integer_type)) {
 
-                    int value2 = p_operand_type == p_float_type
+                    int value2 = p_operand_type == p_context->p_float_type
                             ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
                     pop();
 
-                    int value1 = p_result_type == p_float_type
+                    int value1 = p_result_type == p_context->p_float_type
                             ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
@@ -447,16 +506,16 @@ cx_executor::execute_term(void) {
                     if (value2 == 0) cx_runtime_error(rte_division_by_zero);
 
                     push(int(value1 / value2));
-                    p_result_type = p_integer_type;
+                    p_result_type = p_context->p_integer_type;
 
                 } else {
-                    float value2 = p_operand_type == p_float_type
+                    float value2 = p_operand_type == p_context->p_float_type
                             ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
                     pop();
 
-                    float value1 = p_result_type == p_float_type
+                    float value1 = p_result_type == p_context->p_float_type
                             ? top()->basic_types.float__
                             : top()->basic_types.int__;
 
@@ -465,7 +524,7 @@ cx_executor::execute_term(void) {
                     if (value2 == 0.0f) cx_runtime_error(rte_division_by_zero);
 
                     push(float(value1 / value2));
-                    p_result_type = p_float_type;
+                    p_result_type = p_context->p_float_type;
                 }
             }
                 break;
@@ -481,7 +540,7 @@ cx_executor::execute_term(void) {
                 if (value2 == 0) cx_runtime_error(rte_division_by_zero);
 
                 push(value1 % value2);
-                p_result_type = p_integer_type;
+                p_result_type = p_context->p_integer_type;
             }
                 break;
             case tc_logic_AND:
@@ -493,7 +552,7 @@ cx_executor::execute_term(void) {
                 pop();
 
                 push(value1 && value2);
-                p_result_type = p_boolean_type;
+                p_result_type = p_context->p_boolean_type;
             }
                 break;
             default:
@@ -544,13 +603,21 @@ cx_executor::execute_factor(void) {
                         }
                     } else {
 
-                        p_result_type = p_char_type;
+                        p_result_type = p_context->p_char_type;
+                        cx_stream_lock lock(p_context);
+                        cx_type *p_stream_type = stream_type_of(p_node);
+
+                        if ((p_stream_type == p_context->p_stdin->p_type)
+                                && isatty(STDIN_FILENO)
+                                && !cx_stream_pending(p_stream_type)) {
+
+                            // show any prompt before waiting on a key
+                            cx_stream_flush_all();
 
-                        if (p_node == p_stdin) {
                             // getch from rlutil
                             push((char) cx_getch());
                         } else {
-                            push(fgetc(p_node->p_type->stream.p_file_stream));
+                            push(cx_stream_getc(p_stream_type));
                         }
 
                         get_token();
@@ -561,10 +628,14 @@ cx_executor::execute_factor(void) {
         }
             break;
 
+        case tc_SPAWN:
+            p_result_type = execute_spawn();
+            break;
+
         case tc_number:
         {
             // push the number's integer or real value onto the stack.
-            if (p_node->p_type == p_integer_type) {
+            if (p_node->p_type == p_context->p_integer_type) {
                 push(p_node->defn.constant.value.int__);
             } else {
                 push(p_node->defn.constant.value.float__);
@@ -576,18 +647,13 @@ cx_executor::execute_factor(void) {
         case tc_char:
         case tc_string:
         {
-            //get_token();
-            /* push either a character or a string address onto the
-             * runtime stack, depending on the string length. */
-            int length = strlen(p_node->string__()) - 2; // skip quotes
-            if (length <= 1) {
-                // Character
+            /* push either a character or the address of the pooled
+             * string onto the runtime stack. */
+            p_result_type = p_node->p_type;
+            if (p_result_type == p_context->p_char_type) {
                 push(p_node->defn.constant.value.char__);
-                p_result_type = p_char_type;
             } else {
-
                 push(p_node->defn.constant.value.p_string);
-                p_result_type = p_node->p_type;
             }
 
             get_token();
@@ -603,7 +669,7 @@ cx_executor::execute_factor(void) {
             pop();
 
             push(i);
-            p_result_type = p_boolean_type;
+            p_result_type = p_context->p_boolean_type;
         }
             break;
 
@@ -647,13 +713,13 @@ cx_executor::execute_factor(void) {
                 tmp = (char *) p_address;
 
                 if (p_result_type->is_scalar_type()) {
-                    if (p_result_type == p_integer_type) {
+                    if (p_result_type == p_context->p_integer_type) {
                         int value = top()->basic_types.int__;
                         memcpy(&tmp[old_size], &value, p_result_type->size);
-                    } else if (p_result_type == p_float_type) {
+                    } else if (p_result_type == p_context->p_float_type) {
                         float value = top()->basic_types.float__;
                         memcpy(&tmp[old_size], &value, p_result_type->size);
-                    } else if (p_result_type == p_char_type) {
+                    } else if (p_result_type == p_context->p_char_type) {
                         char value = top()->basic_types.char__;
                         memcpy(&tmp[old_size], &value, p_result_type->size);
                     }
@@ -680,7 +746,7 @@ cx_executor::execute_factor(void) {
             init_list->array.max_index = num_of_elements;
             init_list->size = total_size;
             set_type(init_list->array.p_element_type, p_result_type);
-            set_type(init_list->array.p_index_type, p_integer_type);
+            set_type(init_list->array.p_index_type, p_context->p_integer_type);
 
             p_result_type = init_list;
 
@@ -706,8 +772,8 @@ cx_executor::execute_constant(const cx_symtab_node *p_id) {
     cx_type *p_type = p_id->p_type;
     const cx_data_value *value = &p_id->defn.constant.value;
 
-    if (p_type == p_float_type) push(value->float__);
-    else if (p_type == p_char_type) push(value->char__);
+    if (p_type == p_context->p_float_type) push(value->float__);
+    else if (p_type == p_context->p_char_type) push(value->char__);
     else if (p_type->form == fc_array) push(value->p_string);
     else push(value->int__);
 
@@ -734,6 +800,19 @@ cx_executor::execute_variable(const cx_symtab_node *p_id,
 
     // get the variable's runtime stack address.
     cx_stack_item *p_entry_id = run_stack.get_value_address(p_id);
+
+    /* A store into an array or record value needs its own buffer,
+     * which a value parameter may still share with its actual.  An
+     * array reference parm's slot is its actual's. */
+    if (address_flag && ((p_id->defn.how != dc_reference)
+            || cx_slot_reference(p_id)) && !p_type->is_scalar_type()) {
+        void *addr = cx_value_unshare(p_entry_id->basic_types.addr__);
+
+        // the workers of a parallel for store into the same slot
+        if (addr != p_entry_id->basic_types.addr__) {
+            p_entry_id->basic_types.addr__ = addr;
+        }
+    }
     push((p_id->defn.how == dc_reference) || (!p_type->is_scalar_type())
             ? p_entry_id->basic_types.addr__ : p_entry_id);
 
@@ -763,14 +842,18 @@ cx_executor::execute_variable(const cx_symtab_node *p_id,
     // or a record, replace the address at the top of the stack
     // with the data value.
     if ((!address_flag) && (p_type->is_scalar_type())) {
-        if (p_type == p_float_type) {
+        if (p_type == p_context->p_float_type) {
             cx_stack_item *t = (cx_stack_item *) top()->basic_types.addr__;
             pop();
             push(t->basic_types.float__);
-        } else if (p_type == p_char_type) {
+        } else if (p_type == p_context->p_char_type) {
             cx_stack_item *t = (cx_stack_item *) top()->basic_types.addr__;
             pop();
             push(t->basic_types.char__);
+        } else if (p_type == p_context->p_uint64_type) {
+            cx_stack_item *t = (cx_stack_item *) top()->basic_types.addr__;
+            pop();
+            push(t->basic_types.uint64__);
         } else {
             cx_stack_item *t = (cx_stack_item *) top()->basic_types.addr__;
             pop();
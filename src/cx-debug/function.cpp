@@ -5,6 +5,8 @@
  * to declared and standard subroutines.
  */
 
+#include <cstdio>
+#include <cstdlib>
 #include <memory.h>
 #include "common.h"
 #include "cx-debug/exec.h"
@@ -40,31 +42,42 @@ void cx_executor::enter_routine (cx_symtab_node * p_function_id) {
             p_id = p_id->next__) run_stack.allocate_value(p_id);
 
     // Switch to the callee's intermediate code.
-    p_icode = p_function_id->defn.routine.p_icode;
+    p_icode = icode_of(p_function_id->defn.routine.p_icode);
     p_icode->reset();
 
 }
 
-/** exit_routine    	Exit a routine:  Deallocate its local
- *			parameters and variables, pop its frame
+/** exit_routine    	Exit a routine:  pop its frame, along
+ *			with its parameters and local variables,
  *			off the runtime stack, and return to the
  *			caller's intermediate code.
  *
  * @param p_function_id : ptr to routine name's symbol table node
  */
 void cx_executor::exit_routine (cx_symtab_node *p_function_id) {
-    cx_symtab_node *p_id; // ptr to symtab node of local variable or parm
+    cx_symtab_node *p_id; // ptr to parm or local variable's symtab node
 
     trace_routine_exit(p_function_id);
 
-    // Deallocate local parameters and variables.
+    // Release the buffers of array and record values.
     for (p_id = p_function_id->defn.routine.locals.p_parms_ids;
             p_id;
-            p_id = p_id->next__) run_stack.deallocate_value(p_id);
+            p_id = p_id->next__) {
+        if ((p_id->defn.how == dc_value_parm)
+                && ((p_id->p_type->form == fc_array)
+                || (p_id->p_type->form == fc_complex))) {
+            cx_value_release(run_stack.get_value_address(p_id)->basic_types.addr__);
+        }
+    }
 
     for (p_id = p_function_id->defn.routine.locals.p_variable_ids;
             p_id;
-            p_id = p_id->next__) run_stack.deallocate_value(p_id);
+            p_id = p_id->next__) {
+        if ((p_id->p_type->form == fc_array)
+                || (p_id->p_type->form == fc_complex)) {
+            cx_value_release(run_stack.get_value_address(p_id)->basic_types.addr__);
+        }
+    }
 
     // pop off the callee's stack frame and return to the caller's
     // intermediate code.
@@ -79,10 +92,9 @@ void cx_executor::exit_routine (cx_symtab_node *p_function_id) {
  * @return: ptr to the call's type object
  */
 cx_type *cx_executor::execute_subroutine_call (cx_symtab_node *p_function_id) {
-    /*return p_function_id->defn.routine.which == rc_declared
-                ? execute_declared_subroutine_call(p_function_id)
-                : execute_standard_subroutine_call(p_function_id);*/
-    return execute_declared_subroutine_call(p_function_id);
+    return p_function_id->defn.routine.which == rc_declared
+            ? execute_declared_subroutine_call(p_function_id)
+            : execute_standard_subroutine_call(p_function_id);
 }
 
 /** execute_declared_subroutine_call   Execute a call to a declared
@@ -94,127 +106,145 @@ cx_type *cx_executor::execute_subroutine_call (cx_symtab_node *p_function_id) {
  */
 cx_type *cx_executor::execute_declared_subroutine_call
 (cx_symtab_node *p_function_id) {
-    int old_level = current_nesting_level; // level of caller
+    int old_level = nesting_level; // level of caller
     int new_level = p_function_id->level + 1; // level of callee's locals
 
     // Set up a new stack frame for the callee.
     cx_frame_header *p_new_frame_base = run_stack.push_frame_header
             (old_level, new_level, p_icode);
 
-    // push actual parameter values onto the stack.
+    // push actual parameter values into the callee's parm slots.
     get_token();
 
-    if (token == tc_left_paren) {
-        execute_actual_parameters(p_function_id);
-    }
-
-    //  )
-    get_token();
+    if (token == tc_left_paren) execute_actual_parameters();
 
     // Activate the new stack frame ...
-    current_nesting_level = new_level;
+    nesting_level = new_level;
     run_stack.activate_frame(p_new_frame_base, current_location() - 1);
 
     // ... and execute the callee.
     execute_routine(p_function_id);
 
     // Return to the caller.  Restore the current token.
-    current_nesting_level = old_level;
+    nesting_level = old_level;
     get_token();
 
     return p_function_id->p_type;
 }
 
-/** execute_actual_parameters	Execute the actual parameters of
- *				a declared subroutine call.
+/** call               Call a declared function for a host program,
+ *                      with the program's globals set up by start.
  *
- * @param p_function_id : ptr to the subroutine name's symtab node
+ * @param p_function_id : ptr to the function's symtab node
+ * @param p_args        : the actuals, one per formal.  The buffers of
+ *                        array values go to the callee's frame.
+ *
+ * @return: the function's value
  */
-void cx_executor::execute_actual_parameters (cx_symtab_node *p_function_id) {
-    cx_symtab_node *p_formal_id; // ptr to formal parm's symtab node
+mem_block cx_executor::call(cx_symtab_node *p_function_id,
+        const mem_block *p_args) {
+    cx_context_scope scope(p_context);
+    cx_run_slot slot(this);
+    int old_level = nesting_level; // level of caller
+    int new_level = p_function_id->level + 1; // level of callee's locals
 
-    // Loop to execute each actual parameter.
-    for (p_formal_id = p_function_id->defn.routine.locals.p_parms_ids;
-            p_formal_id;
-            p_formal_id = p_formal_id->next__) {
+    // Set up a new stack frame for the callee.
+    cx_frame_header *p_new_frame_base = run_stack.push_frame_header
+            (old_level, new_level, p_icode);
 
-        cx_type *p_formal_type = p_formal_id->p_type;
-        get_token();
+    // push the actuals into the callee's parm slots.
+    const cx_symtab_node *p_parm_id =
+            p_function_id->defn.routine.locals.p_parms_ids;
 
-        /* Reference parameter: execute_variable will leave the actual
-         * parameter's address on top of the stack. */
-        if (p_formal_id->defn.how == dc_reference) {
+    for (int i = 0; p_parm_id != nullptr; p_parm_id = p_parm_id->next__) {
+        push_value(p_parm_id->p_type, p_args[i++]);
+    }
 
-            const int size = p_node->p_type->size;
-            p_formal_type->form = p_node->p_type->form;
-            execute_variable(p_node, true);
+    // Activate the new stack frame, and execute the callee.
+    nesting_level = new_level;
+    run_stack.activate_frame(p_new_frame_base, current_location());
 
-            if (p_formal_type->form == fc_array) {
+    break_loop = false;
+    execute_routine(p_function_id);
 
-                p_formal_type->size = size;
-                p_formal_type->array.element_count = size;
-                p_formal_type->array.max_index = size;
+    nesting_level = old_level;
 
-                p_formal_id->runstack_item = top();
+    const mem_block result = top()->basic_types;
+    pop();
 
-            } else {
-                p_formal_id->runstack_item = top();
-            }
+    return result;
+}
 
-            get_token();
-        }// value parameter
-        else {
-            cx_type *p_actual_type = execute_expression();
+/** execute_actual_parameters	Execute the actual parameters of
+ *				a declared subroutine call.  Each value
+ *				is left on the runtime stack, where it
+ *				becomes its formal parameter's slot in
+ *				the callee's frame.  How each actual is
+ *				bound was resolved by the parser.
+ *
+ *      ( <call-marker> <actual>, ... )
+ */
+void cx_executor::execute_actual_parameters (void) {
 
-            if ((p_formal_type == p_float_type) &&
-                    (p_actual_type->base_type() == p_integer_type)) {
+    // call marker
+    get_token();
+    const cx_call_site &site = p_context->call_sites[get_call_marker()];
+    const int parm_count = site.parms.size();
+    const cx_symtab_node *p_formal_id =
+            site.p_function_id->defn.routine.locals.p_parms_ids;
 
-                // real formal := integer actual:
-                // convert integer value to real.
-                float ff = top()->basic_types.int__;
-                pop();
+    get_token(); // first actual or )
 
-                push(ff);
-                p_formal_id->runstack_item = top();
-            } else if (!p_formal_type->is_scalar_type()) {
+    for (int i = 0; i < parm_count; ++i) {
+        const cx_actual_parm &parm = site.parms[i];
 
-                /* Formal parameter is an array or a record:
-                 * Make a copy of the actual parameter's value. */
+        if (i > 0) {
+            get_token(); // ,
+            if (p_formal_id != nullptr) p_formal_id = p_formal_id->next__;
+        }
 
-                const int size = p_actual_type->size;
-                void *p_target_address = nullptr;
-                const int num_of_elements = size / p_actual_type->base_type()->size;
+        /* Reference parameter: execute_variable will leave the actual
+         * parameter's address on top of the stack. */
+        if (parm.reference) {
+            const cx_symtab_node *p_actual_id = p_node;
+            get_token();
 
-                p_target_address = realloc(p_target_address, size);
-                //memset(p_target_address, 0, size);
+            /* streams are bound through their type object, and
+             * arrays through their slot, see get_value_address */
+            if (p_actual_id->p_type->form == fc_stream) {
+                push((void *) stream_type_of(p_actual_id));
+            } else if ((p_formal_id != nullptr) && cx_slot_reference(p_formal_id)) {
+                push((void *) run_stack.get_value_address(p_actual_id));
+            } else execute_variable(p_actual_id, true);
+        }// value parameter
+        else {
+            cx_type *p_actual_type = execute_expression();
+            mem_block *p_value = &top()->basic_types;
 
-                if (p_target_address == nullptr) {
-                    perror("realloc");
-                    exit(0);
-                }
+            if (parm.int_to_float) {
 
-                void *p_source = top()->basic_types.addr__;
-                memcpy(p_target_address, p_source, size);
+                // float formal := integer actual
+                p_value->float__ = (float) p_value->int__;
+            } else if (parm.share_value) {
 
-                pop();
-                push(p_target_address);
+                /* Formal parameter is an array or a record, and the
+                 * actual is a local:  Share its buffer.  Whichever
+                 * side stores into it first makes its own copy. */
+                p_value->addr__ = cx_value_share(p_value->addr__);
+            } else if (parm.copy_value) {
 
-                p_formal_type->array.element_count = num_of_elements;
-                p_formal_type->array.max_index = num_of_elements;
-                p_formal_type->size = size;
-                p_formal_type->form = fc_array;
-                p_formal_id->runstack_item = top();
-            } else {
+                /* Formal parameter is an array or a record:
+                 * Make a copy of the actual parameter's value. */
+                const int size = cx_value_size(p_actual_type, p_value->addr__);
+                void *p_copy = cx_value_alloc(size);
 
-                // Range check an integer or enumeration
-                // formal parameter.
-                range_check(p_formal_type, top()->basic_types.int__);
-                p_formal_id->runstack_item = top();
+                memcpy(p_copy, p_value->addr__, size);
+                p_value->addr__ = p_copy;
             }
         }
     }
 
-    if (token == tc_left_paren) get_token();
+    get_token(); // token after )
 }
 
 /** execute_RETURN	Assign a return value to the functions StackItem and
@@ -1,68 +1,1162 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
 #include "exec.h"
 #include "common.h"
+#include "format.h"
+#include "scheduler.h"
 #include "types.h"
 
-void cx_executor::file_out(const cx_symtab_node* p_target_id,
-        const cx_type* p_expr_type) {
+/** cx_out_buffer        Pending output of a stream.  Values are
+ *                      formatted straight into the buffer, which is
+ *                      written out when full, at a newline when the
+ *                      stream is a terminal, and at exit.  Output to
+ *                      a socket is also sent whenever the program
+ *                      waits on its sockets.
+ */
+struct cx_out_buffer {
+    static const int capacity = 64 * 1024;
 
-    cx_type_code expr_type = p_expr_type->type_code;
+    FILE *p_file_stream;
+    int fd;
+    bool line_flush; // flush at each newline (terminals)
+    bool unbuffered; // flush after each value (stderr)
+    bool nonblocking; // a socket; written with write(2), see net.cpp
+    bool unsent; // on the list of socket buffers to send
+    int length; // bytes pending
+    cx_out_buffer *p_next; // next buffer to flush at exit
+    cx_out_buffer *p_prev;
+    char data[capacity];
+};
 
-    mem_block *mem = &top()->basic_types;
+/* Each context keeps a list of every buffer it made, so they can be
+ * flushed at exit, and of the socket buffers holding output that
+ * hasn't been sent yet. */
 
-    switch (expr_type) {
-        case cx_int:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%i",
-                    mem->int__);
-        }
+/** send_bytes           Write bytes to a non-blocking file descriptor
+ *                      until it would block.  Bytes that can't be
+ *                      sent at all, as to a closed connection, are
+ *                      dropped.
+ *
+ * @param fd     : the file descriptor.
+ * @param p_data : ptr to the bytes.
+ * @param size   : number of bytes.
+ * @return number of bytes sent or dropped.
+ */
+static int send_bytes(int fd, const char *p_data, int size) {
+    int sent = 0;
+
+    while (sent < size) {
+        const ssize_t count = write(fd, p_data + sent, size - sent);
+
+        if (count >= 0) {
+            sent += (int) count;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
             break;
-        case cx_char:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%c",
-                    mem->char__);
+        } else if (errno != EINTR) {
+            return size;
         }
-            break;
-        case cx_wchar:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%c",
-                    mem->wchar__);
+    }
+
+    return sent;
+}
+
+/** wait_writable        Wait until a file descriptor takes output.
+ *
+ * @param fd : the file descriptor.
+ */
+static void wait_writable(int fd) {
+    pollfd p = {fd, POLLOUT, 0};
+    cx_slot_pause pause;
+
+    while ((poll(&p, 1, -1) < 0) && (errno == EINTR));
+}
+
+/** send_pending         Send as much of a socket buffer's pending
+ *                      output as the socket takes right now.
+ *
+ * @param p_buffer : ptr to the buffer.
+ * @return true if nothing is left pending.
+ */
+static bool send_pending(cx_out_buffer *p_buffer) {
+    const int sent = send_bytes(p_buffer->fd, p_buffer->data, p_buffer->length);
+
+    p_buffer->length -= sent;
+    memmove(p_buffer->data, &p_buffer->data[sent], p_buffer->length);
+
+    return p_buffer->length == 0;
+}
+
+/** write_buffer         Write out a buffer's pending output.
+ *
+ * @param p_buffer : ptr to the buffer.
+ */
+static void write_buffer(cx_out_buffer *p_buffer) {
+    if (p_buffer->length == 0) return;
+
+    if (p_buffer->nonblocking) {
+        while (!send_pending(p_buffer)) wait_writable(p_buffer->fd);
+        return;
+    }
+
+    fwrite(p_buffer->data, 1, p_buffer->length, p_buffer->p_file_stream);
+    fflush(p_buffer->p_file_stream);
+    p_buffer->length = 0;
+}
+
+/** cx_stream_flush_all  Write out the pending output of every stream
+ *                      of the current context.  Runs at exit, and
+ *                      before any input is read so prompts show up
+ *                      first.
+ */
+void cx_stream_flush_all(void) {
+    const cx_context *p_context = cx_context::current();
+    if (p_context == nullptr) return;
+
+    for (cx_out_buffer *p_buffer = p_context->p_out_buffers;
+            p_buffer != nullptr; p_buffer = p_buffer->p_next) {
+        write_buffer(p_buffer);
+    }
+}
+
+/** cx_stream_release_all        Write out and free every buffer of a
+ *                              context's streams, as the context is
+ *                              torn down.
+ *
+ * @param p_context : ptr to the context.
+ */
+void cx_stream_release_all(cx_context *p_context) {
+    while (p_context->p_out_buffers != nullptr) {
+        cx_out_buffer *p_buffer = p_context->p_out_buffers;
+
+        p_context->p_out_buffers = p_buffer->p_next;
+        write_buffer(p_buffer);
+        delete p_buffer;
+    }
+
+    p_context->unsent_buffers.clear();
+}
+
+/** cx_stream_send_pending       Send the pending output of every
+ *                              socket without waiting on any.
+ *
+ * @param blocked_fds : gets the sockets that still have output
+ *                      pending, to wait until they're writable.
+ */
+void cx_stream_send_pending(std::vector<int> &blocked_fds) {
+    std::vector<cx_out_buffer *> &unsent_buffers =
+            cx_context::current()->unsent_buffers;
+    size_t kept = 0;
+
+    for (cx_out_buffer *p_buffer : unsent_buffers) {
+        if (send_pending(p_buffer)) {
+            p_buffer->unsent = false;
+            continue;
         }
-            break;
-        case cx_float:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%f",
-                    mem->float__);
+
+        blocked_fds.push_back(p_buffer->fd);
+        unsent_buffers[kept++] = p_buffer;
+    }
+
+    unsent_buffers.resize(kept);
+}
+
+/** out_buffer_of        The output buffer of a stream, made on
+ *                      first use.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return ptr to the buffer.
+ */
+static cx_out_buffer *out_buffer_of(cx_type *p_stream_type) {
+    cx_out_buffer *p_buffer = p_stream_type->stream.p_out_buffer;
+    if (p_buffer != nullptr) return p_buffer;
+
+    if (p_stream_type->stream.p_file_stream == nullptr) {
+        cx_runtime_error(rte_stream_not_open);
+    }
+
+    static const bool flush_at_exit = (atexit(cx_stream_flush_all) == 0);
+    (void) flush_at_exit;
+
+    cx_context *p_context = cx_context::current();
+    FILE *p_file = p_stream_type->stream.p_file_stream;
+
+    p_buffer = new cx_out_buffer;
+    p_buffer->p_file_stream = p_file;
+    p_buffer->fd = fileno(p_file);
+    p_buffer->line_flush = isatty(p_buffer->fd) != 0;
+    p_buffer->unbuffered = (p_file == stderr);
+    p_buffer->nonblocking = (fcntl(p_buffer->fd, F_GETFL) & O_NONBLOCK) != 0;
+    p_buffer->unsent = false;
+    p_buffer->length = 0;
+    p_buffer->p_next = p_context->p_out_buffers;
+    p_buffer->p_prev = nullptr;
+    if (p_buffer->p_next != nullptr) p_buffer->p_next->p_prev = p_buffer;
+    p_context->p_out_buffers = p_buffer;
+
+    p_stream_type->stream.p_out_buffer = p_buffer;
+
+    return p_buffer;
+}
+
+/** put_bytes            Append bytes to a stream's buffer.  Output
+ *                      larger than the buffer bypasses it.
+ *
+ * @param p_buffer : ptr to the buffer.
+ * @param p_data   : ptr to the bytes.
+ * @param size     : number of bytes.
+ */
+static void put_bytes(cx_out_buffer *p_buffer, const char *p_data, int size) {
+    if (p_buffer->length + size > cx_out_buffer::capacity) {
+        write_buffer(p_buffer);
+
+        if (size > cx_out_buffer::capacity) {
+            if (!p_buffer->nonblocking) {
+                fwrite(p_data, 1, size, p_buffer->p_file_stream);
+                return;
+            }
+
+            for (;;) {
+                const int sent = send_bytes(p_buffer->fd, p_data, size);
+
+                p_data += sent;
+                size -= sent;
+                if (size == 0) return;
+
+                wait_writable(p_buffer->fd);
+            }
         }
-            break;
-        case cx_uint8:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%u",
-                    mem->uint8__);
+    }
+
+    if (p_buffer->nonblocking && !p_buffer->unsent) {
+        p_buffer->unsent = true;
+        cx_context::current()->unsent_buffers.push_back(p_buffer);
+    }
+
+    memcpy(&p_buffer->data[p_buffer->length], p_data, size);
+    p_buffer->length += size;
+}
+
+/** format_unsigned      Format an unsigned integer in decimal.
+ *
+ * @param p_end : ptr just past the end of the digits to write.
+ * @param value : value to format.
+ * @return ptr to the first digit.
+ */
+static char *format_unsigned(char *p_end, uint64_t value) {
+    char *p = p_end;
+
+    do {
+        *--p = (char) ('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    return p;
+}
+
+/** format_signed        Format a signed integer in decimal.
+ *
+ * @param p_end : ptr just past the end of the digits to write.
+ * @param value : value to format.
+ * @return ptr to the first char.
+ */
+static char *format_signed(char *p_end, int64_t value) {
+    if (value >= 0) return format_unsigned(p_end, (uint64_t) value);
+
+    char *p = format_unsigned(p_end, 0 - (uint64_t) value);
+    *--p = '-';
+
+    return p;
+}
+
+/** format_float         Format a float as "%f" does, with six
+ *                      decimals.  Values too large to scale fall
+ *                      back to snprintf.
+ *
+ * @param p_text : ptr to room for the text.
+ * @param size   : size of that room.
+ * @param value  : value to format.
+ * @return length of the text.
+ */
+static int format_float(char *p_text, int size, float value) {
+    const double number = value;
+
+    if (!std::isfinite(number) || (std::fabs(number) >= 1e12)) {
+        return snprintf(p_text, size, "%f", number);
+    }
+
+    const uint64_t scaled = (uint64_t) llround(std::fabs(number) * 1e6);
+    char digits[32];
+    char *p_end = &digits[sizeof (digits)];
+
+    // fraction, padded to six places
+    char *p = format_unsigned(p_end, scaled % 1000000);
+    while (p_end - p < 6) *--p = '0';
+    *--p = '.';
+    p = format_unsigned(p, scaled / 1000000);
+    if (std::signbit(number)) *--p = '-';
+
+    const int length = (int) (p_end - p);
+    memcpy(p_text, p, length);
+
+    return length;
+}
+
+/** cx_in_buffer         Input read ahead from a stream.  Reads take
+ *                      whatever the file has ready, up to the
+ *                      buffer's capacity, so lines and numbers are
+ *                      scanned straight out of the buffer.
+ */
+struct cx_in_buffer {
+    static const int capacity = 64 * 1024;
+
+    int fd;
+    int start; // next byte to scan
+    int end; // end of the bytes read
+    bool eof;
+    bool nonblocking; // a socket; reads take only what has arrived
+    char data[capacity + 1]; // '\0' after the last byte read
+};
+
+/** in_buffer_of         The input buffer of a stream, made on
+ *                      first use.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return ptr to the buffer.
+ */
+static cx_in_buffer *in_buffer_of(cx_type *p_stream_type) {
+    cx_in_buffer *p_buffer = p_stream_type->stream.p_in_buffer;
+    if (p_buffer != nullptr) return p_buffer;
+
+    if (p_stream_type->stream.p_file_stream == nullptr) {
+        cx_runtime_error(rte_stream_not_open);
+    }
+
+    p_buffer = new cx_in_buffer;
+    p_buffer->fd = fileno(p_stream_type->stream.p_file_stream);
+    p_buffer->start = p_buffer->end = 0;
+    p_buffer->eof = false;
+    p_buffer->nonblocking = (fcntl(p_buffer->fd, F_GETFL) & O_NONBLOCK) != 0;
+    p_buffer->data[0] = '\0';
+
+    p_stream_type->stream.p_in_buffer = p_buffer;
+
+    return p_buffer;
+}
+
+/** fill_buffer          Read more input, keeping the bytes not yet
+ *                      scanned.
+ *
+ * @param p_buffer : ptr to the buffer.
+ * @return true if any bytes were read.
+ */
+static bool fill_buffer(cx_in_buffer *p_buffer) {
+    if (p_buffer->eof) return false;
+
+    /* Show any prompt before waiting on input.  Reads from a socket
+     * don't wait, and its output is sent by the event loop. */
+    if (!p_buffer->nonblocking) {
+        for (cx_out_buffer *p_out = cx_context::current()->p_out_buffers;
+                p_out != nullptr; p_out = p_out->p_next) {
+            if (!p_out->nonblocking) write_buffer(p_out);
         }
+    }
+
+    const int pending = p_buffer->end - p_buffer->start;
+    if (p_buffer->start > 0) {
+        memmove(p_buffer->data, &p_buffer->data[p_buffer->start], pending);
+        p_buffer->start = 0;
+        p_buffer->end = pending;
+    }
+
+    if (pending == cx_in_buffer::capacity) return false;
+
+    ssize_t count;
+    do {
+        count = read(p_buffer->fd, &p_buffer->data[pending],
+                cx_in_buffer::capacity - pending);
+    } while ((count < 0) && (errno == EINTR));
+
+    // nothing has arrived on a socket yet
+    if ((count < 0) && p_buffer->nonblocking
+            && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) return false;
+
+    if (count <= 0) {
+        p_buffer->eof = true;
+        return false;
+    }
+
+    p_buffer->end += count;
+    p_buffer->data[p_buffer->end] = '\0';
+
+    return true;
+}
+
+/** cx_stream_pending    Is any input read ahead but not yet scanned?
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return true if so.
+ */
+bool cx_stream_pending(const cx_type *p_stream_type) {
+    const cx_in_buffer *p_buffer = p_stream_type->stream.p_in_buffer;
+
+    return (p_buffer != nullptr) && (p_buffer->start < p_buffer->end);
+}
+
+/** line_arrived         Has a socket's next line arrived, or its
+ *                      last one before the connection closed?
+ *                      A line that fills the buffer counts.
+ *
+ * @param p_buffer : ptr to the socket's buffer.
+ * @return true if so.
+ */
+static bool line_arrived(cx_in_buffer *p_buffer) {
+    int scanned = p_buffer->start;
+
+    for (;;) {
+        if (memchr(&p_buffer->data[scanned], '\n',
+                p_buffer->end - scanned) != nullptr) return true;
+
+        const int pending = p_buffer->end - p_buffer->start;
+        if (pending == cx_in_buffer::capacity) return true;
+
+        // fill_buffer moves the pending bytes to the front
+        scanned = pending;
+        if (!fill_buffer(p_buffer)) return p_buffer->eof && (pending > 0);
+    }
+}
+
+/** cx_stream_eof        Has a stream's input run out?
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return true if so.
+ */
+bool cx_stream_eof(const cx_type *p_stream_type) {
+    const cx_in_buffer *p_buffer = p_stream_type->stream.p_in_buffer;
+
+    return (p_buffer != nullptr) && p_buffer->eof
+            && (p_buffer->start == p_buffer->end);
+}
+
+/** cx_stream_getc       Read a char from a stream.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return the char, or EOF.
+ */
+int cx_stream_getc(cx_type *p_stream_type) {
+    cx_in_buffer *p_buffer = in_buffer_of(p_stream_type);
+
+    if ((p_buffer->start == p_buffer->end) && !fill_buffer(p_buffer)) {
+        return EOF;
+    }
+
+    return (unsigned char) p_buffer->data[p_buffer->start++];
+}
+
+/** cx_stream_getline    Read a line from a stream into an array of
+ *                      unknown size, without its newline.
+ *
+ *                      A socket gives up only whole lines, and -1
+ *                      until one has arrived.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @param addr          : ptr to the array's data; may move.
+ * @return length of the line, or -1 at the end of the stream.
+ */
+int cx_stream_getline(cx_type *p_stream_type, void *&addr) {
+    cx_in_buffer *p_buffer = in_buffer_of(p_stream_type);
+    int length = 0;
+
+    if ((p_buffer->nonblocking && !line_arrived(p_buffer))
+            || ((p_buffer->start == p_buffer->end) && !fill_buffer(p_buffer))) {
+        addr = cx_value_resize(addr, 0);
+        return -1;
+    }
+
+    for (;;) {
+        const char *p_start = &p_buffer->data[p_buffer->start];
+        const int available = p_buffer->end - p_buffer->start;
+        const char *p_newline = (const char *) memchr(p_start, '\n', available);
+        const int count = (p_newline != nullptr)
+                ? (int) (p_newline - p_start) : available;
+
+        addr = cx_value_resize(addr, length + count);
+        memcpy((char *) addr + length, p_start, count);
+        length += count;
+
+        p_buffer->start += count;
+        if (p_newline != nullptr) {
+            ++p_buffer->start;
             break;
-        case cx_uint16:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%u",
-                    mem->uint16__);
         }
-            break;
-        case cx_uint32:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%u",
-                    mem->uint32__);
+
+        if (!fill_buffer(p_buffer)) break;
+    }
+
+    return length;
+}
+
+/** scan_number          Skip white space and make sure a whole
+ *                      word is in the buffer to be scanned as a
+ *                      number.
+ *
+ * @param p_buffer : ptr to the buffer.
+ * @return ptr to the word's first char, or nullptr at the end
+ *         of the stream.
+ */
+static const char *scan_number(cx_in_buffer *p_buffer) {
+    for (;;) {
+        while ((p_buffer->start < p_buffer->end)
+                && isspace((unsigned char) p_buffer->data[p_buffer->start])) {
+            ++p_buffer->start;
         }
-            break;
-        case cx_uint64:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%lu",
-                    mem->uint64__);
+
+        if (p_buffer->start < p_buffer->end) break;
+        if (!fill_buffer(p_buffer)) return nullptr;
+    }
+
+    // a word that runs to the end of the input read may go on
+    for (;;) {
+        int i = p_buffer->start;
+        while ((i < p_buffer->end)
+                && !isspace((unsigned char) p_buffer->data[i])) ++i;
+
+        if ((i < p_buffer->end) || !fill_buffer(p_buffer)) break;
+    }
+
+    return &p_buffer->data[p_buffer->start];
+}
+
+/** cx_stream_scan_int   Read a decimal integer from a stream.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return the integer, or 0 if there is none.
+ */
+int cx_stream_scan_int(cx_type *p_stream_type) {
+    cx_in_buffer *p_buffer = in_buffer_of(p_stream_type);
+    const char *p_text = scan_number(p_buffer);
+    if (p_text == nullptr) return 0;
+
+    char *p_end;
+    const long value = strtol(p_text, &p_end, 10);
+    p_buffer->start += (int) (p_end - p_text);
+
+    return (int) value;
+}
+
+/** cx_stream_scan_float Read a float from a stream.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return the float, or 0 if there is none.
+ */
+float cx_stream_scan_float(cx_type *p_stream_type) {
+    cx_in_buffer *p_buffer = in_buffer_of(p_stream_type);
+    const char *p_text = scan_number(p_buffer);
+    if (p_text == nullptr) return 0;
+
+    char *p_end;
+    const float value = strtof(p_text, &p_end);
+    p_buffer->start += (int) (p_end - p_text);
+
+    return value;
+}
+
+/** read_fully           Read straight into memory until it's full,
+ *                      skipping the stream's buffer.
+ *
+ * @param fd     : file descriptor to read.
+ * @param p_data : ptr to the memory.
+ * @param size   : number of bytes to read.
+ * @param offset : file offset to read from, or -1 to read from
+ *                 the file's current position.
+ * @return number of bytes read; fewer than size at the end of
+ *         the file, or -1 on an error.
+ */
+static int read_fully(int fd, char *p_data, int size, int64_t offset) {
+    int total = 0;
+
+    while (total < size) {
+        const ssize_t count = (offset < 0)
+                ? read(fd, p_data + total, size - total)
+                : pread(fd, p_data + total, size - total, offset + total);
+
+        if (count == 0) break;
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return (total > 0) ? total : -1;
         }
-            break;
-        default:
-        {
-            fprintf(p_target_id->p_type->stream.p_file_stream, "%s",
-                    (char*) mem->addr__);
+
+        total += (int) count;
+    }
+
+    return total;
+}
+
+/** cx_stream_read       Read the bytes of a value from a stream.
+ *                      Bytes read ahead come first; the rest of a
+ *                      large value is read into it directly.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @param p_data        : ptr to the value's bytes.
+ * @param size          : number of bytes to read.
+ * @return number of bytes read; fewer than size at the end of
+ *         the stream.
+ */
+int cx_stream_read(cx_type *p_stream_type, void *p_data, int size) {
+    cx_in_buffer *p_buffer = in_buffer_of(p_stream_type);
+    char *p_target = (char *) p_data;
+    int total = 0;
+
+    while (total < size) {
+        const int pending = std::min(p_buffer->end - p_buffer->start,
+                size - total);
+
+        if (pending > 0) {
+            memcpy(p_target + total, &p_buffer->data[p_buffer->start], pending);
+            p_buffer->start += pending;
+            total += pending;
+        } else if (size - total >= cx_in_buffer::capacity) {
+            if (p_buffer->eof) break;
+
+            cx_stream_flush_all();
+
+            const int count = read_fully(p_buffer->fd, p_target + total,
+                    size - total, -1);
+
+            if (count > 0) total += count;
+            if (total < size) p_buffer->eof = true;
+        } else if (!fill_buffer(p_buffer)) break;
+    }
+
+    return total;
+}
+
+/** cx_stream_write      Write the bytes of a value to a stream.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @param p_data        : ptr to the value's bytes.
+ * @param size          : number of bytes to write.
+ * @return number of bytes written.
+ */
+int cx_stream_write(cx_type *p_stream_type, const void *p_data, int size) {
+    cx_out_buffer *p_buffer = out_buffer_of(p_stream_type);
+
+    put_bytes(p_buffer, (const char *) p_data, size);
+    if (p_buffer->unbuffered) write_buffer(p_buffer);
+
+    return size;
+}
+
+/** put_padding          Append spaces to a stream's buffer.
+ *
+ * @param p_buffer : ptr to the buffer.
+ * @param count    : number of spaces.
+ */
+static void put_padding(cx_out_buffer *p_buffer, int count) {
+    static const char spaces[] = "                                ";
+
+    while (count > 0) {
+        const int length = std::min(count, (int) sizeof (spaces) - 1);
+
+        put_bytes(p_buffer, spaces, length);
+        count -= length;
+    }
+}
+
+/** integer_argument     The value of a numeric format argument as
+ *                      an integer.
+ *
+ * @param arg : the argument.
+ * @return the value; unsigned types keep their bits.
+ */
+static int64_t integer_argument(const cx_format_arg &arg) {
+    switch (arg.p_type->base_type()->type_code) {
+        case cx_char: return arg.value.char__;
+        case cx_wchar: return arg.value.wchar__;
+        case cx_bool: return arg.value.bool__;
+        case cx_float: return (int64_t) arg.value.float__;
+        case cx_uint8: return arg.value.uint8__;
+        case cx_uint16: return arg.value.uint16__;
+        case cx_uint32: return arg.value.uint32__;
+        case cx_uint64: return (int64_t) arg.value.uint64__;
+        default: return arg.value.int__;
+    }
+}
+
+/** unsigned_argument    The value of a numeric format argument as
+ *                      an unsigned integer of the argument's own
+ *                      width, as C's unsigned conversions take it.
+ *
+ * @param arg : the argument.
+ * @return the value, zero extended.
+ */
+static uint64_t unsigned_argument(const cx_format_arg &arg) {
+    switch (arg.p_type->base_type()->type_code) {
+        case cx_char: return (uint8_t) arg.value.char__;
+        case cx_wchar: return (uint32_t) arg.value.wchar__;
+        case cx_bool: return arg.value.bool__;
+        case cx_float: return (uint64_t) integer_argument(arg);
+        case cx_uint8: return arg.value.uint8__;
+        case cx_uint16: return arg.value.uint16__;
+        case cx_uint32: return arg.value.uint32__;
+        case cx_uint64: return arg.value.uint64__;
+        default: return (uint32_t) arg.value.int__;
+    }
+}
+
+/** wide_argument        Whether an unsigned conversion takes a
+ *                      numeric format argument as 64 bits.
+ *
+ * @param arg : the argument.
+ * @return true for uint64 and float.
+ */
+static bool wide_argument(const cx_format_arg &arg) {
+    const cx_type_code code = arg.p_type->base_type()->type_code;
+
+    return (code == cx_uint64) || (code == cx_float);
+}
+
+/** format_argument      Format a number the way a conversion with
+ *                      flags, a width or a precision asks.
+ *
+ * @param piece  : the conversion.
+ * @param arg    : the argument.
+ * @param p_text : ptr to room for the text.
+ * @param size   : size of that room.
+ * @return length of the whole text, which may not have fit.
+ */
+static int format_argument(const cx_format_piece &piece,
+        const cx_format_arg &arg, char *p_text, int size) {
+    int length;
+
+    if (strchr("di", piece.conversion) != nullptr) {
+        length = snprintf(p_text, size, piece.wide_text.c_str(),
+                (long long) integer_argument(arg));
+    } else if (strchr("uxXo", piece.conversion) != nullptr) {
+        length = wide_argument(arg)
+                ? snprintf(p_text, size, piece.wide_text.c_str(),
+                (unsigned long long) unsigned_argument(arg))
+                : snprintf(p_text, size, piece.text.c_str(),
+                (unsigned) unsigned_argument(arg));
+    } else {
+        const double value = (arg.p_type->base_type()
+                == cx_context::current()->p_float_type)
+                ? arg.value.float__ : (double) integer_argument(arg);
+
+        length = snprintf(p_text, size, piece.text.c_str(), value);
+    }
+
+    return std::max(length, 0);
+}
+
+/** cx_stream_format     Write arguments to a stream as a compiled
+ *                      format says, straight into its buffer.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @param format        : the format.
+ * @param p_args        : ptr to one argument per conversion.
+ * @return number of bytes written.
+ */
+int cx_stream_format(cx_type *p_stream_type, const cx_format &format,
+        const cx_format_arg *p_args) {
+    cx_out_buffer *p_buffer = out_buffer_of(p_stream_type);
+    bool newline = false;
+    int total = 0;
+
+    for (const cx_format_piece &piece : format.pieces) {
+        char text[128];
+        char *p_end = &text[sizeof (text)];
+        const char *p_text = text;
+        std::string wide_text; // numbers too wide for text
+        int length;
+
+        if (piece.conversion == '\0') {
+            p_text = piece.text.data();
+            length = (int) piece.text.size();
+        } else if ((piece.conversion == 'c') || (piece.conversion == 's')) {
+            const cx_format_arg &arg = *p_args++;
+
+            if (arg.p_type->is_scalar_type()) {
+                text[0] = (char) integer_argument(arg);
+                length = 1;
+            } else {
+                p_text = (const char *) arg.value.addr__;
+                length = cx_value_size(arg.p_type, p_text);
+
+                // a char array of fixed size ends at its first '\0'
+                if ((arg.p_type->size > 0) && !arg.p_type->is_constant()) {
+                    length = (int) strnlen(p_text, length);
+                }
+            }
+
+            if (piece.precision >= 0) length = std::min(length, piece.precision);
+
+            const int padding = std::max(piece.width - length, 0);
+
+            if (!piece.left) put_padding(p_buffer, padding);
+            put_bytes(p_buffer, p_text, length);
+            if (piece.left) put_padding(p_buffer, padding);
+
+            newline = newline || (memchr(p_text, '\n', length) != nullptr);
+            total += length + padding;
+            continue;
+        } else if (piece.plain && (piece.conversion == 'd' || piece.conversion == 'i')) {
+            p_text = format_signed(p_end, integer_argument(*p_args++));
+            length = (int) (p_end - p_text);
+        } else if (piece.plain && (piece.conversion == 'u')) {
+            p_text = format_unsigned(p_end, unsigned_argument(*p_args++));
+            length = (int) (p_end - p_text);
+        } else if (piece.plain && (piece.conversion == 'f')
+                && (p_args->p_type->base_type()
+                == cx_context::current()->p_float_type)) {
+            length = format_float(text, sizeof (text), (p_args++)->value.float__);
+        } else {
+            const cx_format_arg &arg = *p_args++;
+
+            length = format_argument(piece, arg, text, sizeof (text));
+            if (length >= (int) sizeof (text)) {
+                wide_text.resize(length + 1);
+                format_argument(piece, arg, &wide_text[0], length + 1);
+                p_text = wide_text.data();
+            }
         }
-            break;
+
+        put_bytes(p_buffer, p_text, length);
+        newline = newline || (memchr(p_text, '\n', length) != nullptr);
+        total += length;
+    }
+
+    if (p_buffer->unbuffered || (p_buffer->line_flush && newline)) {
+        write_buffer(p_buffer);
+    }
+
+    return total;
+}
+
+/** cx_stream_pread      Read the bytes of a value from a file offset,
+ *                      leaving the stream's position alone.  Output
+ *                      still pending on the stream is written first.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @param p_data        : ptr to the value's bytes.
+ * @param size          : number of bytes to read.
+ * @param offset        : file offset of the first byte.
+ * @return number of bytes read; fewer than size past the end of
+ *         the file, or -1 if the stream can't be read that way.
+ */
+int cx_stream_pread(cx_type *p_stream_type, void *p_data, int size,
+        int64_t offset) {
+    FILE *p_file = p_stream_type->stream.p_file_stream;
+    if (p_file == nullptr) cx_runtime_error(rte_stream_not_open);
+
+    if (p_stream_type->stream.p_out_buffer != nullptr) {
+        write_buffer(p_stream_type->stream.p_out_buffer);
+    }
+
+    return read_fully(fileno(p_file), (char *) p_data, size, offset);
+}
+
+/** write_fully          Write bytes straight to a file descriptor,
+ *                      waiting on it while it's a socket that won't
+ *                      take more.
+ *
+ * @param fd     : the file descriptor.
+ * @param p_data : ptr to the bytes.
+ * @param size   : number of bytes.
+ * @return false on an error.
+ */
+static bool write_fully(int fd, const char *p_data, int size) {
+    while (size > 0) {
+        const ssize_t count = write(fd, p_data, size);
+
+        if (count >= 0) {
+            p_data += count;
+            size -= (int) count;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            wait_writable(fd);
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** cx_transfer_method   Ways to copy between file descriptors, from
+ *                      cheapest to the plain read and write every
+ *                      pair of descriptors takes.
+ */
+enum cx_transfer_method {
+    tm_copy_file_range, // file to file, shares extents when it can
+    tm_sendfile, // from a file
+    tm_splice, // to or from a pipe
+    tm_read_write,
+};
+
+/** cx_stream_transfer   Copy bytes from one stream to another.  The
+ *                      bytes the source has read ahead go first;
+ *                      the rest are copied by the kernel, with
+ *                      read(2) and write(2) through a large buffer
+ *                      only when no cheaper way works for the pair
+ *                      of files.  Copying from a socket stops when
+ *                      nothing more has arrived.
+ *
+ * @param p_source_type : ptr to the source stream's type object.
+ * @param p_target_type : ptr to the target stream's type object.
+ * @param length        : number of bytes to copy, or -1 to copy to
+ *                        the end of the source.
+ * @return number of bytes copied, or -1 if an error stopped the
+ *         copy before any were.
+ */
+int64_t cx_stream_transfer(cx_type *p_source_type, cx_type *p_target_type,
+        int64_t length) {
+    static const int chunk_size = 256 * 1024;
+    static thread_local std::unique_ptr<char[]> p_chunk;
+
+    cx_in_buffer *p_in = in_buffer_of(p_source_type);
+    cx_out_buffer *p_out = out_buffer_of(p_target_type);
+    int64_t total = 0;
+
+    // the kernel copies must land after the output already pending
+    const int pending = (int) std::min((int64_t) (p_in->end - p_in->start),
+            (length < 0) ? INT64_MAX : length);
+
+    put_bytes(p_out, &p_in->data[p_in->start], pending);
+    p_in->start += pending;
+    total += pending;
+    write_buffer(p_out);
+
+    cx_transfer_method method = tm_copy_file_range;
+
+    while (!p_in->eof && ((length < 0) || (total < length))) {
+        const size_t size = (size_t) std::min((length < 0)
+                ? INT64_C(1) << 30 : length - total, INT64_C(1) << 30);
+        ssize_t count;
+
+        switch (method) {
+            case tm_copy_file_range:
+                count = copy_file_range(p_in->fd, nullptr, p_out->fd, nullptr,
+                        size, 0);
+                break;
+            case tm_sendfile:
+                count = sendfile(p_out->fd, p_in->fd, nullptr, size);
+                break;
+            case tm_splice:
+                count = splice(p_in->fd, nullptr, p_out->fd, nullptr, size,
+                        SPLICE_F_MOVE);
+                break;
+            default:
+                if (p_chunk == nullptr) p_chunk.reset(new char[chunk_size]);
+
+                count = read(p_in->fd, p_chunk.get(),
+                        std::min(size, (size_t) chunk_size));
+
+                if ((count > 0)
+                        && !write_fully(p_out->fd, p_chunk.get(), (int) count)) {
+                    return (total == 0) ? -1 : total;
+                }
+                break;
+        }
+
+        if (count > 0) {
+            total += count;
+        } else if (count == 0) {
+            p_in->eof = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            pollfd p = {p_in->fd, POLLIN, 0};
+
+            // a socket with nothing more to give, or a target that's full
+            if (p_in->nonblocking && (poll(&p, 1, 0) == 0)) break;
+            wait_writable(p_out->fd);
+        } else if (method != tm_read_write) {
+            method = (cx_transfer_method) (method + 1);
+        } else {
+            return (total == 0) ? -1 : total;
+        }
+    }
+
+    return total;
+}
+
+/** cx_stream_open       Open a file on a stream, closing whatever
+ *                      file the stream had open.  Besides fopen's
+ *                      modes, "m" opens the file read-only to be
+ *                      mapped and scanned from start to end.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @param p_name        : ptr to the file's name.
+ * @param p_mode        : ptr to the open mode.
+ * @return true if the file was opened.
+ */
+bool cx_stream_open(cx_type *p_stream_type, const char *p_name,
+        const char *p_mode) {
+    cx_stream_close(p_stream_type);
+
+    FILE *p_file = fopen(p_name, (strcmp(p_mode, "m") == 0) ? "rb" : p_mode);
+    if (p_file == nullptr) return false;
+
+    p_stream_type->stream.p_file_stream = p_file;
+    p_stream_type->stream.p_file_name = strdup(p_name);
+    p_stream_type->stream.p_file_mode = strdup(p_mode);
+
+    return true;
+}
+
+/** cx_stream_close      Write out a stream's pending output, drop
+ *                      its buffers and close its file.  Values
+ *                      mapped from the file stay valid.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ */
+void cx_stream_close(cx_type *p_stream_type) {
+    cx_out_buffer *p_out = p_stream_type->stream.p_out_buffer;
+
+    if (p_out != nullptr) {
+        cx_context *p_context = cx_context::current();
+        std::vector<cx_out_buffer *> &unsent_buffers = p_context->unsent_buffers;
+
+        write_buffer(p_out);
+
+        if (p_out->p_prev != nullptr) p_out->p_prev->p_next = p_out->p_next;
+        else p_context->p_out_buffers = p_out->p_next;
+        if (p_out->p_next != nullptr) p_out->p_next->p_prev = p_out->p_prev;
+
+        if (p_out->unsent) {
+            unsent_buffers.erase(std::remove(unsent_buffers.begin(),
+                    unsent_buffers.end(), p_out), unsent_buffers.end());
+        }
+
+        delete p_out;
+        p_stream_type->stream.p_out_buffer = nullptr;
+    }
+
+    delete p_stream_type->stream.p_in_buffer;
+    p_stream_type->stream.p_in_buffer = nullptr;
+
+    if (p_stream_type->stream.p_file_stream != nullptr) {
+        cx_socket_forget(p_stream_type);
+        fclose(p_stream_type->stream.p_file_stream);
+        p_stream_type->stream.p_file_stream = nullptr;
+    }
+
+    free(p_stream_type->stream.p_file_name);
+    free(p_stream_type->stream.p_file_mode);
+    p_stream_type->stream.p_file_name = p_stream_type->stream.p_file_mode = nullptr;
+}
+
+/** cx_stream_bind       Make a file variable name another stream,
+ *                      or its own again.
+ *
+ * @param p_variable_type : ptr to the variable's own type object.
+ * @param p_stream_type   : ptr to the stream's type object, or
+ *                          nullptr.
+ */
+void cx_stream_bind(cx_type *p_variable_type, cx_type *p_stream_type) {
+    if (p_variable_type->stream.p_bound_stream == p_stream_type) return;
+
+    remove_type(p_variable_type->stream.p_bound_stream);
+    p_variable_type->stream.p_bound_stream = nullptr;
+
+    if (p_stream_type != nullptr) {
+        set_type(p_variable_type->stream.p_bound_stream, p_stream_type);
+    }
+}
+
+/** stream_type_of       The type object of the stream an id names.
+ *                      Reference parms hold the type object of
+ *                      their actual stream, and file variables
+ *                      may be bound to a socket.
+ *
+ * @param p_id : ptr to the stream id's symtab node.
+ * @return ptr to the stream's type object.
+ */
+cx_type *cx_executor::stream_type_of(const cx_symtab_node *p_id) {
+    if (p_id->defn.how == dc_reference) {
+        cx_type *p_stream_type = (cx_type *)
+                run_stack.get_value_address(p_id)->basic_types.addr__;
+
+        if (p_stream_type != nullptr) return p_stream_type;
+    }
+
+    cx_type *p_bound_type = p_id->p_type->stream.p_bound_stream;
+
+    return (p_bound_type != nullptr) ? p_bound_type : p_id->p_type;
+}
+
+void cx_executor::file_out(const cx_symtab_node* p_target_id,
+        const cx_type* p_expr_type) {
+
+    cx_type_code expr_type = p_expr_type->type_code;
+
+    mem_block *mem = &top()->basic_types;
+
+    cx_stream_lock lock(p_context);
+    cx_out_buffer *p_buffer = out_buffer_of(stream_type_of(p_target_id));
+
+    // integers are formatted backwards from the end of text
+    char text[64];
+    char *p_end = &text[sizeof (text)];
+    const char *p_text = text;
+    int length = 0;
+
+    // literals and strings of unknown size know their length
+    if (!p_expr_type->is_scalar_type()
+            && ((p_expr_type->size == 0) || p_expr_type->is_constant())) {
+        p_text = (const char *) mem->addr__;
+        length = cx_value_size(p_expr_type, mem->addr__);
+    } else {
+        switch (expr_type) {
+            case cx_int:
+                p_text = format_signed(p_end, mem->int__);
+                length = (int) (p_end - p_text);
+                break;
+            case cx_char:
+                text[0] = mem->char__;
+                length = 1;
+                break;
+            case cx_wchar:
+                text[0] = (char) mem->wchar__;
+                length = 1;
+                break;
+            case cx_float:
+                length = format_float(text, sizeof (text), mem->float__);
+                break;
+            case cx_uint8:
+                p_text = format_unsigned(p_end, mem->uint8__);
+                length = (int) (p_end - p_text);
+                break;
+            case cx_uint16:
+                p_text = format_unsigned(p_end, mem->uint16__);
+                length = (int) (p_end - p_text);
+                break;
+            case cx_uint32:
+                p_text = format_unsigned(p_end, mem->uint32__);
+                length = (int) (p_end - p_text);
+                break;
+            case cx_uint64:
+                p_text = format_unsigned(p_end, mem->uint64__);
+                length = (int) (p_end - p_text);
+                break;
+            default:
+                p_text = (const char *) mem->addr__;
+                length = strlen(p_text);
+                break;
+        }
+    }
+
+    put_bytes(p_buffer, p_text, length);
+
+    if (p_buffer->unbuffered || (p_buffer->line_flush
+            && (memchr(p_text, '\n', length) != nullptr))) {
+        write_buffer(p_buffer);
     }
 }
@@ -0,0 +1,520 @@
+/** Executor (Sockets)
+ * net.cpp
+ *
+ * Non-blocking TCP and Unix domain sockets on file variables, and
+ * the epoll event loop that waits on them.
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "cx-debug/exec.h"
+#include "common.h"
+#include "scheduler.h"
+
+// what a socket is ready for, as ready() returns it
+enum cx_ready_code {
+    ready_read = 1,
+    ready_write = 2,
+    ready_hangup = 4,
+    ready_accepted = 8
+};
+
+/** cx_socket            A socket the event loop watches.
+ */
+struct cx_socket {
+    cx_type *p_stream_type;
+    unsigned serial; // tells it from an earlier socket on its fd
+    bool listening;
+    bool connecting;
+    bool watching_output; // waiting to send pending output
+    int ready; // what it was ready for when wait last gave it out
+};
+
+/** cx_ready_socket      A socket an epoll_wait found ready, that
+ *                      wait hasn't given out yet.
+ */
+struct cx_ready_socket {
+    int fd;
+    unsigned serial;
+    int ready;
+};
+
+/** cx_event_loop        The sockets of one script, and the epoll
+ *                      instance that watches them.
+ */
+struct cx_event_loop {
+    int epoll_fd;
+    unsigned next_serial;
+
+    // every open socket, by file descriptor
+    std::unordered_map<int, cx_socket> sockets;
+    std::deque<cx_ready_socket> ready_sockets;
+
+    // sockets with output pending, and closed sockets to let go of
+    std::vector<int> output_fds;
+    std::vector<cx_type *> closed_streams;
+
+    cx_event_loop(void) : epoll_fd(-1), next_serial(0) {
+    }
+};
+
+/** event_loop           The event loop of the current script, made
+ *                      on first use.
+ *
+ * @return the event loop.
+ */
+static cx_event_loop &event_loop(void) {
+    cx_context *p_context = cx_context::current();
+
+    if (p_context->p_event_loop == nullptr) {
+        p_context->p_event_loop = new cx_event_loop;
+    }
+
+    return *p_context->p_event_loop;
+}
+
+/** parse_address        Resolve a socket address:  "host:port" or
+ *                      "[v6-host]:port" for TCP, "unix:path" or a
+ *                      path starting with / for a Unix domain socket.
+ *                      An empty host is any address to listen on,
+ *                      and the loopback address to connect to.
+ *
+ * @param p_address : ptr to the address.
+ * @param passive   : true to listen on it, false to connect to it.
+ * @param address   : gets the resolved address.
+ * @param length    : gets its length.
+ * @return true if it resolved.
+ */
+static bool parse_address(const char *p_address, bool passive,
+        sockaddr_storage &address, socklen_t &length) {
+    memset(&address, 0, sizeof (address));
+
+    if ((p_address[0] == '/') || (strncmp(p_address, "unix:", 5) == 0)) {
+        const char *p_path = (p_address[0] == '/') ? p_address : p_address + 5;
+        sockaddr_un *p_unix = (sockaddr_un *) &address;
+
+        if (strlen(p_path) >= sizeof (p_unix->sun_path)) return false;
+
+        p_unix->sun_family = AF_UNIX;
+        strcpy(p_unix->sun_path, p_path);
+        length = sizeof (sockaddr_un);
+
+        return true;
+    }
+
+    const char *p_colon = strrchr(p_address, ':');
+    if (p_colon == nullptr) return false;
+
+    std::string host(p_address, p_colon - p_address);
+    if ((host.size() >= 2) && (host[0] == '[') && (host[host.size() - 1] == ']')) {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof (hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV | (passive ? AI_PASSIVE : 0);
+
+    addrinfo *p_info = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), p_colon + 1,
+            &hints, &p_info) != 0) return false;
+
+    memcpy(&address, p_info->ai_addr, p_info->ai_addrlen);
+    length = p_info->ai_addrlen;
+    freeaddrinfo(p_info);
+
+    return true;
+}
+
+/** release_closed       Let go of the sockets closed since the last
+ *                      call.  They may have still been in use when
+ *                      they were closed.
+ */
+static void release_closed(void) {
+    cx_event_loop &loop = event_loop();
+
+    for (cx_type *&p_stream_type : loop.closed_streams) remove_type(p_stream_type);
+
+    loop.closed_streams.clear();
+}
+
+/** watch_socket         Make a stream of a new socket, and have the
+ *                      event loop watch it.
+ *
+ * @param fd         : the socket.
+ * @param p_address  : ptr to the address it's on.
+ * @param listening  : true if it accepts connections.
+ * @param connecting : true if it's still connecting.
+ * @return ptr to the stream's type object, or nullptr.
+ */
+static cx_type *watch_socket(int fd, const char *p_address,
+        bool listening, bool connecting) {
+    cx_event_loop &loop = event_loop();
+
+    if (loop.epoll_fd < 0) {
+        loop.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+        // a peer that hangs up shouldn't kill the program
+        signal(SIGPIPE, SIG_IGN);
+    }
+
+    FILE *p_file = fdopen(fd, "r+");
+    if ((loop.epoll_fd < 0) || (p_file == nullptr)) {
+        if (p_file != nullptr) fclose(p_file);
+        else close(fd);
+
+        return nullptr;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP | (connecting ? EPOLLOUT : 0);
+    event.data.fd = fd;
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, fd, &event);
+
+    cx_type *p_stream_type = new cx_type(fc_stream, sizeof (FILE),
+            cx_context::current()->p_file_type->p_type_id);
+    p_stream_type->stream.p_file_stream = p_file;
+    p_stream_type->stream.p_file_name = strdup(p_address);
+
+    cx_socket &entry = loop.sockets[fd];
+    entry.p_stream_type = nullptr;
+    set_type(entry.p_stream_type, p_stream_type);
+    entry.serial = loop.next_serial++;
+    entry.listening = listening;
+    entry.connecting = connecting;
+    entry.watching_output = false;
+    entry.ready = 0;
+
+    return p_stream_type;
+}
+
+/** update_events        Tell epoll what a socket waits for now.
+ *
+ * @param fd     : the socket.
+ * @param entry  : its entry.
+ */
+static void update_events(int fd, const cx_socket &entry) {
+    cx_event_loop &loop = event_loop();
+
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP
+            | ((entry.connecting || entry.watching_output) ? EPOLLOUT : 0);
+    event.data.fd = fd;
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+/** open_socket          Open a non-blocking socket.
+ *
+ * @param address : the address it will be on.
+ * @return the socket, or -1.
+ */
+static int open_socket(const sockaddr_storage &address) {
+    const int fd = socket(address.ss_family,
+            SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    // output is buffered already; don't hold small writes back
+    if ((fd >= 0) && (address.ss_family != AF_UNIX)) {
+        const int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof (on));
+    }
+
+    return fd;
+}
+
+/** cx_socket_connect    Start connecting a new socket, and bind a
+ *                      file variable to it.  wait gives it out as
+ *                      writable once it's connected.
+ *
+ * @param p_variable_type : ptr to the variable's own type object.
+ * @param p_address       : ptr to the address to connect to.
+ * @return the socket's id, or 0 if it can't connect.
+ */
+int cx_socket_connect(cx_type *p_variable_type, const char *p_address) {
+    sockaddr_storage address;
+    socklen_t length;
+
+    release_closed();
+    if (!parse_address(p_address, false, address, length)) return 0;
+
+    const int fd = open_socket(address);
+    if (fd < 0) return 0;
+
+    if ((connect(fd, (const sockaddr *) &address, length) < 0)
+            && (errno != EINPROGRESS)) {
+        close(fd);
+        return 0;
+    }
+
+    cx_type *p_stream_type = watch_socket(fd, p_address, false, true);
+    if (p_stream_type == nullptr) return 0;
+
+    cx_stream_bind(p_variable_type, p_stream_type);
+
+    return fd;
+}
+
+/** cx_socket_listen     Listen for connections on a new socket, and
+ *                      bind a file variable to it.  wait accepts
+ *                      them.
+ *
+ * @param p_variable_type : ptr to the variable's own type object.
+ * @param p_address       : ptr to the address to listen on.
+ * @return the TCP port listened on, 1 for a Unix domain socket,
+ *         or 0 if it can't listen.
+ */
+int cx_socket_listen(cx_type *p_variable_type, const char *p_address) {
+    sockaddr_storage address;
+    socklen_t length;
+
+    release_closed();
+    if (!parse_address(p_address, true, address, length)) return 0;
+
+    const int fd = open_socket(address);
+    if (fd < 0) return 0;
+
+    const int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof (on));
+
+    if ((bind(fd, (const sockaddr *) &address, length) < 0)
+            || (listen(fd, SOMAXCONN) < 0)) {
+        close(fd);
+        return 0;
+    }
+
+    length = sizeof (address);
+    getsockname(fd, (sockaddr *) &address, &length);
+
+    cx_type *p_stream_type = watch_socket(fd, p_address, true, false);
+    if (p_stream_type == nullptr) return 0;
+
+    cx_stream_bind(p_variable_type, p_stream_type);
+
+    switch (address.ss_family) {
+        case AF_INET: return ntohs(((sockaddr_in *) &address)->sin_port);
+        case AF_INET6: return ntohs(((sockaddr_in6 *) &address)->sin6_port);
+        default: return 1;
+    }
+}
+
+/** accept_connections   Accept every connection waiting on a
+ *                      listening socket.
+ *
+ * @param fd     : the listening socket.
+ * @param entry  : its entry.
+ */
+static void accept_connections(int fd, const cx_socket &entry) {
+    cx_event_loop &loop = event_loop();
+
+    const char *p_address = entry.p_stream_type->stream.p_file_name;
+
+    for (;;) {
+        const int connection_fd = accept4(fd, nullptr, nullptr,
+                SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (connection_fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        if (watch_socket(connection_fd, p_address, false, false) != nullptr) {
+            cx_ready_socket ready = {connection_fd,
+                loop.sockets[connection_fd].serial, ready_accepted};
+            loop.ready_sockets.push_back(ready);
+        }
+    }
+}
+
+/** ready_for            Turn an epoll event on a socket into what
+ *                      it's ready for.
+ *
+ * @param fd     : the socket.
+ * @param entry  : its entry.
+ * @param events : the epoll events.
+ * @return what it's ready for, or 0 if wait has nothing to
+ *         give out.
+ */
+static int ready_for(int fd, cx_socket &entry, uint32_t events) {
+    int ready = 0;
+
+    if (events & EPOLLIN) ready |= ready_read;
+    if (events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) ready |= ready_hangup;
+
+    if ((events & EPOLLOUT) && entry.connecting) {
+        int error = 0;
+        socklen_t length = sizeof (error);
+
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        ready |= (error == 0) ? ready_write : ready_hangup;
+
+        entry.connecting = false;
+        update_events(fd, entry);
+    }
+
+    return ready;
+}
+
+/** cx_socket_wait       Wait until a socket is ready, and bind a
+ *                      file variable to it.  Pending output is sent
+ *                      first, and connections are accepted as they
+ *                      come in.
+ *
+ * @param p_variable_type : ptr to the variable's own type object.
+ * @param timeout         : milliseconds to wait, or -1 for as long
+ *                          as it takes.
+ * @return the ready socket's id, 0 if none was ready in time, or
+ *         -1 if there are no sockets to wait on.
+ */
+int cx_socket_wait(cx_type *p_variable_type, int timeout) {
+    cx_event_loop &loop = event_loop();
+
+    release_closed();
+
+    for (;;) {
+        while (!loop.ready_sockets.empty()) {
+            const cx_ready_socket ready = loop.ready_sockets.front();
+            loop.ready_sockets.pop_front();
+
+            auto it = loop.sockets.find(ready.fd);
+            if ((it == loop.sockets.end()) || (it->second.serial != ready.serial)) continue;
+
+            it->second.ready = ready.ready;
+            cx_stream_bind(p_variable_type, it->second.p_stream_type);
+
+            return ready.fd;
+        }
+
+        if (loop.sockets.empty()) return -1;
+
+        // wait to send whatever the sockets didn't take
+        std::vector<int> blocked_fds;
+        cx_stream_send_pending(blocked_fds);
+
+        for (int fd : loop.output_fds) {
+            auto it = loop.sockets.find(fd);
+            if ((it == loop.sockets.end()) || (std::find(blocked_fds.begin(),
+                    blocked_fds.end(), fd) != blocked_fds.end())) continue;
+
+            it->second.watching_output = false;
+            update_events(fd, it->second);
+        }
+
+        loop.output_fds.clear();
+        for (int fd : blocked_fds) {
+            auto it = loop.sockets.find(fd);
+            if (it == loop.sockets.end()) continue;
+
+            loop.output_fds.push_back(fd);
+            if (!it->second.watching_output) {
+                it->second.watching_output = true;
+                update_events(fd, it->second);
+            }
+        }
+
+        epoll_event events[64];
+        int count;
+
+        if (timeout != 0) {
+            cx_slot_pause pause;
+            count = epoll_wait(loop.epoll_fd, events, 64, timeout);
+        } else count = epoll_wait(loop.epoll_fd, events, 64, 0);
+
+        if ((count < 0) && (errno == EINTR)) continue;
+        if (count <= 0) return 0;
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+
+            auto it = loop.sockets.find(fd);
+            if (it == loop.sockets.end()) continue;
+
+            if (it->second.listening) {
+                accept_connections(fd, it->second);
+                continue;
+            }
+
+            const int ready = ready_for(fd, it->second, events[i].events);
+            if (ready != 0) {
+                cx_ready_socket ready_socket = {fd, it->second.serial, ready};
+                loop.ready_sockets.push_back(ready_socket);
+            }
+        }
+    }
+}
+
+/** cx_socket_ready      What a stream was ready for when wait last
+ *                      gave it out.  A stream whose input has run
+ *                      out has hung up.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ * @return the ready bits:  1 read, 2 write, 4 hung up, 8 accepted.
+ */
+int cx_socket_ready(const cx_type *p_stream_type) {
+    int ready = cx_stream_eof(p_stream_type) ? ready_hangup : 0;
+
+    cx_event_loop *p_loop = cx_context::current()->p_event_loop;
+    if ((p_loop == nullptr) || (p_stream_type->stream.p_file_stream == nullptr)) return ready;
+
+    cx_event_loop &loop = *p_loop;
+
+    auto it = loop.sockets.find(fileno(p_stream_type->stream.p_file_stream));
+    if ((it != loop.sockets.end()) && (it->second.p_stream_type == p_stream_type)) {
+        ready |= it->second.ready;
+    }
+
+    return ready;
+}
+
+/** cx_socket_forget     Stop watching a socket that's being closed.
+ *
+ * @param p_stream_type : ptr to the stream's type object.
+ */
+void cx_socket_forget(cx_type *p_stream_type) {
+    cx_event_loop *p_loop = cx_context::current()->p_event_loop;
+    if (p_loop == nullptr) return;
+
+    cx_event_loop &loop = *p_loop;
+    auto it = loop.sockets.find(fileno(p_stream_type->stream.p_file_stream));
+    if ((it == loop.sockets.end()) || (it->second.p_stream_type != p_stream_type)) return;
+
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, it->first, nullptr);
+
+    loop.closed_streams.push_back(it->second.p_stream_type);
+    loop.sockets.erase(it);
+}
+
+/** cx_socket_release_all        Close every socket of a context, and
+ *                              free its event loop, as the context
+ *                              is torn down.
+ *
+ * @param p_context : ptr to the context.
+ */
+void cx_socket_release_all(cx_context *p_context) {
+    cx_event_loop *p_loop = p_context->p_event_loop;
+    if (p_loop == nullptr) return;
+
+    for (auto &entry : p_loop->sockets) {
+        cx_type *p_stream_type = entry.second.p_stream_type;
+
+        fclose(p_stream_type->stream.p_file_stream);
+        p_stream_type->stream.p_file_stream = nullptr;
+        remove_type(entry.second.p_stream_type);
+    }
+
+    for (cx_type *&p_stream_type : p_loop->closed_streams) remove_type(p_stream_type);
+    if (p_loop->epoll_fd >= 0) close(p_loop->epoll_fd);
+
+    delete p_loop;
+    p_context->p_event_loop = nullptr;
+}
@@ -0,0 +1,300 @@
+/** Executor (Parallel Loops)
+ * parallel.cpp
+ *
+ * Execute parallel for loops.  The iterations are split into chunks
+ * that run as tasks of the shared pool (see pool.cpp), each on an
+ * executor of its own:  its stack shares the slots of the program's
+ * frame and of the loop's routine, and it reads the icode through
+ * views with cursors of their own.  The index, the variables the
+ * body declares and the reductions get slots of their own.  The
+ * parser (see parse_parallel.cpp) made sure the body stores into
+ * nothing else but elements of shared arrays and records.
+ */
+
+#include <cstring>
+#include <vector>
+#include "common.h"
+#include "cx-debug/exec.h"
+#include "pool.h"
+
+///  cx_parallel_chunk   A run of the iterations of a parallel for.
+
+struct cx_parallel_chunk {
+    int64_t first; // the index of the first iteration
+    int64_t count; // count of iterations
+    std::vector<mem_block> partials; // of the reductions
+    long statement_count;
+    int line_number; // the worker's, from the loop's on
+    bool aborted;
+    cx_abort abort;
+};
+
+/** store_integer        Store an integer into a value of an integer
+ *                      type, cut to the type's width.
+ *
+ * @param p_context : context of the types.
+ * @param p_type    : ptr to the value's type object.
+ * @param value     : the value to set.
+ * @param integer   : the integer.
+ */
+static void store_integer(const cx_context *p_context, const cx_type *p_type,
+        mem_block &value, uint64_t integer) {
+    if (p_type == p_context->p_uint8_type) value.uint8__ = (uint8_t) integer;
+    else if (p_type == p_context->p_uint16_type) value.uint16__ = (uint16_t) integer;
+    else if (p_type == p_context->p_uint32_type) value.uint32__ = (uint32_t) integer;
+    else if (p_type == p_context->p_uint64_type) value.uint64__ = integer;
+    else value.int__ = (int) integer;
+}
+
+/** identity_of          The value a reduction's partial starts with.
+ *
+ * @param p_context : context of the types.
+ * @param reduction : the reduction.
+ * @return 0, 1, or all ones for &.
+ */
+static mem_block identity_of(const cx_context *p_context,
+        const cx_reduction &reduction) {
+    const cx_type *p_type = reduction.p_id->p_type;
+    mem_block value;
+
+    memset(&value, 0, sizeof (value));
+
+    if (p_type == p_context->p_float_type) {
+        value.float__ = (reduction.op == tc_star) ? 1.0f : 0.0f;
+    } else if (reduction.op == tc_star) {
+        store_integer(p_context, p_type, value, 1);
+    } else if (reduction.op == tc_bit_AND) {
+        store_integer(p_context, p_type, value, ~(uint64_t) 0);
+    }
+
+    return value;
+}
+
+/** fold_integer         Fold two integers with a reduction's
+ *                      operator.
+ */
+template <typename T>
+static T fold_integer(cx_token_code op, T a, T b) {
+    switch (op) {
+        case tc_plus: return a + b;
+        case tc_star: return a * b;
+        case tc_bit_AND: return a & b;
+        case tc_bit_OR: return a | b;
+        case tc_bit_XOR: return a ^ b;
+        default:
+            return a;
+    }
+}
+
+/** fold                 Fold a chunk's partial into a reduction.
+ *
+ * @param p_context : context of the types.
+ * @param reduction : the reduction.
+ * @param into      : the reduction's value.
+ * @param partial   : the chunk's partial.
+ */
+static void fold(const cx_context *p_context, const cx_reduction &reduction,
+        mem_block &into, const mem_block &partial) {
+    const cx_type *p_type = reduction.p_id->p_type;
+    const cx_token_code op = reduction.op;
+
+    if (p_type == p_context->p_float_type) {
+        into.float__ = (op == tc_star) ? into.float__ * partial.float__
+                : into.float__ + partial.float__;
+    } else if (p_type == p_context->p_uint8_type) {
+        into.uint8__ = fold_integer(op, into.uint8__, partial.uint8__);
+    } else if (p_type == p_context->p_uint16_type) {
+        into.uint16__ = fold_integer(op, into.uint16__, partial.uint16__);
+    } else if (p_type == p_context->p_uint32_type) {
+        into.uint32__ = fold_integer(op, into.uint32__, partial.uint32__);
+    } else if (p_type == p_context->p_uint64_type) {
+        into.uint64__ = fold_integer(op, into.uint64__, partial.uint64__);
+    } else {
+
+        // int, wrapping as the executor's own arithmetic does
+        into.int__ = (int) fold_integer(op, (unsigned) into.int__,
+                (unsigned) partial.int__);
+    }
+}
+
+/** execute_PARALLEL     Execute a parallel for statement.
+ *
+ *      parallel <call-marker> for (<id> = <expr>; <id> < <expr>; <id>++)
+ *              <statement>;
+ *
+ * The bounds are evaluated once, before the iterations start.
+ * Once every chunk is done, the reductions are folded in chunk
+ * order and the index is left as a for statement would leave it.
+ *
+ * @param p_function_id : routine ID this statement is apart of.
+ */
+void cx_executor::execute_PARALLEL(cx_symtab_node *p_function_id) {
+    get_token(); // call marker
+    const cx_parallel_loop &loop = p_context->parallel_loops[get_call_marker()];
+
+    get_token(); // for
+    get_token();
+    const int break_point = get_location_marker();
+    get_token();
+    const int statement_location = get_location_marker();
+    get_token();
+    const int condition_marker = get_location_marker();
+    get_token();
+    get_location_marker(); // increment:  the loop's step
+
+    get_token(); // (
+    get_token();
+    execute_assignment(p_node);
+
+    cx_stack_item *p_index = run_stack.get_value_address(loop.p_index_id);
+    const int64_t first = p_index->basic_types.int__;
+
+    // <id> < <expr>  or  <id> <= <expr>
+    go_to(condition_marker);
+    get_token(); // <id>
+    get_token();
+    const int64_t end = (token == tc_lessthan_equal) ? 1 : 0;
+    get_token();
+    execute_expression();
+    const int64_t limit = top()->basic_types.int__ + end;
+    pop();
+
+    const int64_t count = (limit > first)
+            ? (limit - first + loop.step - 1) / loop.step : 0;
+
+    if (count > 0) {
+
+        // the workers store into elements, never into the slot itself
+        for (const cx_symtab_node *p_id : loop.stored_ids) {
+            cx_stack_item *p_slot = run_stack.get_value_address(p_id);
+
+            p_slot->basic_types.addr__ = cx_value_unshare(p_slot->basic_types.addr__);
+        }
+
+        // a few chunks a thread, so a slow chunk doesn't hold up the rest
+        cx_task_pool &pool = cx_task_pool::shared();
+        const int64_t chunk_count = std::min<int64_t>(count, 4 * pool.thread_count());
+        std::vector<cx_parallel_chunk> chunks(chunk_count);
+        cx_task_group group;
+        int64_t iteration = 0;
+        const int line_number = cx_runtime_line(p_context);
+
+        for (int64_t c = 0; c < chunk_count; ++c) {
+            cx_parallel_chunk &chunk = chunks[c];
+
+            chunk.first = first + iteration * loop.step;
+            chunk.count = count / chunk_count + ((c < count % chunk_count) ? 1 : 0);
+            chunk.statement_count = 0;
+            chunk.line_number = line_number;
+            chunk.aborted = false;
+            iteration += chunk.count;
+
+            pool.add(group, [this, &loop, p_function_id, statement_location, &chunk]() {
+                cx_executor worker(p_context);
+
+                worker.execute_chunk(*this, loop, p_function_id,
+                        statement_location, chunk);
+            });
+        }
+
+        pool.wait(group);
+
+        for (const cx_parallel_chunk &chunk : chunks) {
+            statement_count += chunk.statement_count;
+            if (chunk.aborted) throw chunk.abort;
+        }
+
+        for (size_t r = 0; r < loop.reductions.size(); ++r) {
+            const cx_reduction &reduction = loop.reductions[r];
+            mem_block &value = run_stack.get_value_address(reduction.p_id)->basic_types;
+
+            for (const cx_parallel_chunk &chunk : chunks) {
+                fold(p_context, reduction, value, chunk.partials[r]);
+            }
+        }
+    }
+
+    // as the for statement would leave it
+    p_index->basic_types.int__ = (int) (first + count * loop.step);
+
+    go_to(break_point);
+    get_token();
+}
+
+/** execute_chunk        Execute a chunk of the iterations of a
+ *                      parallel for, on a worker's executor.
+ *
+ * @param owner              : the executor running the loop.
+ * @param loop               : the loop.
+ * @param p_function_id      : routine ID the loop is apart of.
+ * @param statement_location : location of the loop's body.
+ * @param chunk              : the chunk, which gets the partials of
+ *                             the reductions and how the run went.
+ */
+void cx_executor::execute_chunk(const cx_executor &owner,
+        const cx_parallel_loop &loop, cx_symtab_node *p_function_id,
+        int statement_location, cx_parallel_chunk &chunk) {
+    cx_context_scope scope(p_context);
+    int *p_saved_line = cx_worker_line_number;
+
+    cx_worker_line_number = &chunk.line_number;
+    is_worker = true;
+    nesting_level = owner.nesting_level;
+    run_stack.share_frames(owner.run_stack, p_context->p_program_ptr_id,
+            p_function_id);
+    p_icode = icode_of(owner.p_icode);
+
+    cx_stack_item *p_index = run_stack.privatize(loop.p_index_id);
+
+    for (const cx_symtab_node *p_id : loop.private_ids) run_stack.privatize(p_id);
+
+    std::vector<cx_stack_item *> partials;
+
+    for (const cx_reduction &reduction : loop.reductions) {
+        partials.push_back(run_stack.privatize(reduction.p_id));
+        partials.back()->basic_types = identity_of(p_context, reduction);
+    }
+
+    try {
+        for (int64_t i = 0; i < chunk.count; ++i) {
+            p_index->basic_types.int__ = (int) (chunk.first + i * loop.step);
+
+            go_to(statement_location);
+            get_token();
+            execute_statement(p_function_id);
+            break_loop = false;
+        }
+    } catch (const cx_abort &abort) {
+        chunk.aborted = true;
+        chunk.abort = abort;
+    }
+
+    for (const cx_stack_item *p_partial : partials) {
+        chunk.partials.push_back(p_partial->basic_types);
+    }
+
+    for (const cx_symtab_node *p_id : loop.private_ids) {
+        if ((p_id->p_type->form == fc_array) || (p_id->p_type->form == fc_complex)) {
+            cx_value_release(run_stack.get_value_address(p_id)->basic_types.addr__);
+        }
+    }
+
+    chunk.statement_count = statement_count;
+    cx_worker_line_number = p_saved_line;
+}
+
+/** icode_of             The icode to run for a routine's icode:  the
+ *                      icode itself, or on a worker a view of it, as
+ *                      the other threads may be running it too.
+ *
+ * @param p_icode : ptr to the routine's icode.
+ * @return ptr to the icode to run.
+ */
+cx_icode *cx_executor::icode_of(cx_icode *p_icode) {
+    if (!is_worker) return p_icode;
+
+    cx_icode *&p_view = icode_views[p_icode];
+    if (p_view == nullptr) p_view = new cx_icode(p_icode);
+
+    return p_view;
+}
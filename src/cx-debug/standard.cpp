@@ -0,0 +1,910 @@
+/** Executor (Standard Routines)
+ * standard.cpp
+ *
+ * Execute calls to the standard routines.
+ */
+
+#include <climits>
+#include <cstring>
+#include <string>
+#include "cx-debug/exec.h"
+#include "common.h"
+#include "format.h"
+#include "intrinsic.h"
+#include "script.h"
+
+/** string_argument      The string value of an argument on top of
+ *                      the stack.  One-char literals are chars.
+ *
+ * @param p_type : ptr to the argument's type object.
+ * @param value  : the argument's value.
+ * @return the string.
+ */
+static std::string string_argument(const cx_type *p_type, const mem_block &value) {
+    if (p_type->is_scalar_type()) return std::string(1, value.char__);
+
+    return std::string((const char *) value.addr__,
+            cx_value_size(p_type, value.addr__));
+}
+
+/** cx_byte_view         How a load or store routine views the bytes
+ *                      of an array.
+ */
+struct cx_byte_view {
+    cx_routine_code rc;
+    int width; // bytes
+    bool big_endian;
+    bool store;
+};
+
+static const cx_byte_view byte_views[] = {
+    {rc_getu8, 1, false, false},
+    {rc_getu16le, 2, false, false},
+    {rc_getu16be, 2, true, false},
+    {rc_getu32le, 4, false, false},
+    {rc_getu32be, 4, true, false},
+    {rc_getu64le, 8, false, false},
+    {rc_getu64be, 8, true, false},
+    {rc_getbits, 0, true, false},
+    {rc_putu8, 1, false, true},
+    {rc_putu16le, 2, false, true},
+    {rc_putu16be, 2, true, true},
+    {rc_putu32le, 4, false, true},
+    {rc_putu32be, 4, true, true},
+    {rc_putu64le, 8, false, true},
+    {rc_putu64be, 8, true, true},
+};
+
+static const bool host_big_endian = (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+
+/** load_bytes           Load an unsigned integer from unaligned bytes.
+ *
+ * @param p_data     : ptr to the first byte.
+ * @param width      : number of bytes: 1, 2, 4 or 8.
+ * @param big_endian : true if the most significant byte comes first.
+ * @return the integer.
+ */
+static uint64_t load_bytes(const char *p_data, int width, bool big_endian) {
+    const bool swap = (big_endian != host_big_endian);
+
+    switch (width) {
+        case 1: return (unsigned char) *p_data;
+        case 2:
+        {
+            uint16_t value;
+            memcpy(&value, p_data, sizeof (value));
+            return swap ? __builtin_bswap16(value) : value;
+        }
+        case 4:
+        {
+            uint32_t value;
+            memcpy(&value, p_data, sizeof (value));
+            return swap ? __builtin_bswap32(value) : value;
+        }
+        default:
+        {
+            uint64_t value;
+            memcpy(&value, p_data, sizeof (value));
+            return swap ? __builtin_bswap64(value) : value;
+        }
+    }
+}
+
+/** store_bytes          Store the low bytes of an unsigned integer
+ *                      into unaligned bytes.
+ *
+ * @param p_data     : ptr to the first byte.
+ * @param width      : number of bytes: 1, 2, 4 or 8.
+ * @param big_endian : true to store the most significant byte first.
+ * @param value      : the integer.
+ */
+static void store_bytes(char *p_data, int width, bool big_endian, uint64_t value) {
+    const bool swap = (big_endian != host_big_endian);
+
+    switch (width) {
+        case 1:
+            *p_data = (char) value;
+            break;
+        case 2:
+        {
+            uint16_t bytes = swap ? __builtin_bswap16((uint16_t) value) : (uint16_t) value;
+            memcpy(p_data, &bytes, sizeof (bytes));
+        }
+            break;
+        case 4:
+        {
+            uint32_t bytes = swap ? __builtin_bswap32((uint32_t) value) : (uint32_t) value;
+            memcpy(p_data, &bytes, sizeof (bytes));
+        }
+            break;
+        default:
+        {
+            uint64_t bytes = swap ? __builtin_bswap64(value) : value;
+            memcpy(p_data, &bytes, sizeof (bytes));
+        }
+            break;
+    }
+}
+
+/** integer_argument     The value of an integer argument on top of
+ *                      the stack, widened to 64 bits.
+ *
+ * @param p_type : ptr to the argument's type object.
+ * @param value  : the argument's value.
+ * @return the value; negative ints keep their two's complement bits.
+ */
+static uint64_t integer_argument(const cx_type *p_type, const mem_block &value) {
+    switch (p_type->base_type()->type_code) {
+        case cx_char: return (unsigned char) value.char__;
+        case cx_uint8: return value.uint8__;
+        case cx_uint16: return value.uint16__;
+        case cx_uint32: return value.uint32__;
+        case cx_uint64: return value.uint64__;
+        default: return (uint64_t) (int64_t) value.int__;
+    }
+}
+
+/** execute_standard_subroutine_call   Execute a call to a standard
+ *                                  routine.
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_standard_subroutine_call
+(cx_symtab_node *p_function_id) {
+    switch (p_function_id->defn.routine.which) {
+        case rc_intrinsic: return execute_intrinsic_call(p_function_id);
+        case rc_host: return execute_host_call(p_function_id);
+        case rc_reserve: return execute_reserve_call(p_function_id);
+        case rc_getline:
+        case rc_getint:
+        case rc_getfloat: return execute_stream_read_call(p_function_id);
+        case rc_fopen:
+        case rc_fclose:
+        case rc_fmap: return execute_file_call(p_function_id);
+        case rc_fread:
+        case rc_fwrite:
+        case rc_pread: return execute_binary_io_call(p_function_id);
+        case rc_transfer: return execute_transfer_call(p_function_id);
+        case rc_getu8:
+        case rc_getu16le:
+        case rc_getu16be:
+        case rc_getu32le:
+        case rc_getu32be:
+        case rc_getu64le:
+        case rc_getu64be:
+        case rc_getbits:
+        case rc_putu8:
+        case rc_putu16le:
+        case rc_putu16be:
+        case rc_putu32le:
+        case rc_putu32be:
+        case rc_putu64le:
+        case rc_putu64be: return execute_byte_view_call(p_function_id);
+        case rc_printf:
+        case rc_fprintf: return execute_format_call(p_function_id);
+        case rc_connect:
+        case rc_listen:
+        case rc_wait:
+        case rc_ready: return execute_socket_call(p_function_id);
+        case rc_join: return execute_join_call(p_function_id);
+        case rc_channel:
+        case rc_close: return execute_channel_call(p_function_id);
+        case rc_send:
+        case rc_try_send: return execute_send_call(p_function_id);
+        case rc_receive:
+        case rc_try_receive: return execute_receive_call(p_function_id);
+        case rc_load:
+        case rc_store:
+        case rc_fetch_add:
+        case rc_compare_exchange: return execute_atomic_call(p_function_id);
+        default:
+            cx_runtime_error(rte_unimplemented_runtime_feature);
+            return p_function_id->p_type;
+    }
+}
+
+/** execute_intrinsic_call    Execute a call to a library routine
+ *                          bound to native code.  Its actuals are
+ *                          evaluated as for the Cx routine, but
+ *                          none is copied and no frame is pushed.
+ *                          A reference actual is passed as its
+ *                          address, or its data's for an array.
+ *
+ *      <id> ( <call-marker> <expr>, ... )
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_intrinsic_call(cx_symtab_node *p_function_id) {
+    const cx_intrinsic *p_intrinsic = p_function_id->defn.routine.p_intrinsic;
+    cx_intrinsic_arg args[cx_intrinsic::max_args];
+
+    execute_native_actuals(args);
+
+    const mem_block result = p_intrinsic->p_code(args);
+    cx_type *p_result_type = p_function_id->p_type;
+
+    push_value(p_result_type, result);
+
+    return p_result_type;
+}
+
+/** execute_host_call     Execute a call to a routine of the host
+ *                      program.  The actuals are evaluated as for
+ *                      an intrinsic and handed to the host as
+ *                      values; strings are copied.  A result the
+ *                      routine's type can't hold is a runtime
+ *                      error.
+ *
+ *      <id> ( <call-marker> <expr>, ... )
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_host_call(cx_symtab_node *p_function_id) {
+    const cx_host_function *p_host = p_function_id->defn.routine.p_host;
+    cx_intrinsic_arg args[cx_host_function::max_args];
+    cx_value values[cx_host_function::max_args];
+
+    const int arg_count = execute_native_actuals(args);
+    const cx_symtab_node *p_parm_id =
+            p_function_id->defn.routine.locals.p_parms_ids;
+
+    for (int i = 0; i < arg_count; ++i, p_parm_id = p_parm_id->next__) {
+        // a string ends at its first '\0'
+        values[i] = (p_parm_id->p_type->form == fc_array)
+                ? cx_value(string_argument(args[i].p_type, args[i].value).c_str())
+                : cx_value_of(p_context, args[i].p_type, args[i].value);
+    }
+
+    const cx_value value = p_host->p_code(values, arg_count, p_host->p_data);
+    cx_type *p_result_type = p_function_id->p_type;
+    mem_block result;
+
+    if (!cx_block_of(p_context, p_result_type, value, result)) {
+        cx_runtime_error(rte_invalid_function_argument);
+    }
+
+    push_value(p_result_type, result);
+
+    return p_result_type;
+}
+
+/** execute_native_actuals    Evaluate the actuals of a call to
+ *                          native code, as for the Cx routine.
+ *                          A reference actual is passed as its
+ *                          address, or its data's for an array.
+ *
+ * @param p_args : ptr to the args to fill in.
+ *
+ * @return: the number of args
+ */
+int cx_executor::execute_native_actuals(cx_intrinsic_arg *p_args) {
+    get_token(); // (
+    get_token(); // call marker
+    const cx_call_site &site = p_context->call_sites[get_call_marker()];
+    const int parm_count = site.parms.size();
+
+    get_token(); // first actual or )
+
+    for (int i = 0; i < parm_count; ++i) {
+        if (i > 0) get_token(); // ,
+
+        // a reference actual is passed by its address
+        p_args[i].reference = site.parms[i].reference;
+        if (p_args[i].reference) {
+            const cx_symtab_node *p_actual_id = p_node;
+
+            get_token();
+            p_args[i].p_type = execute_variable(p_actual_id, true);
+        } else p_args[i].p_type = execute_expression();
+
+        p_args[i].value = top()->basic_types;
+        pop();
+
+        if (site.parms[i].int_to_float) {
+            p_args[i].p_type = p_context->p_float_type;
+            p_args[i].value.float__ = (float) p_args[i].value.int__;
+        }
+    }
+
+    get_token(); // token after )
+
+    return parm_count;
+}
+
+/** execute_reserve_call  Execute a call to reserve:  make room in an
+ *                      array's buffer for the given number of
+ *                      elements, without changing its length.
+ *                      Leaves the element count on the stack.
+ *
+ *      reserve(<array-variable>, <expr>)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_reserve_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token(); // array variable
+
+    const cx_symtab_node *p_array_id = p_node;
+    const int element_size = p_array_id->p_type->base_type()->size;
+
+    get_token(); // ,
+    get_token();
+    execute_expression();
+    const int count = top()->basic_types.int__;
+    pop();
+    get_token(); // token after )
+
+    if (count < 0) cx_runtime_error(rte_invalid_function_argument);
+
+    cx_stack_item *p_slot = run_stack.get_value_address(p_array_id);
+    p_slot->basic_types.addr__ =
+            cx_value_reserve(p_slot->basic_types.addr__, count * element_size);
+
+    push(count);
+
+    return p_function_id->p_type;
+}
+
+/** execute_stream_read_call      Execute a call to getline, getint or
+ *                              getfloat.  Leaves the line's length
+ *                              (-1 at the end of the stream), or the
+ *                              number read, on the stack.
+ *
+ *      getline(<stream>, <char-array-variable>)
+ *      getint(<stream>)
+ *      getfloat(<stream>)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_stream_read_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token(); // stream variable
+
+    cx_stream_lock lock(p_context);
+    cx_type *p_stream_type = stream_type_of(p_node);
+
+    switch (p_function_id->defn.routine.which) {
+        case rc_getline:
+        {
+            get_token(); // ,
+            get_token(); // line variable
+
+            cx_stack_item *p_slot = run_stack.get_value_address(p_node);
+            push(cx_stream_getline(p_stream_type, p_slot->basic_types.addr__));
+        }
+            break;
+        case rc_getint:
+            push(cx_stream_scan_int(p_stream_type));
+            break;
+        default:
+            push(cx_stream_scan_float(p_stream_type));
+            break;
+    }
+
+    get_token(); // )
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_file_call     Execute a call to fopen, fclose or fmap.
+ *                      fopen leaves 1 on the stack if the file was
+ *                      opened, else 0.  fmap maps the file, or the
+ *                      window of it, into the array and leaves the
+ *                      length mapped, or -1 if it can't be mapped.
+ *
+ *      fopen(<stream>, <name-expr>, <mode-expr>)
+ *      fclose(<stream>)
+ *      fmap(<stream>, <char-array-variable>)
+ *      fmap(<stream>, <char-array-variable>, <offset-expr>, <length-expr>)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_file_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token(); // stream variable
+
+    // a file variable bound to a socket opens a file of its own
+    if ((p_function_id->defn.routine.which == rc_fopen)
+            && (p_node->defn.how == dc_variable)) {
+        cx_stream_lock lock(p_context);
+
+        cx_stream_bind(p_node->p_type, nullptr);
+    }
+
+    cx_type *p_stream_type = stream_type_of(p_node);
+    get_token(); // , or )
+
+    switch (p_function_id->defn.routine.which) {
+        case rc_fopen:
+        {
+            get_token();
+            cx_type *p_name_type = execute_expression();
+            const std::string name = string_argument(p_name_type, top()->basic_types);
+            pop();
+
+            get_token(); // ,
+            cx_type *p_mode_type = execute_expression();
+            const std::string mode = string_argument(p_mode_type, top()->basic_types);
+            pop();
+
+            cx_stream_lock lock(p_context);
+            push(cx_stream_open(p_stream_type, name.c_str(), mode.c_str()) ? 1 : 0);
+        }
+            break;
+        case rc_fclose:
+        {
+            cx_stream_lock lock(p_context);
+
+            cx_stream_close(p_stream_type);
+            push(0);
+        }
+            break;
+        default:
+        {
+            get_token(); // array variable
+            cx_stack_item *p_slot = run_stack.get_value_address(p_node);
+            get_token(); // , or )
+
+            FILE *p_file = p_stream_type->stream.p_file_stream;
+            if (p_file == nullptr) cx_runtime_error(rte_stream_not_open);
+
+            const int64_t file_size = (fseeko(p_file, 0, SEEK_END) == 0)
+                    ? (int64_t) ftello(p_file) : 0;
+            rewind(p_file);
+
+            // windows start on a 64K boundary, which is a page on any host
+            const int window_alignment = 64 * 1024;
+            int64_t offset = 0;
+            int64_t length = std::min(file_size,
+                    (int64_t) (INT_MAX & ~(window_alignment - 1)));
+
+            if (token == tc_comma) {
+                get_token();
+                execute_expression();
+                offset = top()->basic_types.int__;
+                pop();
+
+                get_token(); // ,
+                execute_expression();
+                length = top()->basic_types.int__;
+                pop();
+
+                if ((offset < 0) || (length < 0)
+                        || (offset % window_alignment != 0)) {
+                    cx_runtime_error(rte_invalid_function_argument);
+                }
+
+                length = std::max((int64_t) 0,
+                        std::min(length, file_size - offset));
+            }
+
+            cx_stream_lock lock(p_context);
+            const char *p_mode = p_stream_type->stream.p_file_mode;
+            void *addr = cx_value_map(fileno(p_file), offset, (int) length,
+                    (p_mode != nullptr) && (strcmp(p_mode, "m") == 0));
+
+            if (addr == nullptr) {
+                push(-1);
+            } else {
+                cx_value_release(p_slot->basic_types.addr__);
+                p_slot->basic_types.addr__ = addr;
+                push((int) length);
+            }
+        }
+            break;
+    }
+
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_binary_io_call        Execute a call to fread, fwrite or
+ *                              pread.  A value moves as the bytes of
+ *                              its type's size, or of its buffer for
+ *                              an array of unknown size;  a count
+ *                              moves that many elements instead, and
+ *                              resizes an array of unknown size being
+ *                              read into.  Leaves the number of bytes
+ *                              moved on the stack, or -1 if pread
+ *                              can't read the stream.
+ *
+ *      fread(<stream>, <variable> [, <count-expr>])
+ *      fwrite(<stream>, <expr> [, <count-expr>])
+ *      pread(<stream>, <variable>, <offset-expr>)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_binary_io_call(cx_symtab_node *p_function_id) {
+    const cx_routine_code which = p_function_id->defn.routine.which;
+
+    get_token(); // (
+    get_token(); // stream variable
+
+    cx_type *p_stream_type = stream_type_of(p_node);
+    get_token(); // ,
+    get_token();
+
+    /* The value's address:  scalars are read into their stack item,
+     * and written from a copy of the value execute_expression pushes. */
+    cx_symtab_node *p_variable_id = p_node;
+    cx_type *p_type;
+
+    if (which == rc_fwrite) {
+        p_type = execute_expression();
+    } else {
+        get_token();
+        p_type = execute_variable(p_variable_id, true);
+    }
+
+    mem_block value = top()->basic_types;
+    void *p_data = (which == rc_fwrite) && p_type->is_scalar_type()
+            ? (void *) &value : value.addr__;
+    int size = p_type->is_scalar_type()
+            ? p_type->size : cx_value_size(p_type, p_data);
+    pop();
+
+    int64_t offset = 0;
+
+    if (token == tc_comma) {
+        get_token();
+        execute_expression();
+        const int operand = top()->basic_types.int__;
+        pop();
+
+        if (operand < 0) cx_runtime_error(rte_invalid_function_argument);
+
+        if (which == rc_pread) {
+            offset = operand;
+        } else {
+            const int element_size = p_type->base_type()->size;
+            const int64_t count_size = (int64_t) operand * element_size;
+
+            if ((which == rc_fread) && (p_type->form == fc_array)
+                    && (p_type->size == 0)) {
+                if (count_size > INT_MAX) {
+                    cx_runtime_error(rte_invalid_function_argument);
+                }
+
+                cx_stack_item *p_slot = run_stack.get_value_address(p_variable_id);
+                p_slot->basic_types.addr__ = p_data =
+                        cx_value_resize(p_slot->basic_types.addr__, (int) count_size);
+                size = (int) count_size;
+            } else {
+                size = (int) std::min((int64_t) size, count_size);
+            }
+        }
+    }
+
+    cx_stream_lock lock(p_context);
+    int moved;
+
+    switch (which) {
+        case rc_fwrite:
+            moved = cx_stream_write(p_stream_type, p_data, size);
+            break;
+        case rc_pread:
+            moved = cx_stream_pread(p_stream_type, p_data, size, offset);
+            break;
+        default:
+            moved = cx_stream_read(p_stream_type, p_data, size);
+
+            // an array that was sized to a count keeps what was read
+            if ((moved < size) && (p_type->form == fc_array)
+                    && (p_type->size == 0)) {
+                const int element_size = p_type->base_type()->size;
+                cx_stack_item *p_slot = run_stack.get_value_address(p_variable_id);
+
+                p_slot->basic_types.addr__ = cx_value_resize(p_data,
+                        moved - moved % element_size);
+            }
+            break;
+    }
+
+    push(moved);
+
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_transfer_call Execute a call to transfer, which copies
+ *                      bytes from one stream to another without
+ *                      passing them through the program.  Leaves the
+ *                      number of bytes copied on the stack, or -1 if
+ *                      nothing could be.
+ *
+ *      transfer(<stream>, <stream> [, <length-expr>])
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_transfer_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token(); // source stream
+
+    cx_type *p_source_type = stream_type_of(p_node);
+    get_token(); // ,
+    get_token(); // target stream
+
+    cx_type *p_target_type = stream_type_of(p_node);
+    get_token(); // , or )
+
+    // the rest of the source, unless a length is given
+    int64_t length = -1;
+
+    if (token == tc_comma) {
+        get_token();
+        execute_expression();
+        length = top()->basic_types.int__;
+        pop();
+
+        if (length < 0) cx_runtime_error(rte_invalid_function_argument);
+    }
+
+    cx_stream_lock lock(p_context);
+    const int64_t moved = cx_stream_transfer(p_source_type, p_target_type, length);
+    push((int) std::min(moved, (int64_t) INT_MAX));
+
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_byte_view_call Execute a call that loads or stores an
+ *                      integer at a byte offset into an array, in
+ *                      place.  Loads leave the integer on the stack,
+ *                      stores the offset just past it.  A store past
+ *                      the end of an array of unknown size (char *)
+ *                      grows the array, zero filling any gap.
+ *
+ *      getu16be(<array-variable>, <offset-expr>)
+ *      putu16be(<array-variable>, <offset-expr>, <value-expr>)
+ *      getbits(<array-variable>, <bit-offset-expr>, <count-expr>)
+ *
+ * getbits counts bits from the most significant bit of the first
+ * byte, as network protocols do, and takes at most 32 of them.
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_byte_view_call(cx_symtab_node *p_function_id) {
+    const cx_routine_code which = p_function_id->defn.routine.which;
+    const cx_byte_view *p_view = byte_views;
+
+    while (p_view->rc != which) ++p_view;
+
+    get_token(); // (
+    get_token(); // array variable
+
+    cx_symtab_node *p_array_id = p_node;
+    get_token();
+
+    cx_type *p_type = execute_variable(p_array_id, p_view->store);
+    char *p_data = (char *) top()->basic_types.addr__;
+    int size = cx_value_size(p_type, p_data);
+    pop();
+
+    get_token(); // offset
+    execute_expression();
+    const int offset = top()->basic_types.int__;
+    pop();
+
+    if (offset < 0) cx_runtime_error(rte_value_out_of_range);
+
+    if (which == rc_getbits) {
+        get_token(); // bit count
+        execute_expression();
+        const int count = top()->basic_types.int__;
+        pop();
+
+        if ((count < 1) || (count > 32)) {
+            cx_runtime_error(rte_invalid_function_argument);
+        }
+
+        const int first = offset / 8;
+        const int shift = offset % 8;
+        const int width = (shift + count + 7) / 8;
+
+        if ((int64_t) first + width > size) cx_runtime_error(rte_value_out_of_range);
+
+        // the bytes holding the field, most significant first
+        uint64_t bits = 0;
+        for (int i = 0; i < width; ++i) {
+            bits = (bits << 8) | (unsigned char) p_data[first + i];
+        }
+
+        bits >>= (width * 8) - shift - count;
+        push((int) (uint32_t) (bits & ((UINT64_C(1) << count) - 1)));
+
+    } else if (p_view->store) {
+        get_token(); // value
+        cx_type *p_value_type = execute_expression();
+        const uint64_t value = integer_argument(p_value_type, top()->basic_types);
+        pop();
+
+        const int end = offset + p_view->width;
+
+        if (end > size) {
+            if ((p_type->size != 0) || (end < offset)) {
+                cx_runtime_error(rte_value_out_of_range);
+            }
+
+            cx_stack_item *p_slot = run_stack.get_value_address(p_array_id);
+            p_slot->basic_types.addr__ = p_data =
+                    (char *) cx_value_resize(p_slot->basic_types.addr__, end);
+            memset(p_data + size, 0, end - size);
+        }
+
+        store_bytes(p_data + offset, p_view->width, p_view->big_endian, value);
+        push(end);
+
+    } else {
+        if ((int64_t) offset + p_view->width > size) {
+            cx_runtime_error(rte_value_out_of_range);
+        }
+
+        const uint64_t value = load_bytes(p_data + offset, p_view->width,
+                p_view->big_endian);
+
+        switch (p_view->width) {
+            case 8: push(value);
+                break;
+            case 4: push((uint32_t) value);
+                break;
+            default: push((int) value);
+                break;
+        }
+    }
+
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_format_call  Execute a call to printf or fprintf.  Leaves
+ *                      the number of bytes written on the stack.
+ *
+ *      printf(<format-expr>, <expr>, ...)
+ *      fprintf(<stream>, <format-expr>, <expr>, ...)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_format_call(cx_symtab_node *p_function_id) {
+    cx_type *p_stream_type = stream_type_of(p_context->p_stdout);
+
+    get_token(); // (
+
+    if (p_function_id->defn.routine.which == rc_fprintf) {
+        get_token(); // stream variable
+        p_stream_type = stream_type_of(p_node);
+        get_token(); // ,
+    }
+
+    get_token();
+    cx_type *p_format_type = execute_expression();
+    const mem_block format_value = top()->basic_types;
+    pop();
+
+    // a literal was compiled when the call was parsed
+    cx_format computed_format;
+    const cx_format *p_format = p_format_type->is_constant()
+            ? cx_constant_format((const char *) format_value.addr__) : nullptr;
+
+    if (p_format == nullptr) {
+        const std::string text = string_argument(p_format_type, format_value);
+
+        if (!cx_compile_format(text.data(), (int) text.size(), computed_format)) {
+            cx_runtime_error(rte_invalid_function_argument);
+        }
+        p_format = &computed_format;
+    }
+
+    cx_format_arg args[cx_format::max_args];
+    int count = 0;
+
+    while (token == tc_comma) {
+        get_token();
+        cx_type *p_type = execute_expression();
+
+        if (count < cx_format::max_args) {
+            args[count].p_type = p_type;
+            args[count].value = top()->basic_types;
+        }
+        ++count;
+        pop();
+    }
+
+    if (count != (int) p_format->conversions.size()) {
+        cx_runtime_error(rte_invalid_function_argument);
+    }
+
+    cx_stream_lock lock(p_context);
+    push(cx_stream_format(p_stream_type, *p_format, args));
+
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
+
+/** execute_socket_call   Execute a call to connect, listen, wait or
+ *                      ready.  connect, listen and wait bind the file
+ *                      variable to the socket they leave the id, or
+ *                      port, of on the stack.
+ *
+ *      connect(<file-variable>, <address-expr>)
+ *      listen(<file-variable>, <address-expr>)
+ *      wait(<file-variable>, <timeout-expr>)
+ *      ready(<stream>)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_socket_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token(); // stream variable
+
+    cx_type *p_variable_type = p_node->p_type;
+    cx_type *p_stream_type = stream_type_of(p_node);
+    get_token(); // , or )
+
+    switch (p_function_id->defn.routine.which) {
+        case rc_connect:
+        case rc_listen:
+        {
+            get_token();
+            cx_type *p_address_type = execute_expression();
+            const std::string address = string_argument(p_address_type,
+                    top()->basic_types);
+            pop();
+
+            cx_stream_lock lock(p_context);
+            push((p_function_id->defn.routine.which == rc_connect)
+                    ? cx_socket_connect(p_variable_type, address.c_str())
+                    : cx_socket_listen(p_variable_type, address.c_str()));
+        }
+            break;
+        case rc_wait:
+        {
+            get_token();
+            execute_expression();
+            const int timeout = top()->basic_types.int__;
+            pop();
+
+            cx_stream_lock lock(p_context);
+            push(cx_socket_wait(p_variable_type, timeout));
+        }
+            break;
+        default:
+        {
+            cx_stream_lock lock(p_context);
+
+            push(cx_socket_ready(p_stream_type));
+        }
+            break;
+    }
+
+    get_token(); // token after )
+
+    return p_function_id->p_type;
+}
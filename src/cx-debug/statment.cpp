@@ -14,7 +14,7 @@
  */
 void cx_executor::execute_statement(cx_symtab_node *p_function_id) {
     if (token != tc_left_bracket) {
-        ++statement_count;
+        if (++statement_count >= yield_at) yield_slot();
         trace_statement();
     }
 
@@ -23,6 +23,9 @@ void cx_executor::execute_statement(cx_symtab_node *p_function_id) {
         {
             if (p_node->defn.how == dc_function) {
                 execute_subroutine_call(p_node);
+
+                // discard the unused return value
+                pop();
             } else {
                 execute_assignment(p_node);
             }
@@ -36,6 +39,20 @@ void cx_executor::execute_statement(cx_symtab_node *p_function_id) {
             break;
         case tc_FOR: execute_FOR(p_function_id);
             break;
+        case tc_PARALLEL: execute_PARALLEL(p_function_id);
+            break;
+        case tc_ATOMIC:
+
+            // the declaration after it runs as any other
+            get_token();
+            execute_assignment(p_node);
+            break;
+        case tc_SPAWN:
+            execute_spawn();
+
+            // discard the unused handle
+            pop();
+            break;
         case tc_SWITCH: //parse_SWITCH();
             break;
         case tc_CASE:
@@ -110,6 +127,7 @@ void cx_executor::execute_IF(cx_symtab_node * p_function_id) {
 
     execute_expression();
     int condition = top()->basic_types.int__;
+    pop();
 
     // )
     get_token();
@@ -203,7 +221,10 @@ void cx_executor::execute_FOR(cx_symtab_node * p_function_id) {
         go_to(increment_marker);
         get_token();
         // expr 3
-        execute_expression();
+        if (token != tc_right_paren) {
+            execute_expression();
+            pop();
+        }
 
         go_to(condition_marker);
     } while (current_location() == condition_marker);
@@ -0,0 +1,264 @@
+/** Executor (Tasks)
+ * task.cpp
+ *
+ * Spawn calls to declared routines as tasks of the shared pool (see
+ * pool.cpp), and join them.  A task runs on an executor of its own:
+ * its stack has a program frame that shares the slots of the
+ * globals, and a frame of its own for the routine, and it reads the
+ * icode through views, as the workers of a parallel for do (see
+ * parallel.cpp).  The actuals are evaluated by the spawning thread,
+ * and array and record values are copied, so the routine's frame
+ * belongs to the task alone.
+ *
+ * Once a script has spawned a task, its streams are used by one task
+ * at a time (see cx_stream_lock).
+ */
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "cx-debug/exec.h"
+#include "pool.h"
+
+///  cx_spawned_task     A spawned call, and how it went.
+
+struct cx_spawned_task {
+    cx_task_group group;
+    const cx_symtab_node *p_function_id;
+    mem_block result; // the routine's value
+    long statement_count;
+    int line_number; // the task's, from the spawn's on
+    bool aborted;
+    cx_abort abort;
+};
+
+///  cx_task_table       The tasks of a script not yet joined.
+
+struct cx_task_table {
+    std::mutex mutex; // guards tasks and next_handle
+    std::unordered_map<int, cx_spawned_task *> tasks; // by handle
+    int next_handle;
+
+    std::mutex stream_mutex; // see cx_stream_lock
+
+    cx_task_table(void) : next_handle(1) {
+    }
+};
+
+/** task_table           The task table of a script, made on its first
+ *                      spawn.  Until then no other thread runs the
+ *                      script, so there's no race to make it.
+ *
+ * @param p_context : context of the script.
+ * @return the table.
+ */
+static cx_task_table &task_table(cx_context *p_context) {
+    if (p_context->p_tasks == nullptr) p_context->p_tasks = new cx_task_table;
+
+    return *p_context->p_tasks;
+}
+
+/** take_task            Take a task out of its script's table, to
+ *                      join it.
+ *
+ * @param p_context : context of the script.
+ * @param handle    : the task's handle, or 0 for any task.
+ * @return ptr to the task, or nullptr if there's no such task.
+ */
+static cx_spawned_task *take_task(cx_context *p_context, int handle) {
+    cx_task_table *p_table = p_context->p_tasks;
+    if (p_table == nullptr) return nullptr;
+
+    std::lock_guard<std::mutex> lock(p_table->mutex);
+
+    auto it = (handle == 0) ? p_table->tasks.begin() : p_table->tasks.find(handle);
+    if (it == p_table->tasks.end()) return nullptr;
+
+    cx_spawned_task *p_task = it->second;
+    p_table->tasks.erase(it);
+
+    return p_task;
+}
+
+/** cx_task_release_all  Wait for the tasks of a script still running,
+ *                      and free its task table, as its context is
+ *                      torn down.  How the tasks went doesn't matter
+ *                      any more.
+ *
+ * @param p_context : ptr to the context.
+ */
+void cx_task_release_all(cx_context *p_context) {
+    if (p_context->p_tasks == nullptr) return;
+
+    // the tasks waited for may spawn more
+    while (cx_spawned_task *p_task = take_task(p_context, 0)) {
+        cx_task_pool::shared().wait(p_task->group);
+        delete p_task;
+    }
+
+    delete p_context->p_tasks;
+    p_context->p_tasks = nullptr;
+}
+
+///  cx_stream_lock      Lock the script's streams, if it has tasks.
+
+cx_stream_lock::cx_stream_lock(const cx_context *p_context)
+: p_mutex((p_context->p_tasks != nullptr) ? &p_context->p_tasks->stream_mutex : nullptr) {
+    if (p_mutex != nullptr) p_mutex->lock();
+}
+
+cx_stream_lock::~cx_stream_lock(void) {
+    if (p_mutex != nullptr) p_mutex->unlock();
+}
+
+/** execute_spawn        Execute a spawn:  evaluate the actuals and
+ *                      add the call to the pool as a task.  Leaves
+ *                      the task's handle on the stack.
+ *
+ *      spawn <id> ( <call-marker> <actual>, ... )
+ *
+ * @return: ptr to the int type object
+ */
+cx_type *cx_executor::execute_spawn(void) {
+    get_token(); // the routine
+    cx_symtab_node *p_function_id = p_node;
+    std::vector<mem_block> args;
+
+    // the actuals are left on the stack, as for a call
+    get_token();
+    if (token == tc_left_paren) {
+        execute_actual_parameters();
+
+        args.resize(p_function_id->defn.routine.parm_count);
+        for (int i = args.size() - 1; i >= 0; --i) {
+            args[i] = top()->basic_types;
+            pop();
+        }
+    }
+
+    cx_spawned_task *p_task = new cx_spawned_task;
+
+    p_task->p_function_id = p_function_id;
+    memset(&p_task->result, 0, sizeof (p_task->result));
+    p_task->statement_count = 0;
+    p_task->line_number = cx_runtime_line(p_context);
+    p_task->aborted = false;
+
+    cx_task_table &table = task_table(p_context);
+    int handle;
+
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        handle = table.next_handle++;
+        table.tasks[handle] = p_task;
+    }
+
+    cx_context *p_task_context = p_context;
+    const std::vector<cx_stack_item *> global_slots =
+            run_stack.global_slots(p_context->p_program_ptr_id);
+
+    cx_task_pool::shared().add(p_task->group,
+            [p_task_context, global_slots, p_function_id, args, p_task]() {
+                cx_executor worker(p_task_context);
+
+                worker.execute_task(global_slots, p_function_id, args, *p_task);
+            });
+
+    push(handle);
+
+    return p_context->p_integer_type;
+}
+
+/** execute_task         Execute a spawned call, on a worker's
+ *                      executor.
+ *
+ * @param global_slots  : the slots of the spawner's program frame.
+ * @param p_function_id : ptr to the routine's symtab node.
+ * @param args          : the actuals, one per formal.
+ * @param task          : the task, which gets the routine's value
+ *                        and how the run went.
+ */
+void cx_executor::execute_task(const std::vector<cx_stack_item *> &global_slots,
+        cx_symtab_node *p_function_id, const std::vector<mem_block> &args,
+        cx_spawned_task &task) {
+    cx_context_scope scope(p_context);
+    int *p_saved_line = cx_worker_line_number;
+
+    cx_worker_line_number = &task.line_number;
+    is_worker = true;
+    run_stack.share_globals(global_slots);
+    p_icode = icode_of(p_context->p_program_ptr_id->defn.routine.p_icode);
+
+    try {
+        task.result = call(p_function_id, args.data());
+    } catch (const cx_abort &abort) {
+        task.aborted = true;
+        task.abort = abort;
+    }
+
+    task.statement_count = statement_count;
+    cx_worker_line_number = p_saved_line;
+}
+
+/** execute_join_call    Execute a call to join, which waits for a
+ *                      task and leaves the int its routine returned
+ *                      on the stack, or 0 if its value isn't an int.
+ *                      A runtime error in the task ends the joiner
+ *                      too.
+ *
+ *      join(<handle-expr>)
+ *
+ * @param p_function_id : ptr to the routine name's symtab node
+ *
+ * @return: ptr to the call's type object
+ */
+cx_type *cx_executor::execute_join_call(cx_symtab_node *p_function_id) {
+    get_token(); // (
+    get_token();
+    execute_expression();
+    const int handle = top()->basic_types.int__;
+    pop();
+
+    get_token(); // token after )
+
+    cx_spawned_task *p_task = take_task(p_context, handle);
+    if (p_task == nullptr) cx_runtime_error(rte_invalid_task);
+
+    cx_task_pool::shared().wait(p_task->group);
+    statement_count += p_task->statement_count;
+
+    if (p_task->aborted) {
+        const cx_abort abort = p_task->abort;
+
+        delete p_task;
+        throw abort;
+    }
+
+    push((p_task->p_function_id->p_type == p_context->p_integer_type)
+            ? p_task->result.int__ : 0);
+    delete p_task;
+
+    return p_function_id->p_type;
+}
+
+/** join_tasks           Join every task not yet joined, as the
+ *                      program ends:  the tasks share its globals.
+ */
+void cx_executor::join_tasks(void) {
+    while (cx_spawned_task *p_task = take_task(p_context, 0)) {
+        cx_task_pool::shared().wait(p_task->group);
+        statement_count += p_task->statement_count;
+
+        if (p_task->aborted) {
+            const cx_abort abort = p_task->abort;
+
+            delete p_task;
+            throw abort;
+        }
+
+        delete p_task;
+    }
+}
@@ -29,7 +29,7 @@ void cx_executor::trace_routine_exit(const cx_symtab_node *p_function_id) {
 /** trace_statement      Trace the execution of a statement.
  */
 void cx_executor::trace_statement(void) {
-    if (trace_statement_flag) std::cout << ">>  At " << current_line_number
+    if (trace_statement_flag) std::cout << ">>  At " << p_context->current_line_number
             << std::endl;
 }
 
@@ -89,26 +89,26 @@ void cx_executor::trace_data_value(const cx_stack_item &p_data_value,
 
     std::stringstream text;
 
-    if (p_data_type == p_float_type) {
+    if (p_data_type == p_context->p_float_type) {
         text << p_data_value.basic_types.float__;
-    } else if (p_data_type == p_char_type) {
+    } else if (p_data_type == p_context->p_char_type) {
         text << '\'' << p_data_value.basic_types.char__ << '\'';
-    } else if (p_data_type == p_integer_type) {
+    } else if (p_data_type == p_context->p_integer_type) {
         text << p_data_value.basic_types.int__;
-    } else if (p_data_type == p_wchar_type) {
+    } else if (p_data_type == p_context->p_wchar_type) {
         text << '\'' << p_data_value.basic_types.wchar__ << '\'';
-    } else if (p_data_type == p_uint8_type) {
+    } else if (p_data_type == p_context->p_uint8_type) {
         text << p_data_value.basic_types.uint8__;
-    } else if (p_data_type == p_uint16_type) {
+    } else if (p_data_type == p_context->p_uint16_type) {
         text << p_data_value.basic_types.uint16__;
-    } else if (p_data_type == p_uint32_type) {
+    } else if (p_data_type == p_context->p_uint32_type) {
         text << p_data_value.basic_types.uint32__;
-    } else if (p_data_type == p_uint64_type) {
+    } else if (p_data_type == p_context->p_uint64_type) {
         text << p_data_value.basic_types.uint64__;
-    } else if (p_data_type == p_boolean_type) {
+    } else if (p_data_type == p_context->p_boolean_type) {
         text << std::boolalpha << p_data_value.basic_types.bool__;
     } else if (p_data_type->form == fc_array) {
-        if (p_data_type->array.p_element_type == p_char_type) {
+        if (p_data_type->array.p_element_type == p_context->p_char_type) {
             text << '\"' << (char *) p_data_value.basic_types.addr__ << '\"';
         } else text << "<array>";
     } else if (p_data_type->form == fc_complex) {
@@ -8,14 +8,10 @@
 #include <cstring>
 #include <cstdio>
 #include <iostream>
-#include "buffer.h"
+#include "context.h"
+#include "cx-debug/exec.h"
 #include "error.h"
-
-int error_count = 0; // count of syntax errors
-bool error_arrow_flag = true; // true if print arrows under syntax
-
-//   errors, false if not
-int error_arrow_offset = 8; // offset for printing the error arrow
+#include "icode.h"
 
 ///  Abort messages      Keyed to enumeration type cx_abort_code.
 const char *abort_message[] = {
@@ -34,11 +30,24 @@ const char *abort_message[] = {
 
 /** abort_translation    A fatal error occurred during the
  *                     translation.  print the abort code
- *                     to the error file and then exit.
+ *                     to the error file and then exit.  In a
+ *                     host program, list it and throw instead.
  *
  * @param ac : abort code
  */
 void abort_translation(cx_abort_code ac) {
+    cx_context *p_context = cx_context::current();
+
+    if ((p_context != nullptr) && p_context->embedded) {
+        sprintf(p_context->list.text, "*** fatal translator error: %s",
+                abort_message[-ac]);
+        p_context->list.put_line();
+
+        throw cx_abort{ac};
+    }
+
+    // what the script wrote so far comes out before the message
+    cx_stream_flush_all();
     std::cerr << "*** fatal translator error: " << abort_message[-ac] << std::endl;
 
     std::cin.get();
@@ -111,7 +120,14 @@ const char *error_messages[] = {
     "Unimplemented feature",
     "Missing (",
     "Missing '",
-    "Invalid escape character"
+    "Invalid escape character",
+    "Invalid parallel for",
+    "Store into a shared variable in a parallel for",
+    "I/O or a call with side effects in a parallel for",
+    "Invalid spawn",
+    "Only int and uint variables can be atomic",
+    "Not an atomic variable",
+    "Atomic variable used outside an atomic routine"
 };
 
 /** cx_error       print an arrow under the error and then
@@ -121,11 +137,14 @@ const char *error_messages[] = {
  */
 void cx_error(cx_error_code ec) {
     const int max_syntax_errors = 0;
+    cx_context *p_context = cx_context::current();
+    cx_list_buffer &list = p_context->list;
 
-    int error_position = error_arrow_offset + input_position - 1;
+    int error_position = p_context->error_arrow_offset
+            + p_context->input_position - 1;
 
     // print the arrow pointing to the token just scanned.
-    if (error_arrow_flag) {
+    if (p_context->error_arrow_flag) {
         sprintf(list.text, "%*s^", error_position, " ");
         list.put_line();
     }
@@ -134,7 +153,7 @@ void cx_error(cx_error_code ec) {
     sprintf(list.text, "*** error: %s", error_messages[ec]);
     list.put_line();
 
-    if (++error_count > max_syntax_errors) {
+    if (++p_context->error_count > max_syntax_errors) {
         list.put_line("Too many syntax errors.  Translation aborted.");
         abort_translation(abort_too_many_syntax_errors);
     }
@@ -148,13 +167,34 @@ const char *runtime_error_messages[] = {
     "Division by zero",
     "Invalid standard function argument",
     "Invalid user input",
-    "Unimplemented runtime feature"
+    "Unimplemented runtime feature",
+    "Stream is not open",
+    "Not a task, or already joined",
+    "Not a channel",
+    "Value doesn't fit the channel",
+    "Too many channels"
 };
 
+/** cx_runtime_error   print the runtime error and exit.  In a
+ *                  host program, list it and throw instead.
+ *
+ * @param ec : runtime error code
+ */
 void cx_runtime_error(cx_runtime_error_code ec) {
-    extern int current_line_number;
+    cx_context *p_context = cx_context::current();
+
+    if (p_context->embedded) {
+        sprintf(p_context->list.text, "runtime error in line <%d>: %s",
+                cx_runtime_line(p_context), runtime_error_messages[ec]);
+        p_context->list.put_line();
+
+        throw cx_abort{abort_runtime_error};
+    }
 
-    std::cout << "\nruntime error in line <" << current_line_number << ">: "
+    // as abort_translation does
+    cx_stream_flush_all();
+    std::cout << "\nruntime error in line <"
+            << cx_runtime_line(p_context) << ">: "
             << runtime_error_messages[ec] << std::endl;
 
     exit(abort_runtime_error);
@@ -0,0 +1,140 @@
+/** Formats
+ * format.cpp
+ *
+ * Split printf formats into text and conversions.  A literal format
+ * is compiled once, when the call is parsed, and kept with its entry
+ * in the string constant pool.
+ */
+
+#include <cctype>
+#include "common.h"
+#include "format.h"
+
+/** add_text             Append text to a format, joining it to the
+ *                      text before it.
+ *
+ * @param format : the format.
+ * @param p_text : ptr to the text.
+ * @param length : length of the text.
+ */
+static void add_text(cx_format &format, const char *p_text, int length) {
+    if (length == 0) return;
+
+    if (format.pieces.empty() || (format.pieces.back().conversion != '\0')) {
+        cx_format_piece piece;
+
+        piece.conversion = '\0';
+        piece.plain = true;
+        piece.left = false;
+        piece.width = piece.precision = -1;
+        format.pieces.push_back(piece);
+    }
+
+    format.pieces.back().text.append(p_text, length);
+}
+
+/** cx_compile_format    Split a format into its pieces.  Conversions
+ *                      are %d %i %u %x %X %o %c %s %f %e %E %g %G,
+ *                      with the flags -+ #0, a width and a precision.
+ *                      Length modifiers are accepted and ignored;
+ *                      each argument's type gives its size.
+ *
+ * @param p_text : ptr to the format.
+ * @param length : length of the format.
+ * @param format : gets the compiled format.
+ * @return false if the format isn't valid.
+ */
+bool cx_compile_format(const char *p_text, int length, cx_format &format) {
+    const char *p = p_text;
+    const char *p_end = p_text + length;
+
+    format.pieces.clear();
+    format.conversions.clear();
+
+    while (p < p_end) {
+        const char *p_percent = (const char *) memchr(p, '%', p_end - p);
+
+        if (p_percent == nullptr) {
+            add_text(format, p, (int) (p_end - p));
+            break;
+        }
+
+        add_text(format, p, (int) (p_percent - p));
+        p = p_percent + 1;
+
+        if ((p < p_end) && (*p == '%')) {
+            add_text(format, p++, 1);
+            continue;
+        }
+
+        cx_format_piece piece;
+        piece.left = false;
+        piece.width = piece.precision = -1;
+        piece.text = "%";
+
+        while ((p < p_end) && (strchr("-+ #0", *p) != nullptr)) {
+            if (*p == '-') piece.left = true;
+            piece.text += *p++;
+        }
+
+        if ((p < p_end) && isdigit(*p)) {
+            piece.width = 0;
+            while ((p < p_end) && isdigit(*p)) {
+                piece.width = 10 * piece.width + (*p - '0');
+                piece.text += *p++;
+            }
+        }
+
+        if ((p < p_end) && (*p == '.')) {
+            piece.precision = 0;
+            piece.text += *p++;
+            while ((p < p_end) && isdigit(*p)) {
+                piece.precision = 10 * piece.precision + (*p - '0');
+                piece.text += *p++;
+            }
+        }
+
+        while ((p < p_end) && (strchr("hlLqjzt", *p) != nullptr)) ++p;
+
+        if ((p == p_end) || (strchr("diuxXocsfeEgG", *p) == nullptr)) return false;
+
+        piece.conversion = *p++;
+        piece.plain = (piece.text.size() == 1);
+
+        /* a signed integer is formatted as long long, and an unsigned
+         * one at its own width:  as unsigned, or with ll if it's 64
+         * bits, see io.cpp */
+        if (strchr("diuxXo", piece.conversion) != nullptr) {
+            piece.wide_text = piece.text + "ll" + piece.conversion;
+        }
+        piece.text += piece.conversion;
+
+        format.pieces.push_back(piece);
+        format.conversions += piece.conversion;
+    }
+
+    return (int) format.conversions.size() <= cx_format::max_args;
+}
+
+/** cx_constant_format   The compiled format of a string literal,
+ *                      compiled on first use.
+ *
+ * @param p_data : ptr to the literal's pooled data.
+ * @return ptr to the format, or nullptr if it isn't valid.
+ */
+const cx_format *cx_constant_format(const char *p_data) {
+    const cx_string_constant *p_constant = cx_string_constant_of(p_data);
+
+    if (p_constant->p_format == nullptr) {
+        cx_format *p_format = new cx_format;
+
+        if (!cx_compile_format(p_data, p_constant->length, *p_format)) {
+            delete p_format;
+            return nullptr;
+        }
+
+        p_constant->p_format = p_format;
+    }
+
+    return p_constant->p_format;
+}
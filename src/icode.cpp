@@ -5,13 +5,13 @@
 #include "icode.h"
 
 const char *cx_symbol_strings[] = {
-    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
     //operators and punctuation
     "^", "&", "|", "~", "^=", "&=", "|=", "<<",
     "<<=", ">>", ">>=", "-", "-=", "+", "+=", "=", "--",
     "++", "/", "/=", "*", "*=", "<", ">", "==", "<=", ">=",
     "!=", "%", "%=", "[", "]", "?", "#", ".*", "(", ")", "{",
-    "}", ":", ";", ",", "...", ".", "::", "->", "->*", "||",
+    "}", ":", ";", ",", "...", ".", "..", "::", "->", "->*", "||",
     "&&", "!", "\'", "\"",
 
     "if", "return", "continue", "friend", "go_to", "try",
@@ -22,20 +22,50 @@ const char *cx_symbol_strings[] = {
     "noexcept", "export", "switch",
     "extern", "operator", "template", "const",
     "private", "this", "while", "protected", "threadlocal",
-    "for", "public", "throw", "default", "typedef", "mutable", "include"
+    "for", "public", "throw", "default", "typedef", "mutable", "include",
+    "parallel", "spawn", "atomic"
 };
 
+thread_local int *cx_worker_line_number = nullptr;
+
+/** cx_runtime_line      The line the thread running is at:  its
+ *                      worker's, or else the context's.
+ *
+ * @param p_context : context of the script running.
+ * @return the line number.
+ */
+int cx_runtime_line(const cx_context *p_context) {
+    return (cx_worker_line_number != nullptr)
+            ? *cx_worker_line_number : p_context->current_line_number;
+}
+
 /** Copy constructor    Make a copy of the icode.  Only copy as
  *                      many bytes of icode as necessary.
  *
  * @param icode : icode to copy.
  */
-cx_icode::cx_icode(const cx_icode &icode) {
+cx_icode::cx_icode(const cx_icode &icode) : p_context(icode.p_context) {
     int length = int(icode.cursor - icode.p_code); // length of icode
 
     // Copy icode.
     p_code = cursor = new char[length];
     memcpy(p_code, icode.p_code, length);
+    code_length = length;
+    is_view = false;
+}
+
+/** replace     Replace the code segment with rewritten icode,
+ *              as produced by the optimizer.
+ *
+ * @param p_new_code : ptr to the new code segment.
+ * @param length     : length of the new code segment in bytes.
+ */
+void cx_icode::replace(const char *p_new_code, int length) {
+    delete[] p_code;
+
+    p_code = cursor = new char[length];
+    memcpy(p_code, p_new_code, length);
+    code_length = length;
 }
 
 //cx_icode::append(const cx_icode& icode){
@@ -61,7 +91,7 @@ void cx_icode::check_bounds(int size) {
  * @param tc : token code.
  */
 void cx_icode::put(cx_token_code tc) {
-    if (error_count > 0) return;
+    if (p_context->error_count > 0) return;
 
     char code = tc;
     check_bounds(sizeof (char));
@@ -76,7 +106,7 @@ void cx_icode::put(cx_token_code tc) {
  * @param p_node : ptr to symtab node
  */
 void cx_icode::put(const cx_symtab_node *p_node) {
-    if (error_count > 0) return;
+    if (p_context->error_count > 0) return;
 
     short xsymtab = p_node->symtab_index();
     short xnode = p_node->node_index();
@@ -102,9 +132,14 @@ cx_token *cx_icode::get(void) {
     // Loop to process any line markers
     // and extract the next__ token code.
     do {
-        // First read the token code.
-        memcpy((void *) &code, (const void *) cursor, sizeof (char));
-        cursor += sizeof (char);
+        // First read the token code.  A copied segment ends
+        // at its last token, so there's nothing past it to read.
+        if ((code_length > 0) && (cursor >= p_code + code_length)) {
+            code = 0;
+        } else {
+            memcpy((void *) &code, (const void *) cursor, sizeof (char));
+            cursor += sizeof (char);
+        }
         token = (code > 0) ? (cx_token_code) code : tc_dummy;
 
         // If it's a line marker, extract the line number.
@@ -113,7 +148,8 @@ cx_token *cx_icode::get(void) {
 
             memcpy((void *) &number, (const void *) cursor,
                     sizeof (short));
-            current_line_number = number;
+            if (!is_view) p_context->current_line_number = number;
+            else if (cx_worker_line_number != nullptr) *cx_worker_line_number = number;
             cursor += sizeof (short);
         }
     } while (token == mc_line_marker);
@@ -131,6 +167,7 @@ cx_token *cx_icode::get(void) {
             break;
 
         case mc_location_marker:
+        case mc_call_marker:
             p_token = &special_token;
             p_token->code__ = token;
             break;
@@ -156,6 +193,7 @@ cx_token *cx_icode::get(void) {
             break;
 
         case mc_location_marker:
+        case mc_call_marker:
             p_node = nullptr;
             p_token->string[0] = '\0';
             break;
@@ -178,7 +216,6 @@ cx_token *cx_icode::get(void) {
  * @return ptr to the symbol table node
  */
 cx_symtab_node *cx_icode::get_symtab_node(void) {
-    extern cx_symtab **p_vector_symtabs;
     short xsymtab, xnode; // symbol table and node indexes
 
     memcpy((void *) &xsymtab, cursor,
@@ -187,7 +224,7 @@ cx_symtab_node *cx_icode::get_symtab_node(void) {
             sizeof (short));
     cursor += 2 * sizeof (short);
 
-    return p_vector_symtabs[xsymtab]->get(xnode);
+    return p_context->p_vector_symtabs[xsymtab]->get(xnode);
 }
 
 /** insert_line_marker    Insert a line marker into the
@@ -195,7 +232,7 @@ cx_symtab_node *cx_icode::get_symtab_node(void) {
  *                      last appended token code.
  */
 void cx_icode::insert_line_marker(void) {
-    if (error_count > 0) return;
+    if (p_context->error_count > 0) return;
 
     // Remember the last appended token code;
     char last_code;
@@ -205,7 +242,7 @@ void cx_icode::insert_line_marker(void) {
     // Insert a statement marker code
     // followed by the current line number.
     char code = mc_line_marker;
-    short number = current_line_number;
+    short number = p_context->current_line_number;
     check_bounds(sizeof (char) + sizeof (short));
     memcpy((void *) cursor, (const void *) &code, sizeof (char));
     cursor += sizeof (char);
@@ -223,7 +260,7 @@ void cx_icode::insert_line_marker(void) {
  * @return location of the location marker's offset.
  */
 int cx_icode::put_location_marker(void) {
-    if (error_count > 0) return 0;
+    if (p_context->error_count > 0) return 0;
 
     // Append the location marker code.
     char code = mc_location_marker;
@@ -271,6 +308,38 @@ int cx_icode::get_location_marker(void) {
     return int(offset);
 }
 
+/** put_call_marker       Append a call marker to the intermediate
+ *                      code.
+ *
+ * @param index : index of the call's call site.
+ */
+void cx_icode::put_call_marker(int index) {
+    if (p_context->error_count > 0) return;
+
+    char code = mc_call_marker;
+    short xsite = index;
+
+    check_bounds(sizeof (char) + sizeof (short));
+    memcpy((void *) cursor, (const void *) &code, sizeof (char));
+    cursor += sizeof (char);
+    memcpy((void *) cursor, (const void *) &xsite, sizeof (short));
+    cursor += sizeof (short);
+}
+
+/** get_call_marker       Extract a call marker from the
+ *                      intermediate code.
+ *
+ * @return index of the call site.
+ */
+int cx_icode::get_call_marker(void) {
+    short xsite;
+
+    memcpy((void *) &xsite, (const void *) cursor, sizeof (short));
+    cursor += sizeof (short);
+
+    return int(xsite);
+}
+
 /** put_case_item         Append a CASE item to the intermediate
  *                      code.
  *
@@ -278,7 +347,7 @@ int cx_icode::get_location_marker(void) {
  * @param location: location of CASE branch statement
  */
 void cx_icode::put_case_item(int value, int location) {
-    if (error_count > 0) return;
+    if (p_context->error_count > 0) return;
 
     short offset = location & 0xffff;
 
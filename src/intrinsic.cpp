@@ -0,0 +1,459 @@
+/** Intrinsics
+ * intrinsic.cpp
+ *
+ * Native code for the routines of stdlib/cxctype, cxmath and
+ * cxstring.  When a module is included, each of its routines
+ * that has an intrinsic of the same name and signature is bound
+ * to it, and calls to it skip the interpreter entirely.  Each
+ * intrinsic must give the same results as the Cx source.  The
+ * string intrinsics also stop at the end of each array, where
+ * the Cx source would run past it.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "common.h"
+#include "intrinsic.h"
+#include "strscan.h"
+
+/*************
+ *           *
+ *  cxctype  *
+ *           *
+ *************/
+
+enum cx_char_class {
+    cc_is_digit = 0x001,
+    cc_is_xdigit = 0x002,
+    cc_is_lower = 0x004,
+    cc_is_upper = 0x008,
+    cc_is_space = 0x010,
+    cc_is_blank = 0x020,
+    cc_is_cntrl = 0x040,
+    cc_is_graph = 0x080,
+    cc_is_punct = 0x100,
+};
+
+/** cx_char_class_table  Class bits of every char, by unsigned
+ *                      char.
+ */
+struct cx_char_class_table {
+    unsigned short bits[256];
+};
+
+/** make_char_classes    Class bits of every char, defined as in
+ *                      cxctype:  chars are signed, so bytes above
+ *                      127 are neither control chars nor alphanumeric.
+ *
+ * @return the table.
+ */
+static cx_char_class_table make_char_classes(void) {
+    cx_char_class_table classes;
+
+    for (int i = 0; i < 256; ++i) {
+        const signed char c = (signed char) i;
+        unsigned short bits = 0;
+
+        if ((c >= '0') && (c <= '9')) bits |= cc_is_digit;
+        if ((bits & cc_is_digit) || ((c >= 'a') && (c <= 'f'))
+                || ((c >= 'A') && (c <= 'F'))) bits |= cc_is_xdigit;
+        if ((c >= 'a') && (c <= 'z')) bits |= cc_is_lower;
+        if ((c >= 'A') && (c <= 'Z')) bits |= cc_is_upper;
+        if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\v')
+                || (c == '\f') || (c == '\r')) bits |= cc_is_space;
+        if ((c == ' ') || (c == '\t')) bits |= cc_is_blank;
+        if (((c >= 0) && (c <= 31)) || (c == 127)) bits |= cc_is_cntrl;
+        if (!(bits & cc_is_cntrl) && !(bits & cc_is_space)) bits |= cc_is_graph;
+        if ((bits & cc_is_graph) && !(bits & (cc_is_digit | cc_is_lower
+                | cc_is_upper))) bits |= cc_is_punct;
+
+        classes.bits[i] = bits;
+    }
+
+    return classes;
+}
+
+/** char_classes         Class bits of every char, made once for
+ *                      every thread.
+ */
+static const unsigned short *char_classes(void) {
+    static const cx_char_class_table classes = make_char_classes();
+
+    return classes.bits;
+}
+
+/** char_is              Test a char argument's class.
+ *
+ * @param p_args : ptr to the argument.
+ * @param mask   : class bits, any of which will do.
+ * @return a bool value.
+ */
+static mem_block char_is(const cx_intrinsic_arg *p_args, unsigned short mask) {
+    mem_block result;
+
+    result.bool__ = (char_classes()[(unsigned char) p_args[0].value.char__]
+            & mask) != 0;
+
+    return result;
+}
+
+static mem_block native_isdigit(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_digit);
+}
+
+static mem_block native_isxdigit(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_xdigit);
+}
+
+static mem_block native_islower(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_lower);
+}
+
+static mem_block native_isupper(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_upper);
+}
+
+static mem_block native_isalpha(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_lower | cc_is_upper);
+}
+
+static mem_block native_isalnum(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_digit | cc_is_lower | cc_is_upper);
+}
+
+static mem_block native_isspace(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_space);
+}
+
+static mem_block native_isblank(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_blank);
+}
+
+static mem_block native_iscntrl(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_cntrl);
+}
+
+static mem_block native_isprint(const cx_intrinsic_arg *p_args) {
+    mem_block result = char_is(p_args, cc_is_cntrl);
+
+    result.bool__ = !result.bool__;
+
+    return result;
+}
+
+static mem_block native_isgraph(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_graph);
+}
+
+static mem_block native_ispunct(const cx_intrinsic_arg *p_args) {
+    return char_is(p_args, cc_is_punct);
+}
+
+static mem_block native_toupper(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    const char c = p_args[0].value.char__;
+
+    result.char__ = (char_classes()[(unsigned char) c] & cc_is_lower)
+            ? (char) (c - 32) : c;
+
+    return result;
+}
+
+static mem_block native_tolower(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    const char c = p_args[0].value.char__;
+
+    result.char__ = (char_classes()[(unsigned char) c] & cc_is_upper)
+            ? (char) (c + 32) : c;
+
+    return result;
+}
+
+/************
+ *          *
+ *  cxmath  *
+ *          *
+ ************/
+
+/** native_igcd          Greatest common divisor, by remainders
+ *                      rather than the Cx source's subtractions.
+ *                      Also defined where the Cx source never
+ *                      returns:  igcd(0, y) is |y|.
+ */
+static mem_block native_igcd(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    int x = std::abs(p_args[0].value.int__);
+    int y = std::abs(p_args[1].value.int__);
+
+    while (y != 0) {
+        const int r = x % y;
+        x = y;
+        y = r;
+    }
+
+    result.int__ = x;
+
+    return result;
+}
+
+static mem_block native_isqrt(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    const int num = p_args[0].value.int__;
+
+    // exact:  every int is a double, and sqrt rounds correctly
+    result.int__ = (num > 0) ? (int) std::floor(std::sqrt((double) num)) : 0;
+
+    return result;
+}
+
+static mem_block native_isqrt_approx(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    int val_int = p_args[0].value.int__;
+
+    val_int -= 1 << 23;
+    val_int >>= 1;
+    val_int += 1 << 29;
+    result.int__ = val_int;
+
+    return result;
+}
+
+/**************
+ *            *
+ *  cxstring  *
+ *            *
+ **************/
+
+/** array_of             Data and size of an array argument.  A
+ *                      char, such as a one char literal, is an
+ *                      array of one.
+ *
+ * @param arg    : the argument.
+ * @param p_size : gets the size of the array, in chars.
+ * @return ptr to the array's data.
+ */
+static char *array_of(const cx_intrinsic_arg &arg, size_t *p_size) {
+    if (arg.p_type->is_scalar_type()) {
+        *p_size = 1;
+
+        return arg.reference ? (char *) arg.value.addr__
+                : (char *) &arg.value.char__;
+    }
+
+    char *p_data = (char *) arg.value.addr__;
+
+    *p_size = cx_value_size(arg.p_type, p_data);
+
+    return p_data;
+}
+
+/** count_of             A count argument, limited to a size.
+ *
+ * @param arg  : the argument.
+ * @param size : the limit.
+ * @return the count; 0 if the argument is negative.
+ */
+static size_t count_of(const cx_intrinsic_arg &arg, size_t size) {
+    const int count = arg.value.int__;
+
+    if (count < 0) return 0;
+
+    return ((size_t) count < size) ? (size_t) count : size;
+}
+
+static mem_block native_strlen(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    size_t size;
+    const char *p_string = array_of(p_args[0], &size);
+
+    result.int__ = (int) cx_find_char_or_nul(p_string, size, '\0');
+
+    return result;
+}
+
+static mem_block native_strchr(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    size_t size;
+    const char *p_string = array_of(p_args[0], &size);
+    const char c = p_args[1].value.char__;
+    const size_t i = cx_find_char_or_nul(p_string, size, c);
+
+    // the end of the array ends the string, as a '\0' would
+    if (i == size) result.int__ = (c == '\0') ? (int) size : -1;
+    else result.int__ = (p_string[i] == c) ? (int) i : -1;
+
+    return result;
+}
+
+static mem_block native_memchr(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    size_t size;
+    const char *p_data = array_of(p_args[0], &size);
+    const void *p_found = memchr(p_data, p_args[1].value.char__,
+            count_of(p_args[2], size));
+
+    result.int__ = (p_found != nullptr) ? (int) ((const char *) p_found - p_data) : -1;
+
+    return result;
+}
+
+static mem_block native_strcmp(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    size_t size1, size2;
+    const char *p_string1 = array_of(p_args[0], &size1);
+    const char *p_string2 = array_of(p_args[1], &size2);
+
+    result.int__ = cx_compare_strings(p_string1, size1, p_string2, size2);
+
+    return result;
+}
+
+static mem_block native_strstr(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    size_t size, pattern_size;
+    const char *p_string = array_of(p_args[0], &size);
+    const char *p_pattern = array_of(p_args[1], &pattern_size);
+
+    result.int__ = (int) cx_find_substring(
+            p_string, cx_find_char_or_nul(p_string, size, '\0'),
+            p_pattern, cx_find_char_or_nul(p_pattern, pattern_size, '\0'));
+
+    return result;
+}
+
+/** native_memcpy        Copy chars, no more than either array holds.
+ *                      The source is a value parm, so the copy is
+ *                      made as if from a copy of it:  memmove.
+ */
+static mem_block native_memcpy(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    size_t size, source_size;
+    char *p_destination = array_of(p_args[0], &size);
+    const char *p_source = array_of(p_args[1], &source_size);
+    const size_t count = count_of(p_args[2],
+            (size < source_size) ? size : source_size);
+
+    memmove(p_destination, p_source, count);
+    result.int__ = (int) count;
+
+    return result;
+}
+
+static mem_block native_memset(const cx_intrinsic_arg *p_args) {
+    mem_block result;
+    size_t size;
+    char *p_data = array_of(p_args[0], &size);
+    const size_t count = count_of(p_args[2], size);
+
+    memset(p_data, p_args[1].value.char__, count);
+    result.int__ = (int) count;
+
+    return result;
+}
+
+static const cx_intrinsic intrinsics[] = {
+    {"isdigit", "bool(char)", native_isdigit},
+    {"isxdigit", "bool(char)", native_isxdigit},
+    {"islower", "bool(char)", native_islower},
+    {"isupper", "bool(char)", native_isupper},
+    {"isalpha", "bool(char)", native_isalpha},
+    {"isalnum", "bool(char)", native_isalnum},
+    {"isspace", "bool(char)", native_isspace},
+    {"isblank", "bool(char)", native_isblank},
+    {"iscntrl", "bool(char)", native_iscntrl},
+    {"isprint", "bool(char)", native_isprint},
+    {"isgraph", "bool(char)", native_isgraph},
+    {"ispunct", "bool(char)", native_ispunct},
+    {"toupper", "char(char)", native_toupper},
+    {"tolower", "char(char)", native_tolower},
+    {"igcd", "int(int,int)", native_igcd},
+    {"isqrt", "int(int)", native_isqrt},
+    {"isqrt_approx", "int(int)", native_isqrt_approx},
+    {"strlen", "int(char*)", native_strlen},
+    {"strchr", "int(char*,char)", native_strchr},
+    {"memchr", "int(char*,char,int)", native_memchr},
+    {"strcmp", "int(char*,char*)", native_strcmp},
+    {"strstr", "int(char*,char*)", native_strstr},
+    {"memcpy", "int(char*&,char*,int)", native_memcpy},
+    {"memset", "int(char*&,char,int)", native_memset},
+    {nullptr, nullptr, nullptr}
+};
+
+/** type_name            Name of a type in a signature.
+ *
+ * @param p_type : ptr to the type object.
+ * @return the name; arrays of unknown size end in '*'.
+ */
+static std::string type_name(const cx_type *p_type) {
+    if (p_type->form == fc_array) {
+        return type_name(p_type->array.p_element_type)
+                + ((p_type->size == 0) ? "*" : "[]");
+    }
+
+    return (p_type->p_type_id != nullptr) ? p_type->p_type_id->string__() : "?";
+}
+
+/** signature_of         Signature of a declared routine, as the
+ *                      intrinsics table spells them.
+ *
+ * @param p_function_id : ptr to the routine's symtab node.
+ * @return the signature.
+ */
+static std::string signature_of(const cx_symtab_node *p_function_id) {
+    std::string signature = type_name(p_function_id->p_type) + "(";
+
+    for (const cx_symtab_node *p_parm_id =
+            p_function_id->defn.routine.locals.p_parms_ids;
+            p_parm_id != nullptr; p_parm_id = p_parm_id->next__) {
+        if (p_parm_id != p_function_id->defn.routine.locals.p_parms_ids) {
+            signature += ",";
+        }
+
+        signature += type_name(p_parm_id->p_type);
+        if (p_parm_id->defn.how == dc_reference) signature += "&";
+    }
+
+    return signature + ")";
+}
+
+/** cx_bind_intrinsics   Bind the routines of a symbol table that
+ *                      have intrinsics to them.  Routines whose
+ *                      signature differs keep running their Cx code,
+ *                      and so do the program's own routines.
+ *
+ * @param p_symtab   : ptr to the symbol table.
+ * @param first_node : index of the first node entered by the module.
+ */
+void cx_bind_intrinsics(cx_symtab *p_symtab, int first_node) {
+    for (const cx_intrinsic *p_intrinsic = intrinsics;
+            p_intrinsic->p_name != nullptr; ++p_intrinsic) {
+        cx_symtab_node *p_function_id = p_symtab->search(p_intrinsic->p_name);
+
+        if ((p_function_id == nullptr)
+                || (p_function_id->node_index() < first_node)
+                || (p_function_id->defn.how != dc_function)
+                || (p_function_id->defn.routine.which != rc_declared)
+                || (signature_of(p_function_id) != p_intrinsic->p_signature)) {
+            continue;
+        }
+
+        p_function_id->defn.routine.which = rc_intrinsic;
+        p_function_id->defn.routine.p_intrinsic = p_intrinsic;
+    }
+}
+
+/** cx_find_intrinsic    The intrinsic of a given name.
+ *
+ * @param p_name : ptr to the routine's name.
+ * @return ptr to the intrinsic, or nullptr if there is none.
+ */
+const cx_intrinsic *cx_find_intrinsic(const char *p_name) {
+    for (const cx_intrinsic *p_intrinsic = intrinsics;
+            p_intrinsic->p_name != nullptr; ++p_intrinsic) {
+        if (strcmp(p_intrinsic->p_name, p_name) == 0) return p_intrinsic;
+    }
+
+    return nullptr;
+}
@@ -9,19 +9,20 @@
 #include <chrono>
 #endif
 
+#include "batch.h"
 #include "error.h"
 #include "buffer.h"
 #include "parser.h"
 #include "symtable.h"
 #include "common.h"
 #include "icode.h"
+#include "optimizer.h"
+#include "precompiled.h"
 
-// turn on to view Cx debugging
-#ifdef __CX_DEBUG__
-bool cx_dev_debug_flag = true;
-#else
-bool cx_dev_debug_flag = false;
-#endif
+// set by --batch, -j and --slice, see batch.h
+static const char *p_batch_directory = nullptr;
+static int batch_job_count = 0;
+static long batch_slice = cx_batch_default_slice;
 
 void set_options(int argc, char **argv);
 
@@ -36,66 +37,103 @@ int main(int argc, char *argv[]) {
     // Check the command line arguments.
     if (argc < 2) {
         std::cerr << "usage: " << argv[0] << " <source file>" << std::endl;
+        std::cerr << "       " << argv[0] << " --batch <directory> [-j <jobs>]"
+                << " [--slice <statements>]" << std::endl;
         abort_translation(abort_invalid_commandline_args);
     }
 
     set_options(argc, argv);
 
-    list_flag = cx_dev_debug_flag;
-    error_arrow_flag = cx_dev_debug_flag;
+    if (p_batch_directory != nullptr) {
+        return cx_run_batch(p_batch_directory, batch_job_count, batch_slice);
+    }
+
+    // everything the script's parse and run share
+    cx_context *p_context = new cx_context;
+    cx_context_scope scope(p_context);
 
-    // Create the parser for the source file,
-    // and then parse the file.
-    cx_parser *p_parser = new cx_parser(new cx_source_buffer(argv[1]));
+    p_context->list_flag = cx_dev_debug_flag;
+    p_context->error_arrow_flag = cx_dev_debug_flag;
 
+    // a script kept from an earlier run is not parsed again
+    const std::string cache_path =
+            cx_dev_debug_flag ? "" : cx_precompiled_path(argv[1]);
+    cx_symtab_node *p_program_id = cache_path.empty() ? nullptr
+            : cx_load_precompiled(p_context, argv[1], cache_path.c_str());
+
+    if (p_program_id == nullptr) {
+        // Create the parser for the source file,
+        // and then parse the file.
+        cx_parser *p_parser = new cx_parser(p_context,
+                new cx_source_buffer(p_context, argv[1]));
 
 #ifdef __CX_PROFILE_EXECUTION__
-    using namespace std::chrono;
-    high_resolution_clock::time_point t1 = high_resolution_clock::now();
+        using namespace std::chrono;
+        high_resolution_clock::time_point t1 = high_resolution_clock::now();
 #endif
 
-    cx_symtab_node *p_program_id = p_parser->parse();
+        p_program_id = p_parser->parse();
 
 #ifdef __CX_PROFILE_EXECUTION__
-    high_resolution_clock::time_point t2 = high_resolution_clock::now();
-    duration<double> time_span = duration_cast < duration<double >> (t2 - t1);
-    std::std::cout << "finished parsing in: " << time_span.count() << "(secs)" << std::std::endl;
+        high_resolution_clock::time_point t2 = high_resolution_clock::now();
+        duration<double> time_span = duration_cast < duration<double >> (t2 - t1);
+        std::std::cout << "finished parsing in: " << time_span.count() << "(secs)" << std::std::endl;
 #endif
 
-    delete p_parser;
+        delete p_parser;
+
+        if (p_context->error_count == 0) {
+            p_context->convert_symtabs();
 
-    if (error_count == 0) {
-        p_vector_symtabs = new cx_symtab *[symtab_count];
-        for (cx_symtab *p_st = p_symtab_list; p_st; p_st = p_st->next()) {
-            if (p_st != nullptr) {
-                if (p_st->root() != nullptr)p_st->convert(p_vector_symtabs);
+            if (cx_optimize_flag) {
+                cx_optimizer optimizer(p_context);
+                optimizer.optimize(p_program_id);
+            }
+
+            if (!cache_path.empty()) {
+                cx_save_precompiled(p_context, p_program_id, argv[1],
+                        cache_path.c_str());
             }
         }
+    }
 
-        cx_backend *p_backend = new cx_executor;
+    if (p_context->error_count == 0) {
+        cx_backend *p_backend = new cx_executor(p_context);
 
 #ifdef __CX_PROFILE_EXECUTION__
+        using namespace std::chrono;
         std::cin.get();
-        t1 = high_resolution_clock::now();
+        high_resolution_clock::time_point t1 = high_resolution_clock::now();
 #endif
 
         p_backend->go(p_program_id);
 
 #ifdef __CX_PROFILE_EXECUTION__
-        t2 = high_resolution_clock::now();
-        time_span = duration_cast < duration<double >> (t2 - t1);
+        high_resolution_clock::time_point t2 = high_resolution_clock::now();
+        duration<double> time_span = duration_cast < duration<double >> (t2 - t1);
         std::std::cout << "finished executing in: " << time_span.count() << "(secs)" << std::std::endl;
 #endif
 
-        delete[] p_vector_symtabs;
         delete p_backend;
     }
 
+    delete p_context;
+
     return 0;
 }
 
 void set_options(int argc, char **argv) {
     for (int i = 1; i < argc; i++) {
         if (!strcmp("-ddev", argv[i])) cx_dev_debug_flag = true;
+        else if (!strcmp("-O0", argv[i])) cx_optimize_flag = false;
+        else if (!strcmp("--batch", argv[i]) && (i + 1 < argc)) {
+            p_batch_directory = argv[++i];
+        } else if (!strcmp("-j", argv[i]) && (i + 1 < argc)) {
+            batch_job_count = atoi(argv[++i]);
+        } else if (!strncmp("-j", argv[i], 2)) {
+            batch_job_count = atoi(argv[i] + 2);
+        } else if (!strcmp("--slice", argv[i]) && (i + 1 < argc)) {
+            batch_slice = atol(argv[++i]);
+        }
     }
 }
\ No newline at end of file
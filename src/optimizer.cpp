@@ -0,0 +1,1171 @@
+/** Optimizer
+ * optimizer.cpp
+ *
+ * Runs after parsing over the icode of each declared routine.
+ * Pure int and float subexpressions that do not change inside a
+ * do, while or for loop are computed once into a temporary just
+ * before the loop, and identical pure subexpressions within a run
+ * of straight line statements are computed once and reused.
+ *
+ * Reference parameters (dc_reference) and globals may alias each
+ * other, so a store to any of them, or a call, is treated as a
+ * store to all of them.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "common.h"
+#include "optimizer.h"
+
+extern bool cx_dev_debug_flag;
+
+/** is_shared           True if other names may refer to the
+ *                      variable's storage: reference parameters
+ *                      and globals.
+ *
+ * @param p_id : ptr to variable's symtab node.
+ * @return true if the variable may be aliased.
+ */
+static bool is_shared(const cx_symtab_node *p_id) {
+    return (p_id->defn.how == dc_reference) || (p_id->level == 0);
+}
+
+/** result_type         The type the executor gives the result of
+ *                      a binary operator on int and float operands.
+ *
+ * @param p_context : context of the types.
+ * @param op        : operator token.
+ * @param p_type1   : type of the left operand.
+ * @param p_type2   : type of the right operand.
+ * @return int or float type, or nullptr if the result is neither.
+ */
+static cx_type *result_type(const cx_context *p_context, cx_token_code op,
+        cx_type *p_type1, cx_type *p_type2) {
+    if ((p_type1 == nullptr) || (p_type2 == nullptr)) return nullptr;
+
+    bool integers = (p_type1 == p_context->p_integer_type)
+            && (p_type2 == p_context->p_integer_type);
+
+    switch (op) {
+        case tc_plus:
+        case tc_minus:
+        case tc_star:
+        case tc_divide:
+            return integers ? p_context->p_integer_type : p_context->p_float_type;
+        case tc_modulas:
+        case tc_bit_leftshift:
+        case tc_bit_rightshift:
+        case tc_bit_AND:
+        case tc_bit_XOR:
+        case tc_bit_OR:
+            return integers ? p_context->p_integer_type : nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+static void merge(cx_expr_info &info, const cx_expr_info &other) {
+    info.pure = info.pure && other.pure;
+    info.may_fault = info.may_fault || other.may_fault;
+    info.reads.insert(other.reads.begin(), other.reads.end());
+}
+
+static cx_expr_info new_expr_info(void) {
+    cx_expr_info info;
+
+    info.p_type = nullptr;
+    info.pure = true;
+    info.has_op = false;
+    info.may_fault = false;
+    info.nonzero_constant = false;
+
+    return info;
+}
+
+static cx_insn new_insn(cx_token_code tc, cx_symtab_node *p_node = nullptr,
+        int value = 0) {
+    cx_insn insn;
+
+    insn.code = tc;
+    insn.p_node = p_node;
+    insn.value = value;
+
+    return insn;
+}
+
+/** insn_size           Number of icode bytes a decoded insn
+ *                      occupies.
+ *
+ * @param tc : token code of the insn.
+ * @return size in bytes.
+ */
+static int insn_size(cx_token_code tc) {
+    switch (tc) {
+        case tc_identifier:
+        case tc_number:
+        case tc_string:
+        case tc_char:
+            return sizeof (char) + 2 * sizeof (short);
+        case mc_line_marker:
+        case mc_location_marker:
+        case mc_call_marker:
+            return sizeof (char) + sizeof (short);
+        default:
+            return sizeof (char);
+    }
+}
+
+/** optimize            Optimize the program's global icode and
+ *                      the icode of every declared function.
+ *
+ * @param p_program_id : ptr to the program's symtab node.
+ */
+void cx_optimizer::optimize(cx_symtab_node *p_program_id) {
+    cx_context_scope scope(p_context);
+    std::vector<cx_symtab_node *> routines;
+
+    if (p_program_id->defn.routine.p_icode != nullptr) {
+        routines.push_back(p_program_id);
+    }
+
+    for (cx_symtab *p_st = p_context->p_symtab_list; p_st; p_st = p_st->next()) {
+        if (p_st->root() == nullptr) continue;
+
+        cx_symtab_node **p_nodes = p_st->node_vector();
+        for (int i = 0; i < p_st->node_count(); ++i) {
+            cx_symtab_node *p_node = p_nodes[i];
+
+            if ((p_node->defn.how == dc_function)
+                    && (p_node->defn.routine.which == rc_declared)
+                    && (p_node->defn.routine.p_icode != nullptr)) {
+                routines.push_back(p_node);
+            }
+        }
+    }
+
+    for (cx_symtab_node *p_routine_id : routines) optimize_routine(p_routine_id);
+}
+
+/** optimize_routine    Analyse one routine's icode, plan the
+ *                      hoisted and shared subexpressions, and
+ *                      rewrite the icode.  A routine containing
+ *                      anything the analysis does not understand
+ *                      is left untouched.
+ *
+ * @param p_routine_id : ptr to the routine's symtab node.
+ */
+void cx_optimizer::optimize_routine(cx_symtab_node *p_routine_id) {
+    p_function_id = p_routine_id;
+    p_symtab = p_routine_id->defn.routine.p_symtab;
+    cx_icode *p_icode = p_routine_id->defn.routine.p_icode;
+
+    candidates.clear();
+    stmts.clear();
+    stmt_lists.clear();
+    inserts.clear();
+    replacements.clear();
+    pos = 0;
+    current_stmt = -1;
+    failed = false;
+    temp_count = hoist_count = cse_count = 0;
+
+    if ((p_symtab == nullptr) || !decode(p_icode)) return;
+
+    analyze_statement_list(tc_right_bracket, -1);
+    if (failed) return;
+
+    std::vector<int> top_level = stmt_lists.back();
+    for (int s : top_level) hoist_invariants(s);
+
+    for (const std::vector<int> &list : stmt_lists) {
+        eliminate_common_subexpressions(list);
+    }
+
+    if (replacements.empty()) return;
+
+    // Rebuild the insn list with the planned edits applied.
+    std::vector<int> remap(insns.size(), -1);
+    std::vector<cx_insn> rewritten;
+
+    for (int i = 0; i < (int) insns.size();) {
+        int first = rewritten.size();
+
+        auto at = inserts.find(i);
+        if (at != inserts.end()) {
+            rewritten.insert(rewritten.end(), at->second.begin(), at->second.end());
+        }
+
+        remap[i] = first;
+
+        auto rep = replacements.find(i);
+        if (rep != replacements.end()) {
+            rewritten.push_back(new_insn(tc_identifier, rep->second.second));
+            i = rep->second.first;
+        } else {
+            rewritten.push_back(insns[i++]);
+        }
+    }
+
+    for (cx_insn &insn : rewritten) {
+        if (insn.code == mc_location_marker) insn.value = remap[insn.value];
+    }
+
+    insns.swap(rewritten);
+    encode(p_icode);
+
+    // the routine's symtab gained temporaries
+    p_symtab->convert(p_context->p_vector_symtabs);
+
+    if (cx_dev_debug_flag) {
+        std::clog << "optimizer: " << p_routine_id->string__() << ": "
+                << hoist_count << " invariant(s) hoisted, "
+                << cse_count << " common subexpression(s)" << std::endl;
+    }
+}
+
+/** decode              Decode a routine's icode into insns.  Icode
+ *                      following the routine's closing bracket is
+ *                      kept as is.
+ *
+ * @param p_icode : ptr to the routine's icode.
+ * @return false if the icode could not be decoded.
+ */
+bool cx_optimizer::decode(const cx_icode *p_icode) {
+    const char *p_code = p_icode->code();
+    const int length = p_icode->length();
+    std::vector<int> insn_at(length + 1, -1);
+    int offset = 0;
+    int depth = 0;
+
+    insns.clear();
+    tail.clear();
+
+    while ((offset < length) && (depth >= 0)) {
+        char code = p_code[offset];
+        cx_insn insn = new_insn((code > 0) ? (cx_token_code) code : tc_dummy);
+
+        if (offset + insn_size(insn.code) > length) return false;
+
+        insn_at[offset] = insns.size();
+        offset += sizeof (char);
+
+        switch (insn.code) {
+            case tc_identifier:
+            case tc_number:
+            case tc_string:
+            case tc_char:
+            {
+                short xsymtab, xnode;
+
+                memcpy(&xsymtab, p_code + offset, sizeof (short));
+                memcpy(&xnode, p_code + offset + sizeof (short), sizeof (short));
+                offset += 2 * sizeof (short);
+
+                if ((xsymtab < 0) || (xsymtab >= p_context->symtab_count)) return false;
+
+                cx_symtab *p_st = p_context->p_vector_symtabs[xsymtab];
+                if (p_st == nullptr) return false;
+                if ((xnode < 0) || (xnode >= p_st->node_count())) return false;
+
+                insn.p_node = p_st->get(xnode);
+                if (insn.p_node == nullptr) return false;
+            }
+                break;
+            case mc_line_marker:
+            case mc_location_marker:
+            case mc_call_marker:
+            {
+                short value;
+
+                memcpy(&value, p_code + offset, sizeof (short));
+                offset += sizeof (short);
+                insn.value = value;
+            }
+                break;
+            case tc_left_bracket: ++depth;
+                break;
+            case tc_right_bracket: --depth;
+                break;
+            default:
+                break;
+        }
+
+        insns.push_back(insn);
+    }
+
+    tail.assign(p_code + offset, length - offset);
+
+    // Location markers point at insns rather than byte offsets.
+    for (cx_insn &insn : insns) {
+        if (insn.code != mc_location_marker) continue;
+
+        if ((insn.value < 0) || (insn.value >= length)
+                || (insn_at[insn.value] < 0)) return false;
+
+        insn.value = insn_at[insn.value];
+    }
+
+    return true;
+}
+
+/** encode              Encode the insns back into the routine's
+ *                      icode, patching every location marker.
+ *
+ * @param p_icode : ptr to the routine's icode.
+ */
+void cx_optimizer::encode(cx_icode *p_icode) {
+    std::vector<int> offsets(insns.size());
+    int length = 0;
+
+    for (int i = 0; i < (int) insns.size(); ++i) {
+        offsets[i] = length;
+        length += insn_size(insns[i].code);
+    }
+
+    if (length + (int) tail.size() > SHRT_MAX) return;
+
+    std::vector<char> code_segment(length + tail.size());
+    char *p_code = code_segment.data();
+
+    for (const cx_insn &insn : insns) {
+        char code = insn.code;
+        *p_code++ = code;
+
+        switch (insn.code) {
+            case tc_identifier:
+            case tc_number:
+            case tc_string:
+            case tc_char:
+            {
+                short xsymtab = insn.p_node->symtab_index();
+                short xnode = insn.p_node->node_index();
+
+                memcpy(p_code, &xsymtab, sizeof (short));
+                memcpy(p_code + sizeof (short), &xnode, sizeof (short));
+                p_code += 2 * sizeof (short);
+            }
+                break;
+            case mc_line_marker:
+            case mc_location_marker:
+            case mc_call_marker:
+            {
+                short value = (insn.code == mc_location_marker)
+                        ? offsets[insn.value] : insn.value;
+
+                memcpy(p_code, &value, sizeof (short));
+                p_code += sizeof (short);
+            }
+                break;
+            default:
+                break;
+        }
+    }
+
+    memcpy(p_code, tail.data(), tail.size());
+    p_icode->replace(code_segment.data(), code_segment.size());
+}
+
+/********************
+ *                  *
+ *  Analysis        *
+ *                  *
+ ********************/
+
+/** analyze_statement_list      Analyse statements up to the
+ *                              terminator token.
+ *
+ * @param terminator : token that ends the list.
+ * @param parent     : index of the owning statement, or -1.
+ */
+void cx_optimizer::analyze_statement_list(cx_token_code terminator, int parent) {
+    std::vector<int> list;
+
+    while (!failed && (pos < (int) insns.size()) && (code() != terminator)) {
+        int start = pos;
+        int s = analyze_statement(true);
+
+        list.push_back(s);
+        if (parent >= 0) stmts[parent].children.push_back(s);
+
+        while (code() == tc_semicolon) ++pos;
+
+        // no progress means icode this pass does not know
+        if (pos == start) failed = true;
+    }
+
+    stmt_lists.push_back(list);
+}
+
+/** analyze_statement   Analyse one statement, mirroring the way
+ *                      the executor walks it.
+ *
+ * @param in_list : true if the statement is directly inside a
+ *                  statement list, so code can be inserted
+ *                  before it.
+ * @return index of the statement.
+ */
+int cx_optimizer::analyze_statement(bool in_list) {
+    int s = stmts.size();
+    int saved_stmt = current_stmt;
+
+    stmts.push_back(cx_stmt());
+    stmts[s].kind = cx_stmt::sk_empty;
+    stmts[s].begin = pos;
+    stmts[s].in_list = in_list;
+    stmts[s].pure = true;
+    stmts[s].calls = false;
+    stmts[s].line_number = 0;
+    current_stmt = s;
+
+    while (code() == mc_line_marker) stmts[s].line_number = insns[pos++].value;
+
+    switch (code()) {
+        case tc_identifier:
+        {
+            cx_symtab_node *p_id = insns[pos].p_node;
+
+            if (p_id->defn.how == dc_function) {
+                cx_expr_info info = new_expr_info();
+
+                stmts[s].kind = cx_stmt::sk_call;
+                ++pos;
+                analyze_call(p_id, info);
+            } else {
+                stmts[s].kind = cx_stmt::sk_assign;
+                analyze_assignment();
+            }
+        }
+            break;
+        case tc_DO:
+        {
+            stmts[s].kind = cx_stmt::sk_do;
+            ++pos;
+            expect(mc_location_marker);
+            analyze_statement_list(tc_WHILE, s);
+            expect(tc_WHILE);
+
+            // the condition is a parenthesized factor
+            analyze_expression();
+        }
+            break;
+        case tc_WHILE:
+        {
+            stmts[s].kind = cx_stmt::sk_while;
+            ++pos;
+            expect(mc_location_marker);
+            expect(tc_left_paren);
+            analyze_expression();
+            expect(tc_right_paren);
+
+            int body = analyze_statement(false);
+            stmts[s].children.push_back(body);
+        }
+            break;
+        case tc_IF:
+        {
+            stmts[s].kind = cx_stmt::sk_if;
+            ++pos;
+            expect(mc_location_marker);
+            expect(tc_left_paren);
+            analyze_expression();
+            expect(tc_right_paren);
+
+            int branch = analyze_statement(false);
+            stmts[s].children.push_back(branch);
+            while (code() == tc_semicolon) ++pos;
+
+            if (code() == tc_ELSE) {
+                ++pos;
+                expect(mc_location_marker);
+
+                branch = analyze_statement(false);
+                stmts[s].children.push_back(branch);
+                while (code() == tc_semicolon) ++pos;
+            }
+        }
+            break;
+        case tc_FOR:
+        {
+            stmts[s].kind = cx_stmt::sk_for;
+            ++pos;
+            for (int i = 0; i < 4; ++i) expect(mc_location_marker);
+            expect(tc_left_paren);
+
+            if (code() != tc_semicolon) {
+                if (code() == tc_identifier) analyze_assignment();
+                else failed = true;
+            }
+            expect(tc_semicolon);
+
+            if (code() != tc_semicolon) analyze_expression();
+            expect(tc_semicolon);
+
+            if (code() != tc_right_paren) analyze_expression();
+            expect(tc_right_paren);
+
+            int body = analyze_statement(false);
+            stmts[s].children.push_back(body);
+        }
+            break;
+        case tc_left_bracket:
+            stmts[s].kind = cx_stmt::sk_compound;
+            ++pos;
+            analyze_statement_list(tc_right_bracket, s);
+            expect(tc_right_bracket);
+            break;
+        case tc_RETURN:
+            stmts[s].kind = cx_stmt::sk_return;
+            ++pos;
+            if ((code() != tc_semicolon) && (code() != tc_right_bracket)) {
+                analyze_expression();
+            }
+            break;
+        case tc_BREAK:
+            stmts[s].kind = cx_stmt::sk_break;
+            ++pos;
+            break;
+        case tc_PARALLEL:
+            // the loop's workers would share its temporaries
+            failed = true;
+            break;
+        case tc_semicolon:
+            break;
+        default:
+            failed = true;
+            break;
+    }
+
+    stmts[s].end = pos;
+    current_stmt = saved_stmt;
+
+    return s;
+}
+
+/** analyze_assignment  Analyse an assignment, a declaration or the
+ *                      initializer of a for statement.
+ *
+ *      <id> [subscripts] <assign-op> <expression>
+ */
+void cx_optimizer::analyze_assignment(void) {
+    cx_symtab_node *p_target_id = insns[pos++].p_node;
+
+    switch (p_target_id->defn.how) {
+        case dc_variable:
+        case dc_value_parm:
+        case dc_reference:
+            break;
+        default:
+            failed = true;
+            return;
+    }
+
+    cx_expr_info info = new_expr_info();
+    if (code() == tc_left_subscript) analyze_subscripts(info);
+
+    cx_token_code op = code();
+
+    if (token_in(op, tokenlist_assign_ops)) {
+        ++pos;
+        note_write(p_target_id);
+
+        if ((op != tc_plus_plus) && (op != tc_minus_minus)) {
+            analyze_expression();
+        }
+    } else if ((op != tc_semicolon) && (op != tc_right_bracket)) {
+        // declaration lists and anything else unusual
+        failed = true;
+    }
+}
+
+/** analyze_call        Analyse the actual parameters of a call.
+ *                      Reference actuals are stores.
+ *
+ * @param p_id : ptr to the called function's symtab node.
+ * @param info : expression summary to update.
+ */
+void cx_optimizer::analyze_call(cx_symtab_node *p_id, cx_expr_info &info) {
+    info.pure = false;
+
+    if (current_stmt >= 0) {
+        stmts[current_stmt].calls = true;
+        stmts[current_stmt].pure = false;
+    }
+
+    if (code() != tc_left_paren) return;
+    ++pos;
+
+    // standard routines have no call site
+    if (code() == mc_call_marker) ++pos;
+
+    if (code() == tc_right_paren) {
+        ++pos;
+        return;
+    }
+
+    cx_symtab_node *p_formal_id = p_id->defn.routine.locals.p_parms_ids;
+
+    // standard routines may store into any variable they are given
+    const bool standard = (p_id->defn.routine.which != rc_declared)
+            && (p_id->defn.routine.which != rc_forward)
+            && (p_id->defn.routine.which != rc_intrinsic)
+            && (p_id->defn.routine.which != rc_host);
+
+    for (;;) {
+        if ((standard || ((p_formal_id != nullptr)
+                && (p_formal_id->defn.how == dc_reference)))
+                && (code() == tc_identifier)) {
+            note_write(insns[pos].p_node);
+        }
+
+        merge(info, analyze_expression());
+
+        if (p_formal_id != nullptr) p_formal_id = p_formal_id->next__;
+
+        if (code() != tc_comma) break;
+        ++pos;
+    }
+
+    expect(tc_right_paren);
+}
+
+/** analyze_subscripts  Analyse bracketed subscript lists.
+ *
+ * @param info : expression summary to update.
+ */
+void cx_optimizer::analyze_subscripts(cx_expr_info &info) {
+    while (!failed && (code() == tc_left_subscript)) {
+        ++pos;
+
+        for (;;) {
+            merge(info, analyze_expression());
+
+            if (code() != tc_comma) break;
+            ++pos;
+        }
+
+        expect(tc_right_subscript);
+    }
+
+    // element reads are never moved
+    info.pure = false;
+    info.p_type = nullptr;
+}
+
+/** analyze_expression  Analyse an expression (relational operators).
+ *
+ * @return summary of the expression.
+ */
+cx_expr_info cx_optimizer::analyze_expression(void) {
+    cx_expr_info info = analyze_simple_expression();
+
+    if (token_in(code(), tokenlist_relation_ops)) {
+        ++pos;
+        merge(info, analyze_simple_expression());
+        info.p_type = nullptr;
+        info.has_op = true;
+        info.nonzero_constant = false;
+    }
+
+    return info;
+}
+
+/** analyze_simple_expression   Analyse a simple expression (unary
+ *                              operators and additive operators).
+ *
+ * @return summary of the simple expression.
+ */
+cx_expr_info cx_optimizer::analyze_simple_expression(void) {
+    int begin = pos;
+    cx_token_code unary_op = tc_dummy;
+
+    if (token_in(code(), tokenlist_unary_ops)) {
+        unary_op = code();
+        ++pos;
+    }
+
+    cx_expr_info info = analyze_term();
+
+    if (unary_op != tc_dummy) {
+        info.nonzero_constant = false;
+        if ((unary_op == tc_bit_NOT) && (info.p_type != p_context->p_integer_type)) {
+            info.p_type = nullptr;
+        }
+    }
+
+    while (!failed && token_in(code(), tokenlist_add_ops)) {
+        cx_token_code op = code();
+        ++pos;
+
+        cx_expr_info operand = analyze_term();
+
+        info.p_type = result_type(p_context, op, info.p_type, operand.p_type);
+        merge(info, operand);
+        info.has_op = true;
+        info.nonzero_constant = false;
+
+        add_candidate(begin, info);
+    }
+
+    return info;
+}
+
+/** analyze_term        Analyse a term (multiplicative operators).
+ *
+ * @return summary of the term.
+ */
+cx_expr_info cx_optimizer::analyze_term(void) {
+    int begin = pos;
+    cx_expr_info info = analyze_factor();
+
+    while (!failed && token_in(code(), tokenlist_mul_ops)) {
+        cx_token_code op = code();
+        ++pos;
+
+        cx_expr_info operand = analyze_factor();
+
+        if (((op == tc_divide) || (op == tc_modulas))
+                && !operand.nonzero_constant) info.may_fault = true;
+
+        info.p_type = result_type(p_context, op, info.p_type, operand.p_type);
+        merge(info, operand);
+        info.has_op = true;
+        info.nonzero_constant = false;
+
+        add_candidate(begin, info);
+    }
+
+    return info;
+}
+
+/** analyze_factor      Analyse a factor.
+ *
+ * @return summary of the factor.
+ */
+cx_expr_info cx_optimizer::analyze_factor(void) {
+    cx_expr_info info = new_expr_info();
+
+    switch (code()) {
+        case tc_identifier:
+        {
+            cx_symtab_node *p_id = insns[pos++].p_node;
+
+            switch (p_id->defn.how) {
+                case dc_function:
+                    analyze_call(p_id, info);
+                    break;
+                case dc_constant:
+                    if (p_id->p_type == p_context->p_integer_type) {
+                        info.p_type = p_context->p_integer_type;
+                        info.nonzero_constant = p_id->defn.constant.value.int__ != 0;
+                    } else if (p_id->p_type == p_context->p_float_type) {
+                        info.p_type = p_context->p_float_type;
+                        info.nonzero_constant = p_id->defn.constant.value.float__ != 0.0f;
+                    }
+                    break;
+                case dc_type:
+                    info.pure = false;
+                    break;
+                case dc_variable:
+                case dc_value_parm:
+                case dc_reference:
+                    if (p_id->p_type->form == fc_stream) {
+                        // reading a stream consumes input
+                        info.pure = false;
+                    } else if (token_in(code(), tokenlist_assign_ops)) {
+                        cx_token_code op = code();
+                        ++pos;
+
+                        note_write(p_id);
+                        if (current_stmt >= 0) stmts[current_stmt].pure = false;
+                        info.pure = false;
+
+                        if ((op != tc_plus_plus) && (op != tc_minus_minus)) {
+                            merge(info, analyze_expression());
+                        }
+                    } else if (code() == tc_left_subscript) {
+                        analyze_subscripts(info);
+                        if (token_in(code(), tokenlist_assign_ops)) failed = true;
+                    } else if (code() == tc_dot) {
+                        failed = true;
+                    } else {
+                        info.reads.insert(p_id);
+                        if ((p_id->p_type == p_context->p_integer_type)
+                                || (p_id->p_type == p_context->p_float_type)) {
+                            info.p_type = p_id->p_type;
+                        }
+                    }
+                    break;
+                default:
+                    failed = true;
+                    break;
+            }
+        }
+            break;
+        case tc_number:
+        {
+            cx_symtab_node *p_id = insns[pos++].p_node;
+
+            info.p_type = p_id->p_type;
+            info.nonzero_constant = (p_id->p_type == p_context->p_integer_type)
+                    ? p_id->defn.constant.value.int__ != 0
+                    : p_id->defn.constant.value.float__ != 0.0f;
+        }
+            break;
+        case tc_char:
+        case tc_string:
+            ++pos;
+            break;
+        case tc_logic_NOT:
+            ++pos;
+            info = analyze_factor();
+            info.p_type = nullptr;
+            info.nonzero_constant = false;
+            break;
+        case tc_left_paren:
+            ++pos;
+            info = analyze_expression();
+            expect(tc_right_paren);
+            break;
+        case tc_left_bracket:
+        {
+            // initializer list
+            ++pos;
+            for (;;) {
+                merge(info, analyze_expression());
+
+                if (code() != tc_comma) break;
+                ++pos;
+            }
+            expect(tc_right_bracket);
+
+            info.pure = false;
+            info.p_type = nullptr;
+        }
+            break;
+        case tc_semicolon:
+            break;
+        default:
+            failed = true;
+            break;
+    }
+
+    return info;
+}
+
+/** add_candidate       Record the subexpression ending at the
+ *                      current insn if its value can be reused.
+ *
+ * @param begin : first insn of the subexpression.
+ * @param info  : summary of the subexpression.
+ */
+void cx_optimizer::add_candidate(int begin, const cx_expr_info &info) {
+    if (failed || (current_stmt < 0) || !info.pure
+            || (info.p_type == nullptr) || !info.has_op) return;
+
+    cx_candidate cand;
+    cand.begin = begin;
+    cand.end = pos;
+    cand.stmt = current_stmt;
+    cand.p_type = info.p_type;
+    cand.may_fault = info.may_fault;
+    cand.reads = info.reads;
+
+    // nothing may jump into the middle of the subexpression
+    for (int i = begin; i < pos; ++i) {
+        if (insns[i].code == mc_location_marker) return;
+    }
+
+    for (const cx_insn &insn : insns) {
+        if ((insn.code == mc_location_marker)
+                && (insn.value > begin) && (insn.value < pos)) return;
+    }
+
+    stmts[current_stmt].candidates.push_back(candidates.size());
+    candidates.push_back(cand);
+}
+
+/** note_write          Record a store to a variable in the current
+ *                      statement.
+ *
+ * @param p_id : ptr to the variable's symtab node.
+ */
+void cx_optimizer::note_write(const cx_symtab_node *p_id) {
+    if (current_stmt >= 0) stmts[current_stmt].writes.insert(p_id);
+}
+
+/**********************
+ *                    *
+ *  Transformations   *
+ *                    *
+ **********************/
+
+/** collect_region      Gather the stores, calls and candidates of a
+ *                      statement and everything nested in it.
+ *
+ * @param s      : statement index.
+ * @param writes : variables stored to.
+ * @param calls  : set if anything is called.
+ * @param region : candidate indexes.
+ */
+void cx_optimizer::collect_region(int s, cx_node_set &writes, bool &calls,
+        std::vector<int> &region) const {
+    const cx_stmt &stmt = stmts[s];
+
+    writes.insert(stmt.writes.begin(), stmt.writes.end());
+    calls = calls || stmt.calls;
+    region.insert(region.end(), stmt.candidates.begin(), stmt.candidates.end());
+
+    for (int child : stmt.children) collect_region(child, writes, calls, region);
+}
+
+/** invariant           True if none of the candidate's variables
+ *                      can change inside the region.
+ *
+ * @param cand           : candidate subexpression.
+ * @param writes         : variables stored to in the region.
+ * @param shared_written : true if a global or reference parameter
+ *                         may be stored to in the region.
+ * @return true if the value is invariant.
+ */
+bool cx_optimizer::invariant(const cx_candidate &cand, const cx_node_set &writes,
+        bool shared_written) const {
+    for (const cx_symtab_node *p_id : cand.reads) {
+        if (writes.count(p_id) > 0) return false;
+        if (shared_written && is_shared(p_id)) return false;
+    }
+
+    return true;
+}
+
+/** overlaps            True if the span overlaps a planned
+ *                      replacement.
+ *
+ * @param begin : first insn.
+ * @param end   : one past the last insn.
+ */
+bool cx_optimizer::overlaps(int begin, int end) const {
+    for (const auto &rep : replacements) {
+        if ((rep.first < end) && (begin < rep.second.first)) return true;
+    }
+
+    return false;
+}
+
+/** key                 Spelling of a candidate used to match
+ *                      identical subexpressions.
+ *
+ * @param cand : candidate subexpression.
+ * @return key string.
+ */
+std::string cx_optimizer::key(const cx_candidate &cand) const {
+    std::string k;
+
+    for (int i = cand.begin; i < cand.end; ++i) {
+        k += (char) insns[i].code;
+        k.append((const char *) &insns[i].p_node, sizeof (cx_symtab_node *));
+    }
+
+    return k;
+}
+
+/** new_temp            Enter a new local temporary in the
+ *                      routine's symtab.
+ *
+ * @param p_type : type of the temporary.
+ * @return ptr to the temporary's symtab node.
+ */
+cx_symtab_node *cx_optimizer::new_temp(cx_type *p_type) {
+    char name[32];
+
+    do {
+        sprintf(name, "__cx_temp_%d__", temp_count++);
+    } while (p_symtab->search(name) != nullptr);
+
+    cx_symtab_node *p_temp = p_symtab->enter(name, dc_variable);
+    set_type(p_temp->p_type, p_type);
+    p_temp->level = (p_function_id->defn.how == dc_program)
+            ? 0 : p_function_id->level + 1;
+
+    // add to the end of the routine's variable list, and its frame
+    cx_symtab_node **pp_id = &p_function_id->defn.routine.locals.p_variable_ids;
+    int offset = p_function_id->defn.routine.parm_count;
+    while (*pp_id != nullptr) {
+        pp_id = &(*pp_id)->next__;
+        ++offset;
+    }
+    *pp_id = p_temp;
+    p_temp->defn.data.offset = offset;
+
+    p_function_id->defn.routine.total_local_size += p_type->size;
+
+    return p_temp;
+}
+
+/** plan_temp           Plan the statement that computes a
+ *                      temporary:
+ *
+ *                          <temp> = <expression>;
+ *
+ * @param at          : insn to insert the statement before.
+ * @param line_number : line number to mark the statement with.
+ * @param p_temp      : ptr to the temporary's symtab node.
+ * @param cand        : subexpression to compute.
+ */
+void cx_optimizer::plan_temp(int at, int line_number, cx_symtab_node *p_temp,
+        const cx_candidate &cand) {
+    std::vector<cx_insn> &code = inserts[at];
+
+    if (line_number > 0) code.push_back(new_insn(mc_line_marker, nullptr, line_number));
+
+    code.push_back(new_insn(tc_identifier, p_temp));
+    code.push_back(new_insn(tc_equal));
+    code.insert(code.end(), insns.begin() + cand.begin, insns.begin() + cand.end);
+    code.push_back(new_insn(tc_semicolon));
+}
+
+static bool larger_span(const cx_candidate *p_a, const cx_candidate *p_b) {
+    int size_a = p_a->end - p_a->begin;
+    int size_b = p_b->end - p_b->begin;
+
+    return size_a != size_b ? size_a > size_b : p_a->begin < p_b->begin;
+}
+
+/** hoist_invariants    Move subexpressions that do not change
+ *                      inside a loop to just before the loop.
+ *                      Outer loops are visited first so a value
+ *                      is hoisted as far out as it can go.
+ *
+ * @param s : statement index.
+ */
+void cx_optimizer::hoist_invariants(int s) {
+    const cx_stmt &stmt = stmts[s];
+    bool loop = (stmt.kind == cx_stmt::sk_do) || (stmt.kind == cx_stmt::sk_while)
+            || (stmt.kind == cx_stmt::sk_for);
+
+    if (loop && stmt.in_list) {
+        cx_node_set writes;
+        bool shared_written = false;
+        std::vector<int> region;
+
+        collect_region(s, writes, shared_written, region);
+        for (const cx_symtab_node *p_id : writes) {
+            if (is_shared(p_id)) shared_written = true;
+        }
+
+        std::vector<const cx_candidate *> order;
+        for (int c : region) order.push_back(&candidates[c]);
+        std::sort(order.begin(), order.end(), larger_span);
+
+        std::map<std::string, cx_symtab_node *> temps;
+
+        for (const cx_candidate *p_cand : order) {
+            if (p_cand->may_fault || overlaps(p_cand->begin, p_cand->end)
+                    || !invariant(*p_cand, writes, shared_written)) continue;
+
+            std::string k = key(*p_cand);
+            cx_symtab_node *p_temp;
+
+            auto found = temps.find(k);
+            if (found == temps.end()) {
+                p_temp = new_temp(p_cand->p_type);
+                temps[k] = p_temp;
+                plan_temp(stmt.begin, stmt.line_number, p_temp, *p_cand);
+                ++hoist_count;
+            } else p_temp = found->second;
+
+            replacements[p_cand->begin] = std::make_pair(p_cand->end, p_temp);
+        }
+    }
+
+    for (int child : stmt.children) hoist_invariants(child);
+}
+
+/** eliminate_common_subexpressions    Within each run of straight
+ *                      line statements of a list, compute repeated
+ *                      subexpressions once.  A run ends at any
+ *                      statement that calls a function, stores
+ *                      inside an expression or transfers control.
+ *
+ * @param list : statement indexes of one statement list.
+ */
+void cx_optimizer::eliminate_common_subexpressions(const std::vector<int> &list) {
+
+    struct cx_cse_group {
+        std::string key;
+        std::vector<const cx_candidate *> occurrences;
+    };
+
+    std::vector<cx_cse_group> closed;
+    std::map<std::string, cx_cse_group> open;
+
+    auto close_all = [&]() {
+        for (auto &entry : open) closed.push_back(entry.second);
+        open.clear();
+    };
+
+    for (int s : list) {
+        const cx_stmt &stmt = stmts[s];
+        bool straight = ((stmt.kind == cx_stmt::sk_assign)
+                || (stmt.kind == cx_stmt::sk_return)) && stmt.pure;
+
+        if (!straight) {
+            close_all();
+            continue;
+        }
+
+        for (int c : stmt.candidates) {
+            const cx_candidate &cand = candidates[c];
+            if (overlaps(cand.begin, cand.end)) continue;
+
+            std::string k = key(cand);
+            cx_cse_group &group = open[k];
+            group.key = k;
+            group.occurrences.push_back(&cand);
+        }
+
+        // values that read what this statement stores are stale
+        bool shared_written = false;
+        for (const cx_symtab_node *p_id : stmt.writes) {
+            if (is_shared(p_id)) shared_written = true;
+        }
+
+        for (auto it = open.begin(); it != open.end();) {
+            if (!invariant(*it->second.occurrences.front(), stmt.writes, shared_written)) {
+                closed.push_back(it->second);
+                it = open.erase(it);
+            } else ++it;
+        }
+    }
+
+    close_all();
+
+    std::sort(closed.begin(), closed.end(),
+            [](const cx_cse_group &a, const cx_cse_group & b) {
+                return larger_span(a.occurrences.front(), b.occurrences.front());
+            });
+
+    for (const cx_cse_group &group : closed) {
+        std::vector<const cx_candidate *> uses;
+
+        for (const cx_candidate *p_cand : group.occurrences) {
+            if (!overlaps(p_cand->begin, p_cand->end)) uses.push_back(p_cand);
+        }
+
+        if (uses.size() < 2) continue;
+
+        const cx_candidate *p_first = uses.front();
+        const cx_stmt &stmt = stmts[p_first->stmt];
+        cx_symtab_node *p_temp = new_temp(p_first->p_type);
+
+        plan_temp(stmt.begin, stmt.line_number, p_temp, *p_first);
+
+        for (const cx_candidate *p_cand : uses) {
+            replacements[p_cand->begin] = std::make_pair(p_cand->end, p_temp);
+        }
+
+        ++cse_count;
+    }
+}
@@ -10,8 +10,6 @@
 // might not always be true in some cases.
 bool exec_flag(true);
 
-cx_symtab_node *p_program_ptr_id = nullptr;
-
 /** parse_declarations_or_assignment       Parses new declarations or
  *                                      assignment statements.
  *
@@ -24,8 +22,8 @@ cx_symtab_node *p_program_ptr_id = nullptr;
  */
 void cx_parser::parse_declarations_or_assignment(cx_symtab_node *p_function_id) {
 
-    if (!p_program_ptr_id->found_global_end) {
-        p_program_ptr_id->global_finish_location = icode.current_location();
+    if (!p_context->p_program_ptr_id->found_global_end) {
+        p_context->p_program_ptr_id->global_finish_location = icode.current_location();
     }
 
     // track if we seen '*'
@@ -54,8 +52,10 @@ void cx_parser::parse_declarations_or_assignment(cx_symtab_node *p_function_id)
             p_new_id = search_local(p_token->string__());
 
             /* if not nullptr, it's already defined.
-             * check if forwarded */
-            if (p_new_id != nullptr) {
+             * check if forwarded.  a standard routine's
+             * name is taken over by enter_new_local */
+            if ((p_new_id != nullptr)
+                    && !symtab_stack.get_current_symtab()->shadowable(p_new_id)) {
                 if (p_new_id->defn.how == dc_function && p_new_id->defn.routine.which == ::rc_forward) {
                     get_token_append();
                     parse_function_header(p_new_id);
@@ -63,12 +63,18 @@ void cx_parser::parse_declarations_or_assignment(cx_symtab_node *p_function_id)
             } else {
                 p_new_id = enter_new_local(p_token->string__());
                 icode.put(p_new_id);
+                note_private(p_new_id);
             }
 
-            // set type
-            set_type(p_new_id->p_type, p_node->p_type);
+            // set type; each stream keeps its file in a type object of its own
+            if (p_node->p_type->form == fc_stream) {
+                set_type(p_new_id->p_type,
+                        new cx_type(fc_stream, p_node->p_type->size, p_node));
+            } else set_type(p_new_id->p_type, p_node->p_type);
 
-            get_token_append();
+            // the array size is part of the type, not the icode
+            get_token();
+            if (token != tc_left_subscript) icode.put(token);
 
             // check for array type
             if (token == tc_left_subscript) {
@@ -86,15 +92,33 @@ void cx_parser::parse_declarations_or_assignment(cx_symtab_node *p_function_id)
                 p_new_id->defn.how = dc_variable;
             }
 
+            // marked once its initializer is parsed, which can't use it
+            if (atomic_declaration) {
+                if ((p_new_id->defn.how == dc_function)
+                        || (p_new_id->p_type->size == 0)) {
+                    cx_error(err_invalid_atomic);
+                } else if (p_new_id->defn.how == dc_variable) {
+                    p_new_id->is_atomic = true;
+                }
+            }
+
             if (p_new_id->defn.how == dc_variable) {
                 // add variable to variable list
                 if (p_function_id) {
                     cx_symtab_node *p_var_id = p_function_id->defn.routine.locals.p_variable_ids;
+
+                    // locals take the frame slots after the parms
+                    p_new_id->defn.data.offset = p_function_id->defn.routine.parm_count;
+
                     if (!p_var_id) {
                         p_function_id->defn.routine.locals.p_variable_ids = p_new_id;
                         p_function_id->defn.routine.total_local_size += p_new_id->p_type->size;
                     } else {
-                        while (p_var_id->next__)p_var_id = p_var_id->next__;
+                        ++p_new_id->defn.data.offset;
+                        while (p_var_id->next__) {
+                            p_var_id = p_var_id->next__;
+                            ++p_new_id->defn.data.offset;
+                        }
 
                         p_var_id->next__ = p_new_id;
                         p_function_id->defn.routine.total_local_size += p_new_id->p_type->size;
@@ -133,6 +157,39 @@ void cx_parser::parse_declarations_or_assignment(cx_symtab_node *p_function_id)
     }
 }
 
+/** parse_atomic_declaration      parse a declaration of atomic
+ *                              variables, or arrays of them, which
+ *                              tasks and the workers of a parallel for
+ *                              use at once through load, store,
+ *                              fetch_add and compare_exchange:
+ *
+ *      atomic <type-id> <id> [= <expr>], ... ;
+ *      atomic <type-id> <id>[<size>], ... ;
+ *
+ * The type is int or a uint type.  The atomic stays in the icode, and
+ * the executor runs what follows it as any other declaration.
+ *
+ * @param p_function_id : ptr to the routine which owns the variables.
+ */
+void cx_parser::parse_atomic_declaration(cx_symtab_node *p_function_id) {
+    cx_symtab_node *p_type_id = (token == tc_identifier)
+            ? search_all(p_token->string__()) : nullptr;
+
+    if ((p_type_id == nullptr) || (p_type_id->defn.how != dc_type)
+            || ((p_type_id->p_type != p_context->p_integer_type)
+            && (p_type_id->p_type != p_context->p_uint8_type)
+            && (p_type_id->p_type != p_context->p_uint16_type)
+            && (p_type_id->p_type != p_context->p_uint32_type)
+            && (p_type_id->p_type != p_context->p_uint64_type))) {
+        cx_error(err_invalid_atomic);
+        return;
+    }
+
+    atomic_declaration = true;
+    parse_declarations_or_assignment(p_function_id);
+    atomic_declaration = false;
+}
+
 /** parse_constant_declaration    'const' will only set it's qualifier as
  *                              dc_constant all else is treated as a standard
  *                              declaration.
@@ -189,13 +246,13 @@ void cx_parser::parse_constant(cx_symtab_node *p_const_id) {
 
     switch (token) {
         case tc_number:
-            if ((p_token->type() == ty_integer) && (p_const_id->p_type == p_integer_type)) {
+            if ((p_token->type() == ty_integer) && (p_const_id->p_type == p_context->p_integer_type)) {
                 p_const_id->defn.constant.value.int__ = sign == tc_minus ?
                         -p_token->value().int__ : p_token->value().int__;
             } else if ((p_token->type() == ty_real) &&
-                    (((p_const_id->p_type == p_float_type)))) {
+                    (((p_const_id->p_type == p_context->p_float_type)))) {
 
-                if (p_const_id->p_type == p_float_type) {
+                if (p_const_id->p_type == p_context->p_float_type) {
                     p_const_id->defn.constant.value.float__ = sign == tc_minus ?
                             -p_token->value().float__ : p_token->value().float__;
                 } else {
@@ -212,7 +269,7 @@ void cx_parser::parse_constant(cx_symtab_node *p_const_id) {
             break;
         case tc_char:
         case tc_string:
-            if (p_const_id->p_type == p_char_type) {
+            if (p_const_id->p_type == p_context->p_char_type) {
                 int length = strlen(p_token->string__()) - 2;
 
                 if (sign != tc_dummy) cx_error(err_invalid_constant);
@@ -256,28 +313,28 @@ void cx_parser::parse_identifier_constant(cx_symtab_node* p_id1, cx_token_code s
 
     if (p_id2->defn.how != dc_constant) {
         cx_error(err_not_a_constant_identifier);
-        set_type(p_id1->p_type, p_dummy_type);
+        set_type(p_id1->p_type, p_context->p_dummy_type);
         get_token_append();
         return;
     }
 
-    if (p_id2->p_type == p_integer_type) {
+    if (p_id2->p_type == p_context->p_integer_type) {
         p_id2->defn.constant.value.int__ = sign == tc_minus ?
                 -p_id2->defn.constant.value.int__ :
                 p_id2->defn.constant.value.int__;
 
-        set_type(p_id1->p_type, p_integer_type);
-    } else if (p_id2->p_type == p_float_type) {
+        set_type(p_id1->p_type, p_context->p_integer_type);
+    } else if (p_id2->p_type == p_context->p_float_type) {
         p_id1->defn.constant.value.float__ = sign == tc_minus ?
                 -p_id2->defn.constant.value.float__ :
                 p_id2->defn.constant.value.float__;
-        set_type(p_id1->p_type, p_float_type);
-    } else if (p_id2->p_type == p_char_type) {
+        set_type(p_id1->p_type, p_context->p_float_type);
+    } else if (p_id2->p_type == p_context->p_char_type) {
         if (sign != tc_dummy) cx_error(err_invalid_constant);
 
         p_id1->defn.constant.value.char__ = p_id2->defn.constant.value.char__;
 
-        set_type(p_id1->p_type, p_char_type);
+        set_type(p_id1->p_type, p_context->p_char_type);
     } else if (p_id2->p_type->form == fc_enum) {
         if (sign != tc_dummy)cx_error(err_invalid_constant);
 
@@ -285,7 +342,7 @@ void cx_parser::parse_identifier_constant(cx_symtab_node* p_id1, cx_token_code s
 
         set_type(p_id1->p_type, p_id2->p_type);
     } else if (p_id2->p_type->form == fc_array) {
-        if ((sign != tc_dummy) || (p_id2->p_type->array.p_element_type != p_char_type)) {
+        if ((sign != tc_dummy) || (p_id2->p_type->array.p_element_type != p_context->p_char_type)) {
             cx_error(err_invalid_constant);
         }
 
@@ -10,9 +10,12 @@
 #include "buffer.h"
 #include "error.h"
 #include "parser.h"
+#include "intrinsic.h"
 
 /** parse_execute_directive      Opens an external script module
- *                      for parsing.
+ *                      for parsing.  Each module is parsed once;
+ *                      including it again reuses the routines it
+ *                      already entered.
  *
  *      #include <identifier>
  *
@@ -20,8 +23,6 @@
  */
 void cx_parser::parse_execute_directive(cx_symtab_node *p_function_id) {
 
-    extern cx_symtab_node *p_program_ptr_id;
-
     switch (token) {
         case tc_INCLUDE:
         {
@@ -36,20 +37,33 @@ void cx_parser::parse_execute_directive(cx_symtab_node *p_function_id) {
             get_token();
 
             lib_path += p_token->string__();
-            p_program_ptr_id->found_global_end = true;
+            p_context->p_program_ptr_id->found_global_end = true;
+
+            // key modules by their resolved path, however they're named
+            char *p_real_path = realpath(lib_path.c_str(), nullptr);
+            const std::string module_path =
+                    (p_real_path != nullptr) ? p_real_path : lib_path;
+            free(p_real_path);
+
+            if (p_context->included_modules.insert(module_path).second) {
+                cx_parser *parser = new cx_parser(p_context,
+                        new cx_source_buffer(p_context, lib_path.c_str()));
 
-            cx_parser *parser = new cx_parser
-                    (new cx_source_buffer(lib_path.c_str()));
+                const int first_node = p_context->global_symtab.node_count();
 
-            /* true : stdlib module
-             * returns nullptr */
-            parser->parse(true);
+                /* true : stdlib module
+                 * returns nullptr */
+                parser->parse(true);
 
-            delete parser;
+                // library routines with native code run it instead
+                cx_bind_intrinsics(&p_context->global_symtab, first_node);
+
+                delete parser;
+            }
 
             icode.reset();
             icode.put(tc_left_bracket);
-            p_program_ptr_id->found_global_end = false;
+            p_context->p_program_ptr_id->found_global_end = false;
             get_token_append();
         }
             break;
@@ -19,7 +19,7 @@ cx_type *cx_parser::parse_expression(void) {
         get_token_append();
         p_operand_type = parse_simple_expression();
         check_relational_op_operands(p_result_type, p_operand_type);
-        p_result_type = p_boolean_type;
+        p_result_type = p_context->p_boolean_type;
     }
 
     resync(tokenlist_expression_follow, tokenlist_statement_follow, tokenlist_statement_start);
@@ -58,14 +58,14 @@ cx_type *cx_parser::parse_simple_expression(void) {
             case tc_plus:
             case tc_minus:
                 if (integer_operands(p_result_type, p_operand_type)) {
-                    p_result_type = p_integer_type;
+                    p_result_type = p_context->p_integer_type;
                 } else if (real_operands(p_result_type, p_operand_type)) {
-                    p_result_type = p_float_type;
+                    p_result_type = p_context->p_float_type;
                 } else cx_error(err_incompatible_types);
                 break;
             case tc_logic_OR:
                 check_boolean(p_result_type, p_operand_type);
-                p_result_type = p_boolean_type;
+                p_result_type = p_context->p_boolean_type;
                 break;
             default:
                 break;
@@ -97,25 +97,25 @@ cx_type *cx_parser::parse_term(void) {
         switch (op) {
             case tc_star:
                 if (integer_operands(p_result_type, p_operand_type)) {
-                    p_result_type = p_integer_type;
+                    p_result_type = p_context->p_integer_type;
                 } else if (real_operands(p_result_type, p_operand_type)) {
-                    p_result_type = p_float_type;
+                    p_result_type = p_context->p_float_type;
                 } else cx_error(err_incompatible_types);
                 break;
             case tc_divide:
                 if (integer_operands(p_result_type, p_operand_type) ||
                         real_operands(p_result_type, p_operand_type)) {
-                    p_result_type = p_integer_type;
+                    p_result_type = p_context->p_integer_type;
                 } else cx_error(err_incompatible_types);
                 break;
             case tc_modulas:
                 if (integer_operands(p_result_type, p_operand_type)) {
-                    p_result_type = p_integer_type;
+                    p_result_type = p_context->p_integer_type;
                 } else cx_error(err_incompatible_types);
                 break;
             case tc_logic_AND:
                 check_boolean(p_result_type, p_operand_type);
-                p_result_type = p_boolean_type;
+                p_result_type = p_context->p_boolean_type;
                 break;
             default:
                 break;
@@ -180,10 +180,10 @@ cx_type *cx_parser::parse_factor(void) {
                 p_node = enter_local(p_token->string__());
 
                 if (p_token->type() == ty_integer) {
-                    p_node->p_type = p_integer_type;
+                    set_type(p_node->p_type, p_context->p_integer_type);
                     p_node->defn.constant.value.int__ = p_token->value().int__;
                 } else {
-                    p_node->p_type = p_float_type;
+                    set_type(p_node->p_type, p_context->p_float_type);
                     p_node->defn.constant.value.float__ = p_token->value().float__;
                 }
             }
@@ -201,35 +201,24 @@ cx_type *cx_parser::parse_factor(void) {
             char *p_string = p_token->string__();
             cx_symtab_node *p_node = search_all(p_token->string__());
             int length = strlen(p_string) - 2;
-            // '\0' == -1
-            p_result_type = ((length == 1) || (length == -1)) ?
-                    p_char_type : new cx_type(length);
 
             if (!p_node) {
                 p_node = enter_local(p_token->string__());
-                set_type(p_node->p_type, p_result_type);
 
-                if (length <= 1) {
+                // '\0' == -1
+                if ((length == 1) || (length == -1)) {
+                    set_type(p_node->p_type, p_context->p_char_type);
                     p_node->defn.constant.value.char__ = p_string[1];
                 } else {
 
-                    const int size = sizeof (char) * (length + 1);
-                    p_node->defn.constant.value.p_string = new char[size];
-                    memset(p_node->defn.constant.value.p_string, '\0', size);
-                    memcpy(p_node->defn.constant.value.p_string,
-                            &p_string[1], size);
-
-                    // remove the quote
-                    p_node->defn.constant.value.p_string[length] = '\0';
-
-                    p_node->p_type->form = fc_array;
-                    p_node->p_type->array.element_count = length;
-                    p_node->p_type->array.max_index = length;
-                    p_node->p_type->array.min_index = 0;
-                    p_node->p_type->array.p_element_type = p_char_type;
-                    p_node->p_type->array.p_index_type = p_integer_type;
+                    // strings are pooled without their quotes
+                    set_type(p_node->p_type, new cx_type(length, true));
+                    p_node->defn.constant.value.p_string =
+                            (char *) cx_intern_string(&p_string[1], length);
                 }
             }
+
+            p_result_type = p_node->p_type;
             icode.put(p_node);
 
             get_token_append();
@@ -242,10 +231,13 @@ cx_type *cx_parser::parse_factor(void) {
 
             conditional_get_token_append(tc_right_paren, err_missing_right_paren);
             break;
+        case tc_SPAWN:
+            p_result_type = parse_spawn();
+            break;
         case tc_logic_NOT:
             get_token_append();
             check_boolean(parse_factor());
-            p_result_type = p_boolean_type;
+            p_result_type = p_context->p_boolean_type;
 
             break;
         case tc_left_bracket:
@@ -264,7 +256,7 @@ cx_type *cx_parser::parse_factor(void) {
                 // make sure we init all of the same type
                 if (p_prev_type != p_result_type) {
                     cx_error(err_incompatible_assignment);
-                    p_result_type = p_dummy_type;
+                    p_result_type = p_context->p_dummy_type;
                     break;
                 }
 
@@ -287,7 +279,7 @@ cx_type *cx_parser::parse_factor(void) {
             p_array_type->array.min_index = 0;
 
             set_type(p_array_type->array.p_element_type, p_result_type);
-            set_type(p_array_type->array.p_index_type, p_integer_type);
+            set_type(p_array_type->array.p_index_type, p_context->p_integer_type);
 
             p_result_type = p_array_type;
 
@@ -297,7 +289,7 @@ cx_type *cx_parser::parse_factor(void) {
             break;
         default:
             cx_error(err_invalid_expression);
-            p_result_type = p_dummy_type;
+            p_result_type = p_context->p_dummy_type;
             break;
     }
 
@@ -324,28 +316,37 @@ cx_type *cx_parser::parse_variable(const cx_symtab_node* p_id) {
             break;
 
         default:
-            p_result_type = p_dummy_type;
+            p_result_type = p_context->p_dummy_type;
             cx_error(err_invalid_identifier_usage);
             break;
     }
 
+    // see parse_atomic_call
+    if (p_id->is_atomic) cx_error(err_atomic_usage);
+
     //  [ or . : Loop to parse any subscripts and fields.
     int done_flag = false;
+    bool whole = true; // the variable itself, not an element or a field
     do {
         switch (token) {
 
             case tc_left_subscript:
                 p_result_type = parse_subscripts(p_result_type);
+                whole = false;
                 break;
 
             case tc_dot:
                 p_result_type = parse_field(p_result_type);
+                whole = false;
                 break;
 
             default: done_flag = true;
         }
     } while (!done_flag);
 
+    if (token_in(token, tokenlist_assign_ops)) note_store(p_id, token, whole);
+    else note_fetch(p_id);
+
     if (token_in(token, tokenlist_assign_ops)) {
         cx_type *p_expr_type = nullptr;
 
@@ -544,9 +545,9 @@ cx_type *cx_parser::parse_field(const cx_type* p_type) {
 
         cx_error(err_invalid_field);
         get_token_append();
-        return p_dummy_type;
+        return p_context->p_dummy_type;
 
     }
 
-    return p_dummy_type;
+    return p_context->p_dummy_type;
 }
@@ -0,0 +1,343 @@
+/** Parser (Parallel Loops)
+ * parse_parallel.cpp
+ *
+ * parse parallel for loops, whose iterations are split among the
+ * threads of a pool (see cx-debug/parallel.cpp).  The body is
+ * checked as it's parsed:  it may store only into variables it
+ * declares, into elements of shared arrays and records, and into
+ * the loop's reductions with their own operator.  It may not do
+ * I/O, nor call a routine that stores into a global or does I/O.
+ *
+ * The same checks tell whether each routine has effects, so the
+ * routines a body calls can be checked before the body is run.
+ */
+
+#include <algorithm>
+#include "common.h"
+#include "parser.h"
+
+/** folds_into          True if an assignment operator updates a
+ *                      reduction with the reduction's operator.
+ *
+ * @param op : assignment operator.
+ * @param reduction_op : the reduction's operator.
+ * @return true if the operator folds into the reduction.
+ */
+static bool folds_into(cx_token_code op, cx_token_code reduction_op) {
+    switch (reduction_op) {
+        case tc_plus:
+            return (op == tc_plus_equal) || (op == tc_minus_equal)
+                    || (op == tc_plus_plus) || (op == tc_minus_minus);
+        case tc_star: return op == tc_star_equal;
+        case tc_bit_AND: return op == tc_bit_AND_equal;
+        case tc_bit_OR: return op == tc_bit_OR_equal;
+        case tc_bit_XOR: return op == tc_bit_XOR_equal;
+        default:
+            return false;
+    }
+}
+
+/** is_reducible        True if a variable of the given type can be
+ *                      a reduction with the given operator.
+ *
+ * @param p_context : context of the types.
+ * @param p_type    : ptr to the variable's type object.
+ * @param op        : the reduction's operator.
+ * @return true if it can.
+ */
+static bool is_reducible(const cx_context *p_context, const cx_type *p_type,
+        cx_token_code op) {
+    const bool integer = (p_type == p_context->p_integer_type)
+            || (p_type == p_context->p_uint8_type)
+            || (p_type == p_context->p_uint16_type)
+            || (p_type == p_context->p_uint32_type)
+            || (p_type == p_context->p_uint64_type);
+
+    switch (op) {
+        case tc_plus:
+        case tc_star:
+            return integer || (p_type == p_context->p_float_type);
+        case tc_bit_AND:
+        case tc_bit_OR:
+        case tc_bit_XOR:
+            return integer;
+        default:
+            return false;
+    }
+}
+
+/** parse_PARALLEL       parse a parallel for statement.
+ *
+ *      parallel for (<id> = <expr>; <id> < <expr>; <id>++)
+ *              <statement>;
+ *      parallel (+ <id>, ...) for (<id> = <expr>; <id> <= <expr>; <id> += <number>)
+ *              <statement>;
+ *
+ * The icode is a call marker with the loop's index into the
+ * context's parallel loops, then the for statement as parse_FOR
+ * appends it.
+ *
+ * @param p_function_id : ptr to this statements function Id.
+ */
+void cx_parser::parse_PARALLEL(cx_symtab_node* p_function_id) {
+    if (parallel_index >= 0) cx_error(err_invalid_parallel_for);
+
+    const int xloop = p_context->parallel_loops.size();
+    p_context->parallel_loops.push_back(cx_parallel_loop());
+    p_context->parallel_loops[xloop].p_index_id = nullptr;
+    p_context->parallel_loops[xloop].step = 1;
+    icode.put_call_marker(xloop);
+
+    // the reductions are kept with the loop, not in the icode
+    get_token();
+    if (token == tc_left_paren) parse_reductions(p_context->parallel_loops[xloop]);
+
+    if (token != tc_FOR) {
+        cx_error(err_invalid_parallel_for);
+        return;
+    }
+
+    icode.put(tc_FOR);
+
+    int break_point = put_location_marker();
+    int statement_marker = put_location_marker();
+    int condition_marker = put_location_marker();
+    int increment_marker = put_location_marker();
+
+    get_token_append(); // for
+    conditional_get_token_append(tc_left_paren, err_missing_left_paren);
+
+    //  <id> = <expr> ;  The index must be an int variable of its own.
+    const cx_symtab_node *p_index_id = (token == tc_identifier)
+            ? find(p_token->string__()) : nullptr;
+
+    if ((p_index_id == nullptr) || (p_index_id->p_type != p_context->p_integer_type)
+            || ((p_index_id->defn.how != dc_variable)
+            && (p_index_id->defn.how != dc_value_parm))) {
+        cx_error(err_invalid_parallel_for);
+        return;
+    }
+
+    for (const cx_reduction &reduction : p_context->parallel_loops[xloop].reductions) {
+        if (reduction.p_id == p_index_id) cx_error(err_invalid_parallel_for);
+    }
+
+    p_context->parallel_loops[xloop].p_index_id = p_index_id;
+
+    icode.put(p_index_id);
+    get_token_append();
+    if (token != tc_equal) cx_error(err_invalid_parallel_for);
+    parse_assignment(p_index_id);
+    conditional_get_token_append(tc_semicolon, err_missing_semicolon);
+
+    //  <id> < <expr> ;  or  <id> <= <expr> ;
+    fixup_location_marker(condition_marker);
+    parse_loop_index(p_index_id);
+    if ((token != tc_lessthan) && (token != tc_lessthan_equal)) {
+        cx_error(err_invalid_parallel_for);
+    }
+
+    get_token_append();
+    check_assignment_type_compatible(p_context->p_integer_type, parse_expression(),
+            err_incompatible_types);
+    conditional_get_token_append(tc_semicolon, err_missing_semicolon);
+
+    //  <id>++  or  <id> += <number>
+    fixup_location_marker(increment_marker);
+    parse_loop_index(p_index_id);
+    if (token == tc_plus_plus) {
+        get_token_append();
+    } else if (token == tc_plus_equal) {
+        get_token_append();
+
+        if ((token == tc_number) && (p_token->type() == ty_integer)
+                && (p_token->value().int__ > 0)) {
+            p_context->parallel_loops[xloop].step = p_token->value().int__;
+        } else cx_error(err_invalid_parallel_for);
+
+        parse_factor();
+    } else cx_error(err_invalid_parallel_for);
+
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+    fixup_location_marker(statement_marker);
+
+    // the body
+    const int outer_loop_depth = loop_depth;
+
+    parallel_index = xloop;
+    loop_depth = 0;
+
+    parse_statement(p_function_id);
+
+    parallel_index = -1;
+    loop_depth = outer_loop_depth;
+
+    fixup_location_marker(break_point);
+}
+
+/** parse_reductions     parse the reductions of a parallel for:
+ *
+ *      ( <op> <id>, ... )
+ *
+ * where <op> is + * & | or ^.
+ *
+ * @param loop : the loop the reductions are added to.
+ */
+void cx_parser::parse_reductions(cx_parallel_loop &loop) {
+    do {
+        get_token(); // ( or ,
+
+        const cx_token_code op = token;
+        get_token();
+
+        cx_symtab_node *p_id = (token == tc_identifier)
+                ? find(p_token->string__()) : nullptr;
+
+        if ((p_id == nullptr) || ((p_id->defn.how != dc_variable)
+                && (p_id->defn.how != dc_value_parm))
+                || !is_reducible(p_context, p_id->p_type, op)) {
+            cx_error(err_invalid_parallel_for);
+        } else {
+            cx_reduction reduction;
+
+            reduction.p_id = p_id;
+            reduction.op = op;
+            loop.reductions.push_back(reduction);
+        }
+
+        get_token();
+    } while (token == tc_comma);
+
+    conditional_get_token(tc_right_paren, err_missing_right_paren);
+}
+
+/** parse_loop_index     parse the index of a parallel for where its
+ *                      condition and increment start.
+ *
+ * @param p_index_id : ptr to the index's symtab node.
+ */
+void cx_parser::parse_loop_index(const cx_symtab_node *p_index_id) {
+    if ((token != tc_identifier) || (search_all(p_token->string__()) != p_index_id)) {
+        cx_error(err_invalid_parallel_for);
+        return;
+    }
+
+    icode.put(p_index_id);
+    get_token_append();
+}
+
+/** note_private         Note a variable declared in the body of a
+ *                      parallel for:  each worker gets its own.
+ *
+ * @param p_id : ptr to the variable's symtab node.
+ */
+void cx_parser::note_private(const cx_symtab_node *p_id) {
+    if (parallel_index < 0) return;
+
+    p_context->parallel_loops[parallel_index].private_ids.push_back(p_id);
+}
+
+/** note_store           Note a store into a variable, or into an
+ *                      element or a field of it.
+ *
+ * @param p_id  : ptr to the variable's symtab node.
+ * @param op    : the assignment operator, or tc_dummy if the
+ *                variable is handed to a routine that stores
+ *                into it.
+ * @param whole : false if only an element or a field is stored.
+ */
+void cx_parser::note_store(const cx_symtab_node *p_id, cx_token_code op, bool whole) {
+    if (p_id->p_type == nullptr) return;
+
+    if (p_id->p_type->form == fc_stream) {
+        note_side_effect();
+        return;
+    }
+
+    // a function's value is its own
+    if ((p_id->level == 0) && (p_id->defn.how != dc_function)
+            && (p_routine_id != nullptr)) {
+        p_routine_id->defn.routine.has_effects = true;
+    }
+
+    if (!is_shared(p_id)) return;
+
+    cx_parallel_loop &loop = p_context->parallel_loops[parallel_index];
+
+    for (const cx_reduction &reduction : loop.reductions) {
+        if (reduction.p_id == p_id) {
+            if (!whole || !folds_into(op, reduction.op)) {
+                cx_error(err_invalid_parallel_for);
+            }
+
+            return;
+        }
+    }
+
+    if (whole || p_id->p_type->is_scalar_type()) {
+        cx_error(err_parallel_store);
+    } else if ((p_id->defn.how != dc_reference)
+            && (std::find(loop.stored_ids.begin(), loop.stored_ids.end(), p_id)
+            == loop.stored_ids.end())) {
+
+        // its buffer is made the variable's own before the loop
+        loop.stored_ids.push_back(p_id);
+    }
+}
+
+/** note_fetch           Note a fetch of a variable.  The partial
+ *                      value of a reduction means nothing, so it
+ *                      can't be fetched.
+ *
+ * @param p_id : ptr to the variable's symtab node.
+ */
+void cx_parser::note_fetch(const cx_symtab_node *p_id) {
+    if ((p_id->p_type != nullptr) && (p_id->p_type->form == fc_stream)) {
+        note_side_effect();
+    }
+
+    if (parallel_index < 0) return;
+
+    for (const cx_reduction &reduction
+            : p_context->parallel_loops[parallel_index].reductions) {
+        if (reduction.p_id == p_id) cx_error(err_invalid_parallel_for);
+    }
+}
+
+/** note_call            Note a call.  A routine not yet defined is
+ *                      taken to have effects.
+ *
+ * @param p_function_id : ptr to the called routine's symtab node.
+ */
+void cx_parser::note_call(const cx_symtab_node *p_function_id) {
+    if ((p_function_id->defn.routine.which == rc_forward)
+            || p_function_id->defn.routine.has_effects) {
+        note_side_effect();
+    }
+}
+
+/** note_side_effect     Note I/O, or a call to a routine with
+ *                      effects.
+ */
+void cx_parser::note_side_effect(void) {
+    if (p_routine_id != nullptr) p_routine_id->defn.routine.has_effects = true;
+
+    if (parallel_index >= 0) cx_error(err_parallel_side_effect);
+}
+
+/** is_shared            True if the workers of the parallel for
+ *                      whose body is being parsed all see the
+ *                      variable.
+ *
+ * @param p_id : ptr to the variable's symtab node.
+ * @return true if it's shared.
+ */
+bool cx_parser::is_shared(const cx_symtab_node *p_id) const {
+    if (parallel_index < 0) return false;
+
+    const std::vector<const cx_symtab_node *> &private_ids =
+            p_context->parallel_loops[parallel_index].private_ids;
+
+    return std::find(private_ids.begin(), private_ids.end(), p_id)
+            == private_ids.end();
+}
@@ -2,8 +2,6 @@
 #include "common.h"
 #include "parser.h"
 
-extern cx_symtab_node *p_program_ptr_id;
-
 /** parse_function_header         parse a function header:
  *
  *                              <type-id> <id> (<parm-list>);
@@ -44,6 +42,11 @@ cx_symtab_node *cx_parser::parse_function_header(cx_symtab_node *p_function_id)
     p_function_id->defn.routine.locals.p_variable_ids = nullptr;
     p_function_id->defn.routine.locals.p_function_ids = nullptr;
 
+    // set once the body is parsed; an aborted parse leaves none
+    p_function_id->defn.routine.p_symtab = nullptr;
+    p_function_id->defn.routine.p_icode = nullptr;
+    p_function_id->defn.routine.has_effects = false;
+
     //  )
     conditional_get_token_append(tc_right_paren, err_missing_right_paren);
 
@@ -51,15 +54,15 @@ cx_symtab_node *cx_parser::parse_function_header(cx_symtab_node *p_function_id)
         p_function_id->defn.routine.which = rc_forward;
     } else if (token == tc_left_bracket) {
 
-        if (!p_program_ptr_id->found_global_end) {
-            p_program_ptr_id->found_global_end = true;
-            icode.go_to(p_program_ptr_id->global_finish_location);
+        if (!p_context->p_program_ptr_id->found_global_end) {
+            p_context->p_program_ptr_id->found_global_end = true;
+            icode.go_to(p_context->p_program_ptr_id->global_finish_location);
             icode.put(__MAIN_ENTRY__);
             icode.put(tc_semicolon);
             icode.put(tc_right_bracket);
 
             // Set the program's icode.
-            p_program_ptr_id->defn.routine.p_icode = new cx_icode(icode);
+            p_context->p_program_ptr_id->defn.routine.p_icode = new cx_icode(icode);
 
         }
 
@@ -87,8 +90,13 @@ void cx_parser::parse_block(cx_symtab_node *p_function_id) {
     if (token != tc_left_bracket) cx_error(err_missing_left_bracket);
     icode.reset();
 
+    cx_symtab_node *p_outer_routine_id = p_routine_id;
+    p_routine_id = p_function_id;
+
     parse_compound(p_function_id);
 
+    p_routine_id = p_outer_routine_id;
+
     // Set the program's or routine's icode.
     p_function_id->defn.routine.p_icode = new cx_icode(icode);
 }
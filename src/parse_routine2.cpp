@@ -24,6 +24,7 @@ cx_symtab_node *cx_parser::parse_formal_parm_list(cx_symtab_node *p_function_id,
     // Loop to parse the comma-separated sublist of parameter ids.
     cx_type *p_parm_type; // ptr to parm's type object
     while (token == tc_identifier) {
+        is_array = false;
 
         // find param type
         p_node = find(p_token->string__());
@@ -60,7 +61,8 @@ cx_symtab_node *cx_parser::parse_formal_parm_list(cx_symtab_node *p_function_id,
 
         icode.put(p_parm_id);
 
-        ++count;
+        // parms take the first slots of the function's frame
+        p_parm_id->defn.data.offset = count++;
         if (!p_parm_list) p_parm_list = p_parm_id;
 
         // Link the parm id nodes together.
@@ -139,12 +141,16 @@ cx_type *cx_parser::parse_subroutine_call(const cx_symtab_node *p_function_id,
         bool parm_check_flag) {
     //get_token_append();
 
+    note_call(p_function_id);
+
     return (p_function_id->defn.routine.which == rc_declared) ||
-            (p_function_id->defn.routine.which == rc_forward)
+            (p_function_id->defn.routine.which == rc_forward) ||
+            (p_function_id->defn.routine.which == rc_intrinsic) ||
+            (p_function_id->defn.routine.which == rc_host)
             ||
             !parm_check_flag
             ? parse_declared_subroutine_call(p_function_id, parm_check_flag)
-            : parse_declared_subroutine_call(p_function_id, parm_check_flag);
+            : parse_standard_subroutine_call(p_function_id);
 }
 
 /** parse_declared_subroutine_call parse a call to a declared
@@ -161,10 +167,61 @@ cx_type *cx_parser::parse_declared_subroutine_call
     return p_function_id->p_type;
 }
 
+/** parse_spawn         parse a spawn, which calls a declared routine
+ *                      as a task that runs beside its spawner (see
+ *                      cx-debug/task.cpp):
+ *
+ *                          spawn <id>(<expr-list>)
+ *
+ *                      The spawn's value is the task's handle, for
+ *                      join.
+ *
+ * @return ptr to the int type object.
+ */
+cx_type *cx_parser::parse_spawn(void) {
+    note_side_effect();
+
+    get_token_append();
+    cx_symtab_node *p_function_id = (token == tc_identifier)
+            ? search_all(p_token->string__()) : nullptr;
+
+    if ((p_function_id == nullptr) || (p_function_id->defn.how != dc_function)
+            || ((p_function_id->defn.routine.which != rc_declared)
+            && (p_function_id->defn.routine.which != rc_forward))) {
+        cx_error(err_invalid_spawn);
+        return p_context->p_integer_type;
+    }
+
+    // the task may outlive the spawner's variables
+    for (const cx_symtab_node *p_parm_id = p_function_id->defn.routine.locals.p_parms_ids;
+            p_parm_id != nullptr; p_parm_id = p_parm_id->next__) {
+        if (p_parm_id->defn.how == dc_reference) cx_error(err_invalid_spawn);
+    }
+
+    icode.put(p_function_id);
+    get_token_append();
+
+    const int xsite = p_context->call_sites.size();
+    parse_subroutine_call(p_function_id, true);
+
+    // nor can the spawner count the owners of a buffer it shares
+    if (xsite < (int) p_context->call_sites.size()) {
+        for (cx_actual_parm &parm : p_context->call_sites[xsite].parms) {
+            parm.share_value = false;
+        }
+    }
+
+    return p_context->p_integer_type;
+}
+
 /** parse_actual_parm_list     parse an actual parameter list:
  *
  *                              ( <expr-list> )
  *
+ *                          and resolve the call site, so the executor
+ *                          can bind each actual parameter without
+ *                          looking at the formal parameters again.
+ *
  * @param p_function_id    : ptr to routine id's symbol table node.
  * @param parm_check_flag : true to check parameter, false not to.
  */
@@ -181,6 +238,11 @@ void cx_parser::parse_actual_parm_list(const cx_symtab_node *p_function_id,
         return;
     }
 
+    const int xsite = p_context->call_sites.size();
+    p_context->call_sites.push_back(cx_call_site());
+    p_context->call_sites[xsite].p_function_id = p_function_id;
+    icode.put_call_marker(xsite);
+
     /* Loop to parse actual parameter expressions
      * separated by commas. */
     do {
@@ -192,13 +254,34 @@ void cx_parser::parse_actual_parm_list(const cx_symtab_node *p_function_id,
             return;
         }
 
-        parse_actual_parm(p_formal_id, parm_check_flag);
+        cx_actual_parm parm = parse_actual_parm(p_formal_id, parm_check_flag);
+        p_context->call_sites[xsite].parms.push_back(parm);
+
         if (p_formal_id) p_formal_id = p_formal_id->next__;
     } while (token == tc_comma);
 
     //  )
     conditional_get_token_append(tc_right_paren, err_missing_right_paren);
 
+    /* An array or record value can share its buffer with the callee
+     * only if the callee has no other way to store into it:  the
+     * actual must be a local that isn't also passed by reference.
+     * The workers of a parallel for can't count its owners either. */
+    std::vector<cx_actual_parm> &parms = p_context->call_sites[xsite].parms;
+    for (cx_actual_parm &parm : parms) {
+        const cx_symtab_node *p_id = parm.p_variable_id;
+
+        if (!parm.copy_value || (p_id == nullptr) || (p_id->level == 0)
+                || (p_id->defn.how == dc_reference) || is_shared(p_id)) continue;
+
+        parm.share_value = true;
+        for (const cx_actual_parm &other : parms) {
+            if (other.reference && (other.p_variable_id == p_id)) {
+                parm.share_value = false;
+            }
+        }
+    }
+
     // There better not be any more formal parameters.
     if (parm_check_flag && p_formal_id) cx_error(err_wrong_number_of_parms);
 }
@@ -209,15 +292,24 @@ void cx_parser::parse_actual_parm_list(const cx_symtab_node *p_function_id,
  * @param p_formal_id     : ptr to the corresponding formal parm
  *                        id's symbol table node
  * @param parm_check_flag : true to check parameter, false not to.
+ * @return how the actual parameter binds to the formal.
  */
-void cx_parser::parse_actual_parm(const cx_symtab_node *p_formal_id,
+cx_actual_parm cx_parser::parse_actual_parm(const cx_symtab_node *p_formal_id,
         int parm_check_flag) {
+    cx_actual_parm parm;
+
+    parm.reference = false;
+    parm.int_to_float = false;
+    parm.copy_value = false;
+    parm.share_value = false;
+    parm.p_variable_id = nullptr;
+
     /* If we're not checking the actual parameters against
      * the corresponding formal parameters (as during error
      * recovery), just parse the actual parameter. */
     if (!parm_check_flag) {
         parse_expression();
-        return;
+        return parm;
     }
 
     /* If we've already run out of formal parameter,
@@ -226,7 +318,7 @@ void cx_parser::parse_actual_parm(const cx_symtab_node *p_formal_id,
     if (!p_formal_id) {
         cx_error(err_wrong_number_of_parms);
         parse_expression();
-        return;
+        return parm;
     }
 
     /* Formal value parameter: The actual parameter can be an
@@ -234,15 +326,38 @@ void cx_parser::parse_actual_parm(const cx_symtab_node *p_formal_id,
      *                         assignment type compatible with
      *                         the formal parameter. */
     if (p_formal_id->defn.how == dc_value_parm) {
-        check_assignment_type_compatible(p_formal_id->p_type,
-                parse_expression(),
+        cx_symtab_node *p_actual_id = (token == tc_identifier)
+                ? find(p_token->string__()) : nullptr;
+        const int at_actual = icode.current_location();
+
+        cx_type *p_formal_type = p_formal_id->p_type;
+        cx_type *p_actual_type = parse_expression();
+
+        /* A bare variable appends only its symtab node, and the
+         * , or ) that follows it. */
+        if ((p_actual_id != nullptr)
+                && ((p_actual_id->defn.how == dc_variable)
+                || (p_actual_id->defn.how == dc_value_parm)
+                || (p_actual_id->defn.how == dc_reference))
+                && (icode.current_location()
+                == at_actual + 2 * (int) sizeof (short) + (int) sizeof (char))) {
+            parm.p_variable_id = p_actual_id;
+        }
+
+        check_assignment_type_compatible(p_formal_type, p_actual_type,
                 err_incompatible_types);
+
+        parm.int_to_float = (p_formal_type == p_context->p_float_type)
+                && (p_actual_type->base_type() == p_context->p_integer_type);
+        parm.copy_value = !p_formal_type->is_scalar_type();
     }/* Formal VAR parameter: The actual parameter must be a
          *                       variable of the same type as the
          *                       formal parameter. */
     else if (token == tc_identifier) {
         cx_symtab_node *p_actual_id = find(p_token->string__());
 
+        parm.reference = true;
+
         // skip type declaration
         if (p_actual_id->defn.how == dc_type) {
             get_token();
@@ -253,10 +368,24 @@ void cx_parser::parse_actual_parm(const cx_symtab_node *p_formal_id,
         }
 
         icode.put(p_actual_id);
+        parm.p_variable_id = p_actual_id;
 
         get_token_append();
-        if (p_formal_id->p_type->base_type()
-                != parse_variable(p_actual_id)->base_type()) {
+
+        // an array is bound through its slot, so it must be named whole
+        const bool whole = (token == tc_comma) || (token == tc_right_paren);
+        cx_type *p_actual_type = parse_variable(p_actual_id);
+        note_store(p_actual_id, tc_dummy, true);
+
+        if ((p_formal_id->p_type->form == fc_array)
+                && (!whole || (p_actual_type->form != fc_array))) {
+            cx_error(err_invalid_reference);
+        }
+
+        // every stream has a type object of its own
+        if ((p_formal_id->p_type->base_type() != p_actual_type->base_type())
+                && ((p_formal_id->p_type->form != fc_stream)
+                || (p_actual_type->form != fc_stream))) {
             cx_error(err_incompatible_types);
         }
         resync(tokenlist_expression_follow, tokenlist_statement_follow, tokenlist_statement_start);
@@ -265,4 +394,6 @@ void cx_parser::parse_actual_parm(const cx_symtab_node *p_formal_id,
         parse_expression();
         cx_error(err_invalid_reference);
     }
+
+    return parm;
 }
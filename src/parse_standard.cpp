@@ -0,0 +1,772 @@
+/** Parser (Standard Routines)
+ * parse_standard.cpp
+ *
+ * Enter the standard routines into the global symbol table,
+ * and parse calls to them.
+ */
+
+#include "common.h"
+#include "format.h"
+#include "parser.h"
+
+///  cx_std_routine      A standard routine's name, routine code
+///                     and result type, as the context member
+///                     that holds the type.
+
+struct cx_std_routine {
+    const char *p_name;
+    cx_routine_code rc;
+    cx_type *cx_context::*p_type;
+};
+
+static const cx_std_routine std_routines[] = {
+    {"reserve", rc_reserve, &cx_context::p_integer_type},
+    {"getline", rc_getline, &cx_context::p_integer_type},
+    {"getint", rc_getint, &cx_context::p_integer_type},
+    {"getfloat", rc_getfloat, &cx_context::p_float_type},
+    {"fopen", rc_fopen, &cx_context::p_integer_type},
+    {"fclose", rc_fclose, &cx_context::p_integer_type},
+    {"fmap", rc_fmap, &cx_context::p_integer_type},
+    {"fread", rc_fread, &cx_context::p_integer_type},
+    {"fwrite", rc_fwrite, &cx_context::p_integer_type},
+    {"pread", rc_pread, &cx_context::p_integer_type},
+    {"transfer", rc_transfer, &cx_context::p_integer_type},
+    {"getu8", rc_getu8, &cx_context::p_integer_type},
+    {"getu16le", rc_getu16le, &cx_context::p_integer_type},
+    {"getu16be", rc_getu16be, &cx_context::p_integer_type},
+    {"getu32le", rc_getu32le, &cx_context::p_uint32_type},
+    {"getu32be", rc_getu32be, &cx_context::p_uint32_type},
+    {"getu64le", rc_getu64le, &cx_context::p_uint64_type},
+    {"getu64be", rc_getu64be, &cx_context::p_uint64_type},
+    {"getbits", rc_getbits, &cx_context::p_integer_type},
+    {"putu8", rc_putu8, &cx_context::p_integer_type},
+    {"putu16le", rc_putu16le, &cx_context::p_integer_type},
+    {"putu16be", rc_putu16be, &cx_context::p_integer_type},
+    {"putu32le", rc_putu32le, &cx_context::p_integer_type},
+    {"putu32be", rc_putu32be, &cx_context::p_integer_type},
+    {"putu64le", rc_putu64le, &cx_context::p_integer_type},
+    {"putu64be", rc_putu64be, &cx_context::p_integer_type},
+    {"printf", rc_printf, &cx_context::p_integer_type},
+    {"fprintf", rc_fprintf, &cx_context::p_integer_type},
+    {"connect", rc_connect, &cx_context::p_integer_type},
+    {"listen", rc_listen, &cx_context::p_integer_type},
+    {"wait", rc_wait, &cx_context::p_integer_type},
+    {"ready", rc_ready, &cx_context::p_integer_type},
+    {"join", rc_join, &cx_context::p_integer_type},
+    {"channel", rc_channel, &cx_context::p_integer_type},
+    {"send", rc_send, &cx_context::p_boolean_type},
+    {"try_send", rc_try_send, &cx_context::p_boolean_type},
+    {"receive", rc_receive, &cx_context::p_boolean_type},
+    {"try_receive", rc_try_receive, &cx_context::p_boolean_type},
+    {"close", rc_close, &cx_context::p_integer_type},
+    {"load", rc_load, &cx_context::p_integer_type},
+    {"store", rc_store, &cx_context::p_integer_type},
+    {"fetch_add", rc_fetch_add, &cx_context::p_integer_type},
+    {"compare_exchange", rc_compare_exchange, &cx_context::p_boolean_type},
+    {nullptr, rc_declared, nullptr}
+};
+
+/** initialize_std_functions   Enter the standard routines into
+ *                              the global symbol table.
+ *
+ * @param p_context : ptr to the context whose global symbol
+ *                    table they go in.
+ */
+void initialize_std_functions(cx_context *p_context) {
+    for (int i = 0; std_routines[i].p_name != nullptr; ++i) {
+        cx_symtab_node *p_routine_id = p_context->global_symtab.enter(
+                std_routines[i].p_name, dc_function);
+
+        p_routine_id->defn.routine.which = std_routines[i].rc;
+        p_routine_id->defn.routine.parm_count = 0;
+        p_routine_id->defn.routine.total_parm_size = 0;
+        p_routine_id->defn.routine.total_local_size = 0;
+        p_routine_id->defn.routine.locals.p_parms_ids = nullptr;
+        p_routine_id->defn.routine.locals.p_constant_ids = nullptr;
+        p_routine_id->defn.routine.locals.p_type_ids = nullptr;
+        p_routine_id->defn.routine.locals.p_variable_ids = nullptr;
+        p_routine_id->defn.routine.locals.p_function_ids = nullptr;
+        p_routine_id->defn.routine.p_symtab = nullptr;
+        p_routine_id->defn.routine.p_icode = nullptr;
+
+        // all but reserve, the byte views and the atomics do I/O
+        p_routine_id->defn.routine.has_effects = (std_routines[i].rc != rc_reserve)
+                && ((std_routines[i].rc < rc_getu8) || (std_routines[i].rc > rc_putu64be))
+                && ((std_routines[i].rc < rc_load) || (std_routines[i].rc > rc_compare_exchange));
+
+        set_type(p_routine_id->p_type, p_context->*std_routines[i].p_type);
+    }
+}
+
+/** parse_standard_subroutine_call   parse a call to a standard
+ *                                  routine.
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_standard_subroutine_call(const cx_symtab_node *p_function_id) {
+    p_context->called_standard_routines.insert(p_function_id);
+
+    switch (p_function_id->defn.routine.which) {
+        case rc_reserve: return parse_reserve_call(p_function_id);
+        case rc_getline:
+        case rc_getint:
+        case rc_getfloat: return parse_stream_read_call(p_function_id);
+        case rc_fopen:
+        case rc_fclose:
+        case rc_fmap: return parse_file_call(p_function_id);
+        case rc_fread:
+        case rc_fwrite:
+        case rc_pread: return parse_binary_io_call(p_function_id);
+        case rc_transfer: return parse_transfer_call(p_function_id);
+        case rc_getu8:
+        case rc_getu16le:
+        case rc_getu16be:
+        case rc_getu32le:
+        case rc_getu32be:
+        case rc_getu64le:
+        case rc_getu64be:
+        case rc_getbits:
+        case rc_putu8:
+        case rc_putu16le:
+        case rc_putu16be:
+        case rc_putu32le:
+        case rc_putu32be:
+        case rc_putu64le:
+        case rc_putu64be: return parse_byte_view_call(p_function_id);
+        case rc_printf:
+        case rc_fprintf: return parse_format_call(p_function_id);
+        case rc_connect:
+        case rc_listen:
+        case rc_wait:
+        case rc_ready: return parse_socket_call(p_function_id);
+        case rc_join:
+        case rc_close: return parse_handle_call(p_function_id);
+        case rc_channel: return parse_channel_call(p_function_id);
+        case rc_send:
+        case rc_try_send:
+        case rc_receive:
+        case rc_try_receive: return parse_channel_io_call(p_function_id);
+        case rc_load:
+        case rc_store:
+        case rc_fetch_add:
+        case rc_compare_exchange: return parse_atomic_call(p_function_id);
+        default:
+            cx_error(err_unimplemented_feature);
+            return p_context->p_dummy_type;
+    }
+}
+
+/** parse_reserve_call    parse a call to reserve, which makes room
+ *                      in an array's buffer for the given number
+ *                      of elements:
+ *
+ *                          reserve(<array-variable>, <expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_reserve_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    // array variable
+    get_token_append();
+    if (token == tc_identifier) {
+        cx_symtab_node *p_array_id = find(p_token->string__());
+
+        icode.put(p_array_id);
+        get_token_append();
+
+        if (parse_variable(p_array_id)->form != fc_array) {
+            cx_error(err_incompatible_types);
+        }
+
+        // the buffer may move
+        note_store(p_array_id, tc_dummy, true);
+    } else {
+        cx_error(err_missing_variable);
+        parse_expression();
+    }
+
+    //  ,
+    conditional_get_token_append(tc_comma, err_missing_comma);
+
+    // element count
+    check_assignment_type_compatible(p_context->p_integer_type, parse_expression(),
+            err_incompatible_types);
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_stream_read_call        parse a call to getline, getint or
+ *                              getfloat, which read from a stream:
+ *
+ *                                  getline(<stream>, <char-array-variable>)
+ *                                  getint(<stream>)
+ *                                  getfloat(<stream>)
+ *
+ *                              getline reads into an array of unknown
+ *                              size (char *).
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_stream_read_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+    parse_stream_argument();
+
+    // line variable
+    if (p_function_id->defn.routine.which == rc_getline) {
+        conditional_get_token_append(tc_comma, err_missing_comma);
+        parse_char_array_argument();
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_file_call       parse a call to fopen, fclose or fmap:
+ *
+ *                          fopen(<stream>, <name-expr>, <mode-expr>)
+ *                          fclose(<stream>)
+ *                          fmap(<stream>, <char-array-variable>)
+ *                          fmap(<stream>, <char-array-variable>,
+ *                                  <offset-expr>, <length-expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_file_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+    parse_stream_argument();
+
+    switch (p_function_id->defn.routine.which) {
+        case rc_fopen:
+            for (int i = 0; i < 2; ++i) {
+                conditional_get_token_append(tc_comma, err_missing_comma);
+
+                cx_type *p_type = parse_expression();
+                if (p_type->base_type() != p_context->p_char_type) {
+                    cx_error(err_incompatible_types);
+                }
+            }
+            break;
+        case rc_fmap:
+            conditional_get_token_append(tc_comma, err_missing_comma);
+            parse_char_array_argument();
+
+            // optional window of the file
+            if (token == tc_comma) {
+                for (int i = 0; i < 2; ++i) {
+                    conditional_get_token_append(tc_comma, err_missing_comma);
+                    check_assignment_type_compatible(p_context->p_integer_type,
+                            parse_expression(), err_incompatible_types);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_binary_io_call   parse a call to fread, fwrite or pread,
+ *                        which move the bytes of a whole value:
+ *
+ *                          fread(<stream>, <variable>)
+ *                          fread(<stream>, <variable>, <count-expr>)
+ *                          fwrite(<stream>, <expr>)
+ *                          fwrite(<stream>, <expr>, <count-expr>)
+ *                          pread(<stream>, <variable>, <offset-expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_binary_io_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+    parse_stream_argument();
+
+    conditional_get_token_append(tc_comma, err_missing_comma);
+
+    const cx_routine_code which = p_function_id->defn.routine.which;
+    cx_type *p_type = (which == rc_fwrite)
+            ? parse_expression() : parse_variable_argument();
+
+    if (p_type->form == fc_stream) cx_error(err_incompatible_types);
+
+    // element count, or the file offset to read from
+    if ((token == tc_comma) || (which == rc_pread)) {
+        conditional_get_token_append(tc_comma, err_missing_comma);
+        check_assignment_type_compatible(p_context->p_integer_type,
+                parse_expression(), err_incompatible_types);
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_transfer_call   parse a call to transfer, which copies
+ *                      from one stream to another:
+ *
+ *                          transfer(<stream>, <stream>)
+ *                          transfer(<stream>, <stream>, <length-expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_transfer_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+    parse_stream_argument();
+
+    conditional_get_token_append(tc_comma, err_missing_comma);
+    parse_stream_argument();
+
+    // optional number of bytes
+    if (token == tc_comma) {
+        get_token_append();
+        check_assignment_type_compatible(p_context->p_integer_type,
+                parse_expression(), err_incompatible_types);
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_byte_view_call  parse a call that loads or stores an
+ *                      integer at a byte offset into an array:
+ *
+ *                          getu16be(<array-variable>, <offset-expr>)
+ *                          putu16be(<array-variable>, <offset-expr>,
+ *                                  <value-expr>)
+ *                          getbits(<array-variable>, <bit-offset-expr>,
+ *                                  <count-expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_byte_view_call(const cx_symtab_node *p_function_id) {
+    const cx_routine_code which = p_function_id->defn.routine.which;
+
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    // an array of any element type is viewed as its bytes
+    get_token_append();
+    const cx_symtab_node *p_array_id = (token == tc_identifier)
+            ? search_all(p_token->string__()) : nullptr;
+
+    if (parse_variable_argument()->form != fc_array) {
+        cx_error(err_incompatible_types);
+    }
+
+    // a put stores into an element
+    if ((p_array_id != nullptr) && (which >= rc_putu8) && (which <= rc_putu64be)) {
+        note_store(p_array_id, tc_dummy, false);
+    }
+
+    conditional_get_token_append(tc_comma, err_missing_comma);
+    check_assignment_type_compatible(p_context->p_integer_type, parse_expression(),
+            err_incompatible_types);
+
+    if (which == rc_getbits) {
+        conditional_get_token_append(tc_comma, err_missing_comma);
+        check_assignment_type_compatible(p_context->p_integer_type, parse_expression(),
+                err_incompatible_types);
+    } else if ((which >= rc_putu8) && (which <= rc_putu64be)) {
+        conditional_get_token_append(tc_comma, err_missing_comma);
+        check_assignment_type_compatible(p_context->p_uint64_type, parse_expression(),
+                err_incompatible_types);
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_format_call     parse a call to printf or fprintf:
+ *
+ *                          printf(<format-expr>, <expr>, ...)
+ *                          fprintf(<stream>, <format-expr>, <expr>, ...)
+ *
+ *                      A literal format is compiled here, once, and
+ *                      the arguments checked against its conversions.
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_format_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+
+    if (p_function_id->defn.routine.which == rc_fprintf) {
+        parse_stream_argument();
+        conditional_get_token_append(tc_comma, err_missing_comma);
+    }
+
+    // format
+    const bool literal = (token == tc_string);
+    const std::string spelling = literal ? p_token->string__() : "";
+    cx_type *p_format_type = parse_expression();
+    const cx_format *p_format = nullptr;
+
+    if (literal && p_format_type->is_constant()) {
+        cx_symtab_node *p_literal_id = search_all(spelling.c_str());
+
+        p_format = cx_constant_format(p_literal_id->defn.constant.value.p_string);
+        if (p_format == nullptr) cx_error(err_invalid_constant);
+    } else if (p_format_type->base_type() != p_context->p_char_type) {
+        cx_error(err_incompatible_types);
+    }
+
+    // arguments
+    int count = 0;
+    while (token == tc_comma) {
+        get_token_append();
+        cx_type *p_type = parse_expression();
+
+        if ((p_format != nullptr) && (count < (int) p_format->conversions.size())) {
+            const char conversion = p_format->conversions[count];
+
+            // %s takes chars and char arrays, the rest only scalars
+            if (conversion == 's') {
+                if (p_type->base_type() != p_context->p_char_type) {
+                    cx_error(err_incompatible_types);
+                }
+            } else if (!p_type->is_scalar_type()) {
+                cx_error(err_incompatible_types);
+            } else if (strchr("feEgG", conversion) != nullptr) {
+                check_assignment_type_compatible(p_context->p_float_type, p_type,
+                        err_incompatible_types);
+            } else {
+                check_assignment_type_compatible(p_context->p_uint64_type, p_type,
+                        err_incompatible_types);
+            }
+        }
+
+        ++count;
+    }
+
+    if ((p_format != nullptr) && (count != (int) p_format->conversions.size())) {
+        cx_error(err_wrong_number_of_parms);
+    } else if (count > cx_format::max_args) {
+        cx_error(err_wrong_number_of_parms);
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_socket_call     parse a call to connect, listen, wait or
+ *                      ready.  The first three bind a file variable
+ *                      to a socket, so it can't be a parameter:
+ *
+ *                          connect(<file-variable>, <address-expr>)
+ *                          listen(<file-variable>, <address-expr>)
+ *                          wait(<file-variable>, <timeout-expr>)
+ *                          ready(<stream>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_socket_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+    const cx_symtab_node *p_stream_id = parse_stream_argument();
+    const cx_routine_code which = p_function_id->defn.routine.which;
+
+    if (which != rc_ready) {
+        if ((p_stream_id != nullptr) && (p_stream_id->defn.how != dc_variable)) {
+            cx_error(err_invalid_reference);
+        }
+
+        conditional_get_token_append(tc_comma, err_missing_comma);
+
+        cx_type *p_type = parse_expression();
+        if (which == rc_wait) {
+            check_assignment_type_compatible(p_context->p_integer_type, p_type,
+                    err_incompatible_types);
+        } else if (p_type->base_type() != p_context->p_char_type) {
+            cx_error(err_incompatible_types);
+        }
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_handle_call    parse a call to join, which waits for a task
+ *                      made by spawn, or to close, which closes a
+ *                      channel:
+ *
+ *                          join(<handle-expr>)
+ *                          close(<handle-expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_handle_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+    check_assignment_type_compatible(p_context->p_integer_type, parse_expression(),
+            err_incompatible_types);
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_channel_call   parse a call to channel, which makes a channel
+ *                      for values of a type, or for arrays of it of
+ *                      any length, holding up to a capacity of them,
+ *                      or any number for 0:
+ *
+ *                          channel(<type-id>, <capacity-expr>)
+ *                          channel(<type-id> *, <capacity-expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_channel_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    // type
+    get_token_append();
+    if (token == tc_identifier) {
+        cx_symtab_node *p_type_id = find(p_token->string__());
+
+        if ((p_type_id->defn.how != dc_type)
+                || (p_type_id->p_type->form == fc_stream)) {
+            cx_error(err_not_a_type_identifier);
+        }
+
+        icode.put(p_type_id);
+        get_token_append();
+
+        if (token == tc_star) get_token_append();
+    } else cx_error(err_not_a_type_identifier);
+
+    //  ,
+    conditional_get_token_append(tc_comma, err_missing_comma);
+
+    // capacity
+    check_assignment_type_compatible(p_context->p_integer_type, parse_expression(),
+            err_incompatible_types);
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_channel_io_call  parse a call to send, try_send, receive or
+ *                       try_receive.  Whether the value fits the
+ *                       channel's type is checked as it runs:
+ *
+ *                          send(<handle-expr>, <expr>)
+ *                          try_send(<handle-expr>, <expr>)
+ *                          receive(<handle-expr>, <variable>)
+ *                          try_receive(<handle-expr>, <variable>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object.
+ */
+cx_type *cx_parser::parse_channel_io_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    // handle
+    get_token_append();
+    check_assignment_type_compatible(p_context->p_integer_type, parse_expression(),
+            err_incompatible_types);
+
+    //  ,
+    conditional_get_token_append(tc_comma, err_missing_comma);
+
+    const cx_routine_code which = p_function_id->defn.routine.which;
+    cx_type *p_type = ((which == rc_send) || (which == rc_try_send))
+            ? parse_expression() : parse_variable_argument();
+
+    if (p_type->form == fc_stream) cx_error(err_incompatible_types);
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return p_function_id->p_type;
+}
+
+/** parse_atomic_call    parse a call to load, store, fetch_add or
+ *                      compare_exchange, on an atomic variable or an
+ *                      element of an atomic array:
+ *
+ *                          load(<atomic>)
+ *                          store(<atomic>, <expr>)
+ *                          fetch_add(<atomic>, <expr>)
+ *                          compare_exchange(<atomic>, <expected-expr>, <desired-expr>)
+ *
+ * @param p_function_id : ptr to the routine id's symbol table node.
+ * @return ptr to the call's type object:  the atomic's, or bool for
+ *         compare_exchange.
+ */
+cx_type *cx_parser::parse_atomic_call(const cx_symtab_node *p_function_id) {
+    if (token != tc_left_paren) {
+        cx_error(err_missing_left_paren);
+        return p_function_id->p_type;
+    }
+
+    get_token_append();
+    if (token != tc_identifier) {
+        cx_error(err_missing_variable);
+        parse_expression();
+        return p_function_id->p_type;
+    }
+
+    // the atomic, which parse_variable won't take
+    cx_symtab_node *p_atomic_id = find(p_token->string__());
+    cx_type *p_type = p_atomic_id->p_type;
+
+    icode.put(p_atomic_id);
+    get_token_append();
+
+    if (!p_atomic_id->is_atomic) cx_error(err_not_atomic);
+
+    while (token == tc_left_subscript) p_type = parse_subscripts(p_type);
+
+    if (!p_type->is_scalar_type()) {
+        cx_error(err_incompatible_types);
+        p_type = p_context->p_dummy_type;
+    }
+
+    const cx_routine_code which = p_function_id->defn.routine.which;
+    const int operand_count = (which == rc_load) ? 0
+            : (which == rc_compare_exchange) ? 2 : 1;
+
+    for (int i = 0; i < operand_count; ++i) {
+        //  ,
+        conditional_get_token_append(tc_comma, err_missing_comma);
+        check_assignment_type_compatible(p_type, parse_expression(),
+                err_incompatible_types);
+    }
+
+    //  )
+    conditional_get_token_append(tc_right_paren, err_missing_right_paren);
+
+    return (which == rc_compare_exchange) ? p_function_id->p_type : p_type;
+}
+
+/** parse_stream_argument  parse a stream variable passed to a
+ *                        standard routine.
+ *
+ * @return ptr to the stream id's symtab node, or nullptr.
+ */
+cx_symtab_node *cx_parser::parse_stream_argument(void) {
+    if (token != tc_identifier) {
+        cx_error(err_missing_variable);
+        parse_expression();
+        return nullptr;
+    }
+
+    cx_symtab_node *p_stream_id = find(p_token->string__());
+
+    icode.put(p_stream_id);
+    get_token_append();
+
+    if (p_stream_id->p_type->form != fc_stream) {
+        cx_error(err_incompatible_types);
+    }
+
+    return p_stream_id;
+}
+
+/** parse_char_array_argument     parse a char array variable of
+ *                              unknown size (char *) passed to a
+ *                              standard routine that stores into it.
+ */
+void cx_parser::parse_char_array_argument(void) {
+    cx_type *p_array_type = parse_variable_argument();
+
+    if ((p_array_type->form != fc_array) || (p_array_type->size != 0)
+            || (p_array_type->base_type() != p_context->p_char_type)) {
+        cx_error(err_incompatible_types);
+    }
+}
+
+/** parse_variable_argument       parse a variable passed to a
+ *                              standard routine that stores into it.
+ *
+ * @return ptr to the variable's type object.
+ */
+cx_type *cx_parser::parse_variable_argument(void) {
+    if (token != tc_identifier) {
+        cx_error(err_missing_variable);
+        parse_expression();
+        return p_context->p_dummy_type;
+    }
+
+    cx_symtab_node *p_variable_id = find(p_token->string__());
+
+    icode.put(p_variable_id);
+    get_token_append();
+
+    return parse_variable(p_variable_id);
+}
@@ -18,28 +18,54 @@ void cx_parser::parse_statement(cx_symtab_node *p_function_id) {
             get_token_append();
             parse_constant_declaration(p_function_id);
             break;
+        case tc_ATOMIC:
+            get_token_append();
+            parse_atomic_declaration(p_function_id);
+            break;
             //case tcEnum:
             //get_token_append();
             //            parse_enum_header(p_function_id);
             //break;
-        case tc_DO: parse_DO(p_function_id);
+        case tc_DO:
+            ++loop_depth;
+            parse_DO(p_function_id);
+            --loop_depth;
             break;
-        case tc_WHILE: parse_WHILE(p_function_id);
+        case tc_WHILE:
+            ++loop_depth;
+            parse_WHILE(p_function_id);
+            --loop_depth;
             break;
         case tc_IF: parse_IF(p_function_id);
             break;
-        case tc_FOR: parse_FOR(p_function_id);
+        case tc_FOR:
+            ++loop_depth;
+            parse_FOR(p_function_id);
+            --loop_depth;
+            break;
+        case tc_PARALLEL: parse_PARALLEL(p_function_id);
+            break;
+        case tc_SPAWN: parse_spawn();
             break;
         case tc_SWITCH: parse_SWITCH(p_function_id);
             break;
             //case tc_CASE:
             //case tc_DEFAULT:parse_case_label(p_function_id);
             //  break;
-        case tc_BREAK: get_token_append();
+        case tc_BREAK:
+            // the body of a parallel for can only leave a loop of its own
+            if ((parallel_index >= 0) && (loop_depth == 0)) {
+                cx_error(err_invalid_parallel_for);
+            }
+
+            get_token_append();
             break;
         case tc_left_bracket: parse_compound(p_function_id);
             break;
-        case tc_RETURN: parse_RETURN(p_function_id);
+        case tc_RETURN:
+            if (parallel_index >= 0) cx_error(err_invalid_parallel_for);
+
+            parse_RETURN(p_function_id);
             break;
         case tc_pound:
             get_token();
@@ -242,8 +268,8 @@ void cx_parser::parse_SWITCH(cx_symtab_node* p_function_id) {
 
     conditional_get_token_append(tc_right_paren, err_missing_right_paren);
 
-    if ((p_expr_type != p_integer_type)
-            && (p_expr_type != p_char_type)
+    if ((p_expr_type != p_context->p_integer_type)
+            && (p_expr_type != p_context->p_char_type)
             && (p_expr_type->form != fc_enum)) {
         cx_error(err_incompatible_types);
     }
@@ -60,7 +60,7 @@ cx_type *cx_parser::parse_type_spec(cx_symtab_node *p_node) {
                 default:
                     cx_error(err_not_a_type_identifier);
                     get_token_append();
-                    return (p_dummy_type);
+                    return (p_context->p_dummy_type);
             }
         }
 
@@ -78,7 +78,7 @@ cx_type *cx_parser::parse_type_spec(cx_symtab_node *p_node) {
 
         default:
             cx_error(err_invalid_type);
-            return (p_dummy_type);
+            return (p_context->p_dummy_type);
 
     }
 }
@@ -195,7 +195,7 @@ cx_type *cx_parser::parse_subrange_type(cx_symtab_node* p_min_id) {
  * @return
  */
 cx_type *cx_parser::parse_subrange_limit(cx_symtab_node* p_limit_id, int& limit) {
-    cx_type *p_type = p_dummy_type;
+    cx_type *p_type = p_context->p_dummy_type;
     cx_token_code sign = tc_dummy;
 
     limit = 0;
@@ -212,7 +212,7 @@ cx_type *cx_parser::parse_subrange_limit(cx_symtab_node* p_limit_id, int& limit)
                         -p_token->value().int__ :
                         p_token->value().int__;
 
-                p_type = p_integer_type;
+                p_type = p_context->p_integer_type;
 
             } else cx_error(err_invalid_subrange_type);
             break;
@@ -221,19 +221,19 @@ cx_type *cx_parser::parse_subrange_limit(cx_symtab_node* p_limit_id, int& limit)
 
             if (p_limit_id->defn.how == dc_undefined) {
                 p_limit_id->defn.how = dc_constant;
-                p_type = set_type(p_limit_id->p_type, p_dummy_type);
+                p_type = set_type(p_limit_id->p_type, p_context->p_dummy_type);
                 break;
-            } else if ((p_limit_id->p_type == p_float_type) ||
-                    (p_limit_id->p_type == p_dummy_type) ||
+            } else if ((p_limit_id->p_type == p_context->p_float_type) ||
+                    (p_limit_id->p_type == p_context->p_dummy_type) ||
                     (p_limit_id->p_type->form == fc_array)) {
                 cx_error(err_invalid_subrange_type);
             } else if (p_limit_id->defn.how == dc_constant) {
 
-                if (p_limit_id->p_type == p_integer_type) {
+                if (p_limit_id->p_type == p_context->p_integer_type) {
                     limit = sign == tc_minus
                             ? -p_limit_id->defn.constant.value.int__
                             : p_limit_id->defn.constant.value.int__;
-                } else if (p_limit_id->p_type == p_char_type) {
+                } else if (p_limit_id->p_type == p_context->p_char_type) {
                     if (sign != tc_dummy) cx_error(err_invalid_constant);
                     limit = p_limit_id->defn.constant.value.char__;
                 } else if (p_limit_id->p_type->form == fc_enum) {
@@ -254,7 +254,7 @@ cx_type *cx_parser::parse_subrange_limit(cx_symtab_node* p_limit_id, int& limit)
             }
 
             limit = p_token->string__()[1];
-            p_type = p_char_type;
+            p_type = p_context->p_char_type;
             break;
 
         default:
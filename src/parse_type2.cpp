@@ -27,12 +27,12 @@ cx_type *cx_parser::parse_array_type(cx_symtab_node *p_function_id,
         max_index = p_token->value().int__;
         get_token();
 
-        set_type(p_element_type->array.p_index_type, p_integer_type);
+        set_type(p_element_type->array.p_index_type, p_context->p_integer_type);
 
     } else {
         cx_type *p_index_type = parse_expression();
 
-        check_assignment_type_compatible(p_integer_type, p_index_type,
+        check_assignment_type_compatible(p_context->p_integer_type, p_index_type,
                 err_invalid_index_type);
 
         set_type(p_element_type->array.p_index_type, p_index_type);
@@ -41,14 +41,14 @@ cx_type *cx_parser::parse_array_type(cx_symtab_node *p_function_id,
     p_array_type->array.element_count = max_index;
     p_array_type->array.min_index = min_index;
     p_array_type->array.max_index = max_index;
-    p_array_type->size = min_index * p_array_type->array.p_element_type->size;
+    p_array_type->size = max_index * p_array_type->array.p_element_type->size;
 
-    conditional_get_token(tc_right_subscript, err_missing_right_subscript);
-
-    if (token_in(token, tokenlist_assign_ops))parse_assignment(p_array_node);
+    conditional_get_token_append(tc_right_subscript, err_missing_right_subscript);
 
     set_type(p_array_node->p_type, p_array_type);
 
+    if (token_in(token, tokenlist_assign_ops))parse_assignment(p_array_node);
+
     if (p_array_node->defn.how == dc_undefined) {
         p_array_node->defn.how = dc_variable;
     }
@@ -83,20 +83,27 @@ cx_type *cx_parser::parse_unksize_array_type(cx_symtab_node* p_function_id,
 
     bool is_function = false;
     const bool is_expression = token_in(token, tokenlist_assign_ops);
+    const bool is_parm = (p_array_node->defn.how == dc_value_parm)
+            || (p_array_node->defn.how == dc_reference);
 
-    if ((token != tc_left_paren) && (token != tc_right_paren) &&
+    // a parm's , or ) belongs to the formal parm list
+    if (is_parm);
+    else if ((token != tc_left_paren) && (token != tc_right_paren) &&
             (!is_expression)) get_token_append();
     else if ((token != tc_right_paren) && (!is_expression)) is_function = true;
 
     int min_index = 0;
     int max_index = 0;
 
-    set_type(p_array_type->array.p_index_type, p_integer_type);
+    set_type(p_array_type->array.p_index_type, p_context->p_integer_type);
     p_array_type->array.element_count = max_index;
     p_array_type->array.min_index = min_index;
     p_array_type->array.max_index = max_index;
 
     if (is_function) {
+
+        // the function returns the array
+        set_type(p_array_node->p_type, p_array_type);
         parse_function_header(p_array_node);
         return p_array_type;
     }
@@ -108,17 +115,17 @@ cx_type *cx_parser::parse_unksize_array_type(cx_symtab_node* p_function_id,
         if (p_expr_type->base_type() != p_array_type->base_type()) {
             // make sure we init all of the same type
             cx_error(err_incompatible_assignment);
-            p_array_type = p_dummy_type;
+            p_array_type = p_context->p_dummy_type;
 
         } else {
 
-            delete p_array_type;
-            set_type(p_array_node->p_type->array.p_index_type, p_integer_type);
-            set_type(p_array_node->p_type->array.p_element_type, p_expr_type->array.p_element_type);
-            set_type(p_array_node->p_type, p_expr_type);
-
-            p_array_node->p_type->p_type_id = p_array_node;
-            p_array_type = p_expr_type;
+            /* Keep the array's own type of unknown size.  The
+             * executor keeps its length with the value, so the
+             * initializer's type is never resized at runtime. */
+            remove_type(p_array_type->array.p_element_type);
+            set_type(p_array_type->array.p_element_type,
+                    p_expr_type->base_type());
+            set_type(p_array_node->p_type, p_array_type);
         }
     } else {
         set_type(p_array_node->p_type, p_array_type);
@@ -169,7 +176,7 @@ cx_type *cx_parser::parse_string_type(cx_symtab_node* p_function_id,
     cx_type *p_element_type = p_array_type;
 
     // Final element type.
-    set_type(p_element_type->array.p_element_type, p_char_type);
+    set_type(p_element_type->array.p_element_type, p_context->p_char_type);
 
     int min_index = 0;
     int max_index = 0;
@@ -401,7 +408,7 @@ void cx_parser::parse_member_decls(cx_symtab_node *p_function_id, cx_type *p_com
     } while (token != tc_right_bracket);
 
     // connect all symtabs for use within the class
-    p_complex_type->complex.p_class_scope_symtab = new cx_symtab;
+    p_complex_type->complex.p_class_scope_symtab = new cx_symtab(p_context);
     // p_complex_type->complex.p_class_scope_symtab->connect_tables(p_complex_type->complex.MemberTable);
 
     conditional_get_token_append(tc_right_bracket, err_missing_right_bracket);
@@ -5,8 +5,6 @@
 #include "parser.h"
 //#include "complist.h"
 
-extern cx_symtab_node *p_program_ptr_id;
-
 /** parse       parse the source file.  After listing each
  *              source line, extract and list its tokens.
  *
@@ -15,10 +13,11 @@ extern cx_symtab_node *p_program_ptr_id;
 cx_symtab_node *cx_parser::parse(bool std_lib_module) {
 
     extern bool cx_dev_debug_flag;
+    cx_context_scope scope(p_context);
     cx_symtab_node *p_program_id = nullptr;
 
     if (!std_lib_module) {
-        p_program_id = new cx_symtab_node("__cx_global__", dc_program);
+        p_program_id = new cx_symtab_node(p_context, "__cx_global__", dc_program);
         p_program_id->defn.routine.which = rc_declared;
         p_program_id->defn.routine.parm_count = 0;
         p_program_id->defn.routine.total_parm_size = 0;
@@ -30,16 +29,18 @@ cx_symtab_node *cx_parser::parse(bool std_lib_module) {
         p_program_id->defn.routine.locals.p_function_ids = nullptr;
         p_program_id->defn.routine.p_symtab = nullptr;
         p_program_id->defn.routine.p_icode = nullptr;
-        set_type(p_program_id->p_type, p_integer_type);
+        p_program_id->defn.routine.has_effects = false;
+        set_type(p_program_id->p_type, p_context->p_integer_type);
 
-        p_program_ptr_id = p_program_id;
+        p_context->p_program_ptr_id = p_program_id;
     }
 
     icode.reset();
+    p_routine_id = p_program_id;
 
-    current_nesting_level = 0;
+    p_context->current_nesting_level = 0;
     // enter the nesting level 0 and open a new scope for the program.
-    symtab_stack.set_current_symtab(&cx_global_symtab);
+    symtab_stack.set_current_symtab(&p_context->global_symtab);
 
     if (!std_lib_module) icode.put(tc_left_bracket);
     get_token_append();
@@ -54,16 +55,18 @@ cx_symtab_node *cx_parser::parse(bool std_lib_module) {
     get_token_append();
 
     if (!std_lib_module) {
-        p_program_id->defn.routine.p_symtab = &cx_global_symtab; //symtab_stack.exit_scope();
+        p_program_id->defn.routine.p_symtab = &p_context->global_symtab; //symtab_stack.exit_scope();
 
         resync(tokenlist_program_end);
         conditional_get_token_append(tc_end_of_file, err_missing_right_bracket);
 
         if (cx_dev_debug_flag) {
+            cx_list_buffer &list = p_context->list;
+
             list.put_line();
-            sprintf(list.text, "%20d source lines.", current_line_number);
+            sprintf(list.text, "%20d source lines.", p_context->current_line_number);
             list.put_line();
-            sprintf(list.text, "%20d syntax errors.", error_count);
+            sprintf(list.text, "%20d syntax errors.", p_context->error_count);
             list.put_line();
         }
     }
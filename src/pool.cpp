@@ -0,0 +1,268 @@
+/** Task pool
+ * pool.cpp
+ *
+ * A pool of threads with a deque of tasks each.  A thread adds the
+ * tasks it makes to its own deque and takes them back newest first,
+ * while they're hot in its cache; a thread with nothing to do steals
+ * from the other end of another's deque.  A thread that waits for a
+ * group of tasks runs tasks itself until the group is done, so tasks
+ * may add and wait for tasks of their own.
+ *
+ * A thread that blocks until something else is ready, such as a value
+ * on a channel, can't run tasks meanwhile:  a task it ran might block
+ * in turn, on what the thread itself was about to do.  So while it's
+ * blocked and tasks are waiting with no thread to run them, a spare
+ * thread runs them instead, and goes once it runs out.  A thread that
+ * holds a scheduler's slot gives it up while it waits or blocks (see
+ * scheduler.h).
+ */
+
+#include <cstdlib>
+#include <thread>
+#include "common.h"
+#include "pool.h"
+#include "scheduler.h"
+
+// the pool whose thread is running, and the index of its deque
+static thread_local const cx_task_pool *p_thread_pool = nullptr;
+static thread_local int thread_queue = -1;
+
+/** default_thread_count        Threads to run tasks on:  as many as
+ *                              CX_THREADS says, or one per core.
+ *
+ * @return count of threads, the one waiting included.
+ */
+static int default_thread_count(void) {
+    const char *p_count = getenv(__CX_THREADS__);
+    int count = (p_count != nullptr) ? atoi(p_count) : 0;
+
+    if (count <= 0) count = std::thread::hardware_concurrency();
+
+    return (count > 0) ? count : 1;
+}
+
+/** Constructor         Start the pool's threads.  The thread that
+ *                      waits for the tasks helps run them, so there
+ *                      is one thread fewer than the count.
+ *
+ * @param thread_count : count of threads, the one waiting included.
+ */
+cx_task_pool::cx_task_pool(int thread_count)
+: queued(0), idle(0), blocked(0), spares(0) {
+    if (thread_count < 1) thread_count = 1;
+
+    for (int i = 0; i < thread_count; ++i) queues.push_back(new cx_task_queue);
+
+    // the pool lives as long as the process, so its threads are never joined
+    for (int i = 0; i < thread_count - 1; ++i) {
+        std::thread([this, i]() {
+            work(i, false);
+        }).detach();
+    }
+}
+
+/** shared              The pool every script runs its tasks on,
+ *                      started the first time it's needed.
+ *
+ * @return the pool.
+ */
+cx_task_pool &cx_task_pool::shared(void) {
+    static cx_task_pool *p_pool = new cx_task_pool(default_thread_count());
+
+    return *p_pool;
+}
+
+/** queue_of_thread     The deque of the thread running:  its own if
+ *                      it's one of the pool's, else the one the
+ *                      other threads share.
+ *
+ * @return index of the deque.
+ */
+int cx_task_pool::queue_of_thread(void) const {
+    return (p_thread_pool == this) ? thread_queue : queues.size() - 1;
+}
+
+/** add                 Add a task to a group, and to the deque of the
+ *                      thread running.  A task must not throw.
+ *
+ * @param group : the group the task is waited for with.
+ * @param run   : the task.
+ */
+void cx_task_pool::add(cx_task_group &group, const std::function<void(void)> &run) {
+    cx_task_queue *p_queue = queues[queue_of_thread()];
+    cx_task task;
+
+    task.run = run;
+    task.p_group = &group;
+    ++group.pending;
+
+    {
+        std::lock_guard<std::mutex> lock(p_queue->mutex);
+        p_queue->tasks.push_back(task);
+    }
+
+    ++queued;
+
+    // a thread about to wait has checked queued by now
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+    }
+    changed.notify_all();
+}
+
+/** take                Take a task:  the newest of a thread's own
+ *                      deque, else the oldest of another's.
+ *
+ * @param xqueue : index of the thread's deque.
+ * @param task   : gets the task.
+ * @return false if every deque is empty.
+ */
+bool cx_task_pool::take(int xqueue, cx_task &task) {
+    if (queued.load() == 0) return false;
+
+    {
+        cx_task_queue *p_queue = queues[xqueue];
+        std::lock_guard<std::mutex> lock(p_queue->mutex);
+
+        if (!p_queue->tasks.empty()) {
+            task = p_queue->tasks.back();
+            p_queue->tasks.pop_back();
+            --queued;
+
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); ++i) {
+        cx_task_queue *p_queue = queues[(xqueue + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(p_queue->mutex);
+
+        if (!p_queue->tasks.empty()) {
+            task = p_queue->tasks.front();
+            p_queue->tasks.pop_front();
+            --queued;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** run                 Run a task, and wake the thread waiting for
+ *                      its group if it was the last.
+ *
+ * @param task : the task.
+ */
+void cx_task_pool::run(cx_task &task) {
+    task.run();
+
+    // the group may be gone as soon as it's done
+    if (--task.p_group->pending == 0) {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+        }
+        changed.notify_all();
+    }
+}
+
+/** work                Run tasks, for as long as the process runs, or
+ *                      for a spare thread, until there are none.
+ *
+ * @param xqueue : index of the thread's deque.
+ * @param spare  : true for a spare thread.
+ */
+void cx_task_pool::work(int xqueue, bool spare) {
+    p_thread_pool = this;
+    thread_queue = xqueue;
+
+    for (;;) {
+        cx_task task;
+
+        if (take(xqueue, task)) {
+            run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex);
+
+        // a task added since take looked is seen here, or its add waits
+        if (queued.load() > 0) continue;
+
+        if (spare) {
+            --spares;
+            return;
+        }
+
+        ++idle;
+        changed.wait(lock, [this]() {
+            return queued.load() > 0;
+        });
+        --idle;
+    }
+}
+
+/** wait                Run tasks until every task of a group has run.
+ *
+ * @param group : the group.
+ */
+void cx_task_pool::wait(cx_task_group &group) {
+    const int xqueue = queue_of_thread();
+
+    while (!group.done()) {
+        cx_task task;
+
+        if (take(xqueue, task)) {
+            run(task);
+            continue;
+        }
+
+        // the slot of a scheduled run goes to another while this waits
+        cx_slot_pause pause;
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        changed.wait(lock, [this, &group]() {
+            return group.done() || (queued.load() > 0);
+        });
+    }
+}
+
+/** block_until         Block until something is ready, without
+ *                      running tasks.  While tasks are waiting and
+ *                      no thread is free to run them, a spare thread
+ *                      is started in place of each one blocked.
+ *                      Whatever makes it ready must call notify.
+ *
+ * @param ready : tells whether it's ready.  It's called with the
+ *                pool's lock held, so it mustn't call notify.
+ */
+void cx_task_pool::block_until(const std::function<bool(void)> &ready) {
+    cx_slot_pause pause;
+    std::unique_lock<std::mutex> lock(idle_mutex);
+
+    ++blocked;
+
+    while (!ready()) {
+        if ((queued.load() > 0) && (idle == 0) && (spares < blocked)) {
+            const int xqueue = queues.size() - 1;
+
+            ++spares;
+            std::thread([this, xqueue]() {
+                work(xqueue, true);
+            }).detach();
+        }
+
+        changed.wait(lock);
+    }
+
+    --blocked;
+}
+
+/** notify              Wake the threads that are blocked, to check
+ *                      again whether what they wait for is ready.
+ */
+void cx_task_pool::notify(void) {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+    }
+    changed.notify_all();
+}
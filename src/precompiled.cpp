@@ -0,0 +1,1247 @@
+/** Precompiled scripts
+ * precompiled.cpp
+ *
+ * Write a translated script to a file, and read it back into a fresh
+ * context instead of parsing it again.  The file holds what the parse
+ * and the optimizer leave behind:  the symbol tables, the types, the
+ * string constants, the icode of each routine, the call sites and the
+ * parallel loops.
+ *
+ * The file is read through a mapping.  The icode names its nodes by
+ * index, so it's copied out as it is, with no fix-ups.  Nodes and
+ * types point at each other, so they're written as indexes, and
+ * linked up again as they're made.
+ *
+ * A file is used only if it was written by this build of the
+ * interpreter, with the same options, from the same source and the
+ * same #included modules.  Otherwise the script is parsed as usual.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "context.h"
+#include "icode.h"
+#include "intrinsic.h"
+#include "optimizer.h"
+#include "precompiled.h"
+#include "types.h"
+
+// bump when the layout of the file changes
+static const int precompiled_version = 3;
+static const char precompiled_magic[] = "CXPC";
+
+// icode is only good for the build that made it
+static const char precompiled_build[] = __DATE__ " " __TIME__;
+
+// symtab index of a null node ref, and of the program's node
+static const short null_ref = -1;
+static const short program_ref = -2;
+
+///  Payloads of a node's definition.
+
+enum cx_payload_code {
+    pc_value, // constant value, or data offset
+    pc_string, // pooled string constant
+    pc_routine, // program or function
+    pc_forward // function not yet defined
+};
+
+/** cx_node_ref          A node, by the symtab and node indexes the
+ *                      icode names it by.
+ */
+struct cx_node_ref {
+    short xsymtab;
+    short xnode;
+};
+
+/** hash_bytes          FNV-1a hash of a block of bytes.
+ *
+ * @param p_data : ptr to the bytes.
+ * @param length : number of bytes.
+ * @param hash   : hash to go on from.
+ * @return the hash.
+ */
+static uint64_t hash_bytes(const char *p_data, size_t length,
+        uint64_t hash = 14695981039346656037ull) {
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (unsigned char) p_data[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/** hash_file           Hash the contents of a file.
+ *
+ * @param p_path : ptr to the file's path.
+ * @param hash   : the hash.
+ * @return false if the file can't be read.
+ */
+static bool hash_file(const char *p_path, uint64_t &hash) {
+    FILE *p_file = fopen(p_path, "rb");
+    if (p_file == nullptr) return false;
+
+    char buffer[8192];
+    size_t count;
+
+    hash = hash_bytes(nullptr, 0);
+    while ((count = fread(buffer, 1, sizeof (buffer), p_file)) > 0) {
+        hash = hash_bytes(buffer, count, hash);
+    }
+
+    const bool ok = !ferror(p_file);
+    fclose(p_file);
+
+    return ok;
+}
+
+/** stdlib_path         Where #include looks for modules.
+ *
+ * @return the path, or "" if it isn't set.
+ */
+static std::string stdlib_path(void) {
+    const char *p_path = getenv(__CX_STDLIB__);
+
+    return (p_path != nullptr) ? p_path : "";
+}
+
+/** builtin_types       The types every context makes, in the order
+ *                      a file refers to them by.
+ *
+ * @param p_context : ptr to the context.
+ * @param types     : the types.
+ */
+static void builtin_types(const cx_context *p_context,
+        std::vector<cx_type *> &types) {
+    cx_type * const builtins[] = {
+        p_context->p_integer_type, p_context->p_uint8_type,
+        p_context->p_uint16_type, p_context->p_uint32_type,
+        p_context->p_uint64_type, p_context->p_float_type,
+        p_context->p_boolean_type, p_context->p_char_type,
+        p_context->p_wchar_type, p_context->p_complex_type,
+        p_context->p_file_type, p_context->p_dummy_type,
+        p_context->p_stdin->p_type, p_context->p_stdout->p_type,
+        p_context->p_stderr->p_type
+    };
+
+    types.assign(builtins, builtins + sizeof (builtins) / sizeof (builtins[0]));
+}
+
+/** relink_type         Point a type ptr at another type, keeping the
+ *                      reference counts of both.
+ *
+ * @param p_target_type : the type ptr.
+ * @param p_source_type : ptr to the type, or nullptr.
+ */
+static void relink_type(cx_type *&p_target_type, cx_type *p_source_type) {
+    if (p_target_type == p_source_type) return;
+
+    remove_type(p_target_type);
+    p_target_type = nullptr;
+
+    if (p_source_type != nullptr) set_type(p_target_type, p_source_type);
+}
+
+/*****************
+ *               *
+ *  Writing out  *
+ *               *
+ *****************/
+
+/** cx_image_writer      Lays out a translated script.  Any ptr it
+ *                      can't turn into an index, as a host routine
+ *                      or an open stream, makes the script one that
+ *                      can't be kept.
+ */
+class cx_image_writer {
+    const cx_context *p_context;
+    std::unordered_map<const cx_symtab_node *, cx_node_ref> node_refs;
+    std::unordered_map<const cx_type *, int> type_refs;
+    std::vector<const cx_type *> types;
+    int builtin_type_count;
+
+    void put_node_ref(const cx_symtab_node *p_node);
+    void put_type_ref(const cx_type *p_type);
+    void put_symtab_ref(const cx_symtab *p_symtab);
+    void put_node(const cx_symtab_node *p_node);
+    void put_type(const cx_type *p_type);
+
+public:
+    std::string image;
+    bool ok;
+
+    cx_image_writer(const cx_context *p_context);
+
+    void put_bytes(const void *p_data, size_t length) {
+        image.append((const char *) p_data, length);
+    }
+
+    void put_int(int value) {
+        put_bytes(&value, sizeof (int));
+    }
+
+    void put_hash(uint64_t value) {
+        put_bytes(&value, sizeof (uint64_t));
+    }
+
+    void put_string(const char *p_string, int length) {
+        put_int(length);
+        put_bytes(p_string, length);
+        image += '\0';
+    }
+
+    void put_string(const std::string &string) {
+        put_string(string.data(), (int) string.size());
+    }
+
+    void put_script(const cx_symtab_node *p_program_id);
+};
+
+/** Constructor     Number the nodes of every symbol table, and the
+ *                  types every context has.
+ *
+ * @param p_context : ptr to the context of the script.
+ */
+cx_image_writer::cx_image_writer(const cx_context *p_context)
+: p_context(p_context), ok(true) {
+    for (int i = 0; i < p_context->symtab_count; ++i) {
+        const cx_symtab *p_symtab = p_context->p_vector_symtabs[i];
+        if (p_symtab == nullptr) continue;
+
+        for (int j = 0; j < p_symtab->node_count(); ++j) {
+            const cx_node_ref ref = {(short) i, (short) j};
+            node_refs[p_symtab->get(j)] = ref;
+        }
+    }
+
+    const cx_node_ref program = {program_ref, 0};
+    node_refs[p_context->p_program_ptr_id] = program;
+
+    std::vector<cx_type *> builtins;
+    builtin_types(p_context, builtins);
+
+    for (cx_type *p_type : builtins) {
+        type_refs[p_type] = types.size();
+        types.push_back(p_type);
+    }
+    builtin_type_count = types.size();
+}
+
+/** put_node_ref        Write a node as its indexes.
+ *
+ * @param p_node : ptr to the node, or nullptr.
+ */
+void cx_image_writer::put_node_ref(const cx_symtab_node *p_node) {
+    cx_node_ref ref = {null_ref, 0};
+
+    if (p_node != nullptr) {
+        auto it = node_refs.find(p_node);
+
+        if (it != node_refs.end()) ref = it->second;
+        else ok = false;
+    }
+
+    put_bytes(&ref, sizeof (ref));
+}
+
+/** put_type_ref        Write a type as its index among the types,
+ *                      numbering it if it's new.
+ *
+ * @param p_type : ptr to the type object, or nullptr.
+ */
+void cx_image_writer::put_type_ref(const cx_type *p_type) {
+    if (p_type == nullptr) {
+        put_int(-1);
+        return;
+    }
+
+    auto it = type_refs.find(p_type);
+
+    if (it != type_refs.end()) {
+        put_int(it->second);
+    } else {
+        // types are written after the nodes, in the order they're met
+        type_refs[p_type] = types.size();
+        put_int(types.size());
+        types.push_back(p_type);
+    }
+}
+
+/** put_symtab_ref      Write a symbol table as its index.
+ *
+ * @param p_symtab : ptr to the symbol table, or nullptr.
+ */
+void cx_image_writer::put_symtab_ref(const cx_symtab *p_symtab) {
+    put_int((p_symtab != nullptr) ? p_symtab->symtab_index() : -1);
+}
+
+/** put_node            Write a node:  its name, type and links, and
+ *                      the payload of its definition.
+ *
+ * @param p_node : ptr to the node.
+ */
+void cx_image_writer::put_node(const cx_symtab_node *p_node) {
+    const cx_define &defn = p_node->defn;
+
+    put_string(p_node->string__(), strlen(p_node->string__()));
+    put_int(defn.how);
+    put_type_ref(p_node->p_type);
+    put_node_ref(p_node->next__);
+    put_int(p_node->level);
+    put_int(p_node->label_index);
+    put_int(p_node->global_finish_location);
+    put_int(p_node->string_length);
+    put_int(p_node->found_global_end);
+    put_int(p_node->is_atomic);
+
+    if ((defn.how == dc_program) || (defn.how == dc_function)) {
+        if (defn.routine.which == rc_forward) {
+            put_int(pc_forward);
+            return;
+        }
+
+        // a host routine lives in the host program
+        if (defn.routine.which == rc_host) ok = false;
+
+        put_int(pc_routine);
+        put_int(defn.routine.which);
+        put_int(defn.routine.return_marker);
+        put_int(defn.routine.parm_count);
+        put_int(defn.routine.total_parm_size);
+        put_int(defn.routine.total_local_size);
+        put_node_ref(defn.routine.locals.p_parms_ids);
+        put_node_ref(defn.routine.locals.p_constant_ids);
+        put_node_ref(defn.routine.locals.p_type_ids);
+        put_node_ref(defn.routine.locals.p_variable_ids);
+        put_node_ref(defn.routine.locals.p_function_ids);
+        put_symtab_ref(defn.routine.p_symtab);
+        put_int(defn.routine.has_effects);
+
+        put_int(defn.routine.p_icode != nullptr);
+        if (defn.routine.p_icode != nullptr) {
+            put_string(defn.routine.p_icode->code(),
+                    defn.routine.p_icode->length());
+        }
+
+        if (defn.routine.which == rc_intrinsic) {
+            put_string(defn.routine.p_intrinsic->p_name,
+                    strlen(defn.routine.p_intrinsic->p_name));
+        }
+    } else if ((p_node->p_type != nullptr)
+            && (p_node->p_type->form == fc_array)
+            && ((defn.how == dc_constant) || (defn.how == dc_undefined))) {
+        const cx_string_constant *p_constant =
+                cx_string_constant_of(defn.constant.value.p_string);
+
+        put_int(pc_string);
+        put_string(p_constant->data, p_constant->length);
+    } else {
+        put_int(pc_value);
+        put_bytes(&defn.constant.value, sizeof (cx_data_value));
+    }
+}
+
+/** put_type            Write a type made by the parse.
+ *
+ * @param p_type : ptr to the type object.
+ */
+void cx_image_writer::put_type(const cx_type *p_type) {
+    put_int(p_type->form);
+    put_int(p_type->size);
+    put_int(p_type->type_code);
+    put_int(p_type->is_constant());
+    put_node_ref(p_type->p_type_id);
+
+    switch (p_type->form) {
+        case fc_enum:
+            put_node_ref(p_type->enumeration.p_const_ids);
+            put_int(p_type->enumeration.max);
+            break;
+        case fc_array:
+            put_type_ref(p_type->array.p_index_type);
+            put_type_ref(p_type->array.p_element_type);
+            put_int(p_type->array.min_index);
+            put_int(p_type->array.max_index);
+            put_int(p_type->array.element_count);
+            break;
+        case fc_complex:
+            put_symtab_ref(p_type->complex.p_class_scope_symtab);
+            break;
+        case fc_stream:
+            // only opened once the script runs
+            if ((p_type->stream.p_file_name != nullptr)
+                    || (p_type->stream.p_file_stream != nullptr)
+                    || (p_type->stream.p_bound_stream != nullptr)) {
+                ok = false;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/** put_script          Write the symbol tables, the program, the
+ *                      call sites, the parallel loops and the types.
+ *
+ * @param p_program_id : ptr to the program's symtab node.
+ */
+void cx_image_writer::put_script(const cx_symtab_node *p_program_id) {
+    put_int(p_context->symtab_count);
+
+    for (int i = 0; i < p_context->symtab_count; ++i) {
+        const cx_symtab *p_symtab = p_context->p_vector_symtabs[i];
+        const int count = (p_symtab != nullptr) ? p_symtab->node_count() : 0;
+
+        put_int(count);
+        for (int j = 0; j < count; ++j) put_node(p_symtab->get(j));
+    }
+
+    put_node(p_program_id);
+
+    put_int(p_context->call_sites.size());
+    for (const cx_call_site &site : p_context->call_sites) {
+        put_node_ref(site.p_function_id);
+        put_int(site.parms.size());
+
+        for (const cx_actual_parm &parm : site.parms) {
+            put_int(parm.reference);
+            put_int(parm.int_to_float);
+            put_int(parm.copy_value);
+            put_int(parm.share_value);
+            put_node_ref(parm.p_variable_id);
+        }
+    }
+
+    put_int(p_context->parallel_loops.size());
+    for (const cx_parallel_loop &loop : p_context->parallel_loops) {
+        put_node_ref(loop.p_index_id);
+        put_int(loop.step);
+
+        put_int(loop.reductions.size());
+        for (const cx_reduction &reduction : loop.reductions) {
+            put_node_ref(reduction.p_id);
+            put_int(reduction.op);
+        }
+
+        put_int(loop.private_ids.size());
+        for (const cx_symtab_node *p_id : loop.private_ids) put_node_ref(p_id);
+
+        put_int(loop.stored_ids.size());
+        for (const cx_symtab_node *p_id : loop.stored_ids) put_node_ref(p_id);
+    }
+
+    // an array type can bring in its element type as it's written
+    put_int(-1);
+    const size_t count_at = image.size() - sizeof (int);
+
+    for (size_t i = builtin_type_count; i < types.size(); ++i) {
+        put_type(types[i]);
+    }
+
+    const int type_count = types.size() - builtin_type_count;
+    memcpy(&image[count_at], &type_count, sizeof (int));
+}
+
+/******************
+ *                *
+ *  Reading back  *
+ *                *
+ ******************/
+
+///  cx_node_image       A node as read from a file.
+
+struct cx_node_image {
+    const char *p_name;
+    cx_define_code how;
+    int type;
+    cx_node_ref next;
+    int level;
+    int label_index;
+    int global_finish_location;
+    int string_length;
+    bool found_global_end;
+    bool is_atomic;
+
+    cx_payload_code payload;
+    cx_data_value value;
+    const char *p_string;
+    int length; // of the string or the icode; -1 if no icode
+
+    cx_routine_code which;
+    int return_marker;
+    int parm_count;
+    int total_parm_size;
+    int total_local_size;
+    cx_node_ref locals[5];
+    int xsymtab;
+    bool has_effects;
+    const cx_intrinsic *p_intrinsic;
+};
+
+///  cx_type_image       A type as read from a file.
+
+struct cx_type_image {
+    cx_type_form_code form;
+    int size;
+    cx_type_code type_code;
+    bool constant;
+    cx_node_ref type_id;
+    cx_node_ref const_ids;
+    int max;
+    int index_type;
+    int element_type;
+    int min_index, max_index;
+    int element_count;
+    int xsymtab;
+};
+
+///  cx_site_image       A call site as read from a file.
+
+struct cx_site_image {
+    cx_node_ref function;
+    std::vector<cx_actual_parm> parms;
+    std::vector<cx_node_ref> variables;
+};
+
+///  cx_loop_image       A parallel for as read from a file.
+
+struct cx_loop_image {
+    cx_node_ref index;
+    int step;
+    std::vector<cx_node_ref> reductions;
+    std::vector<cx_token_code> ops;
+    std::vector<cx_node_ref> private_ids;
+    std::vector<cx_node_ref> stored_ids;
+};
+
+/** cx_image_reader      Reads a translated script from a mapped
+ *                      file.  Everything is read and checked before
+ *                      the context is touched, so a file that won't
+ *                      do leaves the context as it was.
+ */
+class cx_image_reader {
+    cx_context *p_context;
+    const char *cursor;
+    const char *end;
+
+    std::vector<std::vector<cx_node_image> > symtabs;
+    cx_node_image program;
+    std::vector<cx_site_image> sites;
+    std::vector<cx_loop_image> loops;
+    std::vector<cx_type_image> types;
+
+    // what the file's indexes name in the context
+    std::vector<std::vector<cx_symtab_node *> > nodes;
+    std::vector<cx_symtab *> symtab_ptrs;
+    std::vector<cx_type *> type_ptrs;
+    cx_symtab_node *p_program_id;
+
+    bool get_node(cx_node_image &node);
+    bool get_node_refs(std::vector<cx_node_ref> &refs);
+    bool get_type(cx_type_image &type);
+    bool valid_node_ref(const cx_node_ref &ref) const;
+    bool valid_type_ref(int type) const;
+    bool valid_symtab_ref(int xsymtab) const;
+
+    cx_symtab_node *node_of(const cx_node_ref &ref) const;
+    cx_symtab *symtab_of(int xsymtab) const;
+
+    cx_type *type_of(int type) const {
+        return (type < 0) ? nullptr : type_ptrs[type];
+    }
+
+    void fill_node(cx_symtab_node *p_node, const cx_node_image &image);
+    void fill_type(cx_type *p_type, const cx_type_image &image);
+
+public:
+    bool ok;
+
+    cx_image_reader(cx_context *p_context, const char *p_image, size_t length)
+    : p_context(p_context), cursor(p_image), end(p_image + length), p_program_id(nullptr),
+    ok(true) {
+    }
+
+    bool get_bytes(void *p_data, size_t length) {
+        if ((size_t) (end - cursor) < length) return ok = false;
+
+        memcpy(p_data, cursor, length);
+        cursor += length;
+
+        return true;
+    }
+
+    int get_int(void) {
+        int value = 0;
+
+        get_bytes(&value, sizeof (int));
+
+        return value;
+    }
+
+    uint64_t get_hash(void) {
+        uint64_t value = 0;
+
+        get_bytes(&value, sizeof (uint64_t));
+
+        return value;
+    }
+
+    // a string is left in the mapping, '\0' terminated
+    const char *get_string(int &length) {
+        length = get_int();
+        if ((length < 0) || ((end - cursor) < (ptrdiff_t) length + 1)) {
+            ok = false;
+            return nullptr;
+        }
+
+        const char *p_string = cursor;
+        cursor += length + 1;
+
+        return p_string;
+    }
+
+    std::string get_string(void) {
+        int length;
+        const char *p_string = get_string(length);
+
+        return ok ? std::string(p_string, length) : std::string();
+    }
+
+    bool get_script(void);
+    cx_symtab_node *make_script(void);
+};
+
+/** get_node            Read a node.
+ *
+ * @param node : the node as read.
+ * @return false if the file is short or bad.
+ */
+bool cx_image_reader::get_node(cx_node_image &node) {
+    int length;
+
+    node.p_name = get_string(length);
+    node.how = (cx_define_code) get_int();
+    node.type = get_int();
+    get_bytes(&node.next, sizeof (cx_node_ref));
+    node.level = get_int();
+    node.label_index = get_int();
+    node.global_finish_location = get_int();
+    node.string_length = get_int();
+    node.found_global_end = get_int();
+    node.is_atomic = get_int();
+    node.payload = (cx_payload_code) get_int();
+    node.p_intrinsic = nullptr;
+    node.xsymtab = -1;
+
+    switch (node.payload) {
+        case pc_value:
+            get_bytes(&node.value, sizeof (cx_data_value));
+            break;
+        case pc_string:
+            node.p_string = get_string(node.length);
+            break;
+        case pc_routine:
+            node.which = (cx_routine_code) get_int();
+            node.return_marker = get_int();
+            node.parm_count = get_int();
+            node.total_parm_size = get_int();
+            node.total_local_size = get_int();
+            get_bytes(node.locals, sizeof (node.locals));
+            node.xsymtab = get_int();
+            node.has_effects = get_int();
+
+            node.length = -1;
+            if (get_int()) node.p_string = get_string(node.length);
+
+            if (ok && (node.which == rc_intrinsic)) {
+                node.p_intrinsic = cx_find_intrinsic(get_string().c_str());
+                if (node.p_intrinsic == nullptr) ok = false;
+            }
+            break;
+        case pc_forward:
+            break;
+        default:
+            ok = false;
+            break;
+    }
+
+    return ok;
+}
+
+/** get_node_refs       Read a list of nodes, as their indexes.
+ *
+ * @param refs : the nodes' indexes.
+ * @return false if the file is short or bad.
+ */
+bool cx_image_reader::get_node_refs(std::vector<cx_node_ref> &refs) {
+    const int count = get_int();
+    if (!ok || (count < 0) || (count > 0x7fff)) return false;
+
+    refs.resize(count);
+    for (cx_node_ref &ref : refs) get_bytes(&ref, sizeof (cx_node_ref));
+
+    return ok;
+}
+
+/** get_type            Read a type made by the parse.
+ *
+ * @param type : the type as read.
+ * @return false if the file is short.
+ */
+bool cx_image_reader::get_type(cx_type_image &type) {
+    type.form = (cx_type_form_code) get_int();
+    type.size = get_int();
+    type.type_code = (cx_type_code) get_int();
+    type.constant = get_int();
+    get_bytes(&type.type_id, sizeof (cx_node_ref));
+
+    switch (type.form) {
+        case fc_enum:
+            get_bytes(&type.const_ids, sizeof (cx_node_ref));
+            type.max = get_int();
+            break;
+        case fc_array:
+            type.index_type = get_int();
+            type.element_type = get_int();
+            type.min_index = get_int();
+            type.max_index = get_int();
+            type.element_count = get_int();
+            break;
+        case fc_complex:
+            type.xsymtab = get_int();
+            break;
+        default:
+            break;
+    }
+
+    return ok;
+}
+
+// checks that an index read names something in the file
+bool cx_image_reader::valid_node_ref(const cx_node_ref &ref) const {
+    if ((ref.xsymtab == null_ref) || (ref.xsymtab == program_ref)) return true;
+
+    return (ref.xsymtab >= 0) && (ref.xsymtab < (int) symtabs.size())
+            && (ref.xnode >= 0) && (ref.xnode < (int) symtabs[ref.xsymtab].size());
+}
+
+bool cx_image_reader::valid_type_ref(int type) const {
+    return (type >= -1) && (type < (int) type_ptrs.size() + (int) types.size());
+}
+
+bool cx_image_reader::valid_symtab_ref(int xsymtab) const {
+    return (xsymtab >= -1) && (xsymtab < (int) symtabs.size());
+}
+
+// what an index read names in the context
+cx_symtab_node *cx_image_reader::node_of(const cx_node_ref &ref) const {
+    if (ref.xsymtab == null_ref) return nullptr;
+    if (ref.xsymtab == program_ref) return p_program_id;
+
+    return nodes[ref.xsymtab][ref.xnode];
+}
+
+cx_symtab *cx_image_reader::symtab_of(int xsymtab) const {
+    return (xsymtab < 0) ? nullptr : symtab_ptrs[xsymtab];
+}
+
+/** get_script          Read the symbol tables, the program, the call
+ *                      sites, the parallel loops and the types, and
+ *                      check that every index in them names
+ *                      something.
+ *
+ * @return false if the file won't do.
+ */
+bool cx_image_reader::get_script(void) {
+    const int symtab_count = get_int();
+    if (!ok || (symtab_count < 1) || (symtab_count > 0x7fff)) return false;
+
+    symtabs.resize(symtab_count);
+    for (std::vector<cx_node_image> &symtab : symtabs) {
+        const int count = get_int();
+        if (!ok || (count < 0) || (count > 0x7fff)) return false;
+
+        symtab.resize(count);
+        for (cx_node_image &node : symtab) {
+            if (!get_node(node)) return false;
+        }
+    }
+
+    if (!get_node(program)) return false;
+
+    const int site_count = get_int();
+    if (!ok || (site_count < 0)) return false;
+
+    sites.resize(site_count);
+    for (cx_site_image &site : sites) {
+        get_bytes(&site.function, sizeof (cx_node_ref));
+
+        const int parm_count = get_int();
+        if (!ok || (parm_count < 0)) return false;
+
+        site.parms.resize(parm_count);
+        site.variables.resize(parm_count);
+        for (int i = 0; i < parm_count; ++i) {
+            site.parms[i].reference = get_int();
+            site.parms[i].int_to_float = get_int();
+            site.parms[i].copy_value = get_int();
+            site.parms[i].share_value = get_int();
+            get_bytes(&site.variables[i], sizeof (cx_node_ref));
+        }
+    }
+
+    const int loop_count = get_int();
+    if (!ok || (loop_count < 0)) return false;
+
+    loops.resize(loop_count);
+    for (cx_loop_image &loop : loops) {
+        get_bytes(&loop.index, sizeof (cx_node_ref));
+        loop.step = get_int();
+
+        const int reduction_count = get_int();
+        if (!ok || (reduction_count < 0)) return false;
+
+        loop.reductions.resize(reduction_count);
+        loop.ops.resize(reduction_count);
+        for (int i = 0; i < reduction_count; ++i) {
+            get_bytes(&loop.reductions[i], sizeof (cx_node_ref));
+            loop.ops[i] = (cx_token_code) get_int();
+        }
+
+        if (!get_node_refs(loop.private_ids)
+                || !get_node_refs(loop.stored_ids)) return false;
+    }
+
+    builtin_types(p_context, type_ptrs);
+
+    const int type_count = get_int();
+    if (!ok || (type_count < 0)) return false;
+
+    types.resize(type_count);
+    for (cx_type_image &type : types) {
+        if (!get_type(type)) return false;
+    }
+
+    if (cursor != end) return false;
+
+    // the global symtab starts with the nodes every context enters
+    const cx_symtab &global = p_context->global_symtab;
+
+    if ((p_context->symtab_count != 1)
+            || ((int) symtabs[0].size() < global.node_count())) {
+        return false;
+    }
+
+    for (int i = 0; i < global.node_count(); ++i) {
+        const cx_symtab_node *p_node = global.search(symtabs[0][i].p_name);
+
+        if ((p_node == nullptr) || (p_node->node_index() != i)) return false;
+    }
+
+    // every index must name something
+    std::vector<const cx_node_image *> all_nodes;
+
+    for (const std::vector<cx_node_image> &symtab : symtabs) {
+        for (const cx_node_image &node : symtab) all_nodes.push_back(&node);
+    }
+    all_nodes.push_back(&program);
+
+    for (const cx_node_image *p_node : all_nodes) {
+        if (!valid_type_ref(p_node->type) || !valid_node_ref(p_node->next)
+                || !valid_symtab_ref(p_node->xsymtab)) {
+            return false;
+        }
+
+        if (p_node->payload != pc_routine) continue;
+
+        for (const cx_node_ref &ref : p_node->locals) {
+            if (!valid_node_ref(ref)) return false;
+        }
+    }
+
+    for (const cx_site_image &site : sites) {
+        if (!valid_node_ref(site.function)) return false;
+
+        for (const cx_node_ref &ref : site.variables) {
+            if (!valid_node_ref(ref)) return false;
+        }
+    }
+
+    for (const cx_loop_image &loop : loops) {
+        if (!valid_node_ref(loop.index)) return false;
+
+        for (const std::vector<cx_node_ref> *p_refs
+                : {&loop.reductions, &loop.private_ids, &loop.stored_ids}) {
+            for (const cx_node_ref &ref : *p_refs) {
+                if (!valid_node_ref(ref)) return false;
+            }
+        }
+    }
+
+    for (const cx_type_image &type : types) {
+        if (!valid_node_ref(type.type_id)) return false;
+
+        switch (type.form) {
+            case fc_enum:
+                if (!valid_node_ref(type.const_ids)) return false;
+                break;
+            case fc_array:
+                if (!valid_type_ref(type.index_type)
+                        || !valid_type_ref(type.element_type)) return false;
+                break;
+            case fc_complex:
+                if (!valid_symtab_ref(type.xsymtab)) return false;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return true;
+}
+
+/** fill_node           Set a node as the file has it.
+ *
+ * @param p_node : ptr to the node.
+ * @param image  : the node as read.
+ */
+void cx_image_reader::fill_node(cx_symtab_node *p_node,
+        const cx_node_image &image) {
+    cx_define &defn = p_node->defn;
+
+    relink_type(p_node->p_type, type_of(image.type));
+    p_node->next__ = node_of(image.next);
+    p_node->level = image.level;
+    p_node->label_index = image.label_index;
+    p_node->global_finish_location = image.global_finish_location;
+    p_node->string_length = image.string_length;
+    p_node->found_global_end = image.found_global_end;
+    p_node->is_atomic = image.is_atomic;
+
+    defn.how = image.how;
+
+    switch (image.payload) {
+        case pc_value:
+            defn.constant.value = image.value;
+            break;
+        case pc_string:
+            defn.constant.value.p_string =
+                    (char *) cx_intern_string(image.p_string, image.length);
+            break;
+        case pc_routine:
+            defn.routine.which = image.which;
+            defn.routine.return_marker = image.return_marker;
+            defn.routine.parm_count = image.parm_count;
+            defn.routine.total_parm_size = image.total_parm_size;
+            defn.routine.total_local_size = image.total_local_size;
+            defn.routine.locals.p_parms_ids = node_of(image.locals[0]);
+            defn.routine.locals.p_constant_ids = node_of(image.locals[1]);
+            defn.routine.locals.p_type_ids = node_of(image.locals[2]);
+            defn.routine.locals.p_variable_ids = node_of(image.locals[3]);
+            defn.routine.locals.p_function_ids = node_of(image.locals[4]);
+            defn.routine.p_symtab = symtab_of(image.xsymtab);
+            defn.routine.p_icode = nullptr;
+            defn.routine.p_intrinsic = image.p_intrinsic;
+            defn.routine.p_host = nullptr;
+            defn.routine.has_effects = image.has_effects;
+
+            if (image.length >= 0) {
+                defn.routine.p_icode = new cx_icode(p_context);
+                defn.routine.p_icode->replace(image.p_string, image.length);
+            }
+            break;
+        case pc_forward:
+            defn.routine.which = rc_forward;
+            defn.routine.p_symtab = nullptr;
+            defn.routine.p_icode = nullptr;
+            defn.routine.has_effects = false;
+            break;
+    }
+}
+
+/** fill_type           Set a type as the file has it.
+ *
+ * @param p_type : ptr to the type object.
+ * @param image  : the type as read.
+ */
+void cx_image_reader::fill_type(cx_type *p_type, const cx_type_image &image) {
+    p_type->p_type_id = node_of(image.type_id);
+    p_type->type_code = image.type_code;
+
+    switch (image.form) {
+        case fc_enum:
+            p_type->enumeration.p_const_ids = node_of(image.const_ids);
+            p_type->enumeration.max = image.max;
+            break;
+        case fc_array:
+            relink_type(p_type->array.p_index_type, type_of(image.index_type));
+            relink_type(p_type->array.p_element_type, type_of(image.element_type));
+            p_type->array.min_index = image.min_index;
+            p_type->array.max_index = image.max_index;
+            p_type->array.element_count = image.element_count;
+            break;
+        case fc_complex:
+            p_type->complex.p_class_scope_symtab = symtab_of(image.xsymtab);
+            break;
+        default:
+            break;
+    }
+}
+
+/** make_script         Make the script's symbol tables, nodes and
+ *                      types in the context, in the order the parse
+ *                      made them, so each gets the index the icode
+ *                      names it by.
+ *
+ * @return ptr to the program's symtab node.
+ */
+cx_symtab_node *cx_image_reader::make_script(void) {
+    symtab_ptrs.push_back(&p_context->global_symtab);
+    while ((int) symtab_ptrs.size() < (int) symtabs.size()) {
+        symtab_ptrs.push_back(new cx_symtab(p_context));
+    }
+
+    const int builtin_count = p_context->global_symtab.node_count();
+
+    nodes.resize(symtabs.size());
+    for (size_t i = 0; i < symtabs.size(); ++i) {
+        for (size_t j = 0; j < symtabs[i].size(); ++j) {
+            const cx_node_image &image = symtabs[i][j];
+
+            nodes[i].push_back(((i == 0) && ((int) j < builtin_count))
+                    ? p_context->global_symtab.search(image.p_name)
+                    : symtab_ptrs[i]->enter(image.p_name, image.how));
+        }
+    }
+
+    p_program_id = new cx_symtab_node(p_context, program.p_name, dc_program);
+
+    for (const cx_type_image &image : types) {
+        type_ptrs.push_back(image.constant
+                ? new cx_type(image.element_count, true)
+                : new cx_type(image.form, image.size, nullptr));
+    }
+
+    const int builtin_type_count = type_ptrs.size() - types.size();
+    for (size_t i = 0; i < types.size(); ++i) {
+        fill_type(type_ptrs[builtin_type_count + i], types[i]);
+    }
+
+    for (size_t i = 0; i < symtabs.size(); ++i) {
+        for (size_t j = 0; j < symtabs[i].size(); ++j) {
+            fill_node(nodes[i][j], symtabs[i][j]);
+        }
+    }
+    fill_node(p_program_id, program);
+
+    for (const cx_site_image &site : sites) {
+        cx_call_site call_site;
+
+        call_site.p_function_id = node_of(site.function);
+        call_site.parms = site.parms;
+
+        for (size_t i = 0; i < site.parms.size(); ++i) {
+            call_site.parms[i].p_variable_id = node_of(site.variables[i]);
+        }
+
+        p_context->call_sites.push_back(call_site);
+    }
+
+    for (const cx_loop_image &image : loops) {
+        cx_parallel_loop loop;
+
+        loop.p_index_id = node_of(image.index);
+        loop.step = image.step;
+
+        for (size_t i = 0; i < image.reductions.size(); ++i) {
+            const cx_reduction reduction = {node_of(image.reductions[i]), image.ops[i]};
+            loop.reductions.push_back(reduction);
+        }
+
+        for (const cx_node_ref &ref : image.private_ids) {
+            loop.private_ids.push_back(node_of(ref));
+        }
+        for (const cx_node_ref &ref : image.stored_ids) {
+            loop.stored_ids.push_back(node_of(ref));
+        }
+
+        p_context->parallel_loops.push_back(loop);
+    }
+
+    p_context->p_program_ptr_id = p_program_id;
+    p_context->convert_symtabs();
+
+    return p_program_id;
+}
+
+/****************
+ *              *
+ *  Interface   *
+ *              *
+ ****************/
+
+/** cx_precompiled_path  Where the precompiled form of a script is
+ *                      kept:  a file in the directory CX_CACHE names,
+ *                      keyed by the script's resolved path.
+ *
+ * @param p_source_path : ptr to the script's path.
+ * @return the file's path, or "" if scripts aren't kept.
+ */
+std::string cx_precompiled_path(const char *p_source_path) {
+    const char *p_cache_dir = getenv(__CX_CACHE__);
+    if ((p_cache_dir == nullptr) || (*p_cache_dir == '\0')) return "";
+
+    char *p_real_path = realpath(p_source_path, nullptr);
+    if (p_real_path == nullptr) return "";
+
+    const uint64_t key = hash_bytes(p_real_path, strlen(p_real_path));
+    free(p_real_path);
+
+    char name[32];
+    snprintf(name, sizeof (name), "/%016llx.cxc", (unsigned long long) key);
+
+    return std::string(p_cache_dir) + name;
+}
+
+/** cx_save_precompiled  Keep a translated script, once it's been
+ *                      optimized and before it runs.  The file is
+ *                      written aside and renamed, so a script run at
+ *                      the same time never reads half of it.
+ *
+ * @param p_context     : ptr to the script's context.
+ * @param p_program_id  : ptr to the program's symtab node.
+ * @param p_source_path : ptr to the script's path.
+ * @param p_cache_path  : ptr to the path of the file to write.
+ * @return false if the script can't be kept.
+ */
+bool cx_save_precompiled(const cx_context *p_context,
+        const cx_symtab_node *p_program_id, const char *p_source_path,
+        const char *p_cache_path) {
+    if ((p_context->error_count > 0) || (p_program_id == nullptr)
+            || (p_program_id != p_context->p_program_ptr_id)) return false;
+
+    cx_image_writer writer(p_context);
+    uint64_t hash;
+
+    writer.put_bytes(precompiled_magic, 4);
+    writer.put_int(precompiled_version);
+    writer.put_string(precompiled_build);
+    writer.put_int(cx_optimize_flag);
+    writer.put_string(stdlib_path());
+
+    if (!hash_file(p_source_path, hash)) return false;
+    writer.put_hash(hash);
+
+    writer.put_int(p_context->included_modules.size());
+    for (const std::string &module_path : p_context->included_modules) {
+        if (!hash_file(module_path.c_str(), hash)) return false;
+
+        writer.put_string(module_path);
+        writer.put_hash(hash);
+    }
+
+    writer.put_script(p_program_id);
+    if (!writer.ok) return false;
+
+    const std::string temp_path = std::string(p_cache_path) + "."
+            + std::to_string(getpid());
+    FILE *p_file = fopen(temp_path.c_str(), "wb");
+    if (p_file == nullptr) return false;
+
+    bool ok = fwrite(writer.image.data(), 1, writer.image.size(), p_file)
+            == writer.image.size();
+    ok = (fclose(p_file) == 0) && ok;
+    ok = ok && (rename(temp_path.c_str(), p_cache_path) == 0);
+
+    if (!ok) remove(temp_path.c_str());
+
+    return ok;
+}
+
+/** up_to_date          Check that a file was written by this build,
+ *                      with these options, from the script and the
+ *                      modules as they are now.
+ *
+ * @param reader        : reader at the start of the file.
+ * @param p_source_path : ptr to the script's path.
+ * @param modules       : the paths of the modules the script includes.
+ * @return false if the file is stale.
+ */
+static bool up_to_date(cx_image_reader &reader, const char *p_source_path,
+        std::vector<std::string> &modules) {
+    char magic[4];
+    uint64_t hash;
+
+    if (!reader.get_bytes(magic, 4) || (memcmp(magic, precompiled_magic, 4) != 0)
+            || (reader.get_int() != precompiled_version)
+            || (reader.get_string() != precompiled_build)
+            || (reader.get_int() != (int) cx_optimize_flag)
+            || (reader.get_string() != stdlib_path())) {
+        return false;
+    }
+
+    if (!hash_file(p_source_path, hash) || (reader.get_hash() != hash)) {
+        return false;
+    }
+
+    const int module_count = reader.get_int();
+    if (!reader.ok || (module_count < 0)) return false;
+
+    for (int i = 0; i < module_count; ++i) {
+        modules.push_back(reader.get_string());
+
+        if (!reader.ok || !hash_file(modules.back().c_str(), hash)
+                || (reader.get_hash() != hash)) {
+            return false;
+        }
+    }
+
+    return reader.ok;
+}
+
+/** cx_load_precompiled  Read a kept script into a fresh context, in
+ *                      place of parsing it.  Its symbol tables are
+ *                      converted, and it's ready to run.
+ *
+ * @param p_context     : ptr to the fresh context.
+ * @param p_source_path : ptr to the script's path.
+ * @param p_cache_path  : ptr to the path of the kept file.
+ * @return ptr to the program's symtab node, or nullptr if there's no
+ *         file, or it's stale, and the script must be parsed.
+ */
+cx_symtab_node *cx_load_precompiled(cx_context *p_context,
+        const char *p_source_path, const char *p_cache_path) {
+    const int fd = open(p_cache_path, O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat info;
+    void *p_image = MAP_FAILED;
+
+    if ((fstat(fd, &info) == 0) && (info.st_size > 0)) {
+        p_image = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (p_image == MAP_FAILED) return nullptr;
+
+    cx_context_scope scope(p_context);
+    cx_image_reader reader(p_context, (const char *) p_image, info.st_size);
+    std::vector<std::string> modules;
+    cx_symtab_node *p_program_id = nullptr;
+
+    if (up_to_date(reader, p_source_path, modules) && reader.get_script()) {
+        p_program_id = reader.make_script();
+        p_context->included_modules.insert(modules.begin(), modules.end());
+    }
+
+    munmap(p_image, info.st_size);
+
+    return p_program_id;
+}
@@ -2,51 +2,49 @@
 #include "scanner.h"
 #include "misc.h"
 
-cx_char_code_map char_code_map; // maps a character to its code
-
-/** Constructor     Construct a scanner by constructing the
- *                  text input file buffer and initializing the
- *                  character code map.
+/** make_char_code_map   Build the character code map.  Chars it
+ *                      doesn't name are letters.
  *
- * @param p_buffer : ptr to text input buffer to scan.
+ * @return the map.
  */
-cx_text_scanner::cx_text_scanner(cx_text_in_buffer *p_buffer)
-: p_text_in_buffer(p_buffer) {
+static cx_char_code_map make_char_code_map(void) {
+    cx_char_code_map map = {};
     char i;
 
-    // Initialize the character code map.
-    for (i = 'a'; i <= 'z'; ++i) char_code_map[i] = cc_letter;
-    for (i = 'A'; i <= 'Z'; ++i) char_code_map[i] = cc_letter;
-    for (i = '0'; i <= '9'; ++i) char_code_map[i] = cc_digit;
+    for (i = 'a'; i <= 'z'; ++i) map.codes[(unsigned char) i] = cc_letter;
+    for (i = 'A'; i <= 'Z'; ++i) map.codes[(unsigned char) i] = cc_letter;
+    for (i = '0'; i <= '9'; ++i) map.codes[(unsigned char) i] = cc_digit;
 
-    char_code_map['_' ] = cc_letter;
+    map.codes['_'] = cc_letter;
 
-    char_code_map['+' ] = char_code_map['-' ] = cc_special;
-    char_code_map['*' ] = char_code_map['/' ] = cc_special;
-    char_code_map['=' ] = char_code_map['^' ] = cc_special;
-    char_code_map['.' ] = char_code_map[',' ] = cc_special;
-    char_code_map['<' ] = char_code_map['>' ] = cc_special;
-    char_code_map['(' ] = char_code_map[')' ] = cc_special;
-    char_code_map['[' ] = char_code_map[']' ] = cc_special;
-    char_code_map['{' ] = char_code_map['}' ] = cc_special;
-    char_code_map[':' ] = char_code_map[';' ] = cc_special;
+    for (const char *p = "+-*/=^.,<>()[]{}:;#?~|&!%"; *p; ++p) {
+        map.codes[(unsigned char) *p] = cc_special;
+    }
+    for (const char *p = " \t\n\r\f\\"; *p; ++p) {
+        map.codes[(unsigned char) *p] = cc_white_space;
+    }
 
-    char_code_map['#' ] = char_code_map['?' ] = cc_special;
-    char_code_map['~' ] = char_code_map['|' ] = cc_special;
-    char_code_map['&' ] = char_code_map['!' ] = cc_special;
-    char_code_map['%' ] = cc_special;
+    map.codes['\0'] = cc_white_space;
+    map.codes['\''] = cc_quote;
+    map.codes['\"'] = cc_double_quote;
 
-    char_code_map[' ' ] = char_code_map['\t'] = cc_white_space;
-    char_code_map['\n'] = char_code_map['\0'] = cc_white_space;
-    char_code_map['\r'] = char_code_map['\f'] = cc_white_space;
-    char_code_map['\\'] = cc_white_space;
+    map.codes[(unsigned char) eof_char] = cc_end_of_file;
 
-    char_code_map['\''] = cc_quote;
-    char_code_map['\"'] = cc_double_quote;
+    map.codes['`'] = map.codes['@'] = cc_error;
 
-    char_code_map[eof_char] = cc_end_of_file;
+    return map;
+}
 
-    char_code_map['`'] = char_code_map['@'] = cc_error;
+// maps a character to its code
+const cx_char_code_map char_code_map = make_char_code_map();
+
+/** Constructor     Construct a scanner by constructing the
+ *                  text input file buffer.
+ *
+ * @param p_buffer : ptr to text input buffer to scan.
+ */
+cx_text_scanner::cx_text_scanner(cx_text_in_buffer *p_buffer)
+: p_text_in_buffer(p_buffer) {
 }
 
 /** skip_whitespace      Repeatedly fetch characters from the
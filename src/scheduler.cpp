@@ -0,0 +1,183 @@
+/** Scheduler
+ * scheduler.cpp
+ *
+ * Slots that the runs of many scripts take turns in.  A run's thread
+ * holds its slot through a thread local, so the executor yields, and
+ * code that blocks pauses, without being handed the scheduler.
+ *
+ * A slot is handed from the run that gives it up straight to the run
+ * that waited longest, under the scheduler's lock, so a run that
+ * yields can't take its slot back ahead of the others.  Each waiting
+ * run waits on a condition of its own, so only the run handed the
+ * slot wakes.
+ */
+
+#include <chrono>
+#include <ctime>
+#include "scheduler.h"
+
+/** cx_held_slot         The slot this thread holds, and for which
+ *                      run.
+ */
+struct cx_held_slot {
+    cx_scheduler *p_scheduler; // nullptr if none
+    cx_run_account *p_account;
+    int pauses; // cx_slot_pauses alive, the slot given up while any is
+    double cpu_mark; // thread cpu time when the slot was last taken
+};
+
+static thread_local cx_held_slot held = {nullptr, nullptr, 0, 0};
+
+/** thread_cpu_seconds  CPU time this thread has taken so far.
+ *
+ * @return seconds.
+ */
+static double thread_cpu_seconds(void) {
+    timespec now;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) return 0;
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/** Constructor
+ *
+ * @param slot_count : runs that may hold a slot at once.
+ * @param slice      : statements a run executes per turn, 0 if it
+ *                     keeps its slot until it leaves.
+ */
+cx_scheduler::cx_scheduler(int slot_count, long slice)
+: free_slots((slot_count > 0) ? slot_count : 1), slice((slice > 0) ? slice : 0) {
+}
+
+/** acquire             Wait for a slot, behind the runs already
+ *                      waiting, and take it.
+ *
+ * @param lock    : holds the scheduler's lock.
+ * @param account : of the run taking the slot.
+ */
+void cx_scheduler::acquire(std::unique_lock<std::mutex> &lock,
+        cx_run_account &account) {
+    using namespace std::chrono;
+
+    if (free_slots > 0) {
+        --free_slots;
+    } else {
+        const steady_clock::time_point start = steady_clock::now();
+        cx_waiter waiter;
+
+        waiter.granted = false;
+        waiting.push_back(&waiter);
+        waiter.turn.wait(lock, [&waiter]() {
+            return waiter.granted;
+        });
+
+        account.wait_seconds +=
+                duration_cast<duration<double> >(steady_clock::now() - start).count();
+    }
+
+    ++account.slices;
+    held.cpu_mark = thread_cpu_seconds();
+}
+
+/** release             Give up this thread's slot, to the run that
+ *                      waited longest, if any.  The lock is held.
+ *
+ * @param account : of the run giving the slot up.
+ */
+void cx_scheduler::release(cx_run_account &account) {
+    account.cpu_seconds += thread_cpu_seconds() - held.cpu_mark;
+
+    if (waiting.empty()) {
+        ++free_slots;
+        return;
+    }
+
+    cx_waiter *p_next = waiting.front();
+
+    waiting.pop_front();
+    p_next->granted = true;
+    p_next->turn.notify_one();
+}
+
+/** enter               Begin a run:  wait for a slot, and hold it
+ *                      on this thread until leave.
+ *
+ * @param account : of the run's script.
+ * @return false if this thread already holds a slot, which the run
+ *         shares, and mustn't leave.
+ */
+bool cx_scheduler::enter(cx_run_account &account) {
+    if (held.p_scheduler != nullptr) return false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    ++account.runs;
+    acquire(lock, account);
+
+    held.p_scheduler = this;
+    held.p_account = &account;
+    held.pauses = 0;
+
+    return true;
+}
+
+/** leave               End the run entered on this thread, and give
+ *                      up its slot.
+ *
+ * @param statements : the run executed.
+ */
+void cx_scheduler::leave(long statements) {
+    if (held.p_scheduler != this) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    held.p_account->statements += statements;
+    if (held.pauses == 0) release(*held.p_account);
+
+    held.p_scheduler = nullptr;
+    held.p_account = nullptr;
+}
+
+/** yield               End this thread's turn, if runs are waiting
+ *                      for a slot:  hand its slot to the one that
+ *                      waited longest, and wait behind the others.
+ */
+void cx_scheduler::yield(void) {
+    cx_scheduler *p_scheduler = held.p_scheduler;
+
+    if ((p_scheduler == nullptr) || (held.pauses > 0)) return;
+
+    std::unique_lock<std::mutex> lock(p_scheduler->mutex);
+
+    if (p_scheduler->waiting.empty()) return;
+
+    p_scheduler->release(*held.p_account);
+    p_scheduler->acquire(lock, *held.p_account);
+}
+
+/** pause               Give up this thread's slot while it blocks,
+ *                      until the matching resume.
+ */
+void cx_scheduler::pause(void) {
+    cx_scheduler *p_scheduler = held.p_scheduler;
+
+    if ((p_scheduler == nullptr) || (held.pauses++ > 0)) return;
+
+    std::lock_guard<std::mutex> lock(p_scheduler->mutex);
+
+    p_scheduler->release(*held.p_account);
+}
+
+/** resume              Wait for a slot again, once the last pause
+ *                      of this thread ends.
+ */
+void cx_scheduler::resume(void) {
+    cx_scheduler *p_scheduler = held.p_scheduler;
+
+    if ((p_scheduler == nullptr) || (--held.pauses > 0)) return;
+
+    std::unique_lock<std::mutex> lock(p_scheduler->mutex);
+
+    p_scheduler->acquire(lock, *held.p_account);
+}
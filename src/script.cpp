@@ -0,0 +1,694 @@
+/** Embedding
+ * script.cpp
+ *
+ * Compile a script once, into a context of its own, and run it or
+ * call its functions on behalf of a host program.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "common.h"
+#include "cx-debug/channel.h"
+#include "cx-debug/exec.h"
+#include "optimizer.h"
+#include "parser.h"
+#include "script.h"
+
+/** to_int              The value as an int.
+ *
+ * @return the value, or 0 if it isn't a number.
+ */
+int cx_value::to_int(void) const {
+    switch (code) {
+        case vc_int: return int__;
+        case vc_float: return (int) float__;
+        case vc_char: return char__;
+        case vc_bool: return bool__;
+        default: return 0;
+    }
+}
+
+/** to_float            The value as a float.
+ *
+ * @return the value, or 0 if it isn't a number.
+ */
+float cx_value::to_float(void) const {
+    return (code == vc_float) ? float__ : (float) to_int();
+}
+
+/** cx_value_of          The host's value of a script value.
+ *
+ * @param p_context : ptr to the script's context.
+ * @param p_type    : ptr to the value's type object.
+ * @param value     : the value, or the data of a char array.
+ * @return the value; a char array is the string up to its '\0'.
+ */
+cx_value cx_value_of(const cx_context *p_context, const cx_type *p_type,
+        const mem_block &value) {
+    if (p_type->form == fc_array) {
+        const char *p_data = (const char *) value.addr__;
+
+        if (p_data == nullptr) return cx_value("");
+
+        return cx_value(std::string(p_data,
+                strnlen(p_data, cx_value_size(p_type, p_data))));
+    }
+
+    if (p_type == p_context->p_float_type) return cx_value(value.float__);
+    if (p_type == p_context->p_char_type) return cx_value(value.char__);
+    if (p_type == p_context->p_boolean_type) return cx_value(value.bool__);
+
+    return cx_value(value.int__);
+}
+
+/** cx_block_of          The script value of a host's value.
+ *
+ * @param p_context : ptr to the script's context.
+ * @param p_type    : ptr to the type the script expects.
+ * @param value     : the host's value.
+ * @param block     : the script value.  A string is put in a
+ *                    buffer of its own, which the caller owns.
+ * @return false if the type can't hold the value.
+ */
+bool cx_block_of(const cx_context *p_context, const cx_type *p_type,
+        const cx_value &value, mem_block &block) {
+    if (p_type->form == fc_array) {
+        if ((value.code != vc_string)
+                || (p_type->array.p_element_type != p_context->p_char_type)) {
+            return false;
+        }
+
+        const int length = value.string__.size();
+
+        block.addr__ = cx_value_alloc(length);
+        memcpy(block.addr__, value.string__.data(), length);
+
+        return true;
+    }
+
+    if ((value.code == vc_void) || (value.code == vc_string)) return false;
+
+    if (p_type == p_context->p_float_type) block.float__ = value.to_float();
+    else if (p_type == p_context->p_char_type) block.char__ = value.to_int();
+    else if (p_type == p_context->p_boolean_type) {
+        block.int__ = 0;
+        block.bool__ = (value.to_int() != 0);
+    } else if ((p_type == p_context->p_integer_type)
+            || (p_type->form == fc_enum)) block.int__ = value.to_int();
+    else return false;
+
+    return true;
+}
+
+/** split_signature      Split a host function's signature into the
+ *                      names of its result and parameter types.
+ *
+ * @param signature : the signature, e.g. "int(char*,int)".
+ * @param names     : the result's type name, then each parm's.
+ * @return false if the signature is malformed.
+ */
+static bool split_signature(const std::string &signature,
+        std::vector<std::string> &names) {
+    const size_t open = signature.find('(');
+
+    if ((open == std::string::npos) || (signature.back() != ')')) return false;
+
+    names.push_back(signature.substr(0, open));
+
+    const std::string parms = signature.substr(open + 1,
+            signature.size() - open - 2);
+
+    for (size_t begin = 0; !parms.empty();) {
+        const size_t end = parms.find(',', begin);
+
+        names.push_back(parms.substr(begin, end - begin));
+        if (end == std::string::npos) break;
+
+        begin = end + 1;
+    }
+
+    return true;
+}
+
+/** host_type            Type object of a type name in a host
+ *                      function's signature.
+ *
+ * @param p_context : ptr to the script's context.
+ * @param name      : int, float, char or bool, or char* for a string.
+ * @return ptr to the type object, or nullptr if there is none.
+ */
+static cx_type *host_type(cx_context *p_context, const std::string &name) {
+    if (name == "int") return p_context->p_integer_type;
+    if (name == "float") return p_context->p_float_type;
+    if (name == "char") return p_context->p_char_type;
+    if (name == "bool") return p_context->p_boolean_type;
+
+    if (name == "char*") {
+        cx_type *p_array_type = new cx_type(fc_array, 0, nullptr);
+
+        set_type(p_array_type->array.p_element_type, p_context->p_char_type);
+        set_type(p_array_type->array.p_index_type, p_context->p_integer_type);
+        p_array_type->array.element_count = 0;
+        p_array_type->array.min_index = 0;
+        p_array_type->array.max_index = 0;
+
+        return p_array_type;
+    }
+
+    return nullptr;
+}
+
+/** release_args         Release the strings of the actuals bound so
+ *                      far, when a call can't be made.
+ *
+ * @param p_function_id : ptr to the function's symtab node.
+ * @param p_args        : ptr to the actuals.
+ * @param count         : number of actuals bound.
+ */
+static void release_args(const cx_symtab_node *p_function_id,
+        const mem_block *p_args, int count) {
+    const cx_symtab_node *p_parm_id =
+            p_function_id->defn.routine.locals.p_parms_ids;
+
+    for (int i = 0; i < count; ++i, p_parm_id = p_parm_id->next__) {
+        if (p_parm_id->p_type->form == fc_array) {
+            cx_value_release(p_args[i].addr__);
+        }
+    }
+}
+
+/** Constructor     Make a script with nothing compiled.
+ */
+cx_script::cx_script(void)
+: p_context(nullptr), p_program_id(nullptr), p_executor(nullptr),
+p_scheduler(nullptr) {
+}
+
+/** Destructor      Free the compiled script and its host
+ *                  functions.
+ */
+cx_script::~cx_script(void) {
+    reset();
+    delete p_context;
+
+    for (cx_host_function *p_host : host_functions) delete p_host;
+}
+
+/** define              Define a host function that scripts compiled
+ *                      from now on can call.
+ *
+ * @param p_name      : ptr to the name scripts call it by.
+ * @param p_signature : ptr to its signature, e.g. "float(int)".
+ *                      Parms are int, float, char, bool or char*;
+ *                      the result is one of the first four.
+ * @param p_code      : ptr to the host's code.
+ * @param p_data      : handed back to the code on each call.
+ * @return false if the signature isn't one a host function can have.
+ */
+bool cx_script::define(const char *p_name, const char *p_signature,
+        cx_host_code p_code, void *p_data) {
+    std::vector<std::string> names;
+    bool valid = split_signature(p_signature, names)
+            && (names.size() <= cx_host_function::max_args + 1)
+            && (names[0] != "char*");
+
+    for (size_t i = 0; valid && (i < names.size()); ++i) {
+        valid = (names[i] == "int") || (names[i] == "float")
+                || (names[i] == "char") || (names[i] == "bool")
+                || (names[i] == "char*");
+    }
+
+    if (!valid) {
+        messages.append("*** error: invalid host function signature: ")
+                .append(p_name).append(" ").append(p_signature).append("\n");
+        return false;
+    }
+
+    host_functions.push_back(new cx_host_function{p_name, p_signature,
+        p_code, p_data});
+
+    return true;
+}
+
+/** enter_host_function  Enter a host function into the global symbol
+ *                      table, with a value parm for each parameter
+ *                      of its signature.
+ *
+ * @param p_host : ptr to the host function.
+ * @return false if its name is already taken.
+ */
+bool cx_script::enter_host_function(const cx_host_function *p_host) {
+    cx_symtab *p_symtab = &p_context->global_symtab;
+
+    if (p_symtab->search(p_host->name.c_str()) != nullptr) {
+        messages.append("*** error: host function already defined: ")
+                .append(p_host->name).append("\n");
+        return false;
+    }
+
+    std::vector<std::string> names;
+    split_signature(p_host->signature, names);
+
+    cx_symtab_node *p_function_id = p_symtab->enter(p_host->name.c_str(),
+            dc_function);
+
+    p_function_id->defn.routine.which = rc_host;
+    p_function_id->defn.routine.parm_count = names.size() - 1;
+    p_function_id->defn.routine.total_parm_size = 0;
+    p_function_id->defn.routine.total_local_size = 0;
+    p_function_id->defn.routine.locals.p_parms_ids = nullptr;
+    p_function_id->defn.routine.locals.p_constant_ids = nullptr;
+    p_function_id->defn.routine.locals.p_type_ids = nullptr;
+    p_function_id->defn.routine.locals.p_variable_ids = nullptr;
+    p_function_id->defn.routine.locals.p_function_ids = nullptr;
+    p_function_id->defn.routine.p_symtab = new cx_symtab(p_context);
+    p_function_id->defn.routine.p_icode = nullptr;
+    p_function_id->defn.routine.p_host = p_host;
+    p_function_id->defn.routine.has_effects = true; // as far as we know
+
+    set_type(p_function_id->p_type, host_type(p_context, names[0]));
+
+    cx_symtab_node *p_last_id = nullptr;
+
+    for (size_t i = 1; i < names.size(); ++i) {
+        char parm_name[16];
+        sprintf(parm_name, "arg%d", (int) i - 1);
+
+        cx_symtab_node *p_parm_id = p_function_id->defn.routine.p_symtab
+                ->enter(parm_name, dc_value_parm);
+
+        set_type(p_parm_id->p_type, host_type(p_context, names[i]));
+        if (!p_parm_id->p_type->p_type_id) p_parm_id->p_type->p_type_id = p_parm_id;
+
+        p_parm_id->defn.data.offset = i - 1;
+        p_function_id->defn.routine.total_parm_size += p_parm_id->p_type->size;
+
+        if (p_last_id == nullptr) {
+            p_function_id->defn.routine.locals.p_parms_ids = p_parm_id;
+        } else p_last_id->next__ = p_parm_id;
+
+        p_last_id = p_parm_id;
+    }
+
+    return true;
+}
+
+/** compile             Compile a script into a new context, in place
+ *                      of the one compiled before.
+ *
+ * @param p_name : ptr to the file name, or the name of the text.
+ * @param p_text : ptr to the source text, or nullptr to read the file.
+ * @return false if the script has errors.
+ */
+bool cx_script::compile(const char *p_name, const std::string *p_text) {
+    reset();
+    delete p_context;
+    p_program_id = nullptr;
+    messages.clear();
+
+    p_context = new cx_context;
+    p_context->embedded = true;
+    p_context->p_scheduler = p_scheduler;
+    p_context->list.capture(&messages);
+
+    cx_context_scope scope(p_context);
+
+    try {
+        for (const cx_host_function *p_host : host_functions) {
+            if (!enter_host_function(p_host)) return false;
+        }
+
+        std::unique_ptr<cx_parser> parser(new cx_parser(p_context,
+                (p_text != nullptr)
+                ? new cx_source_buffer(p_context, p_name, *p_text)
+                : new cx_source_buffer(p_context, p_name)));
+
+        p_program_id = parser->parse();
+    } catch (const cx_abort &) {
+        p_program_id = nullptr;
+        return false;
+    }
+
+    if ((p_context->error_count > 0)
+            || (p_program_id->defn.routine.p_icode == nullptr)) {
+        if (p_context->error_count == 0) {
+            messages.append("*** error: no function in ")
+                    .append(p_name).append("\n");
+        }
+
+        p_program_id = nullptr;
+        return false;
+    }
+
+    p_context->convert_symtabs();
+
+    if (cx_optimize_flag) {
+        cx_optimizer optimizer(p_context);
+        optimizer.optimize(p_program_id);
+    }
+
+    return true;
+}
+
+/** compile_file        Compile a script from a source file.
+ *
+ * @param p_file_name : ptr to the file's name.
+ * @return false if the script has errors.
+ */
+bool cx_script::compile_file(const char *p_file_name) {
+    return compile(p_file_name, nullptr);
+}
+
+/** compile_string      Compile a script from source text.
+ *
+ * @param source : the source text.
+ * @param p_name : ptr to the name the script goes by in messages.
+ * @return false if the script has errors.
+ */
+bool cx_script::compile_string(const std::string &source, const char *p_name) {
+    return compile(p_name, &source);
+}
+
+/** run                 Run the whole script, from the setup of its
+ *                      globals through main, as the interpreter
+ *                      would.  Each run starts afresh.
+ *
+ * @return false if nothing is compiled, or the run failed.
+ */
+bool cx_script::run(void) {
+    if (p_program_id == nullptr) return false;
+
+    cx_context_scope scope(p_context);
+    std::unique_ptr<cx_executor> executor(new cx_executor(p_context));
+
+    messages.clear();
+
+    try {
+        executor->go(p_program_id);
+    } catch (const cx_abort &) {
+        cx_stream_flush_all();
+        return false;
+    }
+
+    cx_stream_flush_all();
+    return true;
+}
+
+/** start               Set up the script's globals for calls, if
+ *                      they aren't already.
+ *
+ * @return false if nothing is compiled, or the setup failed.
+ */
+bool cx_script::start(void) {
+    if (p_program_id == nullptr) return false;
+    if (p_executor != nullptr) return true;
+
+    cx_context_scope scope(p_context);
+
+    p_executor = new cx_executor(p_context);
+
+    try {
+        p_executor->start(p_program_id);
+    } catch (const cx_abort &) {
+        delete p_executor;
+        p_executor = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+/** find_global         Find a global of the compiled script.
+ *
+ * @param p_name : ptr to the global's name.
+ * @return ptr to its symtab node, or nullptr if there is none.
+ */
+cx_symtab_node *cx_script::find_global(const char *p_name) const {
+    if (p_program_id == nullptr) return nullptr;
+
+    return p_context->global_symtab.search(p_name);
+}
+
+/** call                Call a function of the script.  The script's
+ *                      globals are set up on the first call, and
+ *                      keep their values from call to call.
+ *
+ * @param p_name    : ptr to the function's name.
+ * @param p_args    : ptr to the actuals, one per formal.
+ * @param arg_count : number of actuals.
+ * @param result    : the function's value.
+ * @return false if there is no such function, the actuals don't fit
+ *         its formals, or the call failed.
+ */
+bool cx_script::call(const char *p_name, const cx_value *p_args,
+        int arg_count, cx_value &result) {
+    cx_symtab_node *p_function_id = find_global(p_name);
+
+    messages.clear();
+
+    if ((p_function_id == nullptr) || (p_function_id->defn.how != dc_function)
+            || ((p_function_id->defn.routine.which != rc_declared)
+            && (p_function_id->defn.routine.which != rc_intrinsic))
+            || (p_function_id->defn.routine.parm_count != arg_count)
+            || (arg_count > cx_host_function::max_args)
+            || !p_function_id->p_type->is_scalar_type()) {
+        messages.append("*** error: no function to call: ").append(p_name)
+                .append("\n");
+        return false;
+    }
+
+    if (!start()) return false;
+
+    cx_context_scope scope(p_context);
+    mem_block args[cx_host_function::max_args];
+    int i = 0;
+
+    // bind the actuals; reference parms have nothing to refer to
+    for (const cx_symtab_node *p_parm_id =
+            p_function_id->defn.routine.locals.p_parms_ids;
+            p_parm_id != nullptr; p_parm_id = p_parm_id->next__, ++i) {
+        if ((p_parm_id->defn.how != dc_value_parm)
+                || !cx_block_of(p_context, p_parm_id->p_type, p_args[i], args[i])) {
+            messages.append("*** error: invalid actual parameter to ")
+                    .append(p_name).append("\n");
+
+            release_args(p_function_id, args, i);
+            return false;
+        }
+    }
+
+    try {
+        result = cx_value_of(p_context, p_function_id->p_type,
+                p_executor->call(p_function_id, args));
+    } catch (const cx_abort &) {
+        // the run stack is left mid-call:  start over next time
+        delete p_executor;
+        p_executor = nullptr;
+
+        cx_stream_flush_all();
+        return false;
+    }
+
+    // the script's output goes out with the call
+    cx_stream_flush_all();
+    return true;
+}
+
+/** get_global          Read a global of the script, as the last
+ *                      call left it.
+ *
+ * @param p_name : ptr to the global's name.
+ * @param value  : the global's value.
+ * @return false if there is no such scalar or string global.
+ */
+bool cx_script::get_global(const char *p_name, cx_value &value) {
+    const cx_symtab_node *p_id = find_global(p_name);
+
+    if ((p_id == nullptr) || (p_id->defn.how != dc_variable)
+            || (!p_id->p_type->is_scalar_type()
+            && (p_id->p_type->form != fc_array)) || !start()) return false;
+
+    value = cx_value_of(p_context, p_id->p_type,
+            p_executor->global_value(p_id)->basic_types);
+
+    return true;
+}
+
+/** set_global          Store into a global of the script, for the
+ *                      calls that follow.
+ *
+ * @param p_name : ptr to the global's name.
+ * @param value  : the value.  A string is cut to the size of a
+ *                 fixed size char array.
+ * @return false if there is no such global, or it can't hold the value.
+ */
+bool cx_script::set_global(const char *p_name, const cx_value &value) {
+    const cx_symtab_node *p_id = find_global(p_name);
+    mem_block block;
+
+    if ((p_id == nullptr) || (p_id->defn.how != dc_variable)
+            || (!p_id->p_type->is_scalar_type()
+            && (p_id->p_type->form != fc_array))
+            || !cx_block_of(p_context, p_id->p_type, value, block)) {
+        return false;
+    }
+
+    if (!start()) {
+        if (p_id->p_type->form == fc_array) cx_value_release(block.addr__);
+        return false;
+    }
+
+    cx_stack_item *p_item = p_executor->global_value(p_id);
+
+    if (p_id->p_type->form != fc_array) {
+        p_item->basic_types = block;
+    } else if (p_id->p_type->size == 0) {
+        cx_value_release(p_item->basic_types.addr__);
+        p_item->basic_types.addr__ = block.addr__;
+    } else {
+        const int size = p_id->p_type->size;
+        char *p_data = (char *) cx_value_unshare(p_item->basic_types.addr__);
+
+        memset(p_data, 0, size);
+        memcpy(p_data, block.addr__,
+                std::min((int) value.string__.size(), size));
+        p_item->basic_types.addr__ = p_data;
+
+        cx_value_release(block.addr__);
+    }
+
+    return true;
+}
+
+/** reset               Release the script's globals.  The next call
+ *                      sets them up afresh.
+ */
+void cx_script::reset(void) {
+    if (p_executor == nullptr) return;
+
+    cx_context_scope scope(p_context);
+
+    try {
+        p_executor->stop(p_program_id);
+    } catch (const cx_abort &) {
+    }
+
+    delete p_executor;
+    p_executor = nullptr;
+}
+
+/** find_channel        Find a channel of the script that the host
+ *                      can pass values through:  one of scalars, or
+ *                      of char arrays, as strings.
+ *
+ * @param p_context : ptr to the script's context, or nullptr.
+ * @param channel   : the channel's handle.
+ * @return ptr to the channel, or nullptr if there is none.
+ */
+static cx_channel *find_channel(const cx_context *p_context, int channel) {
+    if (p_context == nullptr) return nullptr;
+
+    cx_channel *p_channel = p_context->p_channels->find(channel);
+
+    if ((p_channel == nullptr) || (p_channel->is_array
+            ? (p_channel->p_element_type != p_context->p_char_type)
+            : !p_channel->p_element_type->is_scalar_type())) return nullptr;
+
+    return p_channel;
+}
+
+/** send                Send a value into a channel of the script.
+ *
+ * @param channel : the channel's handle.
+ * @param value   : the value;  a string for a channel of char arrays.
+ * @param wait    : true to wait while the channel is full.
+ * @return false if there is no such channel, it can't carry the
+ *         value, or it's closed, or full and not waited on.
+ */
+bool cx_script::send(int channel, const cx_value &value, bool wait) {
+    cx_channel *p_channel = find_channel(p_context, channel);
+    mem_block block;
+
+    if (p_channel == nullptr) return false;
+
+    if (p_channel->is_array) {
+        if (value.code != vc_string) return false;
+
+        const int length = value.string__.size();
+
+        block.addr__ = cx_value_alloc(length);
+        memcpy(block.addr__, value.string__.data(), length);
+    } else if (!cx_block_of(p_context, p_channel->p_element_type, value, block)) {
+        return false;
+    }
+
+    const bool sent = wait ? p_channel->send(block) : p_channel->try_send(block);
+
+    if (!sent && p_channel->is_array) cx_value_release(block.addr__);
+
+    return sent;
+}
+
+/** receive             Receive a value from a channel of the script.
+ *
+ * @param channel : the channel's handle.
+ * @param value   : the value;  a string from a channel of char arrays.
+ * @param wait    : true to wait while the channel is empty.
+ * @return false if there is no such channel, or it's closed and
+ *         empty, or empty and not waited on.
+ */
+bool cx_script::receive(int channel, cx_value &value, bool wait) {
+    cx_channel *p_channel = find_channel(p_context, channel);
+    mem_block block;
+
+    if ((p_channel == nullptr)
+            || !(wait ? p_channel->receive(block) : p_channel->try_receive(block))) {
+        return false;
+    }
+
+    if (p_channel->is_array) {
+        const char *p_data = (const char *) block.addr__;
+
+        value = cx_value(std::string(p_data, strnlen(p_data, cx_value_length(p_data))));
+        cx_value_release(block.addr__);
+    } else value = cx_value_of(p_context, p_channel->p_element_type, block);
+
+    return true;
+}
+
+/** close               Close a channel of the script.
+ *
+ * @param channel : the channel's handle.
+ * @return false if there is no such channel.
+ */
+bool cx_script::close(int channel) {
+    cx_channel *p_channel = (p_context != nullptr)
+            ? p_context->p_channels->find(channel) : nullptr;
+
+    if (p_channel == nullptr) return false;
+
+    p_channel->close();
+
+    return true;
+}
+
+/** schedule            Run the script, from now on, only in the slots
+ *                      of a scheduler.
+ *
+ * @param p_scheduler : ptr to the scheduler, or nullptr to run the
+ *                      script whenever it's run or called.
+ */
+void cx_script::schedule(cx_scheduler *p_scheduler) {
+    this->p_scheduler = p_scheduler;
+    if (p_context != nullptr) p_context->p_scheduler = p_scheduler;
+}
+
+/** account             What the script's runs and calls took under
+ *                      its scheduler, since it was compiled.
+ *
+ * @return the account, all zero if nothing is compiled.
+ */
+cx_run_account cx_script::account(void) const {
+    return (p_context != nullptr) ? *p_context->p_account : cx_run_account();
+}
@@ -0,0 +1,313 @@
+/** String scans
+ * strscan.cpp
+ *
+ * Scans over char buffers for the string intrinsics.  Each scan has
+ * a scalar version, and on x86 an SSE2 and an AVX2 one; the widest
+ * one the CPU supports is picked on first use.  The vector loops
+ * only load whole vectors that lie inside the buffer and leave the
+ * rest to the scalar version, so no scan reads past the buffer's
+ * size, even when it isn't terminated.
+ */
+
+#include <cstring>
+#include "strscan.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CX_STRSCAN_X86
+#include <immintrin.h>
+#endif
+
+/** cx_scan_kernels      The versions of the scans in use.
+ */
+struct cx_scan_kernels {
+    size_t(*find_char_or_nul)(const char *p_data, size_t size, char c);
+    size_t(*find_mismatch)(const char *p_data1, const char *p_data2,
+            size_t size);
+    ptrdiff_t(*find_substring)(const char *p_text, size_t text_length,
+            const char *p_pattern, size_t pattern_length);
+};
+
+/************
+ *          *
+ *  scalar  *
+ *          *
+ ************/
+
+static size_t scalar_find_char_or_nul(const char *p_data, size_t size, char c) {
+    size_t i = 0;
+
+    while ((i < size) && (p_data[i] != c) && (p_data[i] != '\0')) ++i;
+
+    return i;
+}
+
+static size_t scalar_find_mismatch(const char *p_data1, const char *p_data2,
+        size_t size) {
+    size_t i = 0;
+
+    while ((i < size) && (p_data1[i] == p_data2[i]) && (p_data1[i] != '\0')) ++i;
+
+    return i;
+}
+
+/** scalar_find_substring    Find a pattern from a position on.
+ *
+ * @param p_text         : ptr to the text.
+ * @param text_length    : length of the text.
+ * @param p_pattern      : ptr to the pattern; not empty.
+ * @param pattern_length : length of the pattern.
+ * @param start          : position to start at.
+ * @return the pattern's position, or -1 if it isn't found.
+ */
+static ptrdiff_t scalar_find_substring_from(const char *p_text,
+        size_t text_length, const char *p_pattern, size_t pattern_length,
+        size_t start) {
+    for (size_t i = start; i + pattern_length <= text_length; ++i) {
+        if ((p_text[i] == p_pattern[0])
+                && (memcmp(p_text + i + 1, p_pattern + 1, pattern_length - 1) == 0)) {
+            return (ptrdiff_t) i;
+        }
+    }
+
+    return -1;
+}
+
+static ptrdiff_t scalar_find_substring(const char *p_text, size_t text_length,
+        const char *p_pattern, size_t pattern_length) {
+    return scalar_find_substring_from(p_text, text_length,
+            p_pattern, pattern_length, 0);
+}
+
+#ifdef CX_STRSCAN_X86
+
+/**********
+ *        *
+ *  SSE2  *
+ *        *
+ **********/
+
+__attribute__((target("sse2")))
+static size_t sse2_find_char_or_nul(const char *p_data, size_t size, char c) {
+    const __m128i chars = _mm_set1_epi8(c);
+    const __m128i zeros = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i *) (p_data + i));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(block, chars), _mm_cmpeq_epi8(block, zeros)));
+
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+
+    return i + scalar_find_char_or_nul(p_data + i, size - i, c);
+}
+
+__attribute__((target("sse2")))
+static size_t sse2_find_mismatch(const char *p_data1, const char *p_data2,
+        size_t size) {
+    const __m128i zeros = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block1 = _mm_loadu_si128((const __m128i *) (p_data1 + i));
+        const __m128i block2 = _mm_loadu_si128((const __m128i *) (p_data2 + i));
+        const int equal = _mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2));
+        const int nul = _mm_movemask_epi8(_mm_cmpeq_epi8(block1, zeros));
+        const int mask = (~equal & 0xffff) | nul;
+
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+
+    return i + scalar_find_mismatch(p_data1 + i, p_data2 + i, size - i);
+}
+
+/** sse2_find_substring  Find a pattern by its first and its last
+ *                      char, 16 positions at a time; only positions
+ *                      where both match are compared in full.
+ */
+__attribute__((target("sse2")))
+static ptrdiff_t sse2_find_substring(const char *p_text, size_t text_length,
+        const char *p_pattern, size_t pattern_length) {
+    const size_t last = pattern_length - 1;
+    const __m128i firsts = _mm_set1_epi8(p_pattern[0]);
+    const __m128i lasts = _mm_set1_epi8(p_pattern[last]);
+    size_t i = 0;
+
+    for (; i + last + 16 <= text_length; i += 16) {
+        const __m128i block_first = _mm_loadu_si128((const __m128i *) (p_text + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i *) (p_text + i + last));
+        unsigned mask = (unsigned) _mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(block_first, firsts),
+                _mm_cmpeq_epi8(block_last, lasts)));
+
+        while (mask != 0) {
+            const size_t at = i + __builtin_ctz(mask);
+
+            if (memcmp(p_text + at + 1, p_pattern + 1, last) == 0) {
+                return (ptrdiff_t) at;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return scalar_find_substring_from(p_text, text_length,
+            p_pattern, pattern_length, i);
+}
+
+/**********
+ *        *
+ *  AVX2  *
+ *        *
+ **********/
+
+__attribute__((target("avx2")))
+static size_t avx2_find_char_or_nul(const char *p_data, size_t size, char c) {
+    const __m256i chars = _mm256_set1_epi8(c);
+    const __m256i zeros = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i *) (p_data + i));
+        const unsigned mask = (unsigned) _mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_cmpeq_epi8(block, chars), _mm256_cmpeq_epi8(block, zeros)));
+
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+
+    return i + sse2_find_char_or_nul(p_data + i, size - i, c);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_find_mismatch(const char *p_data1, const char *p_data2,
+        size_t size) {
+    const __m256i zeros = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block1 = _mm256_loadu_si256((const __m256i *) (p_data1 + i));
+        const __m256i block2 = _mm256_loadu_si256((const __m256i *) (p_data2 + i));
+        const unsigned equal = (unsigned) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(block1, block2));
+        const unsigned nul = (unsigned) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(block1, zeros));
+        const unsigned mask = ~equal | nul;
+
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+
+    return i + sse2_find_mismatch(p_data1 + i, p_data2 + i, size - i);
+}
+
+__attribute__((target("avx2")))
+static ptrdiff_t avx2_find_substring(const char *p_text, size_t text_length,
+        const char *p_pattern, size_t pattern_length) {
+    const size_t last = pattern_length - 1;
+    const __m256i firsts = _mm256_set1_epi8(p_pattern[0]);
+    const __m256i lasts = _mm256_set1_epi8(p_pattern[last]);
+    size_t i = 0;
+
+    for (; i + last + 32 <= text_length; i += 32) {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i *) (p_text + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i *) (p_text + i + last));
+        unsigned mask = (unsigned) _mm256_movemask_epi8(_mm256_and_si256(
+                _mm256_cmpeq_epi8(block_first, firsts),
+                _mm256_cmpeq_epi8(block_last, lasts)));
+
+        while (mask != 0) {
+            const size_t at = i + __builtin_ctz(mask);
+
+            if (memcmp(p_text + at + 1, p_pattern + 1, last) == 0) {
+                return (ptrdiff_t) at;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return scalar_find_substring_from(p_text, text_length,
+            p_pattern, pattern_length, i);
+}
+
+#endif
+
+/** kernels              The scans for this CPU, picked once.
+ *
+ * @return the scans.
+ */
+static const cx_scan_kernels &kernels(void) {
+    static const cx_scan_kernels scalar = {
+        scalar_find_char_or_nul, scalar_find_mismatch, scalar_find_substring
+    };
+
+#ifdef CX_STRSCAN_X86
+    static const cx_scan_kernels sse2 = {
+        sse2_find_char_or_nul, sse2_find_mismatch, sse2_find_substring
+    };
+    static const cx_scan_kernels avx2 = {
+        avx2_find_char_or_nul, avx2_find_mismatch, avx2_find_substring
+    };
+    static const cx_scan_kernels *p_kernels =
+            __builtin_cpu_supports("avx2") ? &avx2
+            : __builtin_cpu_supports("sse2") ? &sse2 : &scalar;
+
+    return *p_kernels;
+#else
+    return scalar;
+#endif
+}
+
+/** cx_find_char_or_nul  Find a char, or the end of a string.
+ *
+ * @param p_data : ptr to the buffer.
+ * @param size   : size of the buffer.
+ * @param c      : char to find.
+ * @return position of the first c or '\0', or size if there is none.
+ */
+size_t cx_find_char_or_nul(const char *p_data, size_t size, char c) {
+    return kernels().find_char_or_nul(p_data, size, c);
+}
+
+/** cx_compare_strings   Compare two strings, as strcmp does.  The
+ *                      end of a buffer ends its string too.
+ *
+ * @param p_data1 : ptr to the first buffer.
+ * @param size1   : size of the first buffer.
+ * @param p_data2 : ptr to the second buffer.
+ * @param size2   : size of the second buffer.
+ * @return difference of the first chars that differ, as unsigned
+ *         chars; 0 if the strings are equal.
+ */
+int cx_compare_strings(const char *p_data1, size_t size1,
+        const char *p_data2, size_t size2) {
+    const size_t size = (size1 < size2) ? size1 : size2;
+    const size_t i = kernels().find_mismatch(p_data1, p_data2, size);
+    const unsigned char c1 = (i < size1) ? p_data1[i] : '\0';
+    const unsigned char c2 = (i < size2) ? p_data2[i] : '\0';
+
+    return (int) c1 - (int) c2;
+}
+
+/** cx_find_substring    Find a pattern in a text.
+ *
+ * @param p_text         : ptr to the text.
+ * @param text_length    : length of the text.
+ * @param p_pattern      : ptr to the pattern.
+ * @param pattern_length : length of the pattern.
+ * @return the pattern's first position, or -1 if it isn't found.
+ */
+ptrdiff_t cx_find_substring(const char *p_text, size_t text_length,
+        const char *p_pattern, size_t pattern_length) {
+    if (pattern_length == 0) return 0;
+    if (pattern_length > text_length) return -1;
+
+    if (pattern_length == 1) {
+        const void *p_found = memchr(p_text, p_pattern[0], text_length);
+
+        return (p_found != nullptr) ? (const char *) p_found - p_text : -1;
+    }
+
+    return kernels().find_substring(p_text, text_length,
+            p_pattern, pattern_length);
+}
@@ -2,18 +2,11 @@
 #include <iostream>
 #include "error.h"
 #include "buffer.h"
+#include "context.h"
 #include "symtable.h"
 #include "types.h"
 #include "icode.h"
 
-//
-extern cx_type *p_integer_type;
-extern cx_type *p_float_type;
-extern cx_type *p_char_type;
-
-int asm_label_index = 0; // assembly label index
-bool xreference_flag = false; // true = cross-referencing on, false = off
-
 /****************
  *              *
  *  Definition  *
@@ -33,7 +26,9 @@ cx_define::~cx_define(void) {
         case dc_program:
         case dc_function:
 
-            if (routine.which == rc_declared) {
+            if ((routine.which == rc_declared)
+                    || (routine.which == rc_intrinsic)
+                    || (routine.which == rc_host)) {
                 if (routine.p_symtab != nullptr) delete routine.p_symtab;
                 if (routine.p_icode != nullptr) delete routine.p_icode;
             }
@@ -53,10 +48,12 @@ cx_define::~cx_define(void) {
  *                  izing its subtree pointers and the pointer
  *                  to its symbol string.
  *
- * @param p_str : ptr to the symbol string.
- * @param dc    : definition code.
+ * @param p_context : ptr to the context of the script.
+ * @param p_str     : ptr to the symbol string.
+ * @param dc        : definition code.
  */
-cx_symtab_node::cx_symtab_node(const char *p_str, cx_define_code dc)
+cx_symtab_node::cx_symtab_node(cx_context *p_context, const char *p_str,
+        cx_define_code dc)
 : defn(dc) {
     left__ = right__ = next__ = nullptr;
     p_line_num_list = nullptr;
@@ -64,15 +61,16 @@ cx_symtab_node::cx_symtab_node(const char *p_str, cx_define_code dc)
     xnode = 0;
     global_finish_location = 0;
     found_global_end = false;
-    level = current_nesting_level;
-    label_index = ++asm_label_index;
+    is_atomic = false;
+    level = p_context->current_nesting_level;
+    label_index = ++p_context->asm_label_index;
 
     // Allocate and copy the symbol string.
     p_string = new char[strlen(p_str) + 1];
     strcpy(p_string, p_str);
 
     // If cross-referencing, update the line number list.
-    if (xreference_flag) p_line_num_list = new cx_line_num_list;
+    if (p_context->xreference_flag) p_line_num_list = new cx_line_num_list;
 }
 
 /** Destructor      Deallocate a symbol table node.
@@ -99,6 +97,7 @@ cx_symtab_node::~cx_symtab_node(void) {
  */
 void cx_symtab_node::print(void) const {
     const int max_name_print_width = 16;
+    cx_list_buffer &list = cx_context::current()->list;
 
     // Pirst, print left__ subtree
     if (left__) left__->print();
@@ -140,20 +139,21 @@ void cx_symtab_node::print_identifier(void) const {
  *
  */
 void cx_symtab_node::print_constant(void) const {
-    extern cx_list_buffer list;
+    cx_context *p_context = cx_context::current();
+    cx_list_buffer &list = p_context->list;
 
     list.put_line();
     list.put_line("Defined constant");
 
     // value
-    if ((p_type == p_integer_type) ||
+    if ((p_type == p_context->p_integer_type) ||
             (p_type->form == fc_enum)) {
         sprintf(list.text, "value = %d",
                 defn.constant.value.int__);
-    } else if (p_type == p_float_type) {
+    } else if (p_type == p_context->p_float_type) {
         sprintf(list.text, "value = %g",
                 defn.constant.value.float__);
-    } else if (p_type == p_char_type) {
+    } else if (p_type == p_context->p_char_type) {
         sprintf(list.text, "value = '%c'",
                 defn.constant.value.char__);
     } else if (p_type->form == fc_array) {
@@ -173,7 +173,7 @@ void cx_symtab_node::print_constant(void) const {
  *
  */
 void cx_symtab_node::print_var_or_field(void) const {
-    extern cx_list_buffer list;
+    cx_list_buffer &list = cx_context::current()->list;
 
     list.put_line();
     list.put_line(defn.how == dc_variable ? "Declared variable"
@@ -189,6 +189,8 @@ void cx_symtab_node::print_var_or_field(void) const {
  *
  */
 void cx_symtab_node::print_type(void) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     list.put_line();
     list.put_line("Defined type");
 
@@ -218,6 +220,21 @@ void cx_symtab_node::convert(cx_symtab_node *p_vector_nodes[]) {
  *                *
  ******************/
 
+/** Constructor     Make an empty symbol table, and number it
+ *                  among the context's tables.
+ *
+ * @param p_context : ptr to the context of the script.
+ */
+cx_symtab::cx_symtab(cx_context *p_context)
+: p_context(p_context), nodes_count(0), xsymtab(0) {
+    root__ = nullptr;
+    p_vector_nodes = nullptr;
+    xsymtab = p_context->symtab_count++;
+
+    next__ = p_context->p_symtab_list;
+    p_context->p_symtab_list = this;
+}
+
 /** search      search the symbol table for the node with a
  *              given name string.
  *
@@ -238,7 +255,7 @@ cx_symtab_node *cx_symtab::search(const char *p_string) const {
     }
 
     // If found and cross-referencing, update the line number list.
-    if (xreference_flag && (comp == 0)) p_node->p_line_num_list->update();
+    if (p_context->xreference_flag && (comp == 0)) p_node->p_line_num_list->update();
 
     return p_node; // ptr to node, or nullptr if not found
 }
@@ -267,7 +284,7 @@ cx_symtab_node *cx_symtab::enter(const char *p_string, cx_define_code dc) {
     }
 
     // Create and insert a new node.
-    p_node = new cx_symtab_node(p_string, dc); // create a new node,
+    p_node = new cx_symtab_node(p_context, p_string, dc); // create a new node,
     p_node->xsymtab = xsymtab; // set its symtab and
     p_node->xnode = nodes_count++; // node indexes,
     *ppNode = p_node; // insert it, and
@@ -276,7 +293,9 @@ cx_symtab_node *cx_symtab::enter(const char *p_string, cx_define_code dc) {
 
 /** enter_new    search the symbol table for the given name
  *              string.  If the name is not already in there,
- *              enter it.  Otherwise, flag the redefined
+ *              enter it.  If it names a standard routine the
+ *              script may shadow, the node is taken over as the
+ *              new name's.  Otherwise, flag the redefined
  *              identifier error.
  *
  * @param p_string : ptr to name string to enter.
@@ -287,11 +306,29 @@ cx_symtab_node *cx_symtab::enter_new(const char *p_string, cx_define_code dc) {
     cx_symtab_node *p_node = search(p_string);
 
     if (!p_node) p_node = enter(p_string, dc);
-    else cx_error(err_redefined_identifier);
+    else if (shadowable(p_node)) {
+        remove_type(p_node->p_type);
+        p_node->p_type = nullptr;
+        p_node->defn.how = dc;
+    } else cx_error(err_redefined_identifier);
 
     return p_node;
 }
 
+/** shadowable  True if a script's own declaration may take
+ *              over a node:  a standard routine's, as long as
+ *              no call to the routine has been parsed, which
+ *              would run the script's declaration instead.
+ *
+ * @param p_node : ptr to the node.
+ * @return true if the node may be taken over.
+ */
+bool cx_symtab::shadowable(const cx_symtab_node *p_node) const {
+    return (p_node->defn.how == dc_function)
+            && (p_node->defn.routine.which > rc_host)
+            && (p_context->called_standard_routines.count(p_node) == 0);
+}
+
 /** convert     convert the symbol table into a form suitable
  *		for the back end.
  *
@@ -302,8 +339,10 @@ void cx_symtab::convert(cx_symtab *p_vector_symtabs[]) {
     // to this symbol table.
     p_vector_symtabs[xsymtab] = this;
 
-    // Allocate the symbol table node pointer vector
-    // and convert the nodes.
+    /* Allocate the symbol table node pointer vector
+     * and convert the nodes. A table can be converted
+     * again after the optimizer enters temporaries. */
+    if (p_vector_nodes != nullptr) delete [] p_vector_nodes;
     p_vector_nodes = new cx_symtab_node *[nodes_count];
     root__->convert(p_vector_nodes);
 }
@@ -315,29 +354,77 @@ void cx_symtab::convert(cx_symtab *p_vector_symtabs[]) {
  ************************/
 
 /** Constructor	    Initialize the global (level 0) symbol
- *		    table, and set the others to nullptr.
+ *		    table, and set the others to nullptr.  The
+ *		    context has already entered the predefined
+ *		    types and routines.
  *
+ * @param p_context : ptr to the context of the script.
  */
-cx_symtab_stack::cx_symtab_stack(void) {
-    extern cx_symtab cx_global_symtab;
-    void initialize_std_functions(cx_symtab * p_symtab);
-
-    current_nesting_level = 0;
+cx_symtab_stack::cx_symtab_stack(cx_context *p_context)
+: p_context(p_context) {
+    p_context->current_nesting_level = 0;
     for (int i = 1; i < max_nesting_level; ++i) p_symtabs[i] = nullptr;
 
     // Initialize the global nesting level.
-    p_symtabs[0] = &cx_global_symtab;
+    p_symtabs[0] = &p_context->global_symtab;
+}
+
+/** search_local  search the current scope's symbol table.
+ *
+ * @param p_string : ptr to name string to find.
+ * @return ptr to symbol table node if found, else nullptr.
+ */
+cx_symtab_node *cx_symtab_stack::search_local(const char *p_string) {
+    return p_symtabs[p_context->current_nesting_level]->search(p_string);
+}
+
+/** enter_local   enter a name into the current scope's symbol
+ *              table, unless it's already there.
+ *
+ * @param p_string : ptr to name string to enter.
+ * @param dc       : definition code.
+ * @return ptr to symbol table node.
+ */
+cx_symtab_node *cx_symtab_stack::enter_local(const char *p_string,
+        cx_define_code dc) {
+    return p_symtabs[p_context->current_nesting_level]->enter(p_string, dc);
+}
+
+/** enter_new_local       enter a new name into the current
+ *                      scope's symbol table.  Flag the redefined
+ *                      identifier error if it's already there.
+ *
+ * @param p_string : ptr to name string to enter.
+ * @param dc       : definition code.
+ * @return ptr to symbol table node.
+ */
+cx_symtab_node *cx_symtab_stack::enter_new_local(const char *p_string,
+        cx_define_code dc) {
+    return p_symtabs[p_context->current_nesting_level]->enter_new(p_string, dc);
+}
 
-    initialize_builtin_types(p_symtabs[0]);
+/** get_current_symtab   The current scope's symbol table.
+ *
+ * @return ptr to the symbol table.
+ */
+cx_symtab *cx_symtab_stack::get_current_symtab(void) const {
+    return p_symtabs[p_context->current_nesting_level];
+}
 
-    //initialize_std_functions(p_symtabs[0]);
+/** set_current_symtab   Make a symbol table the current scope's.
+ *
+ * @param p_symtab : ptr to the symbol table.
+ */
+void cx_symtab_stack::set_current_symtab(cx_symtab *p_symtab) {
+    p_symtabs[p_context->current_nesting_level] = p_symtab;
 }
 
-/** Destructor	    Remove the predefined types.
+/** set_scope     Set the current nesting level.
  *
+ * @param scope_level : the nesting level.
  */
-cx_symtab_stack::~cx_symtab_stack(void) {
-    remove_builtin_types();
+void cx_symtab_stack::set_scope(int scope_level) {
+    p_context->current_nesting_level = scope_level;
 }
 
 /** search_all   search the symbol table stack for the given
@@ -347,7 +434,7 @@ cx_symtab_stack::~cx_symtab_stack(void) {
  * @return ptr to symbol table node if found, else nullptr.
  */
 cx_symtab_node *cx_symtab_stack::search_all(const char *p_string) const {
-    for (int i = current_nesting_level; i >= 0; --i) {
+    for (int i = p_context->current_nesting_level; i >= 0; --i) {
         cx_symtab_node *p_node = p_symtabs[i]->search(p_string);
         if (p_node) return p_node;
     }
@@ -369,7 +456,7 @@ cx_symtab_node *cx_symtab_stack::find(const char *p_string) const {
 
     if (!p_node) {
         cx_error(err_undefined_identifier);
-        p_node = p_symtabs[current_nesting_level]->enter(p_string);
+        p_node = p_symtabs[p_context->current_nesting_level]->enter(p_string);
     }
 
     return p_node;
@@ -385,12 +472,12 @@ void cx_symtab_stack::enter_scope(void) {
     // dont overwrite mains scope
     //if (current_nesting_level <= 1)++current_nesting_level;
 
-    if (++current_nesting_level > max_nesting_level) {
+    if (++p_context->current_nesting_level > max_nesting_level) {
         cx_error(err_nesting_too_deep);
         abort_translation(abort_nesting_too_deep);
     }
 
-    set_current_symtab(new cx_symtab);
+    set_current_symtab(new cx_symtab(p_context));
 }
 
 /** exit_scope	Exit the current scope and return to the
@@ -401,7 +488,7 @@ void cx_symtab_stack::enter_scope(void) {
  * @return ptr to closed scope's symbol table.
  */
 cx_symtab *cx_symtab_stack::exit_scope(void) {
-    return p_symtabs[current_nesting_level--];
+    return p_symtabs[p_context->current_nesting_level--];
 }
 
 /**********************
@@ -410,6 +497,13 @@ cx_symtab *cx_symtab_stack::exit_scope(void) {
  *                    *
  **********************/
 
+/** Constructor     Make a node for the line being parsed.
+ */
+cx_line_num_node::cx_line_num_node(void)
+: number(cx_context::current()->current_line_number) {
+    next__ = nullptr;
+}
+
 /** Destructor      Deallocate a line number list.
  *
  */
@@ -429,7 +523,9 @@ cx_line_num_list::~cx_line_num_list(void) {
  */
 void cx_line_num_list::update(void) {
     // If the line number is already there, it'll be at the tail.
-    if (tail && (tail->number == current_line_number)) return;
+    if (tail && (tail->number == cx_context::current()->current_line_number)) {
+        return;
+    }
 
     // Append the new node.
     tail->next__ = new cx_line_num_node;
@@ -448,6 +544,7 @@ void cx_line_num_list::print(int new_line_flag, int indent) const {
 
     int n; // count of numbers per line
     cx_line_num_node *p_node; // ptr to line number node
+    cx_list_buffer &list = cx_context::current()->list;
     char *plt = &list.text[strlen(list.text)];
     // ptr to where in list text to append
 
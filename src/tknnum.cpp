@@ -5,6 +5,7 @@
 #include <climits>
 #include <cfloat>
 #include <cctype>
+#include "context.h"
 #include "token.h"
 
 /// radix number bases
@@ -29,12 +30,12 @@ enum cx_radix_base {
  */
 void cx_number_token::get(cx_text_in_buffer &buffer) {
 
-    float number_value = 0.0; /* value of number ignoring
-                           * the decimal point */
+    double number_value = 0.0; /* value of number ignoring
+                           * the decimal point; exact for any int */
     int whole_places = 0; // no. digits before the decimal point
     int decimal_places = 0; // no. digits after  the decimal point
     char exponent_sign = '+';
-    float e_value = 0.0; // value of number after 'E'
+    double e_value = 0.0; // value of number after 'E'
     int exponent = 0; // final value of exponent
     bool saw_dot_dot_Flag = false; // true if encountered '..',
 
@@ -136,7 +137,7 @@ void cx_number_token::get(cx_text_in_buffer &buffer) {
         cx_error(err_real_out_of_range);
         return;
     }
-    if (exponent != 0) number_value *= float(pow((double) 10, exponent));
+    if (exponent != 0) number_value *= pow((double) 10, exponent);
 
     // Check and set the numeric value.
     if (type__ == ty_integer) {
@@ -145,7 +146,7 @@ void cx_number_token::get(cx_text_in_buffer &buffer) {
             return;
         }
         value__.int__ = int(number_value);
-    } else value__.float__ = number_value;
+    } else value__.float__ = (float) number_value;
 
     *ps = '\0';
     code__ = tc_number;
@@ -160,7 +161,7 @@ void cx_number_token::get(cx_text_in_buffer &buffer) {
  * @return true  if success false if failure.
  */
 int cx_number_token::accumulate_value(cx_text_in_buffer &buffer,
-        float &value, cx_error_code ec) {
+        double &value, cx_error_code ec) {
 
     const int max_digit_count = 20;
 
@@ -221,6 +222,8 @@ bool cx_number_token::is_x_digit(const char& c) {
  *
  */
 void cx_number_token::print(void) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     if (type__ == ty_integer) {
         sprintf(list.text, "\t%-18s =%d", ">> integer:",
                 value__.int__);
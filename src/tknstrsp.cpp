@@ -1,5 +1,6 @@
 #include <cstdio>
 #include <cstdint>
+#include "context.h"
 #include "token.h"
 
 /** get_escape_char             Return escape char
@@ -112,6 +113,8 @@ void cx_char_token::get(cx_text_in_buffer &buffer) {
 }
 
 void cx_char_token::print(void) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     sprintf(list.text, "\t%-18s %-s", ">> char:", string);
     list.put_line();
 }
@@ -120,6 +123,8 @@ void cx_char_token::print(void) const {
  *
  */
 void cx_string_token::print(void) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     sprintf(list.text, "\t%-18s %-s", ">> string:", string);
     list.put_line();
 }
@@ -324,6 +329,8 @@ void cx_special_token::get(cx_text_in_buffer &buffer) {
  *
  */
 void cx_special_token::print(void) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     sprintf(list.text, "\t%-18s %-s", ">> special:", string);
     list.put_line();
 }
@@ -2,6 +2,7 @@
 #include <cstring>
 #include <cstdio>
 #include "misc.h"
+#include "context.h"
 #include "token.h"
 
 /*************************
@@ -54,6 +55,9 @@ std::pair<std::string, cx_token_code> map_data[] = {
     std::make_pair("typedef", tc_TYPEDEF),
     std::make_pair("mutable", tc_MUTABLE),
     std::make_pair("include", tc_INCLUDE),
+    std::make_pair("parallel", tc_PARALLEL),
+    std::make_pair("spawn", tc_SPAWN),
+    std::make_pair("atomic", tc_ATOMIC),
 };
 
 
@@ -72,8 +76,6 @@ token_map cx_reserved_words(map_data,
  * @param buffer : ptr to text input buffer.
  */
 void cx_word_token::get(cx_text_in_buffer &buffer) {
-    extern cx_char_code_map char_code_map;
-
     char ch = buffer.current_char(); // char fetched from input
     char *ps = string;
 
@@ -100,14 +102,16 @@ void cx_word_token::check_for_reserved_word(void) {
 
     /* from the reserved word table, check to see if the word
      * is in there. */
-    cx_token_code c_ = cx_reserved_words[this->string__()];
-    if (c_ > 0) code__ = c_;
+    token_map::const_iterator it = cx_reserved_words.find(this->string__());
+    if (it != cx_reserved_words.end()) code__ = it->second;
 
 }
 
 /** print       print the token to the list file.
  */
 void cx_word_token::print(void) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     if (code__ == tc_identifier) {
         sprintf(list.text, "\t%-18s %-s", ">> identifier:", string);
     } else {
@@ -1,5 +1,6 @@
 #include <cstdio>
 #include "buffer.h"
+#include "context.h"
 #include "error.h"
 #include "types.h"
 
@@ -7,37 +8,6 @@ const char *form_strings[] = {
     "*error*", "scalar", "enum", "subrange", "array", "complex", "pointer"
 };
 
-// Pointers to predefined types.
-cx_symtab_node *p_main_function_id = nullptr;
-cx_symtab_node *p_stdin = nullptr;
-cx_symtab_node *p_stdout = nullptr;
-cx_symtab_node *p_stderr = nullptr;
-
-cx_type *p_integer_type = nullptr;
-cx_type *p_short_type = nullptr;
-cx_type *p_long_type = nullptr;
-
-cx_type *p_uint8_type = nullptr;
-cx_type *p_uint16_type = nullptr;
-cx_type *p_uint32_type = nullptr;
-cx_type *p_uint64_type = nullptr;
-
-cx_type *p_float_type = nullptr;
-cx_type *p_double_type = nullptr;
-
-cx_type *p_boolean_type = nullptr;
-
-cx_type *p_char_type = nullptr;
-cx_type *p_wchar_type = nullptr;
-
-//cx_type *p_class_type = nullptr;
-
-cx_type *p_complex_type = nullptr;
-
-cx_type *p_file_type = nullptr;
-
-cx_type *p_dummy_type = nullptr;
-
 /** Constructors    General.
  *
  * @param fc  : form code.
@@ -45,7 +15,11 @@ cx_type *p_dummy_type = nullptr;
  * @param p_id : ptr to symbol table node of type identifier.
  */
 cx_type::cx_type(cx_type_form_code fc, int s, cx_symtab_node* p_id)
-: form(fc), size(s), p_type_id(p_id), reference_count(0) {
+: form(fc), size(s), p_type_id(p_id), reference_count(0),
+is_constant__(false) {
+
+    // unnamed types have no basic type code
+    type_code = cx_void;
 
     switch (fc) {
         case fc_array:
@@ -53,6 +27,13 @@ cx_type::cx_type(cx_type_form_code fc, int s, cx_symtab_node* p_id)
             this->form = fc_array;
             array.p_index_type = array.p_element_type = nullptr;
             break;
+        case fc_stream:
+            stream.p_file_name = stream.p_file_mode = nullptr;
+            stream.p_file_stream = nullptr;
+            stream.p_out_buffer = nullptr;
+            stream.p_in_buffer = nullptr;
+            stream.p_bound_stream = nullptr;
+            break;
         default:
             break;
     }
@@ -89,13 +70,18 @@ cx_type::cx_type(cx_type_form_code fc, int s, cx_symtab_node* p_id)
 
 cx_type::cx_type(int length, bool constant)
 : size(length), form(fc_array), reference_count(0), is_constant__(constant) {
+    cx_context *p_context = cx_context::current();
+
     p_type_id = nullptr;
+    type_code = cx_char;
 
     // used for string constants only. can probably go away
     array.p_index_type = array.p_element_type = nullptr;
-    set_type(array.p_index_type, p_integer_type);
-    set_type(array.p_element_type, p_char_type);
+    set_type(array.p_index_type, p_context->p_integer_type);
+    set_type(array.p_element_type, p_context->p_char_type);
     array.element_count = length;
+    array.min_index = 0;
+    array.max_index = length;
 
 }
 
@@ -118,6 +104,9 @@ cx_type::~cx_type() {
         case fc_complex:
             // delete complex.pSymtabPublic;
             break;
+        case fc_stream:
+            remove_type(stream.p_bound_stream);
+            break;
 
         default:
             break;
@@ -130,6 +119,8 @@ cx_type::~cx_type() {
  * @param vc : vc_verbose or vc_terse to control the output.
  */
 void cx_type::print_type_spec(cx_verbosity_code vc) {
+    cx_list_buffer &list = cx_context::current()->list;
+
     sprintf(list.text, "%s, size %d bytes. type id: ", form_strings[form], size);
 
     if (p_type_id) strcat(list.text, p_type_id->string__());
@@ -160,6 +151,8 @@ void cx_type::print_type_spec(cx_verbosity_code vc) {
  * @param vc : vc_verbose or vc_terse to control the output.
  */
 void cx_type::print_enum_type(cx_verbosity_code vc) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     if (vc == vc_terse) return;
 
     list.put_line("---enum constant identifiers (value = name)---");
@@ -199,6 +192,8 @@ void cx_type::print_subrange_type(cx_verbosity_code vc) const {
  * @param vc : vc_verbose or vc_terse to control the output.
  */
 void cx_type::print_array_type(cx_verbosity_code vc) const {
+    cx_list_buffer &list = cx_context::current()->list;
+
     if (vc == vc_terse) return;
 
     sprintf(list.text, "%d elements", array.element_count);
@@ -221,6 +216,8 @@ void cx_type::print_array_type(cx_verbosity_code vc) const {
  * @param vc : vc_verbose or vc_terse to control the output.
  */
 void cx_type::print_record_type(cx_verbosity_code vc) {
+    cx_list_buffer &list = cx_context::current()->list;
+
     if (vc == vc_terse) return;
 
     list.put_line("member identifiers (offset : name)---");
@@ -290,12 +287,14 @@ void cx_type::print_record_type(cx_verbosity_code vc) {
  *                              identifiers into the symbol
  *                              table.
  *
- * @param p_symtab : ptr to symbol table.
+ * @param p_context : ptr to the context whose global symbol
+ *                   table they go in.
  */
-void initialize_builtin_types(cx_symtab *p_symtab) {
+void initialize_builtin_types(cx_context *p_context) {
+    cx_symtab *p_symtab = &p_context->global_symtab;
 
-    p_main_function_id = p_symtab->enter("main", dc_function);
-    p_main_function_id->defn.routine.which = rc_forward;
+    p_context->p_main_function_id = p_symtab->enter("main", dc_function);
+    p_context->p_main_function_id->defn.routine.which = rc_forward;
 
     // signed int
     cx_symtab_node *p_integer_id = p_symtab->enter("int", dc_type);
@@ -320,118 +319,121 @@ void initialize_builtin_types(cx_symtab *p_symtab) {
 
     cx_symtab_node *p_fileId = p_symtab->enter("file", dc_type);
 
-    if (!p_integer_type) {
-        set_type(p_integer_type, new cx_type(fc_scalar, sizeof (int), p_integer_id));
+    if (!p_context->p_integer_type) {
+        set_type(p_context->p_integer_type, new cx_type(fc_scalar, sizeof (int), p_integer_id));
     }
 
-    if (!p_uint8_type) {
-        set_type(p_uint8_type, new cx_type(fc_scalar, sizeof (uint8_t), p_uint8_id));
+    if (!p_context->p_uint8_type) {
+        set_type(p_context->p_uint8_type, new cx_type(fc_scalar, sizeof (uint8_t), p_uint8_id));
     }
 
-    if (!p_uint16_type) {
-        set_type(p_uint16_type, new cx_type(fc_scalar, sizeof (uint16_t), p_uint16_id));
+    if (!p_context->p_uint16_type) {
+        set_type(p_context->p_uint16_type, new cx_type(fc_scalar, sizeof (uint16_t), p_uint16_id));
     }
 
-    if (!p_uint32_type) {
-        set_type(p_uint32_type, new cx_type(fc_scalar, sizeof (uint32_t), p_uint32_id));
+    if (!p_context->p_uint32_type) {
+        set_type(p_context->p_uint32_type, new cx_type(fc_scalar, sizeof (uint32_t), p_uint32_id));
     }
 
-    if (!p_uint64_type) {
-        set_type(p_uint64_type, new cx_type(fc_scalar, sizeof (uint64_t), p_uint64_id));
+    if (!p_context->p_uint64_type) {
+        set_type(p_context->p_uint64_type, new cx_type(fc_scalar, sizeof (uint64_t), p_uint64_id));
     }
 
-    if (!p_float_type) {
-        set_type(p_float_type, new cx_type(fc_scalar, sizeof (float), p_float_id));
+    if (!p_context->p_float_type) {
+        set_type(p_context->p_float_type, new cx_type(fc_scalar, sizeof (float), p_float_id));
     }
 
-    if (!p_boolean_type) {
-        set_type(p_boolean_type, new cx_type(fc_enum, sizeof (bool), p_boolean_id));
+    if (!p_context->p_boolean_type) {
+        set_type(p_context->p_boolean_type, new cx_type(fc_enum, sizeof (bool), p_boolean_id));
     }
 
-    if (!p_char_type) {
-        set_type(p_char_type, new cx_type(fc_scalar, sizeof (char), p_char_id));
+    if (!p_context->p_char_type) {
+        set_type(p_context->p_char_type, new cx_type(fc_scalar, sizeof (char), p_char_id));
     }
 
-    if (!p_wchar_type) {
-        set_type(p_wchar_type, new cx_type(fc_scalar, sizeof (wchar_t), p_wchar_id));
+    if (!p_context->p_wchar_type) {
+        set_type(p_context->p_wchar_type, new cx_type(fc_scalar, sizeof (wchar_t), p_wchar_id));
     }
 
-    if (!p_complex_type) {
-        set_type(p_complex_type, new cx_type(fc_complex, sizeof (cx_type), p_complex_id));
+    if (!p_context->p_complex_type) {
+        set_type(p_context->p_complex_type, new cx_type(fc_complex, sizeof (cx_type), p_complex_id));
     }
 
-    if (!p_file_type) {
-        set_type(p_file_type, new cx_type(fc_stream, sizeof (FILE), p_fileId));
+    if (!p_context->p_file_type) {
+        set_type(p_context->p_file_type, new cx_type(fc_stream, sizeof (FILE), p_fileId));
     }
 
-    set_type(p_main_function_id->p_type, p_integer_type);
+    set_type(p_context->p_main_function_id->p_type, p_context->p_integer_type);
 
     // link each predefined type id's node to it's type object
-    set_type(p_integer_id->p_type, p_integer_type);
+    set_type(p_integer_id->p_type, p_context->p_integer_type);
 
-    set_type(p_uint8_id->p_type, p_uint8_type);
-    set_type(p_uint16_id->p_type, p_uint16_type);
-    set_type(p_uint32_id->p_type, p_uint32_type);
-    set_type(p_uint64_id->p_type, p_uint64_type);
+    set_type(p_uint8_id->p_type, p_context->p_uint8_type);
+    set_type(p_uint16_id->p_type, p_context->p_uint16_type);
+    set_type(p_uint32_id->p_type, p_context->p_uint32_type);
+    set_type(p_uint64_id->p_type, p_context->p_uint64_type);
 
-    set_type(p_float_id->p_type, p_float_type);
+    set_type(p_float_id->p_type, p_context->p_float_type);
 
-    set_type(p_boolean_id->p_type, p_boolean_type);
+    set_type(p_boolean_id->p_type, p_context->p_boolean_type);
 
-    set_type(p_char_id->p_type, p_char_type);
-    set_type(p_wchar_id->p_type, p_wchar_type);
+    set_type(p_char_id->p_type, p_context->p_char_type);
+    set_type(p_wchar_id->p_type, p_context->p_wchar_type);
 
-    set_type(p_complex_id->p_type, p_complex_type);
+    set_type(p_complex_id->p_type, p_context->p_complex_type);
 
-    set_type(p_fileId->p_type, p_file_type);
+    set_type(p_fileId->p_type, p_context->p_file_type);
 
-    p_boolean_type->enumeration.max = 1;
-    p_boolean_type->enumeration.p_const_ids = p_false_id;
+    p_context->p_boolean_type->enumeration.max = 1;
+    p_context->p_boolean_type->enumeration.p_const_ids = p_false_id;
 
     p_false_id->defn.constant.value.int__ = 0;
     p_true_id->defn.constant.value.int__ = 1;
 
-    set_type(p_true_id->p_type, p_boolean_type);
-    set_type(p_false_id->p_type, p_boolean_type);
+    set_type(p_true_id->p_type, p_context->p_boolean_type);
+    set_type(p_false_id->p_type, p_context->p_boolean_type);
 
     p_false_id->next__ = p_true_id;
 
-    p_stdout = p_symtab->enter("stdout", ::dc_variable);
-    set_type(p_stdout->p_type, p_file_type);
-    p_stdout->p_type->stream.p_file_stream = stdout;
+    // each stream keeps its FILE and its buffer in its own type object
+    p_context->p_stdout = p_symtab->enter("stdout", ::dc_variable);
+    set_type(p_context->p_stdout->p_type, new cx_type(fc_stream, sizeof (FILE), p_fileId));
+    p_context->p_stdout->p_type->stream.p_file_stream = stdout;
 
-    p_stdin = p_symtab->enter("stdin", ::dc_variable);
-    set_type(p_stdin->p_type, p_file_type);
-    p_stdin->p_type->stream.p_file_stream = stdin;
+    p_context->p_stdin = p_symtab->enter("stdin", ::dc_variable);
+    set_type(p_context->p_stdin->p_type, new cx_type(fc_stream, sizeof (FILE), p_fileId));
+    p_context->p_stdin->p_type->stream.p_file_stream = stdin;
 
-    p_stderr = p_symtab->enter("stderr", ::dc_variable);
-    set_type(p_stderr->p_type, p_file_type);
-    p_stderr->p_type->stream.p_file_stream = stderr;
+    p_context->p_stderr = p_symtab->enter("stderr", ::dc_variable);
+    set_type(p_context->p_stderr->p_type, new cx_type(fc_stream, sizeof (FILE), p_fileId));
+    p_context->p_stderr->p_type->stream.p_file_stream = stderr;
 
-    set_type(p_dummy_type, new cx_type(fc_none, 1, nullptr));
+    set_type(p_context->p_dummy_type, new cx_type(fc_none, 1, nullptr));
 }
 
 /** remove_builtin_types       Remove the predefined types.
+ *
+ * @param p_context : ptr to the context they were made for.
  */
-void remove_builtin_types(void) {
-    remove_type(p_complex_type);
+void remove_builtin_types(cx_context *p_context) {
+    remove_type(p_context->p_complex_type);
 
-    remove_type(p_float_type);
+    remove_type(p_context->p_float_type);
 
-    remove_type(p_boolean_type);
+    remove_type(p_context->p_boolean_type);
 
-    remove_type(p_char_type);
-    remove_type(p_wchar_type);
+    remove_type(p_context->p_char_type);
+    remove_type(p_context->p_wchar_type);
 
-    remove_type(p_integer_type);
+    remove_type(p_context->p_integer_type);
 
-    remove_type(p_uint8_type);
-    remove_type(p_uint16_type);
-    remove_type(p_uint32_type);
-    remove_type(p_uint64_type);
+    remove_type(p_context->p_uint8_type);
+    remove_type(p_context->p_uint16_type);
+    remove_type(p_context->p_uint32_type);
+    remove_type(p_context->p_uint64_type);
 
-    remove_type(p_dummy_type);
-    remove_type(p_file_type);
+    remove_type(p_context->p_dummy_type);
+    remove_type(p_context->p_file_type);
 }
 
 void remove_type(cx_type *&p_type);
@@ -484,6 +486,8 @@ void remove_type(cx_type *&p_type) {
  * @param p_type2 : ptr to the second operand's type object.
  */
 void check_relational_op_operands(const cx_type *p_type1, const cx_type *p_type2) {
+    const cx_context *p_context = cx_context::current();
+
     p_type1 = p_type1->base_type();
     p_type2 = p_type2->base_type();
 
@@ -492,21 +496,21 @@ void check_relational_op_operands(const cx_type *p_type1, const cx_type *p_type2
         return;
     }
 
-    if (((p_type1 == p_integer_type) && (p_type2 == p_float_type))
-            || ((p_type2 == p_integer_type) && (p_type2 == p_float_type))) {
+    if (((p_type1 == p_context->p_integer_type) && (p_type2 == p_context->p_float_type))
+            || ((p_type2 == p_context->p_integer_type) && (p_type2 == p_context->p_float_type))) {
         return;
     }
 
-    if ((p_type1 == p_char_type) && (p_type2 == p_integer_type) &&
+    if ((p_type1 == p_context->p_char_type) && (p_type2 == p_context->p_integer_type) &&
             (p_type1->form == fc_scalar)) return;
 
-    if ((p_type1 == p_integer_type) && (p_type2 == p_char_type) &&
+    if ((p_type1 == p_context->p_integer_type) && (p_type2 == p_context->p_char_type) &&
             (p_type2->form == fc_scalar)) return;
 
     if ((p_type1->form == fc_array)
             && (p_type2->form == fc_array)
-            && (p_type1->array.p_element_type == p_char_type)
-            && (p_type2->array.p_element_type == p_char_type)
+            && (p_type1->array.p_element_type == p_context->p_char_type)
+            && (p_type2->array.p_element_type == p_context->p_char_type)
             && (p_type1->array.element_count == p_type2->array.element_count)) {
         return;
     }
@@ -522,16 +526,18 @@ void check_relational_op_operands(const cx_type *p_type1, const cx_type *p_type2
  * @param p_type2 : ptr to the second operand's type object or nullptr.
  */
 void check_integer_or_real(const cx_type *p_type1, const cx_type *p_type2) {
+    const cx_context *p_context = cx_context::current();
+
     p_type1 = p_type1->base_type();
 
-    if ((p_type1 != p_integer_type) && (p_type1 != p_float_type)) {
+    if ((p_type1 != p_context->p_integer_type) && (p_type1 != p_context->p_float_type)) {
         cx_error(err_incompatible_types);
     }
 
     if (p_type2) {
         p_type2 = p_type2->base_type();
 
-        if ((p_type2 != p_integer_type) && (p_type2 != p_float_type)) {
+        if ((p_type2 != p_context->p_integer_type) && (p_type2 != p_context->p_float_type)) {
             cx_error(err_incompatible_types);
         }
     }
@@ -545,12 +551,28 @@ void check_integer_or_real(const cx_type *p_type1, const cx_type *p_type2) {
  * @param p_type2 : ptr to the second operand's type object or nullptr.
  */
 void check_boolean(const cx_type *p_type1, const cx_type *p_type2) {
-    if ((p_type1->base_type() != p_boolean_type)
-            || (p_type2 && (p_type2->base_type() != p_boolean_type))) {
+    const cx_context *p_context = cx_context::current();
+
+    if ((p_type1->base_type() != p_context->p_boolean_type)
+            || (p_type2 && (p_type2->base_type() != p_context->p_boolean_type))) {
         cx_error(err_incompatible_types);
     }
 }
 
+/** is_integer_type      Is a type one of the integer types, signed
+ *                      or unsigned?
+ *
+ * @param p_type : ptr to the type object.
+ * @return true if yes, false if no.
+ */
+static bool is_integer_type(const cx_type *p_type) {
+    const cx_context *p_context = cx_context::current();
+
+    return (p_type == p_context->p_integer_type) || (p_type == p_context->p_char_type)
+            || (p_type == p_context->p_uint8_type) || (p_type == p_context->p_uint16_type)
+            || (p_type == p_context->p_uint32_type) || (p_type == p_context->p_uint64_type);
+}
+
 /** check_assignment_type_compatible   Check that a value's type is
  *                                  assignment compatible with
  *                                  the target's type.  Flag an
@@ -562,43 +584,49 @@ void check_boolean(const cx_type *p_type1, const cx_type *p_type2) {
  */
 void check_assignment_type_compatible(const cx_type *p_target_type,
         const cx_type *p_value_type, cx_error_code ec) {
+    const cx_context *p_context = cx_context::current();
+
 
     p_target_type = p_target_type->base_type();
     p_value_type = p_value_type->base_type();
 
-    if ((p_target_type == p_file_type) ||
-            (p_value_type == p_file_type)) return;
+    // streams take and give any value
+    if ((p_target_type->form == fc_stream) ||
+            (p_value_type->form == fc_stream)) return;
 
     if (p_target_type == p_value_type) return;
 
-    if ((p_target_type == p_float_type)
-            && (p_value_type == p_integer_type)) return;
+    if ((p_target_type == p_context->p_float_type)
+            && (p_value_type == p_context->p_integer_type)) return;
+
+    if ((p_target_type == p_context->p_integer_type)
+            && (p_value_type == p_context->p_char_type)) return;
 
-    if ((p_target_type == p_integer_type)
-            && (p_value_type == p_char_type)) return;
+    if ((p_target_type == p_context->p_char_type)
+            && (p_value_type == p_context->p_integer_type)) return;
 
-    if ((p_target_type == p_char_type)
-            && (p_value_type == p_integer_type)) return;
+    if ((p_target_type == p_context->p_float_type)
+            && (p_value_type == p_context->p_double_type)) return;
 
-    if ((p_target_type == p_float_type)
-            && (p_value_type == p_double_type)) return;
+    if ((p_target_type == p_context->p_double_type)
+            && (p_value_type == p_context->p_integer_type)) return;
 
-    if ((p_target_type == p_double_type)
-            && (p_value_type == p_integer_type)) return;
+    if ((p_target_type == p_context->p_double_type)
+            && (p_value_type == p_context->p_float_type)) return;
 
-    if ((p_target_type == p_double_type)
-            && (p_value_type == p_float_type)) return;
+    if ((p_target_type == p_context->p_integer_type)
+            && (p_value_type == p_context->p_float_type)) return;
 
-    if ((p_target_type == p_integer_type)
-            && (p_value_type == p_float_type)) return;
+    // the unsigned types convert to and from the others, as in C
+    if (is_integer_type(p_target_type) && is_integer_type(p_value_type)) return;
 
-    if ((p_target_type == p_integer_type)
-            && (p_value_type == p_double_type)) return;
+    if ((p_target_type == p_context->p_integer_type)
+            && (p_value_type == p_context->p_double_type)) return;
 
     if ((p_target_type->form == fc_array)
             && (p_value_type->form == fc_array)
-            && (p_target_type->array.p_element_type == p_char_type)
-            && (p_value_type->array.p_element_type == p_char_type)) {
+            && (p_target_type->array.p_element_type == p_context->p_char_type)
+            && (p_value_type->array.p_element_type == p_context->p_char_type)) {
         return;
     }
 
@@ -613,13 +641,15 @@ void check_assignment_type_compatible(const cx_type *p_target_type,
  * @return true if yes, false if no.
  */
 bool integer_operands(const cx_type *p_type1, const cx_type *p_type2) {
+    const cx_context *p_context = cx_context::current();
+
     p_type1 = p_type1->base_type();
     p_type2 = p_type2->base_type();
 
-    return (((p_type1 == p_integer_type) && (p_type2 == p_integer_type)) ||
-            ((p_type1 == p_char_type) && (p_type2 == p_integer_type)) ||
-            ((p_type1 == p_integer_type) && (p_type2 == p_char_type)) ||
-            ((p_type1 == p_char_type) && (p_type2 == p_char_type)));
+    return (((p_type1 == p_context->p_integer_type) && (p_type2 == p_context->p_integer_type)) ||
+            ((p_type1 == p_context->p_char_type) && (p_type2 == p_context->p_integer_type)) ||
+            ((p_type1 == p_context->p_integer_type) && (p_type2 == p_context->p_char_type)) ||
+            ((p_type1 == p_context->p_char_type) && (p_type2 == p_context->p_char_type)));
 }
 
 /** real_operands        Check that the types of both operands
@@ -631,16 +661,18 @@ bool integer_operands(const cx_type *p_type1, const cx_type *p_type2) {
  * @return true if yes, false if no.
  */
 bool real_operands(const cx_type *p_type1, const cx_type *p_type2) {
+    const cx_context *p_context = cx_context::current();
+
     p_type1 = p_type1->base_type();
     p_type2 = p_type2->base_type();
 
-    return (((p_type1 == p_float_type) && (p_type2 == p_float_type))
-            || ((p_type1 == p_float_type) && (p_type2 == p_integer_type))
-            || ((p_type2 == p_float_type) && (p_type1 == p_integer_type))
-            || ((p_type1 == p_float_type) && (p_type2 == p_double_type))
-            || ((p_type2 == p_float_type) && (p_type1 == p_double_type))
-            || ((p_type1 == p_double_type) && (p_type2 == p_integer_type))
-            || ((p_type2 == p_double_type) && (p_type1 == p_integer_type))
-            || ((p_type1 == p_double_type) && (p_type2 == p_float_type))
-            || ((p_type2 == p_double_type) && (p_type1 == p_float_type)));
+    return (((p_type1 == p_context->p_float_type) && (p_type2 == p_context->p_float_type))
+            || ((p_type1 == p_context->p_float_type) && (p_type2 == p_context->p_integer_type))
+            || ((p_type2 == p_context->p_float_type) && (p_type1 == p_context->p_integer_type))
+            || ((p_type1 == p_context->p_float_type) && (p_type2 == p_context->p_double_type))
+            || ((p_type2 == p_context->p_float_type) && (p_type1 == p_context->p_double_type))
+            || ((p_type1 == p_context->p_double_type) && (p_type2 == p_context->p_integer_type))
+            || ((p_type2 == p_context->p_double_type) && (p_type1 == p_context->p_integer_type))
+            || ((p_type1 == p_context->p_double_type) && (p_type2 == p_context->p_float_type))
+            || ((p_type2 == p_context->p_double_type) && (p_type1 == p_context->p_float_type)));
 }
\ No newline at end of file